@@ -19,6 +19,8 @@
 
 #include "CommonDataType/CommonDataType.h"
 #include "DvppCommon/DvppCommon.h"
+#include "ModuleManager/ModuleMessage.h"
+#include "ObjectPool/ObjectPool.h"
 
 struct FrameInfo {
     bool eof;
@@ -27,6 +29,7 @@ struct FrameInfo {
     uint32_t width;
     uint32_t height;
     acldvppStreamFormat format;
+    ascendBaseModule::ModuleMessageContext msgContext;
 };
 
 struct FrameData {
@@ -41,6 +44,7 @@ struct DvppDataInfoT {
     uint32_t srcImageWidth = 0;
     uint32_t srcImageHeight = 0;
     std::shared_ptr<DvppDataInfo> dvppData;
+    ascendBaseModule::ModuleMessageContext msgContext = {};
 };
 
 struct YoloImageInfo {
@@ -50,14 +54,98 @@ struct YoloImageInfo {
     int imgHeight;
 };
 
+// Outputs of one inference, the array is recycled with the message
+using RawDataList = std::vector<RawData, RecyclingAllocator<RawData>>;
+
 struct CommonData {
     bool eof;
     uint32_t channelId = 0;
     uint32_t frameId = 0;
-    std::vector<RawData> inferOutput;
+    RawDataList inferOutput;
+    bool hostOutput = false; // inferOutput was copied to host by an asynchronous ModelInfer
+    RawData hostFrame = {};  // host copy of the frame, empty when the post-processing copies it
     YoloImageInfo yoloImgInfo;
     uint32_t modelType = 0;
     std::shared_ptr<DvppDataInfo> dvppData;
+    ascendBaseModule::ModuleMessageContext msgContext = {};
 };
 
+// Message hooks of the module links, used when a link drops a message and to measure the queue wait
+// (see TypedModule.h).
+// End-of-stream markers are never dropped, and device frames go back to the DVPP memory pool, or are freed with
+// acldvppFree when they were not taken from it.
+inline void ReleaseDvppFrame(std::shared_ptr<DvppDataInfo> &dvppData)
+{
+    if (dvppData == nullptr) {
+        return;
+    }
+    if (dvppData->buffer != nullptr) {
+        dvppData->buffer = nullptr;
+    } else if (dvppData->data != nullptr) {
+        acldvppFree(dvppData->data);
+    }
+    dvppData->data = nullptr;
+}
+
+inline size_t ModuleMessageBytes(const FrameData &data)
+{
+    return data.streamData.size;
+}
+
+inline void ModuleMessageRelease(FrameData &) {} // the stream data is freed by its shared_ptr
+
+inline bool ModuleMessageDroppable(const FrameData &data)
+{
+    return !data.frameInfo.eof;
+}
+
+inline ascendBaseModule::ModuleMessageContext *ModuleMessageContextOf(FrameData &data)
+{
+    return &data.frameInfo.msgContext;
+}
+
+inline size_t ModuleMessageBytes(const DvppDataInfoT &data)
+{
+    return (data.dvppData == nullptr) ? 0 : data.dvppData->dataSize;
+}
+
+inline void ModuleMessageRelease(DvppDataInfoT &data)
+{
+    ReleaseDvppFrame(data.dvppData);
+}
+
+inline bool ModuleMessageDroppable(const DvppDataInfoT &data)
+{
+    return !data.eof;
+}
+
+inline ascendBaseModule::ModuleMessageContext *ModuleMessageContextOf(DvppDataInfoT &data)
+{
+    return &data.msgContext;
+}
+
+inline size_t ModuleMessageBytes(const CommonData &data)
+{
+    size_t bytes = (data.dvppData == nullptr) ? 0 : data.dvppData->dataSize;
+    for (auto &output : data.inferOutput) {
+        bytes += output.lenOfByte;
+    }
+    return bytes;
+}
+
+inline void ModuleMessageRelease(CommonData &data)
+{
+    ReleaseDvppFrame(data.dvppData);
+}
+
+inline bool ModuleMessageDroppable(const CommonData &data)
+{
+    return !data.eof;
+}
+
+inline ascendBaseModule::ModuleMessageContext *ModuleMessageContextOf(CommonData &data)
+{
+    return &data.msgContext;
+}
+
 #endif
\ No newline at end of file
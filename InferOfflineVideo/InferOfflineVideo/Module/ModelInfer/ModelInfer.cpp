@@ -13,10 +13,8 @@
  * limitations under the License.
  */
 #include "ModelInfer/ModelInfer.h"
-#include "PostProcess/PostProcess.h"
-#include "PostProcess/config.h"
-#include "PostProcess/PracticalSocket.h"
 #include "Singleton.h"
+#include <algorithm>
 #include <sstream>
 #include <atomic>
 #include <sys/stat.h>
@@ -27,11 +25,16 @@ using namespace ascendBaseModule;
 
 int ModelBufferSize::outputSize_ = {};
 std::vector<size_t> ModelBufferSize::bufferSize_ = {};
+std::vector<aclDataType> ModelBufferSize::dataType_ = {};
 namespace
 {
     const int YOLOV3_CAFFE = 0;
     const int YOLOV3_TF = 1;
-    const int BUFFER_SZIE = 5;
+    const int OUTPUT_BUFFER_WAIT_SLICE_MS = 100; // a stopped pipeline is noticed within it
+    const int OUTPUT_BUFFER_HELP_SLICE_MS = 1;   // wait of an executor worker which found no task to run
+    const uint32_t BATCH_FILL_SLICE_MS = 100;
+    const uint64_t US_PER_MS = 1000;
+    const int CALLBACK_TRIGGER_TIME = 1000;
 }
 
 ModelInfer::ModelInfer()
@@ -91,6 +94,23 @@ APP_ERROR ModelInfer::ParseConfig(ConfigParser &configParser)
         return ret;
     }
 
+    // optional
+    configParser.GetUnsignedIntValue(moduleName_ + std::string(".outputBufferNum"), outputBufferNum_);
+    configParser.GetIntValue(moduleName_ + std::string(".outputBufferTimeoutMs"), outputBufferTimeoutMs_);
+    if (outputBufferNum_ == 0)
+    {
+        LogError << "ModelInfer[" << instanceId_ << "]: outputBufferNum must be positive.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    configParser.GetUnsignedIntValue(moduleName_ + std::string(".batchSize"), batchSize_);
+    configParser.GetUnsignedIntValue(moduleName_ + std::string(".batchTimeoutMs"), batchTimeoutMs_);
+    if (batchSize_ == 0)
+    {
+        LogError << "ModelInfer[" << instanceId_ << "]: batchSize must be positive.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    configParser.GetUnsignedIntValue(moduleName_ + std::string(".asyncDepth"), asyncDepth_);
+
     return ret;
 }
 
@@ -108,7 +128,8 @@ APP_ERROR ModelInfer::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
 
     modelProcess_ = new ModelProcess(deviceId_, modelName_);
     LogDebug << "modelPath_ = " << modelPath_;
-    ret = modelProcess_->Init(modelPath_);
+    // the instances run the same model, they share its weights
+    ret = modelProcess_->Init(modelPath_, true);
     if (ret != APP_ERR_OK)
     {
         LogError << "ModelInfer[" << instanceId_ << "]: Fail to init ModelProcess." << GetAppErrCodeInfo(ret) << ".";
@@ -117,41 +138,219 @@ APP_ERROR ModelInfer::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
 
     aclmdlDesc *modelDesc = modelProcess_->GetModelDesc();
     size_t outputSize = aclmdlGetNumOutputs(modelDesc);
-    ModelBufferSize::outputSize_ = outputSize;
+    std::vector<size_t> bufferSizes;
+    std::vector<aclDataType> dataTypes;
     for (size_t i = 0; i < outputSize; i++)
     {
-        size_t bufferSize = aclmdlGetOutputSizeByIndex(modelDesc, i);
-        ModelBufferSize::bufferSize_.push_back(bufferSize);
+        bufferSizes.push_back(aclmdlGetOutputSizeByIndex(modelDesc, i));
+        dataTypes.push_back(aclmdlGetOutputDataType(modelDesc, i));
     }
+    // the ring keeps the outputs of whole batches, the post-processing sees the part of one frame
+    std::vector<size_t> frameSizes = bufferSizes;
+    if (batchSize_ > 1)
+    {
+        ret = InitBatch(modelDesc, frameSizes);
+        if (ret != APP_ERR_OK)
+        {
+            return ret;
+        }
+        popBatchSize_ = std::max(popBatchSize_, batchSize_);
+    }
+    // every instance runs the same model
+    ModelBufferSize::outputSize_ = outputSize;
+    ModelBufferSize::bufferSize_ = frameSizes;
+    ModelBufferSize::dataType_ = dataTypes;
 
-    for (size_t i = 0; i < BUFFER_SZIE; ++i)
+    // the sets of an asynchronous instance are only held by the runs in flight, the messages hold host sets
+    ret = outputRing_.Init(bufferSizes, (asyncDepth_ > 0) ? asyncDepth_ : outputBufferNum_);
+    if (ret != APP_ERR_OK)
+    {
+        LogError << "ModelInfer[" << instanceId_ << "]: Fail to init output buffer ring." << GetAppErrCodeInfo(ret) << ".";
+        return ret;
+    }
+    ret = BindSlots(modelDesc);
+    if (ret != APP_ERR_OK || asyncDepth_ == 0)
+    {
+        return ret;
+    }
+    return InitAsync(configParser, frameSizes);
+}
+
+/*
+ * @description: Bind the datasets of the model to each output set of the ring, a frame only replaces the input
+ * @param modelDesc Description of the loaded model
+ */
+APP_ERROR ModelInfer::BindSlots(aclmdlDesc *modelDesc)
+{
+    // a batch is copied into the inputs, a single frame is the first input and the image info the second
+    std::vector<size_t> inputSizes = batchInputSizes_;
+    if (batchSize_ == 1)
     {
-        std::vector<void *> temp;
-        for (size_t j = 0; j < outputSize; ++j)
+        inputSizes.push_back(aclmdlGetInputSizeByIndex(modelDesc, 0));
+        if (modelType_ == YOLOV3_CAFFE)
         {
-            void *outputBuffer = nullptr;
-            APP_ERROR ret = aclrtMalloc(&outputBuffer, ModelBufferSize::bufferSize_[j], ACL_MEM_MALLOC_NORMAL_ONLY);
+            inputSizes.push_back(sizeof(float) * IMAGE_INFO_ARRAY_SIZE);
+        }
+    }
+    inputSize_ = inputSizes[0];
+    std::vector<void *> inputs(inputSizes.size(), nullptr);
+    for (size_t i = 0; i < outputRing_.GetDepth(); i++)
+    {
+        // the runs in flight each need their own inputs, the synchronous runs share them
+        for (size_t j = (batchSize_ == 1) ? 1 : 0; (i == 0 || asyncDepth_ > 0) && j < inputs.size(); j++)
+        {
+            APP_ERROR ret = aclrtMalloc(&inputs[j], inputSizes[j], ACL_MEM_MALLOC_HUGE_FIRST);
             if (ret != APP_ERR_OK)
             {
-                LogError << "Failed to malloc buffer, size is " << ModelBufferSize::bufferSize_[j];
+                LogError << "ModelInfer[" << instanceId_ << "]: Fail to malloc " << inputSizes[j] <<
+                    " bytes of model input " << j << ", ret = " << ret;
                 return ret;
             }
-            temp.push_back(outputBuffer);
+            inputBuffers_.push_back(inputs[j]);
+        }
+        slotInputs_.push_back(inputs);
+        const OutputBufferSet &set = outputRing_.GetSet(i);
+        APP_ERROR ret = modelProcess_->BindSlot(set.index, inputs, inputSizes, set.buffers, set.sizes);
+        if (ret != APP_ERR_OK)
+        {
+            LogError << "ModelInfer[" << instanceId_ << "]: Fail to bind output set " << i << "." <<
+                GetAppErrCodeInfo(ret) << ".";
+            return ret;
+        }
+    }
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Find the batch of the model and the sizes of its inputs, which the frames of a batch are copied to
+ * @param modelDesc Description of the loaded model
+ * @param frameOutputSizes The output sizes of the model, replaced by the sizes of the part of one frame
+ */
+APP_ERROR ModelInfer::InitBatch(aclmdlDesc *modelDesc, std::vector<size_t> &frameOutputSizes)
+{
+    size_t inputNum = aclmdlGetNumInputs(modelDesc);
+    size_t dynamicIndex = inputNum;
+    if (aclmdlGetInputIndexByName(modelDesc, ACL_DYNAMIC_TENSOR_NAME, &dynamicIndex) == ACL_ERROR_NONE)
+    {
+        aclmdlBatch batch = {};
+        APP_ERROR ret = aclmdlGetDynamicBatch(modelDesc, &batch);
+        if (ret != ACL_ERROR_NONE || batch.batchCount == 0)
+        {
+            LogError << "ModelInfer[" << instanceId_ << "]: Fail to get the batch sizes of the model, ret = " << ret;
+            return APP_ERR_ACL_FAILURE;
+        }
+        dynamicBatches_.assign(batch.batch, batch.batch + batch.batchCount);
+        std::sort(dynamicBatches_.begin(), dynamicBatches_.end());
+    }
+    // a static model always runs its whole batch, a dynamic one is sized for its largest
+    size_t inputSize = aclmdlGetInputSizeByIndex(modelDesc, 0);
+    size_t imageSize = modelWidth_ * modelHeight_ * YUV_BYTES_NU / YUV_BYTES_DE;
+    modelBatch_ = dynamicBatches_.empty() ? inputSize / imageSize : dynamicBatches_.back();
+    if (modelBatch_ <= 1 || inputSize % modelBatch_ != 0)
+    {
+        LogError << "ModelInfer[" << instanceId_ << "]: the model input of " << inputSize << " bytes is no batch of " <<
+            modelWidth_ << "x" << modelHeight_ << " frames, batchSize needs a batch model.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    frameSize_ = inputSize / modelBatch_;
+    if (batchSize_ > modelBatch_)
+    {
+        LogWarn << "ModelInfer[" << instanceId_ << "]: batchSize " << batchSize_ <<
+            " is above the batch of the model, " << modelBatch_ << " is used.";
+        batchSize_ = modelBatch_;
+    }
+    for (auto &size : frameOutputSizes)
+    {
+        if (size % modelBatch_ != 0)
+        {
+            LogError << "ModelInfer[" << instanceId_ << "]: the output of " << size << " bytes is no batch of " <<
+                modelBatch_ << " frames.";
+            return APP_ERR_COMM_INVALID_PARAM;
         }
-        buffers_.push(temp);
+        size /= modelBatch_;
+    }
+
+    for (size_t i = 0; i < inputNum; i++)
+    {
+        batchInputSizes_.push_back(aclmdlGetInputSizeByIndex(modelDesc, i));
     }
+    if (modelType_ == YOLOV3_CAFFE)
+    {
+        size_t imgInfoSize = sizeof(float) * IMAGE_INFO_ARRAY_SIZE * modelBatch_;
+        if (inputNum < 2 || batchInputSizes_[1] < imgInfoSize)
+        {
+            LogError << "ModelInfer[" << instanceId_ << "]: the model has no image info input for a batch of " <<
+                modelBatch_ << " frames.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        batchImgInfo_.assign(IMAGE_INFO_ARRAY_SIZE * modelBatch_, 0.f);
+    }
+    pendingFrames_.reserve(batchSize_);
+    LogInfo << "ModelInfer[" << instanceId_ << "]: batches of up to " << batchSize_ << " frames, model batch " <<
+        modelBatch_ << (dynamicBatches_.empty() ? " (static)" : " (dynamic)") << ", timeout " << batchTimeoutMs_ <<
+        " ms.";
     return APP_ERR_OK;
 }
 
-APP_ERROR ModelInfer::Process(std::shared_ptr<void> inputData)
+/*
+ * @description: Lease a set of output buffers, wait while every set is held by a frame in flight
+ * @param ring outputRing_, or hostRing_ for the host copies of a frame
+ * @param lease The lease of the set, the set is released with the last copy of it
+ */
+APP_ERROR ModelInfer::AcquireOutputBuffers(OutputBufferRing &ring, OutputBufferLease &lease)
+{
+    // An executor worker must not sleep until a set is released, the frames holding the sets may be waiting for a
+    // worker to be post-processed. Like ModuleBase::PushToQueue it runs the pending tasks meanwhile, and only waits
+    // for a short slice when there is none. Other threads wait in slices, so a stopped pipeline does not keep them
+    bool onWorker = (executor_ != nullptr) && executor_->IsWorkerThread();
+    APP_ERROR ret = ring.Acquire(lease, 0);
+    uint64_t startUs = ModuleNowUs();
+    while (ret == APP_ERR_COMM_TIMEOUT)
+    {
+        if (isStop_)
+        {
+            return APP_ERR_QUEUE_STOPED;
+        }
+        int32_t waitedMs = static_cast<int32_t>((ModuleNowUs() - startUs) / US_PER_MS);
+        if (outputBufferTimeoutMs_ >= 0 && waitedMs >= outputBufferTimeoutMs_)
+        {
+            LogWarn << "ModelInfer[" << instanceId_ << "]: no output buffer is released in " << waitedMs <<
+                " ms, the frame is dropped.";
+            return APP_ERR_COMM_TIMEOUT;
+        }
+        int32_t sliceMs = OUTPUT_BUFFER_WAIT_SLICE_MS;
+        if (onWorker)
+        {
+            sliceMs = executor_->HelpOnce() ? 0 : OUTPUT_BUFFER_HELP_SLICE_MS;
+        }
+        if (outputBufferTimeoutMs_ >= 0)
+        {
+            sliceMs = std::min(sliceMs, outputBufferTimeoutMs_ - waitedMs);
+        }
+        ret = ring.Acquire(lease, sliceMs);
+    }
+    return ret;
+}
+
+APP_ERROR ModelInfer::ProcessData(std::shared_ptr<DvppDataInfoT> vpcData)
 {
-    std::shared_ptr<DvppDataInfoT> vpcData = std::static_pointer_cast<DvppDataInfoT>(inputData);
     if (vpcData->eof)
     {
-        std::shared_ptr<CommonData> data = std::make_shared<CommonData>();
-        data->channelId = vpcData->channelId;
-        data->eof = true;
-        SendToNextModule(MT_PostProcess, data, data->channelId);
+        if (asyncDepth_ > 0)
+        {
+            // sent by the callback thread after the runs in flight. If it cannot be, it is sent here once the
+            // callback thread has sent them, the two threads never send at the same time
+            jobFrames_.assign(1, vpcData);
+            OutputBufferLease noOutputs;
+            APP_ERROR ret = LaunchJob(jobFrames_, noOutputs);
+            jobFrames_.clear();
+            if (ret == APP_ERR_OK)
+            {
+                return APP_ERR_OK;
+            }
+            WaitJobsDone();
+        }
+        SendEof(vpcData->channelId);
         return APP_ERR_OK;
     }
     srcImageWidth_ = vpcData->srcImageWidth;
@@ -159,57 +358,383 @@ APP_ERROR ModelInfer::Process(std::shared_ptr<void> inputData)
 
     
 
-    std::shared_ptr<DeviceStreamData> dataToSend = std::make_shared<DeviceStreamData>();
-    std::vector<void *> outBuf;
-    std::vector<size_t> outSizes;
-    std::vector<RawData> modelOutput;
+    if (dataToSend_ == nullptr) {
+        dataToSend_ = std::make_shared<DeviceStreamData>();
+    }
+    RawDataList modelOutput;
+    OutputBufferLease lease;
 
-    APP_ERROR ret = YoloProcess(vpcData->channelId, vpcData->frameId,
-                                dataToSend, vpcData->dvppData, outBuf, outSizes, modelOutput);
+    APP_ERROR ret = APP_ERR_OK;
+    {
+        TraceSpan span("YoloProcess", vpcData->msgContext.trace);
+        ret = YoloProcess(vpcData->channelId, vpcData->frameId, dataToSend_, vpcData->dvppData, modelOutput, lease);
+        if (ret == APP_ERR_OK && asyncDepth_ > 0)
+        {
+            jobFrames_.assign(1, vpcData);
+            ret = LaunchJob(jobFrames_, lease);
+            jobFrames_.clear();
+        }
+    }
     if (ret != APP_ERR_OK)
     {
-        acldvppFree(vpcData->dvppData->data);
+        DrainInferStream();
+        ReleaseDvppFrame(vpcData->dvppData);
         LogError << "Failed to YoloProcess, ret=" << ret;
         return ret;
     }
+    if (asyncDepth_ > 0)
+    {
+        return APP_ERR_OK;
+    }
 
 
     //=======================
     //did thid so that image frame goes to another pipeline
     //acldvppFree(vpcData->dvppData->data);
 
-    std::shared_ptr<CommonData> data = std::make_shared<CommonData>();
+    SendResult(*vpcData, modelOutput);
+    return APP_ERR_OK;
+}
+
+void ModelInfer::SendEof(uint32_t channelId)
+{
+    std::shared_ptr<CommonData> data = MakePooled<CommonData>();
+    data->channelId = channelId;
+    data->eof = true;
+    SendToNextModule(std::move(data), channelId);
+}
+
+/*
+ * @description: Send the outputs of a frame to the post-processing, the frame travels with them
+ * @param vpcData The frame, its dvppData is moved to the message
+ * @param modelOutput The outputs of the frame, moved to the message
+ * @param hostOutput Whether the outputs are host copies
+ * @param hostFrame The host copy of the frame, empty when the post-processing copies it
+ */
+void ModelInfer::SendResult(DvppDataInfoT &vpcData, RawDataList &modelOutput, bool hostOutput, RawData hostFrame)
+{
+    std::shared_ptr<CommonData> data = MakePooled<CommonData>();
     data->eof = false;
     data->inferOutput = std::move(modelOutput);
+    data->hostOutput = hostOutput;
+    data->hostFrame = std::move(hostFrame);
     data->yoloImgInfo.modelWidth = modelWidth_;
     data->yoloImgInfo.modelHeight = modelHeight_;
-    data->yoloImgInfo.imgWidth = vpcData->srcImageWidth;
-    data->yoloImgInfo.imgHeight = vpcData->srcImageHeight;
+    data->yoloImgInfo.imgWidth = vpcData.srcImageWidth;
+    data->yoloImgInfo.imgHeight = vpcData.srcImageHeight;
     data->modelType = modelType_;
-    data->channelId = vpcData->channelId;
-    data->frameId = vpcData->frameId;
-    data->dvppData = vpcData->dvppData;
-    SendToNextModule(MT_PostProcess, data, data->channelId);
+    data->channelId = vpcData.channelId;
+    data->frameId = vpcData.frameId;
+    data->dvppData = std::move(vpcData.dvppData);
+    data->msgContext.trace = vpcData.msgContext.trace;
+    SendToNextModule(std::move(data), vpcData.channelId);
+}
+
+/*
+ * @description: Run the popped frames in batches of up to batchSize_ frames, a batch which is not full waits for
+ *               more frames until batchTimeoutMs_ after its first frame. An eof message sends the frames before it.
+ *               The own thread waits in FillBatch, on the executor the batch stays pending and the slice returns,
+ *               the next push or a wake-up at the deadline runs the instance again
+ * @param inputDatas The popped frames, the frames which arrive while waiting are appended
+ */
+APP_ERROR ModelInfer::ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas)
+{
+    if (batchSize_ <= 1)
+    {
+        return ModuleBase::ProcessBatch(inputDatas);
+    }
+
+    APP_ERROR result = APP_ERR_OK;
+    for (size_t i = 0; i < inputDatas.size(); i++)
+    {
+        RecordQueueWait(ModuleMessageHooks<DvppDataInfoT>::Context(inputDatas[i]));
+        std::shared_ptr<DvppDataInfoT> vpcData = std::static_pointer_cast<DvppDataInfoT>(std::move(inputDatas[i]));
+        APP_ERROR ret = APP_ERR_OK;
+        if (vpcData->eof)
+        {
+            ret = FlushBatch(false);
+            ProcessData(std::move(vpcData));
+        }
+        else
+        {
+            if (pendingFrames_.empty())
+            {
+                batchDeadlineUs_ = ModuleNowUs() + batchTimeoutMs_ * US_PER_MS;
+            }
+            pendingFrames_.push_back(std::move(vpcData));
+            if (pendingFrames_.size() >= batchSize_)
+            {
+                ret = FlushBatch(false);
+            }
+            else if (i + 1 == inputDatas.size() && executor_ == nullptr)
+            {
+                FillBatch(inputDatas, batchDeadlineUs_);
+            }
+        }
+        if (ret != APP_ERR_OK)
+        {
+            result = ret;
+        }
+    }
+    APP_ERROR ret = (executor_ == nullptr) ? FlushBatch(true) : FlushExpiredBatch();
+    return (ret != APP_ERR_OK) ? ret : result;
+}
+
+/*
+ * @description: Executor slice without input, e.g. the wake-up at the deadline of the pending batch
+ */
+APP_ERROR ModelInfer::ProcessIdle()
+{
+    return FlushExpiredBatch();
+}
+
+/*
+ * @description: Run the pending batch if its deadline passed, else ask the executor for a wake-up at the deadline
+ */
+APP_ERROR ModelInfer::FlushExpiredBatch()
+{
+    if (pendingFrames_.empty())
+    {
+        return APP_ERR_OK;
+    }
+    if (ModuleNowUs() >= batchDeadlineUs_)
+    {
+        return FlushBatch(true);
+    }
+    WakeUpAt(batchDeadlineUs_);
     return APP_ERR_OK;
 }
 
+/*
+ * @description: Wait for frames until the pending batch could be filled or the deadline passes
+ * @param inputDatas The frames which arrive are appended to it
+ * @param deadlineUs The deadline of the pending batch
+ */
+void ModelInfer::FillBatch(std::vector<std::shared_ptr<void>> &inputDatas, uint64_t deadlineUs)
+{
+    std::vector<std::shared_ptr<void>> arrived;
+    while (!isStop_)
+    {
+        uint64_t nowUs = ModuleNowUs();
+        if (nowUs >= deadlineUs)
+        {
+            return;
+        }
+        // wait in slices, so a stopped pipeline does not keep the thread blocked
+        uint32_t waitMs = static_cast<uint32_t>(std::min<uint64_t>((deadlineUs - nowUs + US_PER_MS - 1) / US_PER_MS,
+            BATCH_FILL_SLICE_MS));
+        APP_ERROR ret = inputQueue_->PopBatch(arrived, batchSize_ - pendingFrames_.size(), waitMs);
+        if (ret == APP_ERR_QUEUE_STOPED)
+        {
+            return;
+        }
+        if (ret == APP_ERR_OK)
+        {
+            metrics_.itemsIn.fetch_add(arrived.size(), std::memory_order_relaxed);
+            for (auto &inputData : arrived)
+            {
+                inputDatas.push_back(std::move(inputData));
+            }
+            return;
+        }
+    }
+}
+
+/*
+ * @description: Run the pending frames as one batch and send their results in order
+ * @param timedOut Whether the batch is sent because its deadline passed, only counted when it is not full
+ */
+APP_ERROR ModelInfer::FlushBatch(bool timedOut)
+{
+    if (pendingFrames_.empty())
+    {
+        return APP_ERR_OK;
+    }
+    metrics_.batchSize.Record(pendingFrames_.size());
+    if (timedOut && pendingFrames_.size() < batchSize_)
+    {
+        metrics_.batchTimeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    APP_ERROR ret = APP_ERR_OK;
+    {
+        TraceSpan span("YoloBatchProcess", pendingFrames_[0]->msgContext.trace);
+        OutputBufferLease lease;
+        ret = RunBatch(pendingFrames_, batchOutputs_, lease);
+        if (ret == APP_ERR_OK && asyncDepth_ > 0)
+        {
+            ret = LaunchJob(pendingFrames_, lease);
+        }
+    }
+    if (ret != APP_ERR_OK)
+    {
+        DrainInferStream();
+        for (auto &vpcData : pendingFrames_)
+        {
+            ReleaseDvppFrame(vpcData->dvppData);
+        }
+        pendingFrames_.clear();
+        LogError << "Failed to run a batch of frames, ret=" << ret;
+        return ret;
+    }
+
+    // the frames of an asynchronous run were taken by its job
+    for (size_t k = 0; k < pendingFrames_.size(); k++)
+    {
+        SendResult(*pendingFrames_[k], batchOutputs_[k]);
+    }
+    pendingFrames_.clear();
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Copy the frames into the batch inputs, run the model once and split its outputs by frame
+ * @param frames The frames of the batch, at most batchSize_
+ * @param modelOutputs The outputs of each frame, sharing the lease of the output set. Not set in asynchronous mode
+ * @param lease The output set of the run, which is only enqueued on inferStream_ in asynchronous mode
+ */
+APP_ERROR ModelInfer::RunBatch(std::vector<std::shared_ptr<DvppDataInfoT>> &frames,
+                               std::vector<RawDataList> &modelOutputs, OutputBufferLease &lease)
+{
+    // a dynamic model runs the smallest batch size that holds the frames, the remaining inputs are not read
+    uint64_t batch = modelBatch_;
+    for (auto batchSize : dynamicBatches_)
+    {
+        if (batchSize >= frames.size())
+        {
+            batch = batchSize;
+            break;
+        }
+    }
+    // The set is not written again before the last message holding the lease is released
+    APP_ERROR ret = AcquireOutputBuffers(outputRing_, lease);
+    if (ret != APP_ERR_OK)
+    {
+        return ret;
+    }
+    const std::vector<void *> &inputs = slotInputs_[lease->index];
+    uint8_t *batchInput = static_cast<uint8_t *>(inputs[0]);
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        const DvppDataInfo &dvppData = *frames[k]->dvppData;
+        if (dvppData.dataSize < frameSize_)
+        {
+            LogError << "The resized frame of " << dvppData.dataSize << " bytes is smaller than the model input of " <<
+                frameSize_ << " bytes.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        ret = (inferStream_ == nullptr) ? aclrtMemcpy(batchInput + k * frameSize_, frameSize_, dvppData.data,
+            frameSize_, ACL_MEMCPY_DEVICE_TO_DEVICE) : aclrtMemcpyAsync(batchInput + k * frameSize_, frameSize_,
+            dvppData.data, frameSize_, ACL_MEMCPY_DEVICE_TO_DEVICE, inferStream_);
+        if (ret != APP_ERR_OK)
+        {
+            LogError << "Failed to copy the frame into the batch input, ret = " << ret;
+            return ret;
+        }
+    }
+    if (!batchImgInfo_.empty())
+    {
+        // rows after the frames repeat the last frame, a row of zeros is no valid image
+        for (size_t k = 0; k < modelBatch_; k++)
+        {
+            const DvppDataInfoT &vpcData = *frames[std::min(k, frames.size() - 1)];
+            float *imgInfo = &batchImgInfo_[k * IMAGE_INFO_ARRAY_SIZE];
+            imgInfo[MODEL_HEIGHT_INDEX] = modelHeight_;
+            imgInfo[MODEL_WIDTH_INDEX] = modelWidth_;
+            imgInfo[IMAGE_HEIGHT_INDEX] = vpcData.srcImageHeight;
+            imgInfo[IMAGE_WIDTH_INDEX] = vpcData.srcImageWidth;
+        }
+        ret = WriteImgInfo(lease->index, batchImgInfo_.data(), batchImgInfo_.size() * sizeof(float));
+        if (ret != APP_ERR_OK)
+        {
+            return ret;
+        }
+    }
+
+    ret = modelProcess_->ModelInference(lease->index, inputs[0], dynamicBatches_.empty() ? 0 : batch, inferStream_);
+    if (ret != APP_ERR_OK)
+    {
+        LogError << "Failed to execute ModelInference, ret = " << ret;
+        return ret;
+    }
+    if (asyncDepth_ > 0)
+    {
+        return APP_ERR_OK;
+    }
+
+    // frame k owns the k-th part of every output, the parts share the lease of the set
+    modelOutputs.resize(frames.size());
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        RawDataList &modelOutput = modelOutputs[k];
+        modelOutput.clear();
+        for (size_t i = 0; i < lease->buffers.size(); i++)
+        {
+            size_t frameOutputSize = lease->sizes[i] / modelBatch_;
+            uint8_t *frameOutput = static_cast<uint8_t *>(lease->buffers[i]) + k * frameOutputSize;
+            RawData rawDevData = RawData();
+            rawDevData.data = std::shared_ptr<void>(lease, frameOutput);
+            rawDevData.lenOfByte = frameOutputSize;
+            modelOutput.push_back(std::move(rawDevData));
+        }
+    }
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Write the image info input bound to a set, from pinned host rows in asynchronous mode
+ * @param slotId The output set of the run
+ * @param imgInfo The rows of the frames
+ * @param size Bytes of the rows
+ */
+APP_ERROR ModelInfer::WriteImgInfo(size_t slotId, const float *imgInfo, size_t size)
+{
+    void *input = slotInputs_[slotId][1];
+    APP_ERROR ret = APP_ERR_OK;
+    if (inferStream_ == nullptr)
+    {
+        ret = aclrtMemcpy(input, size, imgInfo, size, ACL_MEMCPY_HOST_TO_DEVICE);
+    }
+    else
+    {
+        // the set is free, so the previous run on it has read its rows
+        memcpy(hostImgInfo_[slotId], imgInfo, size);
+        ret = aclrtMemcpyAsync(input, size, hostImgInfo_[slotId], size, ACL_MEMCPY_HOST_TO_DEVICE, inferStream_);
+    }
+    if (ret != APP_ERR_OK)
+    {
+        LogError << "Failed to copy the image info to the model input, ret = " << ret;
+    }
+    return ret;
+}
+
 APP_ERROR ModelInfer::DeInit(void)
 {
     LogInfo << "ModelInfer[" << instanceId_ << "]: ModelInfer::begin to deinit.";
 
+    // frames of a batch still waiting for its deadline on the executor
+    for (auto &vpcData : pendingFrames_)
+    {
+        ReleaseDvppFrame(vpcData->dvppData);
+    }
+    pendingFrames_.clear();
+    // the runs in flight are sent before the model and their inputs are released
+    DeInitAsync();
     // Release objects resource
     modelProcess_->DeInit();
     delete modelProcess_;
-
-    while (!buffers_.empty())
+    for (auto buffer : inputBuffers_)
     {
-        std::vector<void *> buffer = buffers_.front();
-        buffers_.pop();
-        for (auto &j : buffer)
-        {
-            aclrtFree(j);
-        }
+        aclrtFree(buffer);
     }
+    inputBuffers_.clear();
+    slotInputs_.clear();
+
+    // the sets still leased by queued frames are freed with the last of them
+    OutputBufferRingStats ringStats = outputRing_.GetStats();
+    LogInfo << "ModelInfer[" << instanceId_ << "]: [OutputBufferRing] [Depth] [" << ringStats.depth << "] [Leased] [" <<
+        ringStats.leased << "] [Waits] [" << ringStats.waits << "]";
+    outputRing_.DeInit();
     LogInfo << "ModelInfer[" << instanceId_ << "]: ModelInfer deinit success.";
     return APP_ERR_OK;
 }
@@ -219,43 +744,58 @@ APP_ERROR ModelInfer::DeInit(void)
  * @param channelId Channel Id of the video input stream
  * @param dataToSend The output data
  * @param vpcData The input data
- * @param outBuf Temporarily save YoloV3 model inference result
- * @param outSizes Temporarily save YoloV3 model inference result sizes
- * @param modelOutput Get output data from inference
+ * @param modelOutput Get output data from inference, not set in asynchronous mode
+ * @param lease The output set of the run, which is only enqueued on inferStream_ in asynchronous mode
  */
 APP_ERROR ModelInfer::YoloProcess(uint32_t channelId, uint32_t frameId, std::shared_ptr<DeviceStreamData> &dataToSend,
-                                  std::shared_ptr<DvppDataInfo> &vpcData, std::vector<void *> &outBuf,
-                                  std::vector<size_t> &outSizes, std::vector<RawData> &modelOutput)
+                                  std::shared_ptr<DvppDataInfo> &vpcData, RawDataList &modelOutput,
+                                  OutputBufferLease &lease)
 {
-    std::vector<void *> inputDataBuffers;
-    std::vector<size_t> buffersSize;
-    std::shared_ptr<void> yoloInfo;
-
-    APP_ERROR ret = InputBuffMalloc(vpcData, inputDataBuffers, buffersSize, yoloInfo);
+    if (vpcData->dataSize < inputSize_)
+    {
+        LogError << "The resized frame of " << vpcData->dataSize << " bytes is smaller than the model input of " <<
+            inputSize_ << " bytes.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    // The set is not written again before the last message holding the lease is released
+    APP_ERROR ret = AcquireOutputBuffers(outputRing_, lease);
     if (ret != APP_ERR_OK)
     {
-        LogError << "Failed to execute InputBuffMalloc, ret = " << ret;
         return ret;
     }
-
-    outBuf = buffers_.front();
-    buffers_.pop();
-    buffers_.push(outBuf);
-    outSizes = ModelBufferSize::bufferSize_;
+    if (modelType_ == YOLOV3_CAFFE)
+    {
+        float imgInfo[IMAGE_INFO_ARRAY_SIZE] = {0};
+        imgInfo[MODEL_HEIGHT_INDEX] = modelHeight_;
+        imgInfo[MODEL_WIDTH_INDEX] = modelWidth_;
+        imgInfo[IMAGE_HEIGHT_INDEX] = srcImageHeight_;
+        imgInfo[IMAGE_WIDTH_INDEX] = srcImageWidth_;
+        ret = WriteImgInfo(lease->index, imgInfo, sizeof(imgInfo));
+        if (ret != APP_ERR_OK)
+        {
+            return ret;
+        }
+    }
 
     dataToSend->channelId = channelId;
     dataToSend->framId = frameId;
-    ret = modelProcess_->ModelInference(inputDataBuffers, buffersSize, outBuf, outSizes);
+    ret = modelProcess_->ModelInference(lease->index, vpcData->data, 0, inferStream_);
     if (ret != APP_ERR_OK)
     {
         LogError << "Failed to execute ModelInference, ret = " << ret;
         return ret;
     }
-    for (size_t i = 0; i < outBuf.size(); i++)
+    if (asyncDepth_ > 0)
+    {
+        return APP_ERR_OK;
+    }
+    modelOutput.reserve(lease->buffers.size());
+    for (size_t i = 0; i < lease->buffers.size(); i++)
     {
         RawData rawDevData = RawData();
-        rawDevData.data.reset(outBuf[i], [](void *) {});
-        rawDevData.lenOfByte = outSizes[i];
+        // The outputs share the lease, it travels with the message to the post-processing
+        rawDevData.data = std::shared_ptr<void>(lease, lease->buffers[i]);
+        rawDevData.lenOfByte = lease->sizes[i];
         modelOutput.push_back(std::move(rawDevData));
     }
 
@@ -263,41 +803,319 @@ APP_ERROR ModelInfer::YoloProcess(uint32_t channelId, uint32_t frameId, std::sha
 }
 
 /*
- * @description: Apply memory for model inference input Data
- * @param: vpcData The resize result to inference
- * @param: inputDataBuffers Input buffer
- * @param: buffersSize Input buffer sizes
- * @param yoloInfo The second input of the model, the memory needs to be released
+ * @description: Create the streams and the callback thread of the asynchronous mode, and the pinned host sets
+ * @param configParser Placement of the callback thread
+ * @param frameOutputSizes The output sizes of one frame
  */
-APP_ERROR ModelInfer::InputBuffMalloc(std::shared_ptr<DvppDataInfo> &vpcData, std::vector<void *> &inputDataBuffers,
-                                      std::vector<size_t> &buffersSize, std::shared_ptr<void> &yoloInfo)
+APP_ERROR ModelInfer::InitAsync(ConfigParser &configParser, const std::vector<size_t> &frameOutputSizes)
 {
-    inputDataBuffers.push_back(vpcData->data);
-    buffersSize.push_back(vpcData->dataSize);
-    if (modelType_ == YOLOV3_CAFFE)
+    // the callback thread takes the placement of the instance unless ModelInferCallback.* overrides it
+    callbackPlacement_ = threadPlacement_;
+    APP_ERROR ret = LoadThreadPlacement(configParser, moduleName_ + "Callback", instanceId_, callbackPlacement_);
+    if (ret != APP_ERR_OK)
     {
-        float imgInfo[IMAGE_INFO_ARRAY_SIZE] = {0};
-        imgInfo[MODEL_HEIGHT_INDEX] = modelHeight_;
-        imgInfo[MODEL_WIDTH_INDEX] = modelWidth_;
-        imgInfo[IMAGE_HEIGHT_INDEX] = srcImageHeight_;
-        imgInfo[IMAGE_WIDTH_INDEX] = srcImageWidth_;
-        void *yoloImgInfo = nullptr;
-        uint32_t imgInfoInputSize = sizeof(float) * IMAGE_INFO_ARRAY_SIZE;
-        APP_ERROR ret = acldvppMalloc(&yoloImgInfo, imgInfoInputSize);
+        LogError << "ModelInfer[" << instanceId_ << "]: invalid thread placement of the callback thread.";
+        return ret;
+    }
+    for (aclrtStream *stream : {&inferStream_, &copyStream_})
+    {
+        ret = aclrtCreateStream(stream);
         if (ret != APP_ERR_OK)
         {
-            LogError << "Failed to malloc buffer, size is " << imgInfoInputSize << ", ret = " << ret;
+            LogError << "ModelInfer[" << instanceId_ << "]: aclrtCreateStream failed, ret=" << ret << ".";
             return ret;
         }
-        yoloInfo.reset(yoloImgInfo, acldvppFree);
-        ret = aclrtMemcpy((uint8_t *)yoloImgInfo, imgInfoInputSize, imgInfo, imgInfoInputSize, ACL_MEMCPY_HOST_TO_DEVICE);
+    }
+    int createThreadErr = pthread_create(&callbackThreadId_, nullptr, &ModelInfer::CallbackThread, (void *)this);
+    if (createThreadErr != 0)
+    {
+        LogError << "Failed to create thread, err = " << createThreadErr;
+        return APP_ERR_ACL_FAILURE;
+    }
+    callbackThreadStarted_ = true;
+    for (aclrtStream stream : {inferStream_, copyStream_})
+    {
+        ret = aclrtSubscribeReport(static_cast<uint64_t>(callbackThreadId_), stream);
         if (ret != APP_ERR_OK)
         {
-            LogError << "Failed to execute aclrtMemcpy, ret = " << ret;
+            LogError << "ModelInfer[" << instanceId_ << "]: aclrtSubscribeReport failed, ret=" << ret << ".";
             return ret;
         }
-        inputDataBuffers.push_back(yoloImgInfo);
-        buffersSize.push_back(sizeof(float) * IMAGE_INFO_ARRAY_SIZE);
+    }
+
+    // outputBufferNum counts batches, a host set holds one frame
+    hostFrameSize_ = (batchSize_ > 1) ? frameSize_ : inputSize_;
+    std::vector<size_t> hostSizes = frameOutputSizes;
+    hostSizes.push_back(hostFrameSize_);
+    ret = hostRing_.Init(hostSizes, outputBufferNum_ * batchSize_, true);
+    if (ret != APP_ERR_OK)
+    {
+        LogError << "ModelInfer[" << instanceId_ << "]: Fail to init host buffer ring."
+                 << GetAppErrCodeInfo(ret) << ".";
+        return ret;
+    }
+    if (modelType_ == YOLOV3_CAFFE)
+    {
+        size_t imgInfoSize = std::max<size_t>(batchImgInfo_.size(), IMAGE_INFO_ARRAY_SIZE) * sizeof(float);
+        for (size_t i = 0; i < slotInputs_.size(); i++)
+        {
+            void *buffer = nullptr;
+            ret = aclrtMallocHost(&buffer, imgInfoSize);
+            if (ret != APP_ERR_OK)
+            {
+                LogError << "ModelInfer[" << instanceId_ << "]: Fail to malloc the host image info, ret = " << ret;
+                return ret;
+            }
+            hostImgInfo_.push_back(buffer);
+        }
+    }
+    LogInfo << "ModelInfer[" << instanceId_ << "]: asynchronous inference, " << asyncDepth_ << " runs in flight.";
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Wait until the runs in flight are sent, then stop the callback thread and destroy the streams
+ */
+void ModelInfer::DeInitAsync()
+{
+    if (callbackThreadStarted_)
+    {
+        WaitJobsDone();
+        for (aclrtStream stream : {inferStream_, copyStream_})
+        {
+            if (stream != nullptr)
+            {
+                (void)aclrtUnSubscribeReport(static_cast<uint64_t>(callbackThreadId_), stream);
+            }
+        }
+        stopCallbackThread_ = true;
+        pthread_join(callbackThreadId_, nullptr);
+        callbackThreadStarted_ = false;
+    }
+    for (aclrtStream *stream : {&inferStream_, &copyStream_})
+    {
+        if (*stream != nullptr)
+        {
+            APP_ERROR ret = aclrtDestroyStream(*stream);
+            if (ret != APP_ERR_OK)
+            {
+                LogError << "ModelInfer[" << instanceId_ << "]: Failed to destroy stream, ret = " << ret;
+            }
+            *stream = nullptr;
+        }
+    }
+    for (auto buffer : hostImgInfo_)
+    {
+        aclrtFreeHost(buffer);
+    }
+    hostImgInfo_.clear();
+    if (asyncDepth_ > 0)
+    {
+        OutputBufferRingStats ringStats = hostRing_.GetStats();
+        LogInfo << "ModelInfer[" << instanceId_ << "]: [HostBufferRing] [Depth] [" << ringStats.depth << "] [Leased] ["
+            << ringStats.leased << "] [Waits] [" << ringStats.waits << "]";
+        hostRing_.DeInit();
+    }
+}
+
+// Wait until the callback thread has finished every job launched
+void ModelInfer::WaitJobsDone()
+{
+    std::unique_lock<std::mutex> lock(jobMutex_);
+    jobDone_.wait(lock, [this]() { return jobsInFlight_ == 0; });
+}
+
+// A failed run may have enqueued work which reads its frames, it is finished before the frames are released
+void ModelInfer::DrainInferStream()
+{
+    if (inferStream_ != nullptr)
+    {
+        (void)aclrtSynchronizeStream(inferStream_);
+    }
+}
+
+/*
+ * @description: Hand a run enqueued on inferStream_ to the callback thread, which copies its outputs to host after it
+ * @param frames The frames of the run, taken by the job when it is launched
+ * @param deviceOutputs The output set of the run, empty for an eof frame
+ */
+APP_ERROR ModelInfer::LaunchJob(std::vector<std::shared_ptr<DvppDataInfoT>> &frames, OutputBufferLease &deviceOutputs)
+{
+    InferJob *job = NewPooled<InferJob>();
+    job->owner = this;
+    if (deviceOutputs != nullptr)
+    {
+        // waits while the post-processing holds every host set, the device runs meanwhile
+        job->hostOutputs.resize(frames.size());
+        for (auto &hostOutputs : job->hostOutputs)
+        {
+            APP_ERROR ret = AcquireOutputBuffers(hostRing_, hostOutputs);
+            if (ret != APP_ERR_OK)
+            {
+                DeletePooled(job);
+                return ret;
+            }
+        }
+    }
+    job->frames.swap(frames);
+    job->deviceOutputs = std::move(deviceOutputs);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        jobsInFlight_++;
+    }
+    APP_ERROR ret = aclrtLaunchCallback(&ModelInfer::OnInferDone, job, ACL_CALLBACK_NO_BLOCK, inferStream_);
+    if (ret != APP_ERR_OK)
+    {
+        // the caller releases the frames, or sends the eof, as for a failed run
+        LogError << "ModelInfer[" << instanceId_ << "]: aclrtLaunchCallback failed, ret = " << ret << ".";
+        frames.swap(job->frames);
+        EndJob(job);
+        return ret;
     }
     return APP_ERR_OK;
 }
+
+/*
+ * @description: Enqueue the copies of the outputs and the frames of a finished run to its host sets
+ * @param job The job of the run, each frame has a host set
+ */
+APP_ERROR ModelInfer::CopyJobToHost(InferJob &job)
+{
+    for (size_t k = 0; k < job.hostOutputs.size(); k++)
+    {
+        const OutputBufferSet &hostSet = *job.hostOutputs[k];
+        size_t outputNum = hostSet.buffers.size() - 1;
+        for (size_t i = 0; i < outputNum; i++)
+        {
+            // frame k owns the k-th part of every output
+            const uint8_t *output = static_cast<const uint8_t *>(job.deviceOutputs->buffers[i]) + k * hostSet.sizes[i];
+            APP_ERROR ret = aclrtMemcpyAsync(hostSet.buffers[i], hostSet.sizes[i], output, hostSet.sizes[i],
+                ACL_MEMCPY_DEVICE_TO_HOST, copyStream_);
+            if (ret != APP_ERR_OK)
+            {
+                LogError << "Failed to copy output buffer of model from device to host, ret = " << ret;
+                return ret;
+            }
+        }
+        const DvppDataInfo &dvppData = *job.frames[k]->dvppData;
+        if (dvppData.dataSize <= hostFrameSize_)
+        {
+            APP_ERROR ret = aclrtMemcpyAsync(hostSet.buffers[outputNum], hostFrameSize_, dvppData.data,
+                dvppData.dataSize, ACL_MEMCPY_DEVICE_TO_HOST, copyStream_);
+            if (ret != APP_ERR_OK)
+            {
+                LogError << "Failed to copy the frame from device to host, ret = " << ret;
+                return ret;
+            }
+        }
+    }
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Send the frames of a job with their host copies, or release them when the job failed
+ * @param job The job, deleted
+ */
+void ModelInfer::FinishJob(InferJob *job)
+{
+    // the device set is free for the next run
+    job->deviceOutputs = nullptr;
+    if (job->ret != APP_ERR_OK)
+    {
+        LogError << "ModelInfer[" << instanceId_ << "]: " << job->frames.size() << " frames are dropped, ret = " <<
+            job->ret << ".";
+    }
+    for (size_t k = 0; k < job->frames.size(); k++)
+    {
+        DvppDataInfoT &vpcData = *job->frames[k];
+        if (vpcData.eof)
+        {
+            SendEof(vpcData.channelId);
+            continue;
+        }
+        if (job->ret != APP_ERR_OK)
+        {
+            ReleaseDvppFrame(vpcData.dvppData);
+            continue;
+        }
+        // The outputs and the frame share the lease of the host set
+        const OutputBufferLease &hostSet = job->hostOutputs[k];
+        size_t outputNum = hostSet->buffers.size() - 1;
+        RawDataList modelOutput;
+        modelOutput.reserve(outputNum);
+        for (size_t i = 0; i < outputNum; i++)
+        {
+            RawData rawHostData = RawData();
+            rawHostData.data = std::shared_ptr<void>(hostSet, hostSet->buffers[i]);
+            rawHostData.lenOfByte = hostSet->sizes[i];
+            modelOutput.push_back(std::move(rawHostData));
+        }
+        RawData hostFrame = RawData();
+        if (vpcData.dvppData->dataSize <= hostFrameSize_)
+        {
+            hostFrame.data = std::shared_ptr<void>(hostSet, hostSet->buffers[outputNum]);
+            hostFrame.lenOfByte = vpcData.dvppData->dataSize;
+        }
+        SendResult(vpcData, modelOutput, true, std::move(hostFrame));
+    }
+    EndJob(job);
+}
+
+/*
+ * @description: Delete a job which was counted in flight by LaunchJob
+ * @param job The job, its frames are sent or released
+ */
+void ModelInfer::EndJob(InferJob *job)
+{
+    DeletePooled(job);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        jobsInFlight_--;
+    }
+    jobDone_.notify_all();
+}
+
+void *ModelInfer::CallbackThread(void *arg)
+{
+    ModelInfer *modelInfer = (ModelInfer *)arg;
+    ApplyThreadPlacement(modelInfer->callbackPlacement_, "InferCb[" + std::to_string(modelInfer->instanceId_) + "]");
+
+    aclError ret = aclrtSetCurrentContext(modelInfer->aclContext_);
+    if (ret != APP_ERR_OK)
+    {
+        LogError << "Failed to set context, ret = " << ret;
+        return ((void *)(-1));
+    }
+    while (!modelInfer->stopCallbackThread_)
+    {
+        (void)aclrtProcessReport(CALLBACK_TRIGGER_TIME);
+    }
+    return nullptr;
+}
+
+// Runs on the callback thread when the model has run, the copies of the job are enqueued on copyStream_
+void ModelInfer::OnInferDone(void *arg)
+{
+    InferJob *job = static_cast<InferJob *>(arg);
+    ModelInfer *modelInfer = job->owner;
+    job->ret = modelInfer->CopyJobToHost(*job);
+    if (job->ret == APP_ERR_OK)
+    {
+        job->ret = aclrtLaunchCallback(&ModelInfer::OnCopyDone, job, ACL_CALLBACK_NO_BLOCK, modelInfer->copyStream_);
+        if (job->ret == APP_ERR_OK)
+        {
+            return;
+        }
+        LogError << "ModelInfer[" << modelInfer->instanceId_ << "]: aclrtLaunchCallback failed, ret = " << job->ret;
+    }
+    // the copies enqueued so far write the host sets of the job
+    (void)aclrtSynchronizeStream(modelInfer->copyStream_);
+    modelInfer->FinishJob(job);
+}
+
+// Runs on the callback thread when the outputs and the frames of the job are on the host
+void ModelInfer::OnCopyDone(void *arg)
+{
+    InferJob *job = static_cast<InferJob *>(arg);
+    job->owner->FinishJob(job);
+}
@@ -16,15 +16,19 @@
 #ifndef MODEL_INFER_H
 #define MODEL_INFER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <pthread.h>
 #include <queue>
 #include <sys/time.h>
 #include "ModuleManager/ModuleManager.h"
+#include "ModuleManager/TypedModule.h"
 #include "ModelProcess/ModelProcess.h"
+#include "ModelProcess/OutputBufferRing.h"
 #include "ConfigParser/ConfigParser.h"
 #include "DvppCommon/DvppCommon.h"
 #include "DataType/DataType.h"
 #include "acl/acl.h"
-#include "StreamPuller/StreamPuller.h"
 
 // Definition of input image info array index
 enum {
@@ -38,9 +42,23 @@ enum {
 struct ModelBufferSize {
     static int outputSize_;
     static std::vector<size_t> bufferSize_;
+    static std::vector<aclDataType> dataType_; // the outputs are decoded in their own type, e.g. FLOAT16
 };
 
-class ModelInfer : public ascendBaseModule::ModuleBase {
+class ModelInfer;
+
+// A run of the model in flight in asynchronous mode. It is executed on the infer stream of its instance, then the
+// callback thread copies its outputs and frames to host on the copy stream, and the frames are sent when the copies
+// are done. A job of a single eof frame passes the runs before it in the same way
+struct InferJob {
+    ModelInfer *owner = nullptr;
+    std::vector<std::shared_ptr<DvppDataInfoT>> frames;
+    OutputBufferLease deviceOutputs;            // released once copied, the set is free for the next run
+    std::vector<OutputBufferLease> hostOutputs; // one set per frame, leased by its message
+    APP_ERROR ret = APP_ERR_OK;
+};
+
+class ModelInfer : public ascendBaseModule::TypedModule<DvppDataInfoT, CommonData> {
 public:
     ModelInfer();
     ~ModelInfer();
@@ -48,16 +66,40 @@ public:
     APP_ERROR DeInit(void);
 
 protected:
-    APP_ERROR Process(std::shared_ptr<void> inputData);
+    APP_ERROR ProcessData(std::shared_ptr<DvppDataInfoT> vpcData);
+    APP_ERROR ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas);
+    APP_ERROR ProcessIdle();
 
 private:
-    APP_ERROR InputBuffMalloc(std::shared_ptr<DvppDataInfo> &vpcData, std::vector<void *> &inputDataBuffers,
-        std::vector<size_t> &buffersSize, std::shared_ptr<void>& yoloInfo);
     APP_ERROR ParseConfig(ConfigParser &configParser);
+    APP_ERROR AcquireOutputBuffers(OutputBufferRing &ring, OutputBufferLease &lease);
+    APP_ERROR InitBatch(aclmdlDesc *modelDesc, std::vector<size_t> &frameOutputSizes);
+    APP_ERROR BindSlots(aclmdlDesc *modelDesc);
+    APP_ERROR InitAsync(ConfigParser &configParser, const std::vector<size_t> &frameOutputSizes);
+    void DeInitAsync();
+    void FillBatch(std::vector<std::shared_ptr<void>> &inputDatas, uint64_t deadlineUs);
+    APP_ERROR FlushBatch(bool timedOut);
+    APP_ERROR FlushExpiredBatch();
+    APP_ERROR RunBatch(std::vector<std::shared_ptr<DvppDataInfoT>> &frames, std::vector<RawDataList> &modelOutputs,
+        OutputBufferLease &lease);
+    APP_ERROR WriteImgInfo(size_t slotId, const float *imgInfo, size_t size);
+    void WaitJobsDone();
+    void DrainInferStream();
+    void SendEof(uint32_t channelId);
+    void SendResult(DvppDataInfoT &vpcData, RawDataList &modelOutput, bool hostOutput = false,
+        RawData hostFrame = RawData());
+
+    // Asynchronous mode
+    APP_ERROR LaunchJob(std::vector<std::shared_ptr<DvppDataInfoT>> &frames, OutputBufferLease &deviceOutputs);
+    APP_ERROR CopyJobToHost(InferJob &job);
+    void FinishJob(InferJob *job);
+    void EndJob(InferJob *job);
+    static void *CallbackThread(void *arg);
+    static void OnInferDone(void *arg);
+    static void OnCopyDone(void *arg);
 
     APP_ERROR YoloProcess(uint32_t channelId, uint32_t frameId, std::shared_ptr<DeviceStreamData> &dataToSend,
-        std::shared_ptr<DvppDataInfo> &vpcData, std::vector<void *> &outBuf,
-        std::vector<size_t> &outSizes, std::vector<RawData> &modelOutput);
+        std::shared_ptr<DvppDataInfo> &vpcData, RawDataList &modelOutput, OutputBufferLease &lease);
 private:
     int deviceId_ = 0;
     uint32_t modelWidth_ = 0;
@@ -70,7 +112,43 @@ private:
     std::string modelPath_ = "";
     ModelProcess* modelProcess_ = nullptr;
 
-    std::queue<std::vector<void *>> buffers_;
+    OutputBufferRing outputRing_;
+    uint32_t outputBufferNum_ = 5;    // output sets of the frames between inference and post-processing
+    int32_t outputBufferTimeoutMs_ = -1; // wait for a free set, < 0: until one is released
+    // The model runs on the datasets bound to the output set of the frame, see ModelProcess::BindSlot
+    size_t inputSize_ = 0;                        // bytes of the first input of the model
+    std::vector<std::vector<void *>> slotInputs_; // inputs bound to each set, the frame replaces the first one
+    std::vector<void *> inputBuffers_;            // device inputs allocated by the instance
+    std::shared_ptr<DeviceStreamData> dataToSend_;
+
+    // Frames of any channel handled by the instance are run together when batchSize_ > 1
+    uint32_t batchSize_ = 1;          // max frames per execution, at most the batch of the model
+    uint32_t batchTimeoutMs_ = 10;    // max wait for a batch to fill, from its first frame
+    uint32_t modelBatch_ = 1;         // frames the inputs and outputs of the model are sized for
+    std::vector<uint64_t> dynamicBatches_; // ascending batch sizes of a dynamic batch model, empty if static
+    size_t frameSize_ = 0;            // bytes of one resized frame in the batch input
+    std::vector<size_t> batchInputSizes_; // sizes of the model inputs in its input order
+    std::vector<float> batchImgInfo_; // host rows of the image info input of a YoloV3 Caffe model
+    std::vector<std::shared_ptr<DvppDataInfoT>> pendingFrames_;
+    uint64_t batchDeadlineUs_ = 0;    // when the pending batch is run, set by its first frame
+    std::vector<RawDataList> batchOutputs_;
+
+    // Asynchronous mode when asyncDepth_ > 0: the thread only enqueues the runs, the sets of outputRing_ bound the
+    // runs in flight and every set has its own inputs. The results travel in pinned host sets of hostRing_
+    uint32_t asyncDepth_ = 0;
+    aclrtStream inferStream_ = nullptr;
+    aclrtStream copyStream_ = nullptr;
+    OutputBufferRing hostRing_;  // per-frame outputs and, in the last buffer, the frame
+    size_t hostFrameSize_ = 0;   // a larger frame is copied by the post-processing
+    std::vector<void *> hostImgInfo_; // pinned sources of the image info input of each set
+    std::vector<std::shared_ptr<DvppDataInfoT>> jobFrames_;
+    pthread_t callbackThreadId_ = {};
+    bool callbackThreadStarted_ = false;
+    std::atomic<bool> stopCallbackThread_ = {false};
+    ascendBaseModule::ThreadPlacement callbackPlacement_ = {}; // of CallbackThread, which runs the stream callbacks
+    std::mutex jobMutex_;
+    std::condition_variable jobDone_;
+    uint32_t jobsInFlight_ = 0;
 };
 
 MODULE_REGIST(ModelInfer)
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CandidateScan.h"
+#include "FastMath.h"
+
+namespace {
+const int32_t HALF_KEY_MIN = -31745; // -inf, the negative NaNs are below it
+const int32_t HALF_KEY_MAX = 31744;  // +inf, the positive NaNs are above it
+
+// Integers ordered as the values of the halves, the negative halves have their magnitude bits flipped
+inline int16_t HalfKey(uint16_t half)
+{
+    const uint16_t magnitudeBits = 0x7fff;
+    return static_cast<int16_t>(half ^ ((half >> 15) ? magnitudeBits : 0)); // 15: sign bit
+}
+
+// The key is its own inverse
+inline uint16_t KeyHalf(int32_t key)
+{
+    return static_cast<uint16_t>(HalfKey(static_cast<uint16_t>(key)));
+}
+
+// The key of the largest half which is not above threshold
+int32_t MakeHalfLimit(float threshold)
+{
+    // nothing is greater than a NaN threshold
+    if (threshold != threshold) {
+        return HALF_KEY_MAX;
+    }
+    // the halves are ordered as their keys
+    int32_t low = HALF_KEY_MIN;
+    int32_t high = HALF_KEY_MAX;
+    if (!(fastmath::HalfToFloat(KeyHalf(low)) <= threshold)) {
+        return HALF_KEY_MIN - 1;
+    }
+    while (low < high) {
+        int32_t middle = low + (high - low + 1) / 2;
+        if (fastmath::HalfToFloat(KeyHalf(middle)) <= threshold) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+// The compares are function objects, so Scan gets them inlined
+struct Greater {
+    template<typename T, typename Limit> bool operator()(T value, Limit threshold) const
+    {
+        return value > threshold;
+    }
+};
+
+// A NaN is not greater than anything, like in the float compare. Its key is above the one of +inf
+struct GreaterHalf {
+    bool operator()(uint16_t value, int32_t limit) const
+    {
+        int32_t key = HalfKey(value);
+        return key > limit && key <= HALF_KEY_MAX;
+    }
+};
+
+template<typename T, typename Limit, typename Compare>
+size_t Scan(const T *data, size_t anchorNum, size_t anchorSize, size_t objOffset, Limit threshold, uint32_t *indexes)
+{
+    Compare greater;
+    size_t count = 0;
+    for (size_t anchor = 0; anchor < anchorNum; anchor++) {
+        if (greater(data[anchor * anchorSize + objOffset], threshold)) {
+            indexes[count++] = static_cast<uint32_t>(anchor);
+        }
+    }
+    return count;
+}
+}
+
+size_t ScanCandidates(const float *data, size_t anchorNum, size_t anchorSize, size_t objOffset, float threshold,
+                      uint32_t *indexes)
+{
+    return Scan<float, float, Greater>(data, anchorNum, anchorSize, objOffset, threshold, indexes);
+}
+
+size_t ScanCandidatesHalf(const uint16_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset,
+                          float threshold, uint32_t *indexes)
+{
+    return Scan<uint16_t, int32_t, GreaterHalf>(data, anchorNum, anchorSize, objOffset, MakeHalfLimit(threshold),
+                                                indexes);
+}
+
+size_t ScanCandidatesInt8(const int8_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset,
+                          int32_t threshold, uint32_t *indexes)
+{
+    return Scan<int8_t, int32_t, Greater>(data, anchorNum, anchorSize, objOffset, threshold, indexes);
+}
+
+size_t ScanCandidatesUint8(const uint8_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset,
+                           int32_t threshold, uint32_t *indexes)
+{
+    return Scan<uint8_t, int32_t, Greater>(data, anchorNum, anchorSize, objOffset, threshold, indexes);
+}
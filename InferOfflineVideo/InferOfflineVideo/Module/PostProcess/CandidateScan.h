@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CANDIDATE_SCAN_H
+#define CANDIDATE_SCAN_H
+
+#include <cstddef>
+#include <stdint.h>
+
+/*
+ * Find the anchors of a yolo layer whose objectness logit is greater than threshold.
+ * The layer is anchorNum anchors of anchorSize floats, the objectness is at objOffset of each anchor. Only the
+ * objectness of each anchor is loaded, which CandidateScanBench found faster than comparing whole windows of the
+ * layer with SIMD for the anchors of the decoder, 6 floats for one class and 85 for yolov3.
+ * indexes must have room for anchorNum entries, the count of the anchors found is returned
+ */
+size_t ScanCandidates(const float *data, size_t anchorNum, size_t anchorSize, size_t objOffset, float threshold,
+                      uint32_t *indexes);
+
+/*
+ * The same for a layer of IEEE half floats. The halves are not converted, they are compared as integers with the
+ * largest half not above threshold, and the NaNs are masked out, which finds the same anchors as a float compare
+ */
+size_t ScanCandidatesHalf(const uint16_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset,
+                          float threshold, uint32_t *indexes);
+
+// The same for quantized layers, the anchors whose quantized objectness is greater than threshold
+size_t ScanCandidatesInt8(const int8_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset,
+                          int32_t threshold, uint32_t *indexes);
+size_t ScanCandidatesUint8(const uint8_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset,
+                           int32_t threshold, uint32_t *indexes);
+
+#endif
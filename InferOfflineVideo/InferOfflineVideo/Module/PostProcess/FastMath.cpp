@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FastMath.h"
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FASTMATH_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FASTMATH_NEON
+#endif
+
+namespace fastmath {
+const FastMath fastMath;
+}
+
+namespace {
+const size_t LANES = 4;
+// exp(x) = 2^n * exp(r), n = round(x / ln2), r = x - n * ln2 with ln2 split in two for precision (cephes expf)
+const float EXP_HI = 88.0f; // n stays at most 127, so 2^n is a normal float
+const float EXP_LO = -87.0f;
+const float LOG2E = 1.44269504088896341f;
+const float LN2_HI = 0.693359375f;
+const float LN2_LO = -2.12194440e-4f;
+const float P0 = 1.9875691500e-4f;
+const float P1 = 1.3981999507e-3f;
+const float P2 = 8.3334519073e-3f;
+const float P3 = 4.1665795894e-2f;
+const float P4 = 1.6666665459e-1f;
+const float P5 = 5.0000001201e-1f;
+const float HALF = 0.5f;
+const float ONE = 1.0f;
+const int EXPONENT_BIAS = 127;
+const int MANTISSA_BITS = 23;
+
+inline float ExpScalar(float x)
+{
+    x = std::min(std::max(x, EXP_LO), EXP_HI);
+    float n = std::floor(x * LOG2E + HALF);
+    float r = x - n * LN2_HI - n * LN2_LO;
+    float y = ((((P0 * r + P1) * r + P2) * r + P3) * r + P4) * r + P5;
+    y = y * r * r + r + ONE;
+    int32_t bits = (static_cast<int32_t>(n) + EXPONENT_BIAS) << MANTISSA_BITS;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return y * scale;
+}
+
+#if defined(FASTMATH_SSE2)
+inline __m128 Exp4(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_LO)), _mm_set1_ps(EXP_HI));
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(LOG2E)), _mm_set1_ps(HALF));
+    // floor, the truncation of negative values is one too large
+    __m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpgt_ps(n, fx), _mm_set1_ps(ONE)));
+    __m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(LN2_HI))), _mm_mul_ps(n, _mm_set1_ps(LN2_LO)));
+    __m128 y = _mm_set1_ps(P0);
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(P1));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(P2));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(P3));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(P4));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(P5));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, r), r), r), _mm_set1_ps(ONE));
+    __m128i bits = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(EXPONENT_BIAS)), MANTISSA_BITS);
+    return _mm_mul_ps(y, _mm_castsi128_ps(bits));
+}
+#elif defined(FASTMATH_NEON)
+inline float32x4_t Exp4(float32x4_t x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(EXP_LO)), vdupq_n_f32(EXP_HI));
+    float32x4_t n = vrndmq_f32(vaddq_f32(vmulq_f32(x, vdupq_n_f32(LOG2E)), vdupq_n_f32(HALF)));
+    float32x4_t r = vsubq_f32(vsubq_f32(x, vmulq_f32(n, vdupq_n_f32(LN2_HI))), vmulq_f32(n, vdupq_n_f32(LN2_LO)));
+    float32x4_t y = vdupq_n_f32(P0);
+    y = vaddq_f32(vmulq_f32(y, r), vdupq_n_f32(P1));
+    y = vaddq_f32(vmulq_f32(y, r), vdupq_n_f32(P2));
+    y = vaddq_f32(vmulq_f32(y, r), vdupq_n_f32(P3));
+    y = vaddq_f32(vmulq_f32(y, r), vdupq_n_f32(P4));
+    y = vaddq_f32(vmulq_f32(y, r), vdupq_n_f32(P5));
+    y = vaddq_f32(vaddq_f32(vmulq_f32(vmulq_f32(y, r), r), r), vdupq_n_f32(ONE));
+    int32x4_t bits = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(EXPONENT_BIAS)), MANTISSA_BITS);
+    return vmulq_f32(y, vreinterpretq_f32_s32(bits));
+}
+#endif
+}
+
+namespace fastmath {
+void ExpBatch(const float *in, float *out, size_t n)
+{
+    size_t i = 0;
+#if defined(FASTMATH_SSE2)
+    for (; i + LANES <= n; i += LANES) {
+        _mm_storeu_ps(out + i, Exp4(_mm_loadu_ps(in + i)));
+    }
+#elif defined(FASTMATH_NEON)
+    for (; i + LANES <= n; i += LANES) {
+        vst1q_f32(out + i, Exp4(vld1q_f32(in + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = ExpScalar(in[i]);
+    }
+}
+
+void SigmoidBatch(const float *in, float *out, size_t n)
+{
+    size_t i = 0;
+#if defined(FASTMATH_SSE2)
+    const __m128 one = _mm_set1_ps(ONE);
+    for (; i + LANES <= n; i += LANES) {
+        __m128 negExp = Exp4(_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(in + i)));
+        _mm_storeu_ps(out + i, _mm_div_ps(one, _mm_add_ps(one, negExp)));
+    }
+#elif defined(FASTMATH_NEON)
+    const float32x4_t one = vdupq_n_f32(ONE);
+    for (; i + LANES <= n; i += LANES) {
+        float32x4_t negExp = Exp4(vnegq_f32(vld1q_f32(in + i)));
+        vst1q_f32(out + i, vdivq_f32(one, vaddq_f32(one, negExp)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = ONE / (ONE + ExpScalar(-in[i]));
+    }
+}
+}
@@ -16,16 +16,20 @@
 #ifndef FASTMATH_H
 #define FASTMATH_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <memory>
+#include <stdint.h>
 
 /*
 Utilize quantization and look up table to accelate exp operation
 */
 class FastMath {
 public:
-    FastMath() {}
-    inline void Init()
+    // The tables are filled here and never written again, so one object is shared by every thread
+    FastMath()
     {
         for (auto i = 0; i < MASK_LEN; i++) {
             negCoef_[0][i] = std::exp(-float(i) / QUANT_VALUE);
@@ -36,7 +40,7 @@ public:
     }
 
     ~FastMath() {}
-    inline float FExp(const float x)
+    inline float FExp(const float x) const
     {
         int quantX = std::max(std::min(x, float(QUANT_BOUND)), -float(QUANT_BOUND)) * QUANT_VALUE;
         float expx;
@@ -47,7 +51,7 @@ public:
         }
         return expx;
     }
-    inline float Sigmoid(float x)
+    inline float Sigmoid(float x) const
     {
         return 1.0f / (1.0f + FExp(-x));
     }
@@ -64,7 +68,8 @@ private:
 };
 
 namespace fastmath {
-    static FastMath fastMath;
+    // Built once during static initialization, in FastMath.cpp
+    extern const FastMath fastMath;
     inline float exp(const float x)
     {
         return fastMath.FExp(x);
@@ -73,6 +78,39 @@ namespace fastmath {
     {
         return fastMath.Sigmoid(x);
     }
+    /*
+     * out[i] = exp(in[i]) and out[i] = sigmoid(in[i]) for n floats, in and out may be the same array.
+     * A polynomial on the range reduced input, 4 floats at a time with SSE2 or NEON. The relative error is about
+     * 2e-7 where the lookup table above has 1.5e-5, inputs are clamped to [-87, 88]
+     */
+    void ExpBatch(const float *in, float *out, size_t n);
+    void SigmoidBatch(const float *in, float *out, size_t n);
+    // IEEE half to float, exact for every half including the denormals, inf and NaN
+    inline float HalfToFloat(uint16_t half)
+    {
+        const uint32_t exponentMask = 0x7c00U << 13;    // 13: mantissa bits of float - half
+        const uint32_t rebias = (127U - 15U) << 23;     // 127, 15: exponent bias of float and half
+        const uint32_t infRebias = (128U - 16U) << 23;  // inf and NaN keep the top exponent
+        const uint32_t denormalMagic = 113U << 23;      // 2^-14
+        uint32_t bits = (half & 0x7fffU) << 13;
+        uint32_t exponent = bits & exponentMask;
+        bits += rebias;
+        if (exponent == exponentMask) {
+            bits += infRebias;
+        } else if (exponent == 0) {
+            float magic;
+            float value;
+            std::memcpy(&magic, &denormalMagic, sizeof(float));
+            bits += 1U << 23;
+            std::memcpy(&value, &bits, sizeof(float));
+            value -= magic;
+            std::memcpy(&bits, &value, sizeof(float));
+        }
+        bits |= static_cast<uint32_t>(half & 0x8000U) << 16;
+        float value;
+        std::memcpy(&value, &bits, sizeof(float));
+        return value;
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Nms.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define NMS_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NMS_NEON
+#endif
+
+namespace {
+const size_t MASK_BITS = 64;
+const size_t LANES = 4;
+const int KEY_CLASS_SHIFT = 32;
+
+// Integers in the descending order of the scores, the scores ordered first get the smaller keys
+inline uint64_t ScoreKey(float score)
+{
+    const uint32_t signBit = 0x80000000U;
+    score = (score == 0.0f) ? 0.0f : score; // -0 and 0 are equal
+    uint32_t bits = 0;
+    std::memcpy(&bits, &score, sizeof(bits));
+    uint32_t ascending = (bits & signBit) ? ~bits : (bits | signBit);
+    return ~ascending;
+}
+
+// The class in the high half of the key, in ascending order of the signed id
+inline uint64_t ClassKey(int classId)
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(classId) ^ 0x80000000U) << KEY_CLASS_SHIFT;
+}
+
+/*
+ * @description: Compute the IoU of box (bx1, by1, bx2, by2) against the boxes [0, count) of the arrays. The steps are
+ *               those of BoxIou, so the values are the same, and a box without intersection gets 0
+ */
+void IouRow(const float *x1, const float *y1, const float *x2, const float *y2, const float *area, size_t count,
+            const float box[4], float boxArea, float *iou)
+{
+    size_t i = 0;
+#if defined(NMS_SSE2)
+    const __m128 bx1 = _mm_set1_ps(box[0]);
+    const __m128 by1 = _mm_set1_ps(box[1]);
+    const __m128 bx2 = _mm_set1_ps(box[2]);
+    const __m128 by2 = _mm_set1_ps(box[3]);
+    const __m128 bArea = _mm_set1_ps(boxArea);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + LANES <= count; i += LANES) {
+        __m128 w = _mm_sub_ps(_mm_min_ps(_mm_loadu_ps(x2 + i), bx2), _mm_max_ps(_mm_loadu_ps(x1 + i), bx1));
+        __m128 h = _mm_sub_ps(_mm_min_ps(_mm_loadu_ps(y2 + i), by2), _mm_max_ps(_mm_loadu_ps(y1 + i), by1));
+        __m128 inter = _mm_mul_ps(w, h);
+        __m128 value = _mm_div_ps(inter, _mm_sub_ps(_mm_add_ps(bArea, _mm_loadu_ps(area + i)), inter));
+        __m128 overlap = _mm_and_ps(_mm_cmpge_ps(w, zero), _mm_cmpge_ps(h, zero));
+        _mm_storeu_ps(iou + i, _mm_and_ps(value, overlap));
+    }
+#elif defined(NMS_NEON)
+    const float32x4_t bx1 = vdupq_n_f32(box[0]);
+    const float32x4_t by1 = vdupq_n_f32(box[1]);
+    const float32x4_t bx2 = vdupq_n_f32(box[2]);
+    const float32x4_t by2 = vdupq_n_f32(box[3]);
+    const float32x4_t bArea = vdupq_n_f32(boxArea);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; i + LANES <= count; i += LANES) {
+        float32x4_t w = vsubq_f32(vminq_f32(vld1q_f32(x2 + i), bx2), vmaxq_f32(vld1q_f32(x1 + i), bx1));
+        float32x4_t h = vsubq_f32(vminq_f32(vld1q_f32(y2 + i), by2), vmaxq_f32(vld1q_f32(y1 + i), by1));
+        float32x4_t inter = vmulq_f32(w, h);
+        float32x4_t value = vdivq_f32(inter, vsubq_f32(vaddq_f32(bArea, vld1q_f32(area + i)), inter));
+        uint32x4_t overlap = vandq_u32(vcgeq_f32(w, zero), vcgeq_f32(h, zero));
+        vst1q_f32(iou + i, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(value), overlap)));
+    }
+#endif
+    for (; i < count; ++i) {
+        float w = std::min(x2[i], box[2]) - std::max(x1[i], box[0]);
+        float h = std::min(y2[i], box[3]) - std::max(y1[i], box[1]);
+        if (w < 0.0f || h < 0.0f) {
+            iou[i] = 0.0f;
+            continue;
+        }
+        float inter = w * h;
+        iou[i] = inter / (boxArea + area[i] - inter);
+    }
+}
+}
+
+void NmsEngine::SetConfig(const NmsConfig &config)
+{
+    config_ = config;
+}
+
+const NmsConfig &NmsEngine::GetConfig() const
+{
+    return config_;
+}
+
+/*
+ * @description: Keep the topK boxes, sort them and copy them into the arrays
+ * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ */
+void NmsEngine::Load(const std::vector<DetectBox> &detBoxes)
+{
+    // The boxes are sorted as keys of class and score next to their index, which is much faster than comparing the
+    // boxes through an index array. Ties are broken by the index, so the order does not depend on the sort algorithm
+    keys_.resize(detBoxes.size());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        keys_[i] = {ScoreKey(detBoxes[i].prob), static_cast<uint32_t>(i)};
+    }
+    auto lessKey = [](const SortKey &a, const SortKey &b) {
+        return a.key < b.key || (a.key == b.key && a.index < b.index);
+    };
+    if (config_.topK != 0 && keys_.size() > config_.topK) {
+        std::partial_sort(keys_.begin(), keys_.begin() + config_.topK, keys_.end(), lessKey);
+        keys_.resize(config_.topK);
+    }
+    if (!config_.classAgnostic) {
+        for (SortKey &key : keys_) {
+            key.key |= ClassKey(detBoxes[key.index].classID);
+        }
+    }
+    std::sort(keys_.begin(), keys_.end(), lessKey);
+    const size_t count = keys_.size();
+    order_.resize(count);
+    x1_.resize(count);
+    y1_.resize(count);
+    x2_.resize(count);
+    y2_.resize(count);
+    area_.resize(count);
+    score_.resize(count);
+    classId_.resize(count);
+    iou_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        order_[i] = keys_[i].index;
+        const DetectBox &box = detBoxes[order_[i]];
+        x1_[i] = box.x - box.width / 2.f;
+        y1_[i] = box.y - box.height / 2.f;
+        x2_[i] = box.x + box.width / 2.f;
+        y2_[i] = box.y + box.height / 2.f;
+        area_[i] = box.width * box.height;
+        score_[i] = box.prob;
+        classId_[i] = box.classID;
+    }
+}
+
+void NmsEngine::SwapBoxes(size_t i, size_t j)
+{
+    std::swap(order_[i], order_[j]);
+    std::swap(x1_[i], x1_[j]);
+    std::swap(y1_[i], y1_[j]);
+    std::swap(x2_[i], x2_[j]);
+    std::swap(y2_[i], y2_[j]);
+    std::swap(area_[i], area_[j]);
+    std::swap(score_[i], score_[j]);
+    std::swap(classId_[i], classId_[j]);
+}
+
+/*
+ * @description: Greedy NMS of the boxes [begin, end) sorted by score, a kept box suppresses the following boxes whose
+ *               IoU with it is greater than iouThresh
+ */
+void NmsEngine::HardNms(size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        if (suppressed_[i / MASK_BITS] & (1ULL << (i % MASK_BITS))) {
+            continue;
+        }
+        const float box[4] = {x1_[i], y1_[i], x2_[i], y2_[i]};
+        const size_t next = i + 1;
+        // pointers, not operator[], next may be the end of the arrays
+        IouRow(x1_.data() + next, y1_.data() + next, x2_.data() + next, y2_.data() + next, area_.data() + next,
+            end - next, box, area_[i], iou_.data() + next);
+        for (size_t j = next; j < end; ++j) {
+            if (iou_[j] > config_.iouThresh) {
+                suppressed_[j / MASK_BITS] |= 1ULL << (j % MASK_BITS);
+            }
+        }
+    }
+}
+
+/*
+ * @description: Soft-NMS of the boxes [begin, end), the box with the highest score is moved to the front and the
+ *               scores of the following boxes are decayed by their IoU with it, until no score is above scoreThresh
+ * @return  End of the kept boxes, which are reordered in the order they were selected
+ */
+size_t NmsEngine::SoftNms(size_t begin, size_t end)
+{
+    const bool linear = (config_.method == SOFT_NMS_LINEAR);
+    for (size_t i = begin; i < end; ++i) {
+        size_t best = i;
+        for (size_t j = i + 1; j < end; ++j) {
+            if (score_[j] > score_[best]) {
+                best = j;
+            }
+        }
+        if (!(score_[best] > config_.scoreThresh)) {
+            return i;
+        }
+        SwapBoxes(i, best);
+        const float box[4] = {x1_[i], y1_[i], x2_[i], y2_[i]};
+        const size_t next = i + 1;
+        IouRow(x1_.data() + next, y1_.data() + next, x2_.data() + next, y2_.data() + next, area_.data() + next,
+            end - next, box, area_[i], iou_.data() + next);
+        for (size_t j = next; j < end; ++j) {
+            if (linear) {
+                score_[j] *= (iou_[j] > config_.iouThresh) ? (1.0f - iou_[j]) : 1.0f;
+            } else {
+                score_[j] *= std::exp(-iou_[j] * iou_[j] / config_.sigma);
+            }
+        }
+    }
+    return end;
+}
+
+void NmsEngine::Run(std::vector<DetectBox> &detBoxes)
+{
+    Load(detBoxes);
+    const size_t count = order_.size();
+    suppressed_.assign((count + MASK_BITS - 1) / MASK_BITS, 0);
+    kept_.clear();
+    size_t begin = 0;
+    while (begin < count) {
+        // boxes [begin, end) are one class, or all of them when classAgnostic
+        size_t end = begin + 1;
+        while (end < count && (config_.classAgnostic || classId_[end] == classId_[begin])) {
+            ++end;
+        }
+        if (config_.method == SOFT_NMS_NONE) {
+            HardNms(begin, end);
+            for (size_t i = begin; i < end; ++i) {
+                if (!(suppressed_[i / MASK_BITS] & (1ULL << (i % MASK_BITS)))) {
+                    kept_.push_back(detBoxes[order_[i]]);
+                }
+            }
+        } else {
+            size_t keptEnd = SoftNms(begin, end);
+            for (size_t i = begin; i < keptEnd; ++i) {
+                kept_.push_back(detBoxes[order_[i]]);
+                kept_.back().prob = score_[i];
+            }
+        }
+        begin = end;
+    }
+    detBoxes.swap(kept_);
+}
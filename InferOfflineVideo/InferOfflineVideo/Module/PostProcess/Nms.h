@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NMS_H
+#define NMS_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+#include "Yolov3Post.h"
+
+enum SoftNmsMethod {
+    SOFT_NMS_NONE = 0,  // hard NMS, the overlapping boxes are removed
+    SOFT_NMS_LINEAR,    // the score of a box overlapping more than iouThresh is scaled by 1 - iou
+    SOFT_NMS_GAUSSIAN,  // the score of every overlapping box is scaled by exp(-iou * iou / sigma)
+};
+
+struct NmsConfig {
+    bool classAgnostic = false; // boxes of different classes suppress each other
+    SoftNmsMethod method = SOFT_NMS_NONE;
+    float iouThresh = IOU_THRESH;
+    uint32_t topK = 0;          // only the topK boxes with the highest scores go into NMS, 0: all of them
+    float sigma = 0.5f;         // of SOFT_NMS_GAUSSIAN
+    float scoreThresh = SCORE_THRESH; // Soft-NMS drops the boxes whose score decays to it
+};
+
+// Non-maximum suppression over the boxes of a frame. The boxes are copied into arrays of corners, areas and scores,
+// the IoU of a kept box against the following ones is computed 4 at a time with SSE2 or NEON and the suppressed
+// boxes are marked in a bitmask. The arrays are members, so after the first frames no memory is allocated
+class NmsEngine {
+public:
+    void SetConfig(const NmsConfig &config);
+    const NmsConfig &GetConfig() const;
+    // Replaces detBoxes by the kept boxes, grouped by class in ascending order unless classAgnostic, and sorted by
+    // score within a group. Soft-NMS writes the decayed scores into prob
+    void Run(std::vector<DetectBox> &detBoxes);
+
+private:
+    struct SortKey {
+        uint64_t key; // class in the high half unless classAgnostic, descending score in the low half
+        uint32_t index;
+    };
+
+    void Load(const std::vector<DetectBox> &detBoxes);
+    void SwapBoxes(size_t i, size_t j);
+    void HardNms(size_t begin, size_t end);
+    size_t SoftNms(size_t begin, size_t end);
+
+    NmsConfig config_;
+    std::vector<SortKey> keys_;
+    std::vector<uint32_t> order_; // index in detBoxes of each box of the arrays below
+    std::vector<float> x1_;
+    std::vector<float> y1_;
+    std::vector<float> x2_;
+    std::vector<float> y2_;
+    std::vector<float> area_;
+    std::vector<float> score_;
+    std::vector<int> classId_;
+    std::vector<float> iou_;
+    std::vector<uint64_t> suppressed_;
+    std::vector<DetectBox> kept_;
+};
+
+#endif
@@ -18,6 +18,8 @@
 #include "PostProcess/config.h"
 #include <sstream>
 #include <atomic>
+#include <map>
+#include <algorithm>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include "Singleton.h"
@@ -29,7 +31,23 @@ using namespace ascendBaseModule;
 namespace {
     const int YOLOV3_CAFFE = 0;
     const int YOLOV3_TF = 1;
-    const int BUFFER_SIZE = 5;
+    const std::map<std::string, SoftNmsMethod> NMS_METHOD_NAMES = {
+        {"hard", SOFT_NMS_NONE},
+        {"linear", SOFT_NMS_LINEAR},
+        {"gaussian", SOFT_NMS_GAUSSIAN},
+    };
+    const std::map<std::string, YoloLayout> YOLO_LAYOUT_NAMES = {
+        {"v3", YOLO_LAYOUT_V3},
+        {"v4", YOLO_LAYOUT_V4},
+        {"v5", YOLO_LAYOUT_V5},
+        {"tiny", YOLO_LAYOUT_TINY},
+    };
+    const std::map<aclDataType, YoloTensorType> YOLO_TENSOR_TYPES = {
+        {ACL_FLOAT, YOLO_TENSOR_FLOAT32},
+        {ACL_FLOAT16, YOLO_TENSOR_FLOAT16},
+        {ACL_INT8, YOLO_TENSOR_INT8},
+        {ACL_UINT8, YOLO_TENSOR_UINT8},
+    };
 }
 
 PostProcess::PostProcess()
@@ -45,24 +63,144 @@ APP_ERROR PostProcess::Init(ConfigParser &configParser, ModuleInitArgs &initArgs
 
     AssignInitArgs(initArgs);
 
-    for (int i = 0; i < BUFFER_SIZE; ++i) {
-        std::vector<void *> temp;
+    APP_ERROR ret = ParseDecoderConfig(configParser);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = ParseNmsConfig(configParser);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    // optional, workers shared by the instances which decode the yolo layers and the frames of a batch
+    uint32_t decodeThreadNum = 0;
+    configParser.GetUnsignedIntValue(moduleName_ + std::string(".decodeThreadNum"), decodeThreadNum);
+    if (decodeThreadNum > 0) {
+        taskPool_ = TaskPool::GetShared(decodeThreadNum);
+        decoder_.SetWorkerNum(decodeThreadNum);
+    }
+
+    const size_t slotNum = (taskPool_ != nullptr) ? std::max<uint32_t>(popBatchSize_, 1) : 1;
+    for (size_t i = 0; i < slotNum; i++) {
+        std::unique_ptr<PostProcessSlot> slot(new PostProcessSlot());
+        slot->decoder = decoder_;
+        slot->nms = nms_;
+        slots_.push_back(std::move(slot));
         for (size_t j = 0; j < ModelBufferSize::outputSize_; j++) {
             void *hostPtrBuffer = nullptr;
-            APP_ERROR ret = (APP_ERROR)aclrtMallocHost(&hostPtrBuffer, ModelBufferSize::bufferSize_[j]);
+            ret = (APP_ERROR)aclrtMallocHost(&hostPtrBuffer, ModelBufferSize::bufferSize_[j]);
             if (ret != APP_ERR_OK) {
                 LogError << "Failed to malloc output buffer of model on host, ret = " << ret;
                 return ret;
             }
-            temp.push_back(hostPtrBuffer);
+            slots_.back()->hostBuffers.push_back(hostPtrBuffer);
         }
-        buffers_.push(temp);
     }
 
     return APP_ERR_OK;
 }
 
-void PostProcess::ConstructData(std::vector<ObjDetectInfo> &objInfos, std::shared_ptr<DeviceStreamData> &dataToSend)
+// optional, e.g.
+//   PostProcess.yoloLayout = v5
+//   PostProcess.classNum = 80
+//   PostProcess.scoreThresh = 0.3
+//   PostProcess.classes = 0,2
+APP_ERROR PostProcess::ParseDecoderConfig(ConfigParser &configParser)
+{
+    YoloDecoderConfig config;
+    std::string layoutName;
+    if (configParser.GetStringValue(moduleName_ + std::string(".yoloLayout"), layoutName) == APP_ERR_OK) {
+        auto iter = YOLO_LAYOUT_NAMES.find(layoutName);
+        if (iter == YOLO_LAYOUT_NAMES.end()) {
+            LogError << "PostProcess[" << instanceId_ << "]: Invalid " << moduleName_ << ".yoloLayout: " << layoutName
+                     << ", expect v3, v4, v5 or tiny.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        config.layout = iter->second;
+    }
+    configParser.GetIntValue(moduleName_ + std::string(".classNum"), config.classNum);
+    configParser.GetIntValue(moduleName_ + std::string(".anchorNum"), config.anchorDim);
+    configParser.GetVectorFloatValue(moduleName_ + std::string(".anchors"), config.anchors);
+    configParser.GetVectorUint32Value(moduleName_ + std::string(".strides"), config.strides);
+    configParser.GetFloatValue(moduleName_ + std::string(".scaleXY"), config.scaleXY);
+    configParser.GetFloatValue(moduleName_ + std::string(".objectnessThresh"), config.objectnessThresh);
+    configParser.GetVectorFloatValue(moduleName_ + std::string(".scoreThresh"), config.scoreThresh);
+    configParser.GetVectorUint32Value(moduleName_ + std::string(".classes"), config.classes);
+    APP_ERROR ret = ParseOutputFormats(configParser, config.outputFormats);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = decoder_.Init(config);
+    if (ret != APP_ERR_OK) {
+        LogError << "PostProcess[" << instanceId_ << "]: Invalid yolo decoder config, ret = " << ret << ".";
+    }
+    return ret;
+}
+
+// The types of the model outputs come from ModelInfer, the quantized ones need a scale. optional, e.g.
+//   PostProcess.outputScale = 0.0625        one for all outputs, or one per output
+//   PostProcess.outputZeroPoint = 0,0,-4
+APP_ERROR PostProcess::ParseOutputFormats(ConfigParser &configParser, std::vector<YoloOutputFormat> &formats)
+{
+    std::vector<float> scales;
+    std::vector<float> zeroPoints;
+    configParser.GetVectorFloatValue(moduleName_ + std::string(".outputScale"), scales);
+    configParser.GetVectorFloatValue(moduleName_ + std::string(".outputZeroPoint"), zeroPoints);
+    const std::vector<aclDataType> &dataTypes = ModelBufferSize::dataType_;
+    for (size_t i = 0; i < dataTypes.size(); i++) {
+        auto iter = YOLO_TENSOR_TYPES.find(dataTypes[i]);
+        if (iter == YOLO_TENSOR_TYPES.end()) {
+            // e.g. the object count of the Caffe model, which is not decoded
+            break;
+        }
+        YoloOutputFormat format;
+        format.type = iter->second;
+        if (format.type == YOLO_TENSOR_INT8 || format.type == YOLO_TENSOR_UINT8) {
+            if (scales.size() != 1 && scales.size() <= i) {
+                LogError << "PostProcess[" << instanceId_ << "]: The output " << i << " of the model is quantized, "
+                         << moduleName_ << ".outputScale is needed.";
+                return APP_ERR_COMM_INVALID_PARAM;
+            }
+            format.scale = (scales.size() == 1) ? scales[0] : scales[i];
+            if (zeroPoints.size() == 1 || zeroPoints.size() > i) {
+                format.zeroPoint = (zeroPoints.size() == 1) ? zeroPoints[0] : zeroPoints[i];
+            }
+        }
+        formats.push_back(format);
+    }
+    return APP_ERR_OK;
+}
+
+// optional, e.g.
+//   PostProcess.nmsClassAgnostic = false
+//   PostProcess.nmsMethod = gaussian
+APP_ERROR PostProcess::ParseNmsConfig(ConfigParser &configParser)
+{
+    NmsConfig config;
+    config.scoreThresh = decoder_.GetMinScoreThresh();
+    configParser.GetBoolValue(moduleName_ + std::string(".nmsClassAgnostic"), config.classAgnostic);
+    configParser.GetFloatValue(moduleName_ + std::string(".nmsIouThresh"), config.iouThresh);
+    configParser.GetUnsignedIntValue(moduleName_ + std::string(".nmsTopK"), config.topK);
+    configParser.GetFloatValue(moduleName_ + std::string(".nmsSigma"), config.sigma);
+    std::string methodName;
+    if (configParser.GetStringValue(moduleName_ + std::string(".nmsMethod"), methodName) == APP_ERR_OK) {
+        auto iter = NMS_METHOD_NAMES.find(methodName);
+        if (iter == NMS_METHOD_NAMES.end()) {
+            LogError << "PostProcess[" << instanceId_ << "]: Invalid " << moduleName_ << ".nmsMethod: " << methodName
+                     << ", expect hard, linear or gaussian.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        config.method = iter->second;
+    }
+    if (config.sigma <= 0) {
+        LogError << "PostProcess[" << instanceId_ << "]: " << moduleName_ << ".nmsSigma must be positive.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    nms_.SetConfig(config);
+    return APP_ERR_OK;
+}
+
+void PostProcess::ConstructData(const std::vector<ObjDetectInfo> &objInfos,
+    std::shared_ptr<DeviceStreamData> &dataToSend)
 {
     for (int k = 0; k < objInfos.size(); ++k) {
         ObjectDetectInfo detectInfo;
@@ -124,57 +262,79 @@ APP_ERROR PostProcess::WriteResult(const std::vector<ObjDetectInfo> &objInfos, u
     return APP_ERR_OK;
 }
 
-APP_ERROR PostProcess::YoloPostProcess(std::vector<RawData> &modelOutput, std::shared_ptr<DeviceStreamData> &dataToSend,std::vector<ObjDetectInfo> &objInfos)
+/*
+ * @description: Copy the outputs of a frame to the host and decode them into slot.objInfos
+ * @param: data The frame
+ * @param: slot Host buffers and decode state of the frame
+ * @param: pool Workers which decode the yolo layers with the caller, nullptr: decoded by the caller alone
+ */
+APP_ERROR PostProcess::YoloPostProcess(const CommonData &data, PostProcessSlot &slot, TaskPool *pool)
 {
-    const size_t outputLen = modelOutput.size();
-    if (outputLen <= 0) {
+    if (data.inferOutput.empty()) {
         LogError << "Failed to get model output data";
         return APP_ERR_INFER_GET_OUTPUT_FAIL;
     }
 
-    
     APP_ERROR ret;
-    if (modelType_ == YOLOV3_CAFFE) {
-        ret = GetObjectInfoCaffe(modelOutput, objInfos);
+    if (data.modelType == YOLOV3_CAFFE) {
+        ret = GetObjectInfoCaffe(slot);
         if (ret != APP_ERR_OK) {
             LogError << "Failed to get Caffe model output, ret = " << ret;
             return ret;
         }
     } else {
-        ret = GetObjectInfoTensorflow(modelOutput, objInfos);
+        ret = GetObjectInfoTensorflow(data, slot, pool);
         if (ret != APP_ERR_OK) {
-            LogError << "Failed to get Caffe model output, ret = " << ret;
+            LogError << "Failed to get Tensorflow model output, ret = " << ret;
             return ret;
         }
     }
-
-    ConstructData(objInfos, dataToSend);
-    // Write object info to result file
-    ret = WriteResult(objInfos, dataToSend->channelId, dataToSend->framId);
-    if (ret != APP_ERR_OK) {
-        LogError << "Failed to write result, ret = " << ret;
-    }
     return APP_ERR_OK;
 }
 
-APP_ERROR PostProcess::GetObjectInfoCaffe(std::vector<RawData> &modelOutput,
-    std::vector<ObjDetectInfo> &objInfos)
+/*
+ * @description: Copy the outputs of the model to the host buffers of the slot, slot.hostPtr points to them.
+ *               Called on the module thread, which has the ACL context
+ * @param: data The frame, its outputs are on device, or already on host after an asynchronous inference
+ * @param: slot Host buffers of the frame
+ */
+APP_ERROR PostProcess::CopyOutputToHost(const CommonData &data, PostProcessSlot &slot)
 {
-    std::vector<std::shared_ptr<void>> hostPtr;
-    std::vector<void *> buffer = buffers_.front();
-    buffers_.pop();
-    buffers_.push(buffer);
+    slot.hostPtr.clear();
+    slot.hostSizes.clear();
+    slot.objInfos.clear();
+    const RawDataList &modelOutput = data.inferOutput;
+    if (data.hostOutput) {
+        for (auto &output : modelOutput) {
+            slot.hostPtr.push_back(output.data);
+            slot.hostSizes.push_back(output.lenOfByte);
+        }
+        return APP_ERR_OK;
+    }
+    std::vector<void *> &buffer = slot.hostBuffers;
+    if (modelOutput.size() > buffer.size()) {
+        LogError << "The model has " << modelOutput.size() << " outputs, " << buffer.size() << " are expected.";
+        return APP_ERR_INFER_GET_OUTPUT_FAIL;
+    }
     for (size_t j = 0; j < modelOutput.size(); j++) {
         void *hostPtrBuffer = buffer[j];
-        std::shared_ptr<void> hostPtrBufferManager(hostPtrBuffer, [](void *) {});
         APP_ERROR ret = (APP_ERROR)aclrtMemcpy(hostPtrBuffer, modelOutput[j].lenOfByte, modelOutput[j].data.get(),
             modelOutput[j].lenOfByte, ACL_MEMCPY_DEVICE_TO_HOST);
         if (ret != APP_ERR_OK) {
             LogError << "Failed to copy output buffer of model from device to host, ret = " << ret;
             return ret;
         }
-        hostPtr.push_back(hostPtrBufferManager);
+        // Not owned, an empty owner makes the pointer without a control block
+        slot.hostPtr.push_back(std::shared_ptr<void>(std::shared_ptr<void>(), hostPtrBuffer));
+        slot.hostSizes.push_back(modelOutput[j].lenOfByte);
     }
+    return APP_ERR_OK;
+}
+
+APP_ERROR PostProcess::GetObjectInfoCaffe(PostProcessSlot &slot)
+{
+    std::vector<std::shared_ptr<void>> &hostPtr = slot.hostPtr;
+    std::vector<ObjDetectInfo> &objInfos = slot.objInfos;
     uint32_t objNum = ((uint32_t *)(hostPtr[1].get()))[0];
     for (uint32_t k = 0; k < objNum; k++) {
         int pos = 0;
@@ -190,31 +350,21 @@ APP_ERROR PostProcess::GetObjectInfoCaffe(std::vector<RawData> &modelOutput,
     return APP_ERR_OK;
 }
 
-APP_ERROR PostProcess::GetObjectInfoTensorflow(std::vector<RawData> &modelOutput,
-    std::vector<ObjDetectInfo> &objInfos)
+APP_ERROR PostProcess::GetObjectInfoTensorflow(const CommonData &data, PostProcessSlot &slot, TaskPool *pool)
 {
-    std::vector<std::shared_ptr<void>> hostPtr;
-    std::vector<void *> buffer = buffers_.front();
-    buffers_.pop();
-    buffers_.push(buffer);
-    for (size_t j = 0; j < modelOutput.size(); j++) {
-        void *hostPtrBuffer = buffer[j];
-        std::shared_ptr<void> hostPtrBufferManager(hostPtrBuffer, [](void *) {});
-        APP_ERROR ret = (APP_ERROR)aclrtMemcpy(hostPtrBuffer, modelOutput[j].lenOfByte, modelOutput[j].data.get(),
-            modelOutput[j].lenOfByte, ACL_MEMCPY_DEVICE_TO_HOST);
-        if (ret != APP_ERR_OK) {
-            LogError << "Failed to copy output buffer of model from device to host, ret = " << ret;
-            return ret;
-        }
-        hostPtr.push_back(hostPtrBufferManager);
-    }
-    Yolov3DetectionOutput(hostPtr, objInfos, yoloImageInfo_);
-    return APP_ERR_OK;
+    return Yolov3DetectionOutput(slot.hostPtr, slot.hostSizes, slot.objInfos, data.yoloImgInfo, slot.decoder,
+                                 slot.nms, pool);
 }
 
-APP_ERROR PostProcess::Process(std::shared_ptr<void> inputData)
+/*
+ * @description: Send the result of a decoded frame and release the frame, eof frames count the stopped streams
+ * @param: data The frame
+ * @param: slot The frame's objInfos and the result of YoloPostProcess in slot.ret
+ */
+APP_ERROR PostProcess::FinishFrame(std::shared_ptr<CommonData> &data, PostProcessSlot &slot)
 {
-    std::shared_ptr<CommonData> data = std::static_pointer_cast<CommonData>(inputData);
+    // host outputs of an asynchronous inference go back to their ring
+    slot.hostPtr.clear();
     if (data->eof) {
         Singleton::GetInstance().GetStopedStreamNum()++;
         if (Singleton::GetInstance().GetStopedStreamNum() == Singleton::GetInstance().GetStreamPullerNum()) {
@@ -222,36 +372,62 @@ APP_ERROR PostProcess::Process(std::shared_ptr<void> inputData)
         }
         return APP_ERR_OK;
     }
-    std::vector<RawData> &modelOutput = data->inferOutput;
-    yoloImageInfo_ = data->yoloImgInfo;
-    modelType_ = data->modelType;
-
-    std::shared_ptr<DeviceStreamData> detectInfo = std::make_shared<DeviceStreamData>();
-    detectInfo->framId = data->frameId;
-    detectInfo->channelId = data->channelId;
-
-    std::vector<ObjDetectInfo> objInfos;
-    APP_ERROR ret = YoloPostProcess(modelOutput, detectInfo,objInfos);
+    APP_ERROR ret = slot.ret;
     if (ret != APP_ERR_OK) {
-        acldvppFree(data->dvppData->data);
+        ReleaseDvppFrame(data->dvppData);
         LogError << "Failed to run YoloPostProcess, ret = " << ret;
         return ret;
     }
+    ret = SendResult(*data, slot.objInfos);
+    ReleaseDvppFrame(data->dvppData);
+    return ret;
+}
+
+/*
+ * @description: Write the result file of a frame and stream the frame with its objects
+ * @param: data The frame, its device data is released by the caller
+ * @param: objInfos The objects detected in the frame
+ */
+APP_ERROR PostProcess::SendResult(const CommonData &data, const std::vector<ObjDetectInfo> &objInfos)
+{
+    if (detectInfo_ == nullptr) {
+        detectInfo_ = std::make_shared<DeviceStreamData>();
+    }
+    std::shared_ptr<DeviceStreamData> &detectInfo = detectInfo_;
+    detectInfo->detectResult.clear();
+    detectInfo->framId = data.frameId;
+    detectInfo->channelId = data.channelId;
+
+    ConstructData(objInfos, detectInfo);
+    // Write object info to result file
+    APP_ERROR ret = WriteResult(objInfos, detectInfo->channelId, detectInfo->framId);
+    if (ret != APP_ERR_OK) {
+        LogError << "Failed to write result, ret = " << ret;
+    }
     //test for streaming of data 
     uint32_t objNum = objInfos.size();
     std::cout << "Detected Obj:" << objNum <<std::endl;
-    std::shared_ptr<void> vdecOutBufferDev(data->dvppData->data, acldvppFree);
-    void *dataHost = malloc(data->dvppData->dataSize);
+    // an asynchronous inference copied the frame with the outputs
+    void *copiedHost = nullptr;
+    void *dataHost = data.hostFrame.data.get();
     if (dataHost == nullptr)
     {
-        LogError << "malloc host data buffer failed. dataSize= " << data->dvppData->dataSize << "\n";
-    }
-    // copy output to host memory
-    auto aclRet = aclrtMemcpy(dataHost, data->dvppData->dataSize, vdecOutBufferDev.get(), data->dvppData->dataSize, ACL_MEMCPY_DEVICE_TO_HOST);
-    if (aclRet != ACL_ERROR_NONE)
-    {
-        LogError << "acl memcpy data to host failed, dataSize= " << data->dvppData->dataSize << "ret= " << aclRet << "\n";
-        free(dataHost);
+        copiedHost = malloc(data.dvppData->dataSize);
+        dataHost = copiedHost;
+        if (dataHost == nullptr)
+        {
+            LogError << "malloc host data buffer failed. dataSize= " << data.dvppData->dataSize << "\n";
+        }
+        // copy output to host memory
+        auto aclRet = aclrtMemcpy(dataHost, data.dvppData->dataSize, data.dvppData->data, data.dvppData->dataSize,
+            ACL_MEMCPY_DEVICE_TO_HOST);
+        if (aclRet != ACL_ERROR_NONE)
+        {
+            LogError << "acl memcpy data to host failed, dataSize= " << data.dvppData->dataSize << "ret= " << aclRet
+                << "\n";
+            free(copiedHost);
+            copiedHost = nullptr;
+        }
     }
     try
     {
@@ -259,8 +435,8 @@ APP_ERROR PostProcess::Process(std::shared_ptr<void> inputData)
         UDPSocket sock;
         string servAddress = "192.168.5.255";
         unsigned short servPort = 8888;
-        std::cout << "datasize: " << data->dvppData->dataSize << std::endl;
-        int total_pack = 1 + (data->dvppData->dataSize - 1) / PACK_SIZE;
+        std::cout << "datasize: " << data.dvppData->dataSize << std::endl;
+        int total_pack = 1 + (data.dvppData->dataSize - 1) / PACK_SIZE;
         total_pack += 1;
         int ibuf[1];
         ibuf[0] = total_pack;
@@ -285,7 +461,7 @@ APP_ERROR PostProcess::Process(std::shared_ptr<void> inputData)
             sock.sendTo(static_cast<char*>(dataHost)+index, PACK_SIZE, servAddress, servPort);
             index+=PACK_SIZE;
          }
-         int remainingByte = data->dvppData->dataSize-index;
+         int remainingByte = data.dvppData->dataSize-index;
          sock.sendTo(static_cast<char*>(dataHost)+index, remainingByte, servAddress, servPort);
         sock.sendTo(payloadData.c_str(), payloadData.size(), servAddress, servPort);
         std::cout << "streaming done" << std::endl;
@@ -297,19 +473,76 @@ APP_ERROR PostProcess::Process(std::shared_ptr<void> inputData)
         LogError << "THis is a streaming error ";
     }
 
-    free(dataHost);
-    acldvppFree(data->dvppData->data);
+    free(copiedHost);
     return APP_ERR_OK;
 }
 
+APP_ERROR PostProcess::ProcessData(std::shared_ptr<CommonData> data)
+{
+    PostProcessSlot &slot = *slots_[0];
+    if (!data->eof) {
+        TraceSpan span("YoloPostProcess", data->msgContext.trace);
+        slot.ret = CopyOutputToHost(*data, slot);
+        if (slot.ret == APP_ERR_OK) {
+            slot.ret = YoloPostProcess(*data, slot, taskPool_.get());
+        }
+    }
+    return FinishFrame(data, slot);
+}
+
+/*
+ * @description: Decode the frames of a batch on the task pool, each with its own slot. The outputs are copied
+ *               to the host and the results are sent on the module thread, in the order the frames were queued
+ * @param: inputDatas Frames popped from the input queue, at most popBatchSize
+ */
+APP_ERROR PostProcess::ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas)
+{
+    if (taskPool_ == nullptr || inputDatas.size() <= 1 || inputDatas.size() > slots_.size()) {
+        return ModuleBase::ProcessBatch(inputDatas);
+    }
+
+    batch_.clear();
+    for (auto &inputData : inputDatas) {
+        std::shared_ptr<CommonData> data = std::static_pointer_cast<CommonData>(inputData);
+        RecordQueueWait(ModuleMessageHooks<CommonData>::Context(inputData));
+        batch_.push_back(data);
+    }
+    for (size_t i = 0; i < batch_.size(); i++) {
+        PostProcessSlot &slot = *slots_[i];
+        slot.ret = APP_ERR_OK;
+        if (!batch_[i]->eof) {
+            slot.ret = CopyOutputToHost(*batch_[i], slot);
+        }
+    }
+    taskPool_->ParallelFor(batch_.size(), [this](size_t i) {
+        const CommonData &data = *batch_[i];
+        PostProcessSlot &slot = *slots_[i];
+        if (data.eof || slot.ret != APP_ERR_OK) {
+            return;
+        }
+        TraceSpan span("YoloPostProcess", data.msgContext.trace);
+        slot.ret = YoloPostProcess(data, slot, nullptr);
+    });
+
+    APP_ERROR result = APP_ERR_OK;
+    for (size_t i = 0; i < batch_.size(); i++) {
+        APP_ERROR ret = FinishFrame(batch_[i], *slots_[i]);
+        if (ret != APP_ERR_OK) {
+            result = ret;
+        }
+    }
+    batch_.clear();
+    return result;
+}
+
 APP_ERROR PostProcess::DeInit(void)
 {
-    while (!buffers_.empty()) {
-        std::vector<void *> buffer = buffers_.front();
-        buffers_.pop();
-        for (auto& j : buffer) {
+    for (auto &slot : slots_) {
+        for (auto &j : slot->hostBuffers) {
             aclrtFreeHost(j);
         }
     }
+    slots_.clear();
+    taskPool_.reset();
     return APP_ERR_OK;
 }
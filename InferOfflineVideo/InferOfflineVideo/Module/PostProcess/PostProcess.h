@@ -18,13 +18,30 @@
 
 #include <queue>
 #include "ModuleManager/ModuleManager.h"
+#include "ModuleManager/TypedModule.h"
 #include "ConfigParser/ConfigParser.h"
 #include "DvppCommon/DvppCommon.h"
 #include "DataType/DataType.h"
 #include "Yolov3Post.h"
+#include "YoloDecoder.h"
+#include "Nms.h"
+#include "TaskPool/TaskPool.h"
 #include "ModelInfer/ModelInfer.h"
 
-class PostProcess : public ascendBaseModule::ModuleBase {
+// Host copy and decode state of one frame. The frames of a batch are decoded at the same time, one slot each
+struct PostProcessSlot {
+    // The device outputs stay leased by the frame until they are copied here
+    std::vector<void *> hostBuffers;
+    // Reused by every frame, so their capacity is allocated once
+    std::vector<std::shared_ptr<void>> hostPtr;
+    std::vector<size_t> hostSizes;
+    std::vector<ObjDetectInfo> objInfos;
+    YoloDecoder decoder;
+    NmsEngine nms;
+    APP_ERROR ret = APP_ERR_OK;
+};
+
+class PostProcess : public ascendBaseModule::TypedModule<CommonData, void> {
 public:
     PostProcess();
     ~PostProcess();
@@ -32,19 +49,33 @@ public:
     APP_ERROR DeInit(void);
 
 protected:
-    APP_ERROR Process(std::shared_ptr<void> inputData);
+    APP_ERROR ProcessData(std::shared_ptr<CommonData> data);
+    // Decodes the frames of the batch on the task pool, then writes their results in the queued order
+    APP_ERROR ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas);
+    // Publishes the objects of a decoded frame, called in the order the frames were queued
+    virtual APP_ERROR SendResult(const CommonData &data, const std::vector<ObjDetectInfo> &objInfos);
 
 private:
-    APP_ERROR YoloPostProcess(std::vector<RawData> &modelOutput, std::shared_ptr<DeviceStreamData> &dataToSend,std::vector<ObjDetectInfo> &objInfos);
-    APP_ERROR GetObjectInfoCaffe(std::vector<RawData> &modelOutput, std::vector<ObjDetectInfo> &objInfos);
-    APP_ERROR GetObjectInfoTensorflow(std::vector<RawData> &modelOutput, std::vector<ObjDetectInfo> &objInfos);
-    void ConstructData(std::vector<ObjDetectInfo> &objInfos, std::shared_ptr<DeviceStreamData> &dataToSend);
+    APP_ERROR ParseDecoderConfig(ConfigParser &configParser);
+    APP_ERROR ParseOutputFormats(ConfigParser &configParser, std::vector<YoloOutputFormat> &formats);
+    APP_ERROR ParseNmsConfig(ConfigParser &configParser);
+    APP_ERROR YoloPostProcess(const CommonData &data, PostProcessSlot &slot, TaskPool *pool);
+    APP_ERROR GetObjectInfoCaffe(PostProcessSlot &slot);
+    APP_ERROR GetObjectInfoTensorflow(const CommonData &data, PostProcessSlot &slot, TaskPool *pool);
+    APP_ERROR CopyOutputToHost(const CommonData &data, PostProcessSlot &slot);
+    APP_ERROR FinishFrame(std::shared_ptr<CommonData> &data, PostProcessSlot &slot);
+    void ConstructData(const std::vector<ObjDetectInfo> &objInfos, std::shared_ptr<DeviceStreamData> &dataToSend);
     APP_ERROR WebProcess(std::shared_ptr<DeviceStreamData>& inputData);
     APP_ERROR WriteResult(const std::vector<ObjDetectInfo> &objInfos, uint32_t channelId, uint32_t frameId);
 
-    uint32_t modelType_ = 0;
-    YoloImageInfo yoloImageInfo_;
-    std::queue<std::vector<void *>> buffers_;
+    std::shared_ptr<DeviceStreamData> detectInfo_;
+    // Configured once, copied into the slots
+    YoloDecoder decoder_;
+    NmsEngine nms_;
+    // One slot without task pool, popBatchSize slots with it
+    std::vector<std::unique_ptr<PostProcessSlot>> slots_;
+    std::shared_ptr<TaskPool> taskPool_;
+    std::vector<std::shared_ptr<CommonData>> batch_;
 };
 
 MODULE_REGIST(PostProcess)
@@ -0,0 +1,472 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "YoloDecoder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Log/Log.h"
+#include "FastMath.h"
+#include "CandidateScan.h"
+#include "TaskPool/TaskPool.h"
+
+namespace {
+const int BOX_OFFSET_Y = 1;
+const int BOX_OFFSET_WIDTH = 2;
+const int BOX_OFFSET_HEIGHT = 3;
+const int ANCHOR_PAIR = 2;
+const float LOGIT_MARGIN = 0.01f; // larger than the error of fastmath::sigmoid around the threshold
+const float V5_XY_SCALE = 2.0f;
+const float V5_XY_OFFSET = 0.5f;
+const float V5_WH_SCALE = 2.0f;
+/*
+ * The class scores of models with at least this many classes are computed with SigmoidBatch, the others with the
+ * lookup table like the objectness. The two differ by less than 4e-6 on a class probability, which changes the
+ * selected class only where two classes or a class and its threshold are that close: none of 100000 anchors of
+ * 80 random logits in FastMathTest. See FastMathBench for the time of both
+ */
+const int BATCH_SIGMOID_MIN_CLASSES = 8;
+const size_t MIN_TASK_ANCHORS = 1024;    // smaller bands cost more to hand over than to decode
+const size_t TASKS_PER_THREAD = 2;       // a few bands per thread even out the different candidate counts
+const size_t TENSOR_TYPE_SIZES[YOLO_TENSOR_TYPE_NUM] = {sizeof(float), sizeof(uint16_t), sizeof(int8_t),
+                                                       sizeof(uint8_t)};
+const float QUANT_LIMIT_BOUND = 1024.0f;  // beyond the range of every quantized type
+
+struct LayoutDefaults {
+    std::vector<float> anchors;
+    std::vector<uint32_t> strides;
+};
+
+// darknet and ultralytics anchors of the coco models
+const LayoutDefaults V3_DEFAULTS = {
+    {10, 13, 16, 30, 33, 23, 30, 61, 62, 45, 59, 119, 116, 90, 156, 198, 373, 326}, {32, 16, 8}
+};
+const LayoutDefaults V4_DEFAULTS = {
+    {12, 16, 19, 36, 40, 28, 36, 75, 76, 55, 72, 146, 142, 110, 192, 243, 459, 401}, {8, 16, 32}
+};
+const LayoutDefaults V5_DEFAULTS = {
+    {10, 13, 16, 30, 33, 23, 30, 61, 62, 45, 59, 119, 116, 90, 156, 198, 373, 326}, {8, 16, 32}
+};
+const LayoutDefaults TINY_DEFAULTS = {
+    {10, 14, 23, 27, 37, 58, 81, 82, 135, 169, 344, 319}, {32, 16}
+};
+
+// The candidate scan and the conversion of the elements of each output type
+inline size_t ScanLayer(const float *data, size_t anchorNum, size_t anchorSize, const YoloLayer &,
+                        float objectnessLogit, uint32_t *indexes)
+{
+    return ScanCandidates(data, anchorNum, anchorSize, BOX_DIM, objectnessLogit, indexes);
+}
+
+inline size_t ScanLayer(const uint16_t *data, size_t anchorNum, size_t anchorSize, const YoloLayer &,
+                        float objectnessLogit, uint32_t *indexes)
+{
+    return ScanCandidatesHalf(data, anchorNum, anchorSize, BOX_DIM, objectnessLogit, indexes);
+}
+
+inline size_t ScanLayer(const int8_t *data, size_t anchorNum, size_t anchorSize, const YoloLayer &layer, float,
+                        uint32_t *indexes)
+{
+    return ScanCandidatesInt8(data, anchorNum, anchorSize, BOX_DIM, layer.objectnessLimit, indexes);
+}
+
+inline size_t ScanLayer(const uint8_t *data, size_t anchorNum, size_t anchorSize, const YoloLayer &layer, float,
+                        uint32_t *indexes)
+{
+    return ScanCandidatesUint8(data, anchorNum, anchorSize, BOX_DIM, layer.objectnessLimit, indexes);
+}
+
+inline float ToFloat(float value, const YoloOutputFormat &)
+{
+    return value;
+}
+
+inline float ToFloat(uint16_t value, const YoloOutputFormat &)
+{
+    return fastmath::HalfToFloat(value);
+}
+
+inline float ToFloat(int8_t value, const YoloOutputFormat &format)
+{
+    return (value - format.zeroPoint) * format.scale;
+}
+
+inline float ToFloat(uint8_t value, const YoloOutputFormat &format)
+{
+    return (value - format.zeroPoint) * format.scale;
+}
+
+// The class logits of an anchor as floats, the ones of FLOAT32 outputs are used in place
+inline const float *ToFloats(const float *values, int, const YoloOutputFormat &, float *)
+{
+    return values;
+}
+
+template<typename T>
+inline const float *ToFloats(const T *values, int count, const YoloOutputFormat &format, float *buffer)
+{
+    for (int i = 0; i < count; ++i) {
+        buffer[i] = ToFloat(values[i], format);
+    }
+    return buffer;
+}
+
+const LayoutDefaults &GetLayoutDefaults(YoloLayout layout)
+{
+    switch (layout) {
+        case YOLO_LAYOUT_V4:
+            return V4_DEFAULTS;
+        case YOLO_LAYOUT_V5:
+            return V5_DEFAULTS;
+        case YOLO_LAYOUT_TINY:
+            return TINY_DEFAULTS;
+        default:
+            return V3_DEFAULTS;
+    }
+}
+}
+
+APP_ERROR YoloDecoder::Init(const YoloDecoderConfig &config)
+{
+    config_ = config;
+    const LayoutDefaults &defaults = GetLayoutDefaults(config_.layout);
+    if (config_.strides.empty()) {
+        config_.strides = defaults.strides;
+    }
+    if (config_.anchors.empty() && config_.anchorDim == ANCHOR_DIM &&
+        config_.strides.size() * ANCHOR_DIM * ANCHOR_PAIR == defaults.anchors.size()) {
+        config_.anchors = defaults.anchors;
+    }
+    if (config_.scoreThresh.empty()) {
+        config_.scoreThresh.push_back(SCORE_THRESH);
+    }
+    APP_ERROR ret = CheckConfig();
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+
+    // the classes which are not kept get a threshold no score can pass
+    classThresh_.assign(config_.classNum, std::numeric_limits<float>::infinity());
+    for (int c = 0; c < config_.classNum; ++c) {
+        bool kept = config_.classes.empty() ||
+            std::find(config_.classes.begin(), config_.classes.end(), static_cast<uint32_t>(c)) != config_.classes.end();
+        if (kept) {
+            classThresh_[c] = (config_.scoreThresh.size() == 1) ? config_.scoreThresh[0] : config_.scoreThresh[c];
+        }
+    }
+    minScoreThresh_ = *std::min_element(classThresh_.begin(), classThresh_.end());
+    // Anchors whose objectness logit is not above it can never pass the objectness check, the ones above it are still
+    // checked with fastmath::sigmoid, so the boxes are the same as when every anchor is checked
+    objectnessLogit_ = (config_.objectnessThresh > 0) ?
+        std::log(config_.objectnessThresh / (1.0f - config_.objectnessThresh)) - LOGIT_MARGIN :
+        -std::numeric_limits<float>::infinity();
+
+    const int classNum1 = 1;
+    const int classNum2 = 2;
+    const int classNumCoco = 80;
+    switch (config_.classNum) {
+        case classNum1:
+            SetDecodeBands<classNum1>();
+            break;
+        case classNum2:
+            SetDecodeBands<classNum2>();
+            break;
+        case classNumCoco:
+            SetDecodeBands<classNumCoco>();
+            break;
+        default:
+            SetDecodeBands<0>();
+            break;
+    }
+    netWidth_ = 0;
+    netHeight_ = 0;
+    layers_.clear();
+    tasks_.clear();
+    return APP_ERR_OK;
+}
+
+template<int CLASSES>
+void YoloDecoder::SetDecodeBands()
+{
+    decodeBands_[YOLO_TENSOR_FLOAT32] = &YoloDecoder::DecodeBand<CLASSES, float>;
+    decodeBands_[YOLO_TENSOR_FLOAT16] = &YoloDecoder::DecodeBand<CLASSES, uint16_t>;
+    decodeBands_[YOLO_TENSOR_INT8] = &YoloDecoder::DecodeBand<CLASSES, int8_t>;
+    decodeBands_[YOLO_TENSOR_UINT8] = &YoloDecoder::DecodeBand<CLASSES, uint8_t>;
+}
+
+void YoloDecoder::SetWorkerNum(uint32_t workerNum)
+{
+    workerNum_ = workerNum;
+    // the bands are split again by the next Decode
+    netWidth_ = 0;
+    netHeight_ = 0;
+}
+
+APP_ERROR YoloDecoder::CheckConfig() const
+{
+    if (config_.classNum <= 0 || config_.anchorDim <= 0 || config_.strides.empty()) {
+        LogError << "The yolo decoder needs a positive class number, anchor number and at least one stride.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    if (config_.anchors.size() != config_.strides.size() * config_.anchorDim * ANCHOR_PAIR) {
+        LogError << "The yolo decoder has " << config_.anchors.size() << " anchor values, " <<
+            config_.strides.size() * config_.anchorDim * ANCHOR_PAIR << " are expected for " <<
+            config_.strides.size() << " outputs of " << config_.anchorDim << " anchors.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    for (auto stride : config_.strides) {
+        if (stride == 0 || std::count(config_.strides.begin(), config_.strides.end(), stride) != 1) {
+            LogError << "The strides of the yolo decoder must be positive and different.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+    }
+    if (config_.scoreThresh.size() != 1 && config_.scoreThresh.size() != static_cast<size_t>(config_.classNum)) {
+        LogError << "The yolo decoder has " << config_.scoreThresh.size() << " score thresholds, 1 or " <<
+            config_.classNum << " are expected.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    for (auto classId : config_.classes) {
+        if (classId >= static_cast<uint32_t>(config_.classNum)) {
+            LogError << "The yolo decoder keeps class " << classId << ", the model has " << config_.classNum << ".";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+    }
+    for (const auto &format : config_.outputFormats) {
+        if (format.type < YOLO_TENSOR_FLOAT32 || format.type >= YOLO_TENSOR_TYPE_NUM) {
+            LogError << "The yolo decoder does not support the output type " << format.type << ".";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        if (!(format.scale > 0.0f) || std::isinf(format.scale) || !std::isfinite(format.zeroPoint)) {
+            LogError << "The quantization scale of a yolo output must be positive, the zero point finite.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+    }
+    if (config_.objectnessThresh >= 1.0f) {
+        LogError << "The objectness threshold of the yolo decoder must be less than 1.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    return APP_ERR_OK;
+}
+
+const YoloDecoderConfig &YoloDecoder::GetConfig() const
+{
+    return config_;
+}
+
+float YoloDecoder::GetScoreThresh(int classId) const
+{
+    if (classId < 0 || classId >= static_cast<int>(classThresh_.size())) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return classThresh_[classId];
+}
+
+float YoloDecoder::GetMinScoreThresh() const
+{
+    return minScoreThresh_;
+}
+
+/*
+ * @description: Build the layers of the model input size, the layer of the smallest stride gets the first anchors.
+ *               The layers are cut into bands of rows, one per layer without workers
+ * @param netWidth  Model input width
+ * @param netHeight  Model input height
+ */
+void YoloDecoder::BuildLayers(int netWidth, int netHeight)
+{
+    std::vector<uint32_t> sortedStrides = config_.strides;
+    std::sort(sortedStrides.begin(), sortedStrides.end());
+    const size_t anchorValues = static_cast<size_t>(config_.anchorDim) * ANCHOR_PAIR;
+    layers_.clear();
+    for (size_t i = 0; i < config_.strides.size(); ++i) {
+        const uint32_t stride = config_.strides[i];
+        size_t rank = std::find(sortedStrides.begin(), sortedStrides.end(), stride) - sortedStrides.begin();
+        YoloLayer layer;
+        layer.outputIdx = i;
+        layer.width = netWidth / static_cast<int>(stride);
+        layer.height = netHeight / static_cast<int>(stride);
+        layer.anchors.assign(config_.anchors.begin() + rank * anchorValues,
+                             config_.anchors.begin() + (rank + 1) * anchorValues);
+        if (i < config_.outputFormats.size()) {
+            layer.format = config_.outputFormats[i];
+        }
+        // q > floor(logit / scale + zeroPoint) for every q whose value is above the logit
+        float quantLimit = objectnessLogit_ / layer.format.scale + layer.format.zeroPoint;
+        quantLimit = std::max(std::min(quantLimit, QUANT_LIMIT_BOUND), -QUANT_LIMIT_BOUND);
+        layer.objectnessLimit = static_cast<int32_t>(std::floor(quantLimit));
+        layers_.push_back(layer);
+    }
+
+    size_t totalAnchors = 0;
+    for (const auto &layer : layers_) {
+        totalAnchors += static_cast<size_t>(layer.width) * layer.height * config_.anchorDim;
+    }
+    size_t taskAnchors = totalAnchors;
+    if (workerNum_ > 0) {
+        const size_t taskNum = TASKS_PER_THREAD * (workerNum_ + 1);
+        taskAnchors = std::max(MIN_TASK_ANCHORS, (totalAnchors + taskNum - 1) / taskNum);
+    }
+    tasks_.clear();
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        const size_t rowAnchors = static_cast<size_t>(layers_[i].width) * config_.anchorDim;
+        const int bandRows = static_cast<int>(std::max<size_t>(1, taskAnchors / std::max<size_t>(1, rowAnchors)));
+        for (int row = 0; row < layers_[i].height; row += bandRows) {
+            YoloDecodeTask task;
+            task.layerIdx = i;
+            task.rowBegin = row;
+            task.rowEnd = std::min(row + bandRows, layers_[i].height);
+            task.candidates.resize(rowAnchors * (task.rowEnd - task.rowBegin));
+            task.classLogits.resize(config_.classNum);
+            task.classScores.resize(config_.classNum);
+            tasks_.push_back(std::move(task));
+        }
+    }
+    netWidth_ = netWidth;
+    netHeight_ = netHeight;
+}
+
+/*
+ * @description: Select the highest confidence class label for each predicted box of a band and save into detBoxes
+ * @param netout  The feature data which contains box coordinates, objectness value and confidence of each class
+ * @param layer  Yolo output layer
+ * @param task  Rows of the layer and scratch
+ * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ * CLASSES  The class number when it is known at compile time, 0: config_.classNum
+ * T  The element type of the layer, float, uint16_t halves, int8_t or uint8_t
+ */
+template<int CLASSES, typename T>
+void YoloDecoder::DecodeBand(const void *layerData, const YoloLayer &layer, YoloDecodeTask &task,
+                             std::vector<DetectBox> &detBoxes)
+{
+    const T *netout = static_cast<const T *>(layerData);
+    const YoloOutputFormat &format = layer.format;
+    const int classNum = (CLASSES > 0) ? CLASSES : config_.classNum;
+    const int bboxDim = BOX_DIM;
+    const int anchorSize = bboxDim + 1 + classNum;
+    const int anchorBase = task.rowBegin * layer.width * config_.anchorDim;
+    const size_t anchorNum = static_cast<size_t>(task.rowEnd - task.rowBegin) * layer.width * config_.anchorDim;
+    const bool v5 = (config_.layout == YOLO_LAYOUT_V5);
+    const float scaleXY = config_.scaleXY;
+    const float offsetXY = (scaleXY - 1.0f) / 2.f;
+    const float *classThresh = classThresh_.data();
+    const bool batchSigmoid = (classNum >= BATCH_SIGMOID_MIN_CLASSES);
+    float *classScores = task.classScores.data();
+    // Only the anchors whose objectness logit passes the prefilter go through the sigmoid below
+    size_t candidateNum = ScanLayer(netout + static_cast<size_t>(anchorSize) * anchorBase, anchorNum, anchorSize,
+                                    layer, objectnessLogit_, task.candidates.data());
+    for (size_t n = 0; n < candidateNum; ++n) {
+        int anchor = anchorBase + static_cast<int>(task.candidates[n]);
+        int j = anchor / config_.anchorDim;
+        int k = anchor % config_.anchorDim;
+        const T *box = netout + static_cast<size_t>(anchorSize) * anchor;
+        // check obj
+        float objectness = fastmath::sigmoid(ToFloat(box[bboxDim], format));
+        if (objectness <= config_.objectnessThresh) {
+            continue;
+        }
+        int classID = -1;
+        float maxProb = 0.0f;
+        const float *classLogits = ToFloats(box + bboxDim + 1, classNum, format, task.classLogits.data());
+        if (batchSigmoid) {
+            fastmath::SigmoidBatch(classLogits, classScores, classNum);
+        }
+        // Select the class of the largest confidence among the ones above their thresholds
+        for (int c = 0; c < classNum; ++c) {
+            float classProb = (batchSigmoid ? classScores[c] : fastmath::sigmoid(classLogits[c])) * objectness;
+            if (classProb > classThresh[c] && classProb > maxProb) {
+                maxProb = classProb;
+                classID = c;
+            }
+        }
+        if (classID < 0) {
+            continue;
+        }
+        DetectBox det = {};
+        int row = j / layer.width;
+        int col = j % layer.width;
+        if (v5) {
+            float width = fastmath::sigmoid(ToFloat(box[BOX_OFFSET_WIDTH], format)) * V5_WH_SCALE;
+            float height = fastmath::sigmoid(ToFloat(box[BOX_OFFSET_HEIGHT], format)) * V5_WH_SCALE;
+            det.x = (col + fastmath::sigmoid(ToFloat(box[0], format)) * V5_XY_SCALE - V5_XY_OFFSET) / layer.width;
+            det.y = (row + fastmath::sigmoid(ToFloat(box[BOX_OFFSET_Y], format)) * V5_XY_SCALE - V5_XY_OFFSET) /
+                layer.height;
+            det.width = width * width * layer.anchors[ANCHOR_PAIR * k] / netWidth_;
+            det.height = height * height * layer.anchors[ANCHOR_PAIR * k + 1] / netHeight_;
+        } else {
+            det.x = (col + fastmath::sigmoid(ToFloat(box[0], format)) * scaleXY - offsetXY) / layer.width;
+            det.y = (row + fastmath::sigmoid(ToFloat(box[BOX_OFFSET_Y], format)) * scaleXY - offsetXY) / layer.height;
+            det.width = fastmath::exp(ToFloat(box[BOX_OFFSET_WIDTH], format)) * layer.anchors[ANCHOR_PAIR * k] /
+                netWidth_;
+            det.height = fastmath::exp(ToFloat(box[BOX_OFFSET_HEIGHT], format)) * layer.anchors[ANCHOR_PAIR * k + 1] /
+                netHeight_;
+        }
+        det.classID = classID;
+        det.prob = maxProb;
+        detBoxes.emplace_back(det);
+    }
+}
+
+/*
+ * @description: Decode the outputs of a frame into detBoxes
+ * @param featLayerData  The outputs of the model on host
+ * @param featLayerSizes  The sizes in bytes of the outputs
+ * @param netWidth  Model input width
+ * @param netHeight  Model input height
+ * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ * @param pool  Workers which decode the bands with the caller, nullptr: the caller decodes them
+ */
+APP_ERROR YoloDecoder::Decode(const std::vector<std::shared_ptr<void>> &featLayerData,
+                              const std::vector<size_t> &featLayerSizes, int netWidth, int netHeight,
+                              std::vector<DetectBox> &detBoxes, TaskPool *pool)
+{
+    if (decodeBands_[YOLO_TENSOR_FLOAT32] == nullptr) {
+        LogError << "The yolo decoder is not initialized.";
+        return APP_ERR_COMM_INIT_FAIL;
+    }
+    if (netWidth != netWidth_ || netHeight != netHeight_) {
+        BuildLayers(netWidth, netHeight);
+    }
+    const size_t anchorSize = BOX_DIM + 1 + config_.classNum;
+    for (const auto &layer : layers_) {
+        const size_t needed = static_cast<size_t>(layer.width) * layer.height * config_.anchorDim * anchorSize *
+            TENSOR_TYPE_SIZES[layer.format.type];
+        if (layer.outputIdx >= featLayerData.size() || layer.outputIdx >= featLayerSizes.size() ||
+            featLayerSizes[layer.outputIdx] < needed) {
+            LogError << "The output " << layer.outputIdx << " of the model is missing or smaller than the " << needed <<
+                " bytes of a " << layer.width << "x" << layer.height << " yolo layer.";
+            return APP_ERR_INFER_GET_OUTPUT_FAIL;
+        }
+    }
+    auto netout = [this, &featLayerData](const YoloDecodeTask &task) {
+        return featLayerData[layers_[task.layerIdx].outputIdx].get();
+    };
+    if (pool == nullptr || tasks_.size() <= 1) {
+        for (auto &task : tasks_) {
+            const YoloLayer &layer = layers_[task.layerIdx];
+            (this->*decodeBands_[layer.format.type])(netout(task), layer, task, detBoxes);
+        }
+        return APP_ERR_OK;
+    }
+    pool->ParallelFor(tasks_.size(), [this, &netout](size_t i) {
+        YoloDecodeTask &task = tasks_[i];
+        const YoloLayer &layer = layers_[task.layerIdx];
+        task.boxes.clear();
+        (this->*decodeBands_[layer.format.type])(netout(task), layer, task, task.boxes);
+    });
+    for (const auto &task : tasks_) {
+        detBoxes.insert(detBoxes.end(), task.boxes.begin(), task.boxes.end());
+    }
+    return APP_ERR_OK;
+}
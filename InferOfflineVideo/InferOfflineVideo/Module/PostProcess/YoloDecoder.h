@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef YOLO_DECODER_H
+#define YOLO_DECODER_H
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+#include "ErrorCode/ErrorCode.h"
+#include "Yolov3Post.h"
+
+class TaskPool;
+
+enum YoloLayout {
+    YOLO_LAYOUT_V3 = 0, // xy = (cell + sigmoid(t)) / grid, wh = exp(t) * anchor
+    YOLO_LAYOUT_V4,     // as v3 with scaleXY, different default anchors
+    YOLO_LAYOUT_V5,     // xy = (cell + 2 * sigmoid(t) - 0.5) / grid, wh = (2 * sigmoid(t))^2 * anchor
+    YOLO_LAYOUT_TINY,   // as v3 with 2 outputs
+};
+
+// Element type of a model output
+enum YoloTensorType {
+    YOLO_TENSOR_FLOAT32 = 0,
+    YOLO_TENSOR_FLOAT16,
+    YOLO_TENSOR_INT8,
+    YOLO_TENSOR_UINT8,
+    YOLO_TENSOR_TYPE_NUM
+};
+
+// The values of INT8 and UINT8 outputs are (q - zeroPoint) * scale
+struct YoloOutputFormat {
+    YoloTensorType type = YOLO_TENSOR_FLOAT32;
+    float scale = 1.0f;
+    float zeroPoint = 0.0f;
+};
+
+// The fields left empty are filled with the defaults of the layout by YoloDecoder::Init
+struct YoloDecoderConfig {
+    YoloLayout layout = YOLO_LAYOUT_V3;
+    int classNum = CLASS_NUM;
+    int anchorDim = ANCHOR_DIM;     // anchors per cell
+    std::vector<float> anchors;     // (width, height) in pixels of the model input, for the strides in ascending order
+    std::vector<uint32_t> strides;  // of the model outputs, in output order
+    float scaleXY = 1.0f;           // grid sensitivity of v4 models, 1: none
+    float objectnessThresh = OBJECTNESS_THRESH;
+    std::vector<float> scoreThresh; // one for every class, or one for all of them
+    std::vector<uint32_t> classes;  // the classes to keep, empty: all of them
+    std::vector<YoloOutputFormat> outputFormats; // in output order, the outputs without one are FLOAT32
+};
+
+// One output of the model, [height][width][anchorDim][box, objectness, classes] elements of format.type
+struct YoloLayer {
+    size_t outputIdx;
+    int width;
+    int height;
+    std::vector<float> anchors; // anchorDim (width, height) pairs
+    YoloOutputFormat format;
+    int32_t objectnessLimit;    // of quantized outputs, the anchors whose objectness is not above it are skipped
+};
+
+// Rows [rowBegin, rowEnd) of a layer, decoded by one task. The scratch of a task is only used by the worker running it
+struct YoloDecodeTask {
+    size_t layerIdx;
+    int rowBegin;
+    int rowEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<float> classLogits; // of the outputs which are not FLOAT32
+    std::vector<float> classScores;
+    std::vector<DetectBox> boxes;
+};
+
+// Decodes the outputs of a yolo model into boxes. Each PostProcess instance owns one, the layers are built again
+// when the model input size changes. The class loop is specialized for 1, 2 and 80 classes, the class scores of
+// models with 8 classes or more are computed with fastmath::SigmoidBatch. FLOAT16 and quantized outputs are decoded
+// as they are, the objectness is compared in their type and only the candidates are converted. With workers, the
+// layers are split into bands of rows decoded in parallel, and the boxes of the bands are appended in order, so they
+// do not depend on it
+class YoloDecoder {
+public:
+    APP_ERROR Init(const YoloDecoderConfig &config);
+    const YoloDecoderConfig &GetConfig() const;
+    // Threshold of the score of a class, above 1 for the classes which are not kept
+    float GetScoreThresh(int classId) const;
+    float GetMinScoreThresh() const;
+    // Workers of the pool given to Decode, the layers are split for them and the caller
+    void SetWorkerNum(uint32_t workerNum);
+    // Appends the boxes of a frame to detBoxes, the coordinates are relative to the model input
+    APP_ERROR Decode(const std::vector<std::shared_ptr<void>> &featLayerData, const std::vector<size_t> &featLayerSizes,
+                     int netWidth, int netHeight, std::vector<DetectBox> &detBoxes, TaskPool *pool = nullptr);
+
+private:
+    using DecodeBandFunc = void (YoloDecoder::*)(const void *netout, const YoloLayer &layer, YoloDecodeTask &task,
+                                                 std::vector<DetectBox> &detBoxes);
+
+    APP_ERROR CheckConfig() const;
+    void BuildLayers(int netWidth, int netHeight);
+    template<int CLASSES>
+    void SetDecodeBands();
+    template<int CLASSES, typename T>
+    void DecodeBand(const void *netout, const YoloLayer &layer, YoloDecodeTask &task,
+                    std::vector<DetectBox> &detBoxes);
+
+    YoloDecoderConfig config_;
+    DecodeBandFunc decodeBands_[YOLO_TENSOR_TYPE_NUM] = {};
+    std::vector<float> classThresh_;
+    float minScoreThresh_ = SCORE_THRESH;
+    float objectnessLogit_ = 0.0f;
+    int netWidth_ = 0;
+    int netHeight_ = 0;
+    uint32_t workerNum_ = 0;
+    std::vector<YoloLayer> layers_;
+    std::vector<YoloDecodeTask> tasks_;
+};
+
+#endif
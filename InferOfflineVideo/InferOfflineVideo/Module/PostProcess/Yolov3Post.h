@@ -20,35 +20,16 @@
 #include <vector>
 #include <memory>
 #include "DataType/DataType.h"
+#include "ErrorCode/ErrorCode.h"
 
-const int CLASS_NUM = 1;
-const int DEPTH = 255; // (4(box: x, y, h, w) + 1(confidence) + 80(classNum)) * 3(anchorNum)
-const int BIASES_NUM = 18; // Yolov3 anchors, generate from train data, coco dataset
-const float BIASES[BIASES_NUM] = {10, 13, 16, 30, 33, 23, 30, 61, 62, 45, 59, 119, 116, 90, 156, 198, 373, 326};
+const int CLASS_NUM = 1; // Defaults of the yolo decoder
 const float SCORE_THRESH = 0.3; // Threshold of confidence
 const float OBJECTNESS_THRESH = 0.3; // Threshold of objectness value
 const float IOU_THRESH = 0.45; // Non-Maximum Suppression threshold
 const float COORDINATE_PARAM = 2.0;
-const int YOLO_TYPE = 3;
 const int ANCHOR_DIM = 3;
 const int BOX_DIM = 4;
 
-struct OutputLayer {
-    int layerIdx;
-    int width;
-    int height;
-    float anchors[6];
-};
-
-struct NetInfo {
-    int anchorDim;
-    int classNum;
-    int bboxDim;
-    int netWidth;
-    int netHeight;
-    std::vector<OutputLayer> outputLayers;
-};
-
 // Box information
 struct DetectBox {
     float prob;
@@ -69,9 +50,17 @@ struct ObjDetectInfo {
     float classId;
 };
 
+class YoloDecoder;
+class NmsEngine;
+class TaskPool;
+
 // Realize the Yolo layer to get detiction object info
-void Yolov3DetectionOutput(std::vector<std::shared_ptr<void>> featLayerData,
-                           std::vector<ObjDetectInfo> &objInfos,
-                           YoloImageInfo imgInfo);
+APP_ERROR Yolov3DetectionOutput(const std::vector<std::shared_ptr<void>> &featLayerData,
+                                const std::vector<size_t> &featLayerSizes,
+                                std::vector<ObjDetectInfo> &objInfos,
+                                YoloImageInfo imgInfo,
+                                YoloDecoder &decoder,
+                                NmsEngine &nms,
+                                TaskPool *pool = nullptr);
 
 #endif
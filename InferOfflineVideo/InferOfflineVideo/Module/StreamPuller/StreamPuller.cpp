@@ -29,6 +29,11 @@ using namespace ascendBaseModule;
 namespace {
 const int LOW_THRESHOLD = 128;
 const int MAX_THRESHOLD = 4096;
+
+void FreePacket(AVPacket *packet)
+{
+    av_packet_free(&packet);
+}
 }
 
 using Time = std::chrono::high_resolution_clock;
@@ -79,7 +84,7 @@ APP_ERROR StreamPuller::DeInit(void)
     return APP_ERR_OK;
 }
 
-APP_ERROR StreamPuller::Process(std::shared_ptr<void> inputData)
+APP_ERROR StreamPuller::ProcessData(std::shared_ptr<void> inputData)
 {
     int failureNum = 0;
     while (failureNum < 1) {
@@ -186,14 +191,16 @@ void StreamPuller::PullStreamDataLoop()
             break;
         }
         av_init_packet(&pkt);
+        TraceContext trace = Tracer::Begin(frameInfo_.channelId, frameInfo_.frameId);
+        uint64_t readStartUs = trace.sampled ? Tracer::NowUs() : 0;
         int ret = av_read_frame(pFormatCtx_, &pkt);
         if (ret != 0) {
             if (ret == AVERROR_EOF) {
                 LogInfo << "StreamPuller [" << instanceId_ << "]: channel StreamPuller is EOF, exit";
-                std::shared_ptr<FrameData> frameData = std::make_shared<FrameData>();
+                std::shared_ptr<FrameData> frameData = MakePooled<FrameData>();
                 frameData->frameInfo = frameInfo_;
                 frameData->frameInfo.eof = true;
-                SendToNextModule(MT_VideoDecoder, frameData, frameData->frameInfo.channelId);
+                SendToNextModule(std::move(frameData), frameInfo_.channelId);
                 break;
             }
             LogInfo << "StreamPuller [" << instanceId_ << "]: channel Read frame failed, continue";
@@ -206,14 +213,30 @@ void StreamPuller::PullStreamDataLoop()
                 continue;
             }
 
-            uint8_t* dataBuffer = (uint8_t *)malloc(pkt.size);
-            std::copy(pkt.data, pkt.data + pkt.size, dataBuffer);
-            std::shared_ptr<FrameData> frameData = std::make_shared<FrameData>();
+            // The stream data keeps a reference to the buffer of the packet instead of a copy of it
+            std::shared_ptr<AVPacket> packet(av_packet_alloc(), FreePacket, RecyclingAllocator<AVPacket>());
+            if (packet == nullptr) {
+                LogError << "StreamPuller [" << instanceId_ << "]: failed to allocate packet";
+                av_packet_unref(&pkt);
+                continue;
+            }
+            if (pkt.buf != nullptr) {
+                av_packet_move_ref(packet.get(), &pkt);
+            } else if (av_packet_ref(packet.get(), &pkt) != 0) { // not refcounted, copied into a new buffer
+                LogError << "StreamPuller [" << instanceId_ << "]: failed to reference packet";
+                av_packet_unref(&pkt);
+                continue;
+            }
+            std::shared_ptr<FrameData> frameData = MakePooled<FrameData>();
             frameData->frameInfo = frameInfo_;
             frameData->frameInfo.eof = false;
-            frameData->streamData.data.reset(dataBuffer, free);
-            frameData->streamData.size = pkt.size;
-            SendToNextModule(MT_VideoDecoder, frameData, frameData->frameInfo.channelId);
+            frameData->streamData.data = std::shared_ptr<void>(packet, packet->data);
+            frameData->streamData.size = packet->size;
+            frameData->frameInfo.msgContext.trace = trace;
+            if (trace.sampled) {
+                Tracer::Record("PullStreamData", TRACE_SPAN_STAGE, trace, readStartUs, Tracer::NowUs());
+            }
+            SendToNextModule(std::move(frameData), frameInfo_.channelId);
             frameInfo_.frameId++;
         }
         av_packet_unref(&pkt);
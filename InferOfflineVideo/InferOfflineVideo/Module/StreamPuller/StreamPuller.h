@@ -20,6 +20,7 @@
 #include "acl/acl.h"
 #include "ErrorCode/ErrorCode.h"
 #include "ModuleManager/ModuleManager.h"
+#include "ModuleManager/TypedModule.h"
 #include "ConfigParser/ConfigParser.h"
 #include "DataType/DataType.h"
 
@@ -27,7 +28,7 @@ extern "C" {
 #include "libavformat/avformat.h"
 }
 
-class StreamPuller : public ascendBaseModule::ModuleBase {
+class StreamPuller : public ascendBaseModule::TypedModule<void, FrameData> {
 public:
     StreamPuller();
     ~StreamPuller();
@@ -35,7 +36,7 @@ public:
     APP_ERROR DeInit(void);
 
 protected:
-    APP_ERROR Process(std::shared_ptr<void> inputData);
+    APP_ERROR ProcessData(std::shared_ptr<void> inputData);
 
 private:
     APP_ERROR ParseConfig(ConfigParser &configParser);
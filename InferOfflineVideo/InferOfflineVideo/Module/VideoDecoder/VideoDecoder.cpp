@@ -38,12 +38,8 @@ VideoDecoder::~VideoDecoder() {}
 
 void VideoDecoder::VideoDecoderCallBack(acldvppStreamDesc *input, acldvppPicDesc *output, void *userdata)
 {
-    void *dataDev = acldvppGetStreamDescData(input);
-    APP_ERROR ret = (APP_ERROR)acldvppFree(dataDev);
-    if (ret != APP_ERR_OK) {
-        LogError << "fail to free input stream desc dataDev";
-    }
-    ret = (APP_ERROR)acldvppDestroyStreamDesc(input);
+    // The stream data and the decoded picture are owned by decodeInfo, they go back to the pool when it is released
+    APP_ERROR ret = (APP_ERROR)acldvppDestroyStreamDesc(input);
     if (ret != APP_ERR_OK) {
         LogError << "fail to destroy input stream desc";
     }
@@ -54,8 +50,13 @@ void VideoDecoder::VideoDecoderCallBack(acldvppStreamDesc *input, acldvppPicDesc
         return;
     }
     VideoDecoder* videoDecoder = decodeInfo->videoDecoder;
+    const TraceContext &trace = decodeInfo->frameInfo.msgContext.trace;
+    if (trace.sampled) {
+        Tracer::Record("VdecDecode", TRACE_SPAN_STAGE, trace, decodeInfo->sendTimeUs, Tracer::NowUs());
+    }
+    TraceSpan callbackSpan("VideoDecoderCallBack", trace);
     if (videoDecoder->frameId % videoDecoder->skipInterval_ == 0) {
-        std::shared_ptr<DvppDataInfo> temp = std::make_shared<DvppDataInfo>();
+        std::shared_ptr<DvppDataInfo> temp = MakePooled<DvppDataInfo>();
         temp->height = decodeInfo->frameInfo.height;
         temp->width = decodeInfo->frameInfo.width;
         temp->heightStride = DVPP_ALIGN_UP(decodeInfo->frameInfo.height, VPC_STRIDE_HEIGHT);
@@ -69,22 +70,22 @@ void VideoDecoder::VideoDecoderCallBack(acldvppStreamDesc *input, acldvppPicDesc
         videoDecoder->vpcDvppCommon_->CombineResizeProcess(*temp, out, true, VPC_PT_FIT);
         temp = videoDecoder->vpcDvppCommon_->GetResizedImage();
 
-        std::shared_ptr<DvppDataInfoT> toNext = std::make_shared<DvppDataInfoT>();
+        std::shared_ptr<DvppDataInfoT> toNext = MakePooled<DvppDataInfoT>();
         toNext->eof = false;
         toNext->channelId = decodeInfo->frameInfo.channelId;
         toNext->srcImageWidth = decodeInfo->frameInfo.width;
         toNext->srcImageHeight = decodeInfo->frameInfo.height;
         toNext->frameId = videoDecoder->frameId;
         toNext->dvppData = std::move(temp);
-        videoDecoder->SendToNextModule(MT_ModelInfer, toNext, toNext->channelId);
+        toNext->msgContext.trace = trace;
+        videoDecoder->SendToNextModule(std::move(toNext), decodeInfo->frameInfo.channelId);
     }
     videoDecoder->frameId++;
-    acldvppFree(acldvppGetPicDescData(output));
     ret = (APP_ERROR)acldvppDestroyPicDesc(output);
     if (ret != APP_ERR_OK) {
         LogError << "Fail to destroy pic desc";
     }
-    delete decodeInfo;
+    DeletePooled(decodeInfo);
 }
 
 void *VideoDecoder::DecoderThread(void *arg)
@@ -94,6 +95,8 @@ void *VideoDecoder::DecoderThread(void *arg)
         LogError << "arg is nullptr";
         return ((void *)(-1));
     }
+    ApplyThreadPlacement(videoDecoder->callbackPlacement_,
+        "VdecCallback[" + std::to_string(videoDecoder->instanceId_) + "]");
 
     aclError ret = aclrtSetCurrentContext(videoDecoder->aclContext_);
     if (ret != APP_ERR_OK) {
@@ -133,6 +136,14 @@ APP_ERROR VideoDecoder::Init(ConfigParser &configParser, ModuleInitArgs &initArg
         return ret;
     }
 
+    // the callback thread takes the placement of the instance unless VideoDecoderCallback.* overrides it
+    callbackPlacement_ = threadPlacement_;
+    ret = LoadThreadPlacement(configParser, moduleName_ + "Callback", instanceId_, callbackPlacement_);
+    if (ret != APP_ERR_OK) {
+        LogError << "VideoDecoder[" << instanceId_ << "]: invalid thread placement of the callback thread.";
+        return ret;
+    }
+
     int createThreadErr = pthread_create(&decoderThreadId_, nullptr, &VideoDecoder::DecoderThread, (void *)this);
     if (createThreadErr != 0) {
         LogError << "Failed to create thread, err = " << createThreadErr;
@@ -151,6 +162,7 @@ APP_ERROR VideoDecoder::Init(ConfigParser &configParser, ModuleInitArgs &initArg
         LogError << "create vpcDvppCommon_ Failed";
         return APP_ERR_COMM_ALLOC_MEM;
     }
+    vpcDvppCommon_->SetMemoryPoolChannel(instanceId_);
 
     ret = vpcDvppCommon_->Init();
     if (ret != APP_ERR_OK) {
@@ -220,19 +232,18 @@ APP_ERROR VideoDecoder::CreateVdecDvppCommon(acldvppStreamFormat format)
     return ret;
 }
 
-APP_ERROR VideoDecoder::Process(std::shared_ptr<void> inputData)
+APP_ERROR VideoDecoder::ProcessData(std::shared_ptr<FrameData> frameData)
 {
-    std::shared_ptr<FrameData> frameData = std::static_pointer_cast<FrameData>(inputData);
     if (frameData->frameInfo.eof) {
         APP_ERROR ret = vdecDvppCommon_->VdecSendEosFrame();
         if (ret != APP_ERR_OK) {
             LogError << "Failed to send eos frame, ret = " << ret;
             return ret;
         }
-        std::shared_ptr<DvppDataInfoT> toNext = std::make_shared<DvppDataInfoT>();
+        std::shared_ptr<DvppDataInfoT> toNext = MakePooled<DvppDataInfoT>();
         toNext->eof = true;
         toNext->channelId = frameData->frameInfo.channelId;
-        SendToNextModule(MT_ModelInfer, toNext, toNext->channelId);
+        SendToNextModule(std::move(toNext), frameData->frameInfo.channelId);
         return APP_ERR_OK;
     }
     streamWidth_ = frameData->frameInfo.width;
@@ -246,17 +257,22 @@ APP_ERROR VideoDecoder::Process(std::shared_ptr<void> inputData)
         }
     }
 
-    std::shared_ptr<DvppDataInfo> vdecData = std::make_shared<DvppDataInfo>();
+    std::shared_ptr<DvppDataInfo> vdecData = MakePooled<DvppDataInfo>();
     vdecData->dataSize = frameData->streamData.size;
     vdecData->data = (uint8_t *)frameData->streamData.data.get();
 
-    DecodeInfo *decodeInfo = new DecodeInfo();
+    DecodeInfo *decodeInfo = NewPooled<DecodeInfo>();
     decodeInfo->frameInfo = frameData->frameInfo;
     decodeInfo->videoDecoder = this;
+    if (decodeInfo->frameInfo.msgContext.trace.sampled) {
+        decodeInfo->sendTimeUs = Tracer::NowUs();
+    }
 
-    APP_ERROR ret = vdecDvppCommon_->CombineVdecProcess(vdecData, decodeInfo);
+    APP_ERROR ret = vdecDvppCommon_->CombineVdecProcess(vdecData, decodeInfo, decodeInfo->inputBuffer,
+                                                        decodeInfo->outputBuffer);
     if (ret != APP_ERR_OK) {
         LogError << "Failed to do VdecProcess, ret = " << ret;
+        DeletePooled(decodeInfo);
         return ret;
     }
 
@@ -18,11 +18,12 @@
 #define VIDEO_DECODER_H
 
 #include "ModuleManager/ModuleManager.h"
+#include "ModuleManager/TypedModule.h"
 #include "ConfigParser/ConfigParser.h"
 #include "DvppCommon/DvppCommon.h"
 #include "DataType/DataType.h"
 
-class VideoDecoder : public ascendBaseModule::ModuleBase {
+class VideoDecoder : public ascendBaseModule::TypedModule<FrameData, DvppDataInfoT> {
 public:
     VideoDecoder();
     ~VideoDecoder();
@@ -30,7 +31,7 @@ public:
     APP_ERROR DeInit(void);
 
 protected:
-    APP_ERROR Process(std::shared_ptr<void> inputData);
+    APP_ERROR ProcessData(std::shared_ptr<FrameData> frameData);
 
 private:
     APP_ERROR ParseConfig(ConfigParser &configParser);
@@ -53,11 +54,15 @@ private:
     DvppCommon* vpcDvppCommon_ = nullptr;
     DvppCommon* vdecDvppCommon_ = nullptr;
     pthread_t decoderThreadId_;
+    ascendBaseModule::ThreadPlacement callbackPlacement_ = {}; // of DecoderThread, which runs the VDEC callbacks
 };
 
 struct DecodeInfo {
     VideoDecoder *videoDecoder = nullptr;
     FrameInfo frameInfo;
+    uint64_t sendTimeUs = 0; // when the frame was sent to VDEC, set for traced frames only
+    DvppBuffer inputBuffer;  // device memory of the stream data
+    DvppBuffer outputBuffer; // device memory of the decoded picture, resized in the callback
 };
 
 MODULE_REGIST(VideoDecoder)
@@ -0,0 +1,208 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include "BlockingQueue/BlockingQueue.h"
+#include "ModelInferHarness.h"
+
+// Throughput and latency of ModelInfer, synchronous and with ModelInfer.asyncDepth = 2, for single frames and
+// batches of 8. Three channels push their frames at once (saturated) or one frame each every 20 ms (paced, 150 fps).
+// The sink stands for PostProcess: it copies the outputs and the frame to host when ModelInfer left them on the
+// device, then works 1 ms on each frame. The simulated model takes 4 ms per run and the copies 2 GB/s, the outputs
+// are about those of yolov3 for 80 classes.
+// Usage: AsyncInferBench [frames per channel]
+namespace {
+const uint32_t CHANNEL_NUM = 3;
+const uint32_t PACED_GAP_US = 20000;
+const uint32_t SINK_WORK_US = 1000;
+const uint32_t BENCH_BATCH = 8;
+const size_t FRAME_OUTPUT_SIZE = 921600; // first output of a frame, about the three outputs of yolov3
+const size_t FRAME_INPUT_SIZE = HARNESS_MODEL_WIDTH * HARNESS_MODEL_HEIGHT * YUV_BGR_SIZE_CONVERT_3 /
+    YUV_BGR_SIZE_CONVERT_2;
+const size_t IMAGE_INFO_SIZE = 16;
+const size_t SECOND_OUTPUT_SIZE = 32;
+const double EOF_TIMEOUT_S = 120.0;
+
+uint64_t FrameKey(uint32_t channelId, uint32_t frameId)
+{
+    const int channelShift = 32;
+    return (static_cast<uint64_t>(channelId) << channelShift) | frameId;
+}
+
+// Copies what PostProcess would read to host, works on the frame and records when it is done
+class PostProcessSink : public ascendBaseModule::TypedModule<CommonData, void> {
+public:
+    APP_ERROR Init(ConfigParser &, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        host_.resize(FRAME_OUTPUT_SIZE);
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+    std::map<uint64_t, uint64_t> GetDoneUs()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return doneUs_;
+    }
+
+    uint32_t GetEofNum()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return eofNum_;
+    }
+
+protected:
+    APP_ERROR ProcessData(std::shared_ptr<CommonData> data)
+    {
+        if (data->eof) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            eofNum_++;
+            return APP_ERR_OK;
+        }
+        if (!data->hostOutput) {
+            for (const RawData &output : data->inferOutput) {
+                aclrtMemcpy(host_.data(), host_.size(), output.data.get(), std::min(output.lenOfByte, host_.size()),
+                    ACL_MEMCPY_DEVICE_TO_HOST);
+            }
+            aclrtMemcpy(host_.data(), host_.size(), data->dvppData->data, data->dvppData->dataSize,
+                ACL_MEMCPY_DEVICE_TO_HOST);
+        }
+        usleep(SINK_WORK_US);
+        ReleaseDvppFrame(data->dvppData);
+        std::lock_guard<std::mutex> lock(mutex_);
+        doneUs_[FrameKey(data->channelId, data->frameId)] = ascendBaseModule::ModuleNowUs();
+        return APP_ERR_OK;
+    }
+
+private:
+    std::vector<uint8_t> host_ = {};
+    std::mutex mutex_ = {};
+    std::map<uint64_t, uint64_t> doneUs_ = {};
+    uint32_t eofNum_ = 0;
+};
+
+// Sizes the simulated model for batchSize frames per run
+void SetModel(uint32_t batchSize)
+{
+    std::string inputs = std::to_string(FRAME_INPUT_SIZE * batchSize) + "," +
+        std::to_string(IMAGE_INFO_SIZE * batchSize);
+    std::string outputs = std::to_string(FRAME_OUTPUT_SIZE * batchSize) + "," +
+        std::to_string(SECOND_OUTPUT_SIZE * batchSize);
+    setenv("ACL_SIM_MODEL_INPUTS", inputs.c_str(), 1);
+    setenv("ACL_SIM_MODEL_OUTPUTS", outputs.c_str(), 1);
+}
+
+void Run(aclrtContext context, uint32_t batchSize, uint32_t asyncDepth, uint32_t gapUs, uint32_t frameNum)
+{
+    SetModel(batchSize);
+    std::string name = "AsyncInferBench_" + std::to_string(batchSize) + "_" + std::to_string(asyncDepth);
+    std::string config = WriteModelInferConfig(name, {
+        "ModelInfer.batchSize = " + std::to_string(batchSize),
+        "ModelInfer.asyncDepth = " + std::to_string(asyncDepth),
+    });
+    ConfigParser configParser;
+    configParser.ParseConfig(config);
+    ModelInfer infer;
+    PostProcessSink sink;
+    std::shared_ptr<HarnessQueue> input = std::make_shared<BlockingQueue<std::shared_ptr<void>>>(UINT32_MAX);
+    std::shared_ptr<HarnessQueue> output = std::make_shared<BlockingQueue<std::shared_ptr<void>>>(UINT32_MAX);
+    infer.SetInputVec(input);
+    infer.SetOutputInfo("PostProcess", ascendBaseModule::MODULE_CONNECT_ONE, {output});
+    sink.SetInputVec(output);
+    ascendBaseModule::ModuleInitArgs args;
+    args.context = context;
+    args.pipelineName = "bench";
+    args.moduleName = "ModelInfer";
+    args.instanceId = 0;
+    args.popBatchSize = batchSize;
+    if (infer.Init(configParser, args) != APP_ERR_OK) {
+        std::printf("  ModelInfer init failed\n");
+        return;
+    }
+    args.moduleName = "PostProcess";
+    args.popBatchSize = 1;
+    sink.Init(configParser, args);
+    sink.Run();
+    infer.Run();
+
+    std::map<uint64_t, uint64_t> pushUs;
+    double start = NowSeconds();
+    for (uint32_t frameId = 0; frameId < frameNum; frameId++) {
+        for (uint32_t channelId = 0; channelId < CHANNEL_NUM; channelId++) {
+            pushUs[FrameKey(channelId, frameId)] = ascendBaseModule::ModuleNowUs();
+            input->Push(MakeHarnessFrame(channelId, frameId), true);
+        }
+        if (gapUs > 0) {
+            usleep(gapUs);
+        }
+    }
+    for (uint32_t channelId = 0; channelId < CHANNEL_NUM; channelId++) {
+        input->Push(MakeHarnessEof(channelId), true);
+    }
+    double deadline = NowSeconds() + EOF_TIMEOUT_S;
+    while (sink.GetEofNum() < CHANNEL_NUM && NowSeconds() < deadline) {
+        usleep(1000);
+    }
+    double seconds = NowSeconds() - start;
+    infer.Stop();
+    sink.Stop();
+
+    std::map<uint64_t, uint64_t> doneUs = sink.GetDoneUs();
+    std::vector<uint64_t> latencies;
+    for (const auto &done : doneUs) {
+        latencies.push_back(done.second - pushUs[done.first]);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const size_t percent = 100;
+    const size_t p99 = 99;
+    double p50Ms = latencies.empty() ? 0 : latencies[latencies.size() / 2] / 1000.0;
+    double p99Ms = latencies.empty() ? 0 : latencies[latencies.size() * p99 / percent] / 1000.0;
+    std::printf("  batch %u %-5s %-9s %7.1f fps  latency p50 %8.2f ms  p99 %8.2f ms  (%zu of %u frames)\n",
+        batchSize, (asyncDepth > 0) ? "async" : "sync", (gapUs > 0) ? "paced" : "saturated",
+        doneUs.size() / seconds, p50Ms, p99Ms, doneUs.size(), frameNum * CHANNEL_NUM);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const uint32_t asyncDepth = 2;
+    uint32_t frameNum = static_cast<uint32_t>(BenchIterations(argc, argv, 200));
+    setenv("ACL_SIM_MODEL_LATENCY_US", "4000", 1);
+    setenv("ACL_SIM_MEMCPY_GBPS", "2", 1);
+    aclrtContext context = nullptr;
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    aclrtCreateContext(&context, 0);
+    for (uint32_t gapUs : {0u, PACED_GAP_US}) {
+        for (uint32_t batchSize : {1u, BENCH_BATCH}) {
+            for (uint32_t depth : {0u, asyncDepth}) {
+                Run(context, batchSize, depth, gapUs, frameNum);
+            }
+        }
+    }
+    aclrtDestroyContext(context);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BlockingQueue/BackpressureQueue.h"
+#include "BlockingQueue/BlockingQueue.h"
+#include "TestCommon.h"
+
+// The drop policies never block a producer, and an end-of-stream marker at the head of the queue stays there
+namespace {
+using ItemQueue = BackpressureQueue<uint64_t>;
+
+const uint64_t EOF_ITEM = UINT64_MAX; // never dropped
+const uint32_t QUEUE_SIZE = 2;
+const uint64_t ITEM_BYTES = 10;
+const uint64_t PRODUCER_ITEMS = 20000;
+const int PRODUCER_NUM = 2;
+const double PRODUCER_TIMEOUT_S = 10.0;
+
+std::shared_ptr<ItemQueue> MakeQueue(BackpressurePolicy policy, std::atomic<uint64_t> &released)
+{
+    auto queue = std::make_shared<ItemQueue>(std::make_shared<BlockingQueue<uint64_t>>(QUEUE_SIZE), policy,
+        QUEUE_SIZE * ITEM_BYTES);
+    queue->SetMessageFuncs([](const uint64_t &) { return ITEM_BYTES; },
+        [&released](uint64_t &) { released++; },
+        [](const uint64_t &item) { return item != EOF_ITEM; });
+    return queue;
+}
+
+// The queue is full behind an end-of-stream marker: the new item is dropped and the marker is popped first
+void TestEofAtHead()
+{
+    const BackpressurePolicy policies[] = {
+        BACKPRESSURE_DROP_OLDEST, BACKPRESSURE_KEEP_LATEST, BACKPRESSURE_BYTE_BUDGET
+    };
+    for (BackpressurePolicy policy : policies) {
+        std::atomic<uint64_t> released {0};
+        std::shared_ptr<ItemQueue> queue = MakeQueue(policy, released);
+        TEST_CHECK(queue->Push(EOF_ITEM) == APP_ERR_OK);
+        TEST_CHECK(queue->Push(uint64_t(1)) == APP_ERR_OK);
+        TEST_CHECK(queue->Push(uint64_t(2)) == APP_ERR_OK);
+        TEST_CHECK(queue->GetDropCount() == 1 && released.load() == 1);
+
+        // once the marker is taken, the oldest frame makes room for the new one
+        uint64_t item = 0;
+        TEST_CHECK(queue->Pop(item, 0) == APP_ERR_OK && item == EOF_ITEM);
+        TEST_CHECK(queue->Push(uint64_t(3)) == APP_ERR_OK);
+        TEST_CHECK(queue->Push(uint64_t(4)) == APP_ERR_OK);
+        TEST_CHECK(queue->GetDropCount() == 2);
+        TEST_CHECK(queue->Pop(item, 0) == APP_ERR_OK && item == 3);
+        TEST_CHECK(queue->Pop(item, 0) == APP_ERR_OK && item == 4);
+    }
+}
+
+// Two producers push to a full queue with a marker at its head and no consumer. Neither of them may block, every
+// item they pushed is dropped and the marker is still the first item out
+void TestTwoProducersEofAtHead()
+{
+    std::atomic<uint64_t> released {0};
+    std::shared_ptr<ItemQueue> queue = MakeQueue(BACKPRESSURE_DROP_OLDEST, released);
+    TEST_CHECK(queue->Push(EOF_ITEM) == APP_ERR_OK);
+    TEST_CHECK(queue->Push(uint64_t(1)) == APP_ERR_OK);
+    std::atomic<int> done {0};
+    std::atomic<int> pushErrors {0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCER_NUM; ++p) {
+        producers.emplace_back([&queue, &done, &pushErrors]() {
+            for (uint64_t i = 0; i < PRODUCER_ITEMS; ++i) {
+                if (queue->Push(i + 2) != APP_ERR_OK) {
+                    pushErrors++;
+                }
+            }
+            done++;
+        });
+    }
+    double deadline = NowSeconds() + PRODUCER_TIMEOUT_S;
+    while (done.load() < PRODUCER_NUM && NowSeconds() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    TEST_CHECK(done.load() == PRODUCER_NUM);
+    queue->Stop(); // wakes a blocked producer, so the test ends even if the check above failed
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    queue->Restart();
+    TEST_CHECK(pushErrors.load() == 0);
+    TEST_CHECK(queue->GetDropCount() == PRODUCER_ITEMS * PRODUCER_NUM);
+    TEST_CHECK(released.load() == PRODUCER_ITEMS * PRODUCER_NUM);
+    uint64_t item = 0;
+    TEST_CHECK(queue->Pop(item, 0) == APP_ERR_OK && item == EOF_ITEM);
+    TEST_CHECK(queue->Pop(item, 0) == APP_ERR_OK && item == 1);
+}
+}
+
+int main()
+{
+    TEST_RUN(TestEofAtHead);
+    TEST_RUN(TestTwoProducersEofAtHead);
+    return TestResult();
+}
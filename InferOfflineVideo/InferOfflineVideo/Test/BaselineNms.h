@@ -0,0 +1,90 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BASELINE_NMS_H
+#define BASELINE_NMS_H
+
+#include <algorithm>
+#include <vector>
+#include "PostProcess/Yolov3Post.h"
+
+// The NMS of Yolov3Post.cpp before NmsEngine replaced it (commit 4a6517c), the reference of NmsTest and NmsBench.
+// The code is unchanged but for classNum, which was the constant CLASS_NUM
+namespace baseline {
+/*
+ * @description: Compute Intersection over Union value
+ */
+inline float BoxIou(DetectBox a, DetectBox b)
+{
+    float left = std::max(a.x - a.width / 2.f, b.x - b.width / 2.f);
+    float right = std::min(a.x + a.width / 2.f, b.x + b.width / 2.f);
+    float top = std::max(a.y - a.height / 2.f, b.y - b.height / 2.f);
+    float bottom = std::min(a.y + a.height / 2.f, b.y + b.height / 2.f);
+    if (top > bottom || left > right) { // If no intersection
+        return 0.0f;
+    }
+    // intersection / union
+    float area = (right - left) * (bottom - top);
+    return area / (a.width * a.height + b.width * b.height - area);
+}
+
+/*
+ * @description: Filter the Deteboxes, for each class, if two Deteboxes' IOU is greater than threshold,
+                 erase the one with smaller confidence
+ * @param dets  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ * @param sortBoxes  DetectBox vector after filtering
+ */
+inline void FilterByIou(std::vector<DetectBox> dets, std::vector<DetectBox>& sortBoxes)
+{
+    for (unsigned int m = 0; m < dets.size(); ++m) {
+        auto& item = dets[m];
+        sortBoxes.push_back(item);
+        for (unsigned int n = m + 1; n < dets.size(); ++n) {
+            if (BoxIou(item, dets[n]) > IOU_THRESH) {
+                dets.erase(dets.begin() + n);
+                --n;
+            }
+        }
+    }
+}
+
+/*
+ * @description: Sort the DetectBox for each class and filter out the DetectBox with same object using IOU
+ * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ */
+inline void NmsSort(std::vector<DetectBox>& detBoxes, int classNum = CLASS_NUM)
+{
+    std::vector<DetectBox> sortBoxes;
+    std::vector<std::vector<DetectBox>> resClass;
+    resClass.resize(classNum);
+    for (const auto& item: detBoxes) {
+        resClass[item.classID].push_back(item);
+    }
+    for (int i = 0; i < classNum; ++i) {
+        auto& dets = resClass[i];
+        if (dets.size() == 0) {
+            continue;
+        }
+        std::sort(dets.begin(), dets.end(), [=](const DetectBox& a, const DetectBox& b) {
+            return a.prob > b.prob;
+        });
+        FilterByIou(dets, sortBoxes);
+    }
+    detBoxes = std::move(sortBoxes);
+}
+}
+
+#endif
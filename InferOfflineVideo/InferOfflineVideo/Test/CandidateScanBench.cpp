@@ -0,0 +1,120 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "PostProcess/CandidateScan.h"
+#include "PostProcess/FastMath.h"
+#include "TestCommon.h"
+
+// Time of the objectness scan of the anchors of the three yolov3 layers (13x13, 26x26 and 52x52 grids of 3 anchors),
+// in ns per anchor, with ScanCandidates* for each layer type, and for fp16 with a loop converting the halves to float,
+// which ScanCandidatesHalf compares as integers instead. The anchors are the 85 values of yolov3 for 80 classes and
+// the 6 values of one class, the default of the decoder.
+// Usage: CandidateScanBench [rounds]
+namespace {
+const size_t YOLO_ANCHOR_SIZE = 85;
+const size_t ONE_CLASS_ANCHOR_SIZE = 6;
+const size_t YOLO_OBJ_OFFSET = 4;
+const size_t ANCHOR_NUM = (13 * 13 + 26 * 26 + 52 * 52) * 3;
+const float THRESHOLD = -1.386f; // logit of the objectness 0.2, a few percent of the anchors pass it
+const float INT8_SCALE = 0.1f;   // objectness logit of the quantized layer = byte * scale
+
+size_t ScanHalfScalar(const uint16_t *data, size_t anchorNum, size_t anchorSize, size_t objOffset, float threshold,
+                      uint32_t *indexes)
+{
+    size_t count = 0;
+    for (size_t anchor = 0; anchor < anchorNum; anchor++) {
+        if (fastmath::HalfToFloat(data[anchor * anchorSize + objOffset]) > threshold) {
+            indexes[count++] = static_cast<uint32_t>(anchor);
+        }
+    }
+    return count;
+}
+
+// float to half, the mantissa is truncated and the values out of the normal half range are clamped
+uint16_t FloatToHalf(float value)
+{
+    const int32_t exponentRebias = 127 - 15; // exponent bias of float and half
+    const int32_t halfExponentMax = 31;
+    const uint32_t halfMaxFinite = 0x7bff;
+    const int mantissaShift = 13;            // mantissa bits of float - half
+    const int halfMantissaBits = 10;
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - exponentRebias;
+    if (exponent <= 0) {
+        return static_cast<uint16_t>(sign);
+    }
+    if (exponent >= halfExponentMax) {
+        return static_cast<uint16_t>(sign | halfMaxFinite);
+    }
+    uint32_t mantissa = (bits >> mantissaShift) & 0x3ff;
+    return static_cast<uint16_t>(sign | (static_cast<uint32_t>(exponent) << halfMantissaBits) | mantissa);
+}
+
+template<typename Scan> void Report(const char *name, Scan scan, size_t rounds)
+{
+    std::vector<uint32_t> indexes(ANCHOR_NUM);
+    size_t found = 0;
+    double start = NowSeconds();
+    for (size_t round = 0; round < rounds; round++) {
+        found = scan(indexes.data());
+    }
+    double nsPerAnchor = (NowSeconds() - start) * 1e9 / (rounds * ANCHOR_NUM);
+    std::printf("  %-12s %7.3f ns/anchor  %zu of %zu anchors found\n", name, nsPerAnchor, found, ANCHOR_NUM);
+}
+
+void RunLayout(size_t anchorSize, size_t objOffset, size_t rounds)
+{
+    std::mt19937 random(1);
+    std::normal_distribution<float> logits(-5.0f, 2.0f);
+    std::vector<float> floats(ANCHOR_NUM * anchorSize);
+    std::vector<uint16_t> halves(floats.size());
+    std::vector<int8_t> bytes(floats.size());
+    for (size_t i = 0; i < floats.size(); i++) {
+        floats[i] = logits(random);
+        halves[i] = FloatToHalf(floats[i]);
+        bytes[i] = static_cast<int8_t>(std::max(-128.0f, std::min(127.0f, std::round(floats[i] / INT8_SCALE))));
+    }
+    int32_t byteThreshold = static_cast<int32_t>(std::floor(THRESHOLD / INT8_SCALE));
+    std::printf("anchors of %zu values\n", anchorSize);
+    Report("fp32", [&](uint32_t *indexes) {
+        return ScanCandidates(floats.data(), ANCHOR_NUM, anchorSize, objOffset, THRESHOLD, indexes);
+    }, rounds);
+    Report("fp16 loop", [&](uint32_t *indexes) {
+        return ScanHalfScalar(halves.data(), ANCHOR_NUM, anchorSize, objOffset, THRESHOLD, indexes);
+    }, rounds);
+    Report("fp16", [&](uint32_t *indexes) {
+        return ScanCandidatesHalf(halves.data(), ANCHOR_NUM, anchorSize, objOffset, THRESHOLD, indexes);
+    }, rounds);
+    Report("int8", [&](uint32_t *indexes) {
+        return ScanCandidatesInt8(bytes.data(), ANCHOR_NUM, anchorSize, objOffset, byteThreshold, indexes);
+    }, rounds);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rounds = BenchIterations(argc, argv, 2000);
+    RunLayout(YOLO_ANCHOR_SIZE, YOLO_OBJ_OFFSET, rounds);
+    RunLayout(ONE_CLASS_ANCHOR_SIZE, YOLO_OBJ_OFFSET, rounds);
+    return 0;
+}
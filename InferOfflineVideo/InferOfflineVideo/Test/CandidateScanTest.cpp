@@ -0,0 +1,217 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "PostProcess/CandidateScan.h"
+#include "PostProcess/FastMath.h"
+#include "TestCommon.h"
+
+// The scans find exactly the anchors of a plain loop over the objectness channel converted to float, the half scan
+// which compares the halves as integers too
+namespace {
+const float INF = std::numeric_limits<float>::infinity();
+const float NAN_VALUE = std::numeric_limits<float>::quiet_NaN();
+const size_t HALF_NUM = 65536;
+const uint16_t HALF_POS_INF = 0x7c00;
+const uint16_t HALF_NEG_INF = 0xfc00;
+const uint16_t HALF_POS_NAN = 0x7e01;
+const uint16_t HALF_NEG_NAN = 0xfe01;
+
+// a plane of objectness, odd sizes, the 6 values of one class and the 85 of yolov3
+const size_t ANCHOR_SIZES[] = {1, 2, 3, 6, 7, 85};
+// 0, a few, and up to a yolov3 layer of 13x13x3 anchors
+const size_t ANCHOR_NUMS[] = {0, 1, 5, 13, 100, 507};
+
+std::vector<float> Thresholds()
+{
+    return {-INF, INF, NAN_VALUE, -NAN_VALUE, -70000.0f, -5.0f, -0.0f, 0.0f, 1e-9f, -1e-9f, 6e-8f, 0.5f, 1.337f,
+            4.5f, 65504.0f, 70000.0f};
+}
+
+template<typename T, typename Limit>
+std::vector<uint32_t> ScanReference(const std::vector<T> &data, size_t anchorNum, size_t anchorSize,
+                                    size_t objOffset, Limit threshold)
+{
+    std::vector<uint32_t> indexes;
+    for (size_t anchor = 0; anchor < anchorNum; anchor++) {
+        if (data[anchor * anchorSize + objOffset] > threshold) {
+            indexes.push_back(static_cast<uint32_t>(anchor));
+        }
+    }
+    return indexes;
+}
+
+std::vector<uint32_t> ScanReferenceHalf(const std::vector<uint16_t> &data, size_t anchorNum, size_t anchorSize,
+                                        size_t objOffset, float threshold)
+{
+    std::vector<float> values(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        values[i] = fastmath::HalfToFloat(data[i]);
+    }
+    return ScanReference(values, anchorNum, anchorSize, objOffset, threshold);
+}
+
+// objOffset 0, 4 (the objectness of yolo) and the last element of the anchor
+std::vector<size_t> ObjOffsets(size_t anchorSize)
+{
+    std::vector<size_t> offsets = {0};
+    if (anchorSize > 4) {
+        offsets.push_back(4);
+    }
+    if (anchorSize > 1) {
+        offsets.push_back(anchorSize - 1);
+    }
+    return offsets;
+}
+
+// Normal values with the special ones mixed in
+std::vector<float> MakeFloats(size_t size, std::mt19937 &random)
+{
+    const float specials[] = {INF, -INF, NAN_VALUE, -NAN_VALUE, 0.0f, -0.0f, 1e-40f, 0.5f, 4.5f, 65504.0f};
+    std::normal_distribution<float> normal(0.0f, 3.0f);
+    std::uniform_int_distribution<size_t> pick(0, 7); // one in eight is special
+    std::vector<float> values(size);
+    for (size_t i = 0; i < size; i++) {
+        values[i] = (pick(random) == 0) ? specials[random() % (sizeof(specials) / sizeof(specials[0]))] :
+            normal(random);
+    }
+    return values;
+}
+
+template<typename Scan> bool Same(Scan scan, const std::vector<uint32_t> &expected, size_t anchorNum)
+{
+    std::vector<uint32_t> indexes(anchorNum + 1, 0);
+    size_t count = scan(indexes.data());
+    indexes.resize(count);
+    return indexes == expected;
+}
+
+void TestFloat()
+{
+    std::mt19937 random(1);
+    for (size_t anchorSize : ANCHOR_SIZES) {
+        for (size_t anchorNum : ANCHOR_NUMS) {
+            std::vector<float> data = MakeFloats(anchorNum * anchorSize, random);
+            for (size_t objOffset : ObjOffsets(anchorSize)) {
+                for (float threshold : Thresholds()) {
+                    std::vector<uint32_t> expected = ScanReference(data, anchorNum, anchorSize, objOffset, threshold);
+                    TEST_CHECK(Same([&](uint32_t *indexes) {
+                        return ScanCandidates(data.data(), anchorNum, anchorSize, objOffset, threshold, indexes);
+                    }, expected, anchorNum));
+                }
+            }
+        }
+    }
+}
+
+void TestHalf()
+{
+    std::mt19937 random(2);
+    const uint16_t specials[] = {HALF_POS_INF, HALF_NEG_INF, HALF_POS_NAN, HALF_NEG_NAN, 0x7fff, 0xffff, 0x0001,
+                                 0x8001, 0x0000, 0x8000};
+    for (size_t anchorSize : ANCHOR_SIZES) {
+        for (size_t anchorNum : ANCHOR_NUMS) {
+            std::vector<uint16_t> data(anchorNum * anchorSize);
+            for (size_t i = 0; i < data.size(); i++) {
+                data[i] = (i % 8 == 0) ? specials[random() % (sizeof(specials) / sizeof(specials[0]))] :
+                    static_cast<uint16_t>(random());
+            }
+            for (size_t objOffset : ObjOffsets(anchorSize)) {
+                for (float threshold : Thresholds()) {
+                    std::vector<uint32_t> expected =
+                        ScanReferenceHalf(data, anchorNum, anchorSize, objOffset, threshold);
+                    TEST_CHECK(Same([&](uint32_t *indexes) {
+                        return ScanCandidatesHalf(data.data(), anchorNum, anchorSize, objOffset, threshold, indexes);
+                    }, expected, anchorNum));
+                }
+            }
+        }
+    }
+}
+
+// Every half, including the NaNs above +inf, as the objectness of one anchor, against thresholds at and next to
+// a sample of the halves
+void TestEveryHalf()
+{
+    const size_t anchorSize = 1;
+    const size_t objOffset = 0;
+    std::vector<uint16_t> data(HALF_NUM * anchorSize, 0);
+    for (size_t half = 0; half < HALF_NUM; half++) {
+        data[half * anchorSize + objOffset] = static_cast<uint16_t>(half);
+    }
+    std::vector<float> thresholds = Thresholds();
+    const size_t halfStep = 97; // a sample of the halves, every one would take minutes
+    for (size_t half = 0; half < HALF_NUM; half += halfStep) {
+        float value = fastmath::HalfToFloat(static_cast<uint16_t>(half));
+        thresholds.push_back(value);
+        thresholds.push_back(std::nextafter(value, INF));
+        thresholds.push_back(std::nextafter(value, -INF));
+    }
+    int mismatches = 0;
+    for (float threshold : thresholds) {
+        std::vector<uint32_t> expected = ScanReferenceHalf(data, HALF_NUM, anchorSize, objOffset, threshold);
+        mismatches += Same([&](uint32_t *indexes) {
+            return ScanCandidatesHalf(data.data(), HALF_NUM, anchorSize, objOffset, threshold, indexes);
+        }, expected, HALF_NUM) ? 0 : 1;
+    }
+    TEST_CHECK(mismatches == 0);
+}
+
+void TestBytes()
+{
+    const int32_t thresholdMin = -300;
+    const int32_t thresholdMax = 300;
+    const int32_t byteNum = 256;
+    std::mt19937 random(3);
+    for (size_t anchorSize : ANCHOR_SIZES) {
+        for (size_t anchorNum : ANCHOR_NUMS) {
+            std::vector<int8_t> signedData(anchorNum * anchorSize);
+            std::vector<uint8_t> unsignedData(signedData.size());
+            for (size_t i = 0; i < signedData.size(); i++) {
+                unsignedData[i] = static_cast<uint8_t>(random() % byteNum);
+                signedData[i] = static_cast<int8_t>(unsignedData[i]);
+            }
+            for (size_t objOffset : ObjOffsets(anchorSize)) {
+                for (int32_t threshold = thresholdMin; threshold <= thresholdMax; threshold++) {
+                    std::vector<uint32_t> expected =
+                        ScanReference(signedData, anchorNum, anchorSize, objOffset, threshold);
+                    TEST_CHECK(Same([&](uint32_t *indexes) {
+                        return ScanCandidatesInt8(signedData.data(), anchorNum, anchorSize, objOffset, threshold,
+                                                  indexes);
+                    }, expected, anchorNum));
+                    expected = ScanReference(unsignedData, anchorNum, anchorSize, objOffset, threshold);
+                    TEST_CHECK(Same([&](uint32_t *indexes) {
+                        return ScanCandidatesUint8(unsignedData.data(), anchorNum, anchorSize, objOffset, threshold,
+                                                   indexes);
+                    }, expected, anchorNum));
+                }
+            }
+        }
+    }
+}
+}
+
+int main()
+{
+    TEST_RUN(TestFloat);
+    TEST_RUN(TestHalf);
+    TEST_RUN(TestEveryHalf);
+    TEST_RUN(TestBytes);
+    return TestResult();
+}
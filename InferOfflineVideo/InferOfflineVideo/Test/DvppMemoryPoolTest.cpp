@@ -0,0 +1,80 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "acl/acl.h"
+#include "DvppCommon/DvppMemoryPool.h"
+#include "TestCommon.h"
+
+namespace {
+const size_t KB = 1024;
+
+// The pool is a per-device singleton, the tests run in order and look at the difference of the stats
+void TestReuse()
+{
+    DvppMemoryPool &pool = DvppMemoryPool::GetInstance();
+    DvppMemoryPoolStats before = pool.GetStats();
+    DvppBuffer buffer;
+    TEST_CHECK(pool.Alloc(100 * KB, 0, buffer) == APP_ERR_OK && buffer != nullptr);
+    buffer.reset();
+    // same size class (96 KB ~ 112 KB), same channel: served from the free list
+    TEST_CHECK(pool.Alloc(110 * KB, 0, buffer) == APP_ERR_OK);
+    DvppMemoryPoolStats after = pool.GetStats();
+    TEST_CHECK(after.misses - before.misses == 1);
+    TEST_CHECK(after.hits - before.hits == 1);
+    TEST_CHECK(after.inUseBytes - before.inUseBytes == 112 * KB);
+    buffer.reset();
+    TEST_CHECK(pool.GetStats().cachedBytes - before.cachedBytes == 112 * KB);
+}
+
+void TestTrimAllDrains()
+{
+    DvppMemoryPool &pool = DvppMemoryPool::GetInstance();
+    DvppBuffer cached;
+    DvppBuffer held;
+    TEST_CHECK(pool.Alloc(4 * KB, 1, cached) == APP_ERR_OK);
+    TEST_CHECK(pool.Alloc(64 * KB, 1, held) == APP_ERR_OK);
+    cached.reset();
+    TEST_CHECK(pool.GetStats().cachedBytes > 0);
+
+    DvppMemoryPool::TrimAll();
+    TEST_CHECK(pool.GetStats().cachedBytes == 0);
+    // a buffer released after the trim is freed, not cached until the process exits
+    held.reset();
+    DvppMemoryPoolStats stats = pool.GetStats();
+    TEST_CHECK(stats.cachedBytes == 0);
+    TEST_CHECK(stats.inUseBytes == 0);
+
+    // the drained pool still allocates, straight from the device
+    uint64_t misses = stats.misses;
+    TEST_CHECK(pool.Alloc(4 * KB, 1, held) == APP_ERR_OK);
+    held.reset();
+    TEST_CHECK(pool.Alloc(4 * KB, 1, held) == APP_ERR_OK);
+    held.reset();
+    TEST_CHECK(pool.GetStats().misses - misses == 2);
+    TEST_CHECK(pool.GetStats().cachedBytes == 0);
+}
+}
+
+int main()
+{
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    TEST_RUN(TestReuse);
+    TEST_RUN(TestTrimAllDrains);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return TestResult();
+}
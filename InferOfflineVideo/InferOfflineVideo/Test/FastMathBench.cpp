@@ -0,0 +1,93 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "PostProcess/FastMath.h"
+#include "TestCommon.h"
+
+// Time of exp and sigmoid in ns per element with std::exp, the lookup table (fastmath::exp, fastmath::sigmoid) and
+// the SSE2/NEON polynomial (ExpBatch, SigmoidBatch), on arrays of logits as long as the class scores of yolov3
+// and as a whole layer.
+// Usage: FastMathBench [rounds]
+namespace {
+const size_t YOLO_CLASS_NUM = 80;
+const size_t LAYER_SIZE = 4096;
+const int PASSES = 5; // the fastest pass is reported, the others were slowed down by the rest of the host
+volatile float g_sink = 0.0f;
+
+template<typename Function> void Report(const char *name, Function function, std::vector<float> &x,
+                                        std::vector<float> &y, size_t rounds)
+{
+    double best = 0.0;
+    for (int pass = 0; pass < PASSES; pass++) {
+        double start = NowSeconds();
+        for (size_t round = 0; round < rounds; round++) {
+            function(x.data(), y.data(), x.size());
+            g_sink = y[round % y.size()];
+        }
+        double seconds = NowSeconds() - start;
+        best = (pass == 0) ? seconds : std::min(best, seconds);
+    }
+    double nsPerElement = best * 1e9 / (rounds * x.size());
+    std::printf("  %-14s %7.3f ns/element\n", name, nsPerElement);
+}
+
+void RunLength(size_t length, size_t rounds)
+{
+    std::mt19937 random(1);
+    std::normal_distribution<float> logits(-4.0f, 3.0f);
+    std::vector<float> x(length);
+    std::vector<float> y(length);
+    for (float &value : x) {
+        value = logits(random);
+    }
+    std::printf("arrays of %zu floats\n", length);
+    Report("std::exp", [](const float *in, float *out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = std::exp(in[i]);
+        }
+    }, x, y, rounds);
+    Report("exp LUT", [](const float *in, float *out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = fastmath::exp(in[i]);
+        }
+    }, x, y, rounds);
+    Report("ExpBatch", fastmath::ExpBatch, x, y, rounds);
+    Report("std sigmoid", [](const float *in, float *out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+        }
+    }, x, y, rounds);
+    Report("sigmoid LUT", [](const float *in, float *out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = fastmath::sigmoid(in[i]);
+        }
+    }, x, y, rounds);
+    Report("SigmoidBatch", fastmath::SigmoidBatch, x, y, rounds);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rounds = BenchIterations(argc, argv, 20000);
+    RunLength(YOLO_CLASS_NUM, rounds * (LAYER_SIZE / YOLO_CLASS_NUM));
+    RunLength(LAYER_SIZE, rounds);
+    return 0;
+}
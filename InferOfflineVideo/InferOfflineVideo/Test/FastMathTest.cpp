@@ -0,0 +1,219 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "PostProcess/FastMath.h"
+#include "TestCommon.h"
+
+// Error of ExpBatch, SigmoidBatch and the lookup table against std::exp in double, and what the switch of the
+// class scores from the lookup table to SigmoidBatch (YoloDecoder, BATCH_SIGMOID_MIN_CLASSES) does to the classes
+namespace {
+const float EXP_LO = -87.0f; // the clamp of ExpBatch
+const float EXP_HI = 88.0f;
+const size_t SWEEP_NUM = 1 << 16;
+const double BATCH_MAX_REL_ERROR = 2e-7; // FastMath.h
+const double BATCH_MEAN_REL_ERROR = 5e-8;
+const double LUT_MAX_REL_ERROR = 1.5e-5;
+const double LUT_MEAN_REL_ERROR = 1e-5;
+const double BATCH_SIGMOID_MAX_ERROR = 2e-7;
+
+struct Error {
+    double max;
+    double mean;
+};
+
+// x evenly over [lo, hi]
+std::vector<float> Sweep(float lo, float hi, size_t num)
+{
+    std::vector<float> x(num);
+    for (size_t i = 0; i < num; i++) {
+        x[i] = lo + (hi - lo) * static_cast<float>(i) / static_cast<float>(num - 1);
+    }
+    return x;
+}
+
+template<typename Reference> Error RelativeError(const std::vector<float> &x, const std::vector<float> &y,
+                                                 Reference reference)
+{
+    Error error = {0.0, 0.0};
+    for (size_t i = 0; i < x.size(); i++) {
+        double expected = reference(static_cast<double>(x[i]));
+        double relative = std::fabs(y[i] - expected) / expected;
+        error.max = std::max(error.max, relative);
+        error.mean += relative / x.size();
+    }
+    return error;
+}
+
+double ExpReference(double x)
+{
+    return std::exp(x);
+}
+
+double SigmoidReference(double x)
+{
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+void TestExpBatch()
+{
+    std::vector<float> x = Sweep(EXP_LO, EXP_HI, SWEEP_NUM);
+    std::vector<float> y(x.size());
+    fastmath::ExpBatch(x.data(), y.data(), x.size());
+    Error batch = RelativeError(x, y, ExpReference);
+    for (size_t i = 0; i < x.size(); i++) {
+        y[i] = fastmath::exp(x[i]);
+    }
+    Error lut = RelativeError(x, y, ExpReference);
+    std::printf("  exp relative error, ExpBatch max %.2e mean %.2e, lookup table max %.2e mean %.2e\n", batch.max,
+                batch.mean, lut.max, lut.mean);
+    TEST_CHECK(batch.max < BATCH_MAX_REL_ERROR);
+    TEST_CHECK(batch.mean < BATCH_MEAN_REL_ERROR);
+    TEST_CHECK(lut.max < LUT_MAX_REL_ERROR);
+    TEST_CHECK(lut.mean < LUT_MEAN_REL_ERROR);
+}
+
+// Over the whole clamp, far out of the range of the class logits, where the scores near 0 need a relative error
+void TestSigmoidBatch()
+{
+    std::vector<float> x = Sweep(EXP_LO, EXP_HI, SWEEP_NUM);
+    std::vector<float> y(x.size());
+    fastmath::SigmoidBatch(x.data(), y.data(), x.size());
+    Error batch = RelativeError(x, y, SigmoidReference);
+    for (size_t i = 0; i < x.size(); i++) {
+        y[i] = fastmath::sigmoid(x[i]);
+    }
+    Error lut = RelativeError(x, y, SigmoidReference);
+    std::printf("  sigmoid relative error, SigmoidBatch max %.2e mean %.2e, lookup table max %.2e mean %.2e\n",
+                batch.max, batch.mean, lut.max, lut.mean);
+    TEST_CHECK(batch.max < BATCH_SIGMOID_MAX_ERROR);
+    TEST_CHECK(lut.max < LUT_MAX_REL_ERROR);
+}
+
+// Every length up to a few vectors, so the scalar tail and the vector lanes both see each position, in place too
+void TestLengths()
+{
+    const size_t maxLength = 19;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> logits(-20.0f, 20.0f);
+    std::vector<float> x(maxLength);
+    for (float &value : x) {
+        value = logits(random);
+    }
+    for (size_t n = 0; n <= maxLength; n++) {
+        std::vector<float> y(maxLength + 1, -1.0f);
+        fastmath::ExpBatch(x.data(), y.data(), n);
+        std::vector<float> inPlace(x.begin(), x.begin() + n);
+        fastmath::SigmoidBatch(inPlace.data(), inPlace.data(), n);
+        for (size_t i = 0; i < n; i++) {
+            TEST_CHECK(std::fabs(y[i] - ExpReference(x[i])) / ExpReference(x[i]) < BATCH_MAX_REL_ERROR);
+            TEST_CHECK(std::fabs(inPlace[i] - SigmoidReference(x[i])) / SigmoidReference(x[i]) <
+                       BATCH_SIGMOID_MAX_ERROR);
+        }
+        TEST_CHECK(y[n] == -1.0f); // nothing written past n
+    }
+}
+
+// Out of the clamp the results stay finite and the sigmoid saturates
+void TestEdges()
+{
+    const float edges[] = {-1e30f, -200.0f, EXP_LO, -0.0f, 0.0f, EXP_HI, 200.0f, 1e30f};
+    const size_t edgeNum = sizeof(edges) / sizeof(edges[0]);
+    float exps[edgeNum];
+    float sigmoids[edgeNum];
+    fastmath::ExpBatch(edges, exps, edgeNum);
+    fastmath::SigmoidBatch(edges, sigmoids, edgeNum);
+    for (size_t i = 0; i < edgeNum; i++) {
+        TEST_CHECK(std::isfinite(exps[i]) && exps[i] > 0.0f);
+        TEST_CHECK(sigmoids[i] >= 0.0f && sigmoids[i] <= 1.0f);
+    }
+    TEST_CHECK(exps[3] == 1.0f && exps[4] == 1.0f);
+    TEST_CHECK(sigmoids[3] == 0.5f && sigmoids[4] == 0.5f);
+    TEST_CHECK(sigmoids[0] < 1e-37f && sigmoids[edgeNum - 1] == 1.0f);
+}
+
+/*
+ * The class selection of YoloDecoder::DecodeBand on the scores of the lookup table and of SigmoidBatch, for anchors
+ * of 80 yolov3 class logits. A score moves by less than the error of the lookup table, so the selected class only
+ * changes where two scores are closer than that, or one is that close to its threshold
+ */
+void TestClassScores()
+{
+    const int classNum = 80;
+    const int anchorNum = 100000;
+    const float objectness = 0.9f;
+    const float classThresh = 0.3f;
+    const float scoreTolerance = 5e-6f; // the absolute error of the lookup table sigmoid is about 2e-6
+    std::mt19937 random(2);
+    std::normal_distribution<float> logits(-4.0f, 3.0f);
+    std::vector<float> classLogits(classNum);
+    std::vector<float> batchScores(classNum);
+    double maxDifference = 0.0;
+    int changed = 0;
+    int nearTies = 0;
+    for (int anchor = 0; anchor < anchorNum; anchor++) {
+        for (float &logit : classLogits) {
+            logit = logits(random);
+        }
+        fastmath::SigmoidBatch(classLogits.data(), batchScores.data(), classNum);
+        int lutClass = -1;
+        int batchClass = -1;
+        float lutMax = 0.0f;
+        float batchMax = 0.0f;
+        std::vector<float> lutProbs(classNum);
+        for (int c = 0; c < classNum; c++) {
+            float lutProb = fastmath::sigmoid(classLogits[c]) * objectness;
+            float batchProb = batchScores[c] * objectness;
+            lutProbs[c] = lutProb;
+            maxDifference = std::max(maxDifference, static_cast<double>(std::fabs(lutProb - batchProb)));
+            if (lutProb > classThresh && lutProb > lutMax) {
+                lutMax = lutProb;
+                lutClass = c;
+            }
+            if (batchProb > classThresh && batchProb > batchMax) {
+                batchMax = batchProb;
+                batchClass = c;
+            }
+        }
+        if (lutClass == batchClass) {
+            continue;
+        }
+        changed++;
+        // a class of the other selection must be within the tolerance of the winner or of the threshold
+        float other = (batchClass < 0) ? classThresh : lutProbs[batchClass];
+        float winner = (lutClass < 0) ? classThresh : lutProbs[lutClass];
+        nearTies += (std::fabs(winner - other) <= scoreTolerance) ? 1 : 0;
+    }
+    std::printf("  class probabilities differ by at most %.2e, %d of %d anchors change class, all near ties: %s\n",
+                maxDifference, changed, anchorNum, (changed == nearTies) ? "yes" : "no");
+    TEST_CHECK(maxDifference < scoreTolerance);
+    TEST_CHECK(changed == nearTies);
+}
+}
+
+int main()
+{
+    TEST_RUN(TestExpBatch);
+    TEST_RUN(TestSigmoidBatch);
+    TEST_RUN(TestLengths);
+    TEST_RUN(TestEdges);
+    TEST_RUN(TestClassScores);
+    return TestResult();
+}
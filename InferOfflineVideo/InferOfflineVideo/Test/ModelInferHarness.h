@@ -0,0 +1,206 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODEL_INFER_HARNESS_H
+#define MODEL_INFER_HARNESS_H
+
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "acl/acl.h"
+#include "BlockingQueue/RingQueue.h"
+#include "ModelInfer/ModelInfer.h"
+#include "TestCommon.h"
+
+// ModelInfer driven without the rest of the pipeline, on the ACL simulator. The test pushes decoded frames into
+// its input queue, and a FrameSink takes its output like PostProcess would, on the same executor if one is used.
+// The shape of the simulated model is set by the ACL_SIM_MODEL_* environment variables, see AclSimulator.h
+const uint32_t HARNESS_MODEL_WIDTH = 416;
+const uint32_t HARNESS_MODEL_HEIGHT = 416;
+const uint32_t HARNESS_QUEUE_SIZE = 64;
+
+typedef QueueBase<std::shared_ptr<void>> HarnessQueue;
+
+// Write the config of one ModelInfer and an empty model file next to it, lines are "key = value" added to the
+// required items. Returns the config file name
+inline std::string WriteModelInferConfig(const std::string &name, const std::vector<std::string> &lines)
+{
+    std::string modelPath = name + ".om";
+    std::ofstream(modelPath.c_str()) << "simulated";
+    std::string configPath = name + ".cfg";
+    std::ofstream config(configPath.c_str());
+    config << "SystemConfig.deviceId = 0\n";
+    config << "ModelInfer.modelWidth = " << HARNESS_MODEL_WIDTH << "\n";
+    config << "ModelInfer.modelHeight = " << HARNESS_MODEL_HEIGHT << "\n";
+    config << "ModelInfer.modelType = 0\n";
+    config << "ModelInfer.modelName = YoloV3\n";
+    config << "ModelInfer.modelPath = " << modelPath << "\n";
+    for (const std::string &line : lines) {
+        config << line << "\n";
+    }
+    return configPath;
+}
+
+// A decoded frame of the model input size, every byte set from the channel and the frame id
+inline std::shared_ptr<DvppDataInfoT> MakeHarnessFrame(uint32_t channelId, uint32_t frameId)
+{
+    const uint32_t frameSize = HARNESS_MODEL_WIDTH * HARNESS_MODEL_HEIGHT * YUV_BGR_SIZE_CONVERT_3 /
+        YUV_BGR_SIZE_CONVERT_2;
+    std::shared_ptr<DvppDataInfoT> frame = std::make_shared<DvppDataInfoT>();
+    frame->eof = false;
+    frame->channelId = channelId;
+    frame->frameId = frameId;
+    frame->srcImageWidth = HARNESS_MODEL_WIDTH;
+    frame->srcImageHeight = HARNESS_MODEL_HEIGHT;
+    frame->dvppData = std::make_shared<DvppDataInfo>();
+    void *data = nullptr;
+    if (acldvppMalloc(&data, frameSize) != ACL_ERROR_NONE) {
+        return nullptr;
+    }
+    std::memset(data, static_cast<int>((channelId * 16 + frameId) & 0xff), frameSize);
+    frame->dvppData->data = static_cast<uint8_t *>(data);
+    frame->dvppData->dataSize = frameSize;
+    return frame;
+}
+
+inline std::shared_ptr<DvppDataInfoT> MakeHarnessEof(uint32_t channelId)
+{
+    std::shared_ptr<DvppDataInfoT> frame = std::make_shared<DvppDataInfoT>();
+    frame->eof = true;
+    frame->channelId = channelId;
+    return frame;
+}
+
+// Takes the place of PostProcess, records the frames in the order they arrive and holds each one (and so its
+// output buffer set) for holdUs
+class FrameSink : public ascendBaseModule::TypedModule<CommonData, void> {
+public:
+    struct Received {
+        uint32_t channelId;
+        uint32_t frameId;
+        bool eof;
+        size_t outputNum;
+    };
+
+    explicit FrameSink(uint32_t holdUs = 0) : holdUs_(holdUs) {}
+
+    APP_ERROR Init(ConfigParser &, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+    std::vector<Received> GetReceived()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return received_;
+    }
+
+    size_t GetReceivedNum()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return received_.size();
+    }
+
+protected:
+    APP_ERROR ProcessData(std::shared_ptr<CommonData> data)
+    {
+        if (holdUs_ > 0 && !data->eof) {
+            usleep(holdUs_);
+        }
+        ReleaseDvppFrame(data->dvppData);
+        std::lock_guard<std::mutex> lock(mutex_);
+        received_.push_back({data->channelId, data->frameId, data->eof, data->inferOutput.size()});
+        return APP_ERR_OK;
+    }
+
+private:
+    uint32_t holdUs_ = 0;
+    std::mutex mutex_ = {};
+    std::vector<Received> received_ = {};
+};
+
+// ModelInfer -> FrameSink, both on the executor when one is given
+struct ModelInferHarness {
+    ModelInfer infer;
+    FrameSink sink;
+    std::shared_ptr<HarnessQueue> input = std::make_shared<MpmcRingQueue<std::shared_ptr<void>>>(HARNESS_QUEUE_SIZE);
+    std::shared_ptr<HarnessQueue> output = std::make_shared<SpscRingQueue<std::shared_ptr<void>>>(HARNESS_QUEUE_SIZE);
+
+    explicit ModelInferHarness(uint32_t sinkHoldUs = 0) : sink(sinkHoldUs) {}
+
+    APP_ERROR Start(const std::string &configPath, aclrtContext context,
+        ascendBaseModule::ModuleExecutor *executor = nullptr)
+    {
+        ConfigParser configParser;
+        APP_ERROR ret = configParser.ParseConfig(configPath);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        infer.SetInputVec(input);
+        infer.SetOutputInfo("PostProcess", ascendBaseModule::MODULE_CONNECT_ONE, {output});
+        sink.SetInputVec(output);
+        ascendBaseModule::ModuleInitArgs inferArgs;
+        inferArgs.context = context;
+        inferArgs.pipelineName = "test";
+        inferArgs.moduleName = "ModelInfer";
+        inferArgs.instanceId = 0;
+        ret = infer.Init(configParser, inferArgs);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        ascendBaseModule::ModuleInitArgs sinkArgs = inferArgs;
+        sinkArgs.moduleName = "PostProcess";
+        sink.Init(configParser, sinkArgs);
+        infer.SetExecutor(executor);
+        sink.SetExecutor(executor);
+        sink.Run();
+        return infer.Run();
+    }
+
+    // wait until the sink got the eof of channelNum channels, false on timeout
+    bool WaitEof(uint32_t channelNum, double timeOutSeconds)
+    {
+        double deadline = NowSeconds() + timeOutSeconds;
+        while (NowSeconds() < deadline) {
+            uint32_t eofNum = 0;
+            for (const FrameSink::Received &received : sink.GetReceived()) {
+                eofNum += received.eof ? 1 : 0;
+            }
+            if (eofNum >= channelNum) {
+                return true;
+            }
+            usleep(1000);
+        }
+        return false;
+    }
+
+    void Stop()
+    {
+        infer.Stop();
+        sink.Stop();
+    }
+};
+
+#endif
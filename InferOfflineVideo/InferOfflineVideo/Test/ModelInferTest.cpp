@@ -0,0 +1,143 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include "ModuleManager/ModuleExecutor.h"
+#include "ModelInferHarness.h"
+
+namespace {
+const uint32_t FRAME_NUM = 32;
+const double EOF_TIMEOUT_S = 30.0;
+const uint32_t BATCH_SIZE = 4;
+const uint32_t BATCH_TIMEOUT_MS = 500;
+
+aclrtContext g_context = nullptr;
+
+// Every frame pushed arrives once and in order, followed by the eof
+void CheckReceived(FrameSink &sink, uint32_t frameNum)
+{
+    std::vector<FrameSink::Received> received = sink.GetReceived();
+    TEST_CHECK(received.size() == frameNum + 1);
+    for (size_t i = 0; i < received.size() && i < frameNum; ++i) {
+        TEST_CHECK(!received[i].eof && received[i].frameId == i);
+        TEST_CHECK(received[i].outputNum == ModelBufferSize::bufferSize_.size());
+    }
+    TEST_CHECK(!received.empty() && received.back().eof);
+}
+
+// ModelInfer and the sink share one executor worker, and the sink holds the frames longer than an inference takes.
+// Waiting for a free output set must let the worker run the sink, a worker sleeping in the wait would only get a
+// set back after outputBufferTimeoutMs and drop the frame
+void TestExecutorWaitsForOutputBuffer()
+{
+    std::string config = WriteModelInferConfig("ModelInferTest_executor", {
+        "ModelInfer.outputBufferNum = 2",
+        "ModelInfer.outputBufferTimeoutMs = 1000",
+    });
+    ascendBaseModule::ModuleExecutor executor(1);
+    TEST_CHECK(executor.Start() == APP_ERR_OK);
+    ModelInferHarness harness(2000);
+    TEST_CHECK(harness.Start(config, g_context, &executor) == APP_ERR_OK);
+    for (uint32_t i = 0; i < FRAME_NUM; ++i) {
+        harness.input->Push(MakeHarnessFrame(0, i), true);
+    }
+    harness.input->Push(MakeHarnessEof(0), true);
+    TEST_CHECK(harness.WaitEof(1, EOF_TIMEOUT_S));
+    harness.Stop();
+    executor.Stop();
+    CheckReceived(harness.sink, FRAME_NUM);
+}
+
+// Waits until the sink received num messages, false on timeout
+bool WaitReceived(FrameSink &sink, size_t num, double timeOutSeconds)
+{
+    double deadline = NowSeconds() + timeOutSeconds;
+    while (sink.GetReceivedNum() < num) {
+        if (NowSeconds() >= deadline) {
+            return false;
+        }
+        usleep(1000);
+    }
+    return true;
+}
+
+// A batch which is not full waits for its deadline without holding the executor worker: a module sharing the only
+// worker runs meanwhile, and a wake-up at the deadline runs the batch although no more frames arrive
+void TestExecutorBatchTimeout()
+{
+    // the default simulated model as a static batch of BATCH_SIZE frames, with an image info row per frame
+    setenv("ACL_SIM_MODEL_INPUTS", "1038336,64", 1);
+    setenv("ACL_SIM_MODEL_OUTPUTS", "98304,128", 1);
+    std::string config = WriteModelInferConfig("ModelInferTest_batchTimeout", {
+        "ModelInfer.batchSize = " + std::to_string(BATCH_SIZE),
+        "ModelInfer.batchTimeoutMs = " + std::to_string(BATCH_TIMEOUT_MS),
+    });
+    ascendBaseModule::ModuleExecutor executor(1);
+    TEST_CHECK(executor.Start() == APP_ERR_OK);
+    ModelInferHarness harness;
+    TEST_CHECK(harness.Start(config, g_context, &executor) == APP_ERR_OK);
+    FrameSink other;
+    std::shared_ptr<HarnessQueue> otherInput = std::make_shared<MpmcRingQueue<std::shared_ptr<void>>>(
+        HARNESS_QUEUE_SIZE);
+    ConfigParser configParser;
+    ascendBaseModule::ModuleInitArgs otherArgs;
+    otherArgs.moduleName = "Other";
+    otherArgs.instanceId = 0;
+    other.SetInputVec(otherInput);
+    other.Init(configParser, otherArgs);
+    other.SetExecutor(&executor);
+    other.Run();
+
+    double startSeconds = NowSeconds();
+    harness.input->Push(MakeHarnessFrame(0, 0), true);
+    usleep(BATCH_TIMEOUT_MS * 1000 / 10);
+    std::shared_ptr<CommonData> message = std::make_shared<CommonData>();
+    message->eof = true;
+    otherInput->Push(message, true);
+    TEST_CHECK(WaitReceived(other, 1, EOF_TIMEOUT_S));
+    double otherSeconds = NowSeconds() - startSeconds;
+    TEST_CHECK(WaitReceived(harness.sink, 1, EOF_TIMEOUT_S));
+    double batchSeconds = NowSeconds() - startSeconds;
+    std::printf("  other module after %.1f ms, batch after %.1f ms of %u ms\n", otherSeconds * 1000,
+        batchSeconds * 1000, BATCH_TIMEOUT_MS);
+    TEST_CHECK(otherSeconds < BATCH_TIMEOUT_MS / 1000.0 / 2);
+    TEST_CHECK(batchSeconds >= BATCH_TIMEOUT_MS / 1000.0);
+    TEST_CHECK(harness.infer.GetMetrics().batchTimeouts == 1);
+
+    harness.input->Push(MakeHarnessEof(0), true);
+    TEST_CHECK(harness.WaitEof(1, EOF_TIMEOUT_S));
+    harness.Stop();
+    other.Stop();
+    executor.Stop();
+    std::vector<FrameSink::Received> received = harness.sink.GetReceived();
+    TEST_CHECK(received.size() == 2 && !received[0].eof && received[0].frameId == 0 && received[1].eof);
+    unsetenv("ACL_SIM_MODEL_INPUTS");
+    unsetenv("ACL_SIM_MODEL_OUTPUTS");
+}
+}
+
+int main()
+{
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    aclrtCreateContext(&g_context, 0);
+    TEST_RUN(TestExecutorWaitsForOutputBuffer);
+    TEST_RUN(TestExecutorBatchTimeout);
+    aclrtDestroyContext(g_context);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return TestResult();
+}
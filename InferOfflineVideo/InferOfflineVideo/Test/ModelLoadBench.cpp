@@ -0,0 +1,141 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileManager/FileManager.h"
+#include "ModelProcess/ModelProcess.h"
+#include "ResourceManager/ResourceManager.h"
+#include "TestCommon.h"
+
+// Startup time and resident memory of loading one model file for every ModelInfer instance, on the simulator with
+// the file in page cache. "read per instance" is the ReadBinaryFile of each instance before the model registry,
+// "ModelProcess::Init" loads through the registry, which maps the file once. The simulator does not parse the
+// model, the driver side of a real load comes on top of both.
+// Usage: ModelLoadBench [instances] [model MB] [populate], populate 1 sets SystemConfig.modelMapPopulate
+namespace {
+const size_t BYTES_PER_MB = 1024 * 1024;
+const char *MODEL_PATH = "ModelLoadBench.om";
+
+struct MemoryUsage {
+    long rssKb = 0;
+    long peakKb = 0;
+};
+
+long ReadStatusKb(const std::string &status, const std::string &key)
+{
+    size_t pos = status.find(key);
+    return (pos == std::string::npos) ? 0 : std::atol(status.c_str() + pos + key.size());
+}
+
+MemoryUsage GetMemoryUsage()
+{
+    std::ifstream file("/proc/self/status");
+    std::string status((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    MemoryUsage usage;
+    usage.rssKb = ReadStatusKb(status, "VmRSS:");
+    usage.peakKb = ReadStatusKb(status, "VmHWM:");
+    return usage;
+}
+
+// the peak of each phase starts from the current RSS, where the kernel allows it
+void ResetPeak()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+void Report(const char *name, double startSeconds, const MemoryUsage &before, size_t instances)
+{
+    double ms = (NowSeconds() - startSeconds) * 1000;
+    MemoryUsage after = GetMemoryUsage();
+    std::printf("  %-20s %9.1f ms  %7.3f ms/instance  RSS %+6ld MB  peak %+6ld MB\n", name, ms, ms / instances,
+        (after.rssKb - before.rssKb) / 1024, (after.peakKb - before.rssKb) / 1024);
+}
+
+void WriteModelFile(size_t modelMb)
+{
+    std::vector<char> block(BYTES_PER_MB);
+    for (size_t i = 0; i < block.size(); i++) {
+        block[i] = static_cast<char>(i * 31);
+    }
+    std::ofstream file(MODEL_PATH, std::ios::binary);
+    for (size_t mb = 0; mb < modelMb; mb++) {
+        file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+}
+
+void ReadPerInstance(size_t instances)
+{
+    ResetPeak();
+    MemoryUsage before = GetMemoryUsage();
+    double start = NowSeconds();
+    for (size_t i = 0; i < instances; i++) {
+        std::shared_ptr<uint8_t> buffer;
+        int length = 0;
+        ReadBinaryFile(MODEL_PATH, buffer, length);
+    }
+    Report("read per instance", start, before, instances);
+}
+
+void InitInstances(size_t instances)
+{
+    ResetPeak();
+    MemoryUsage before = GetMemoryUsage();
+    double start = NowSeconds();
+    std::vector<std::unique_ptr<ModelProcess>> models;
+    for (size_t i = 0; i < instances; i++) {
+        models.emplace_back(new ModelProcess(0, "ModelLoadBench"));
+        if (models.back()->Init(MODEL_PATH, true) != APP_ERR_OK) {
+            std::printf("  ModelProcess::Init failed\n");
+            return;
+        }
+    }
+    Report("ModelProcess::Init", start, before, instances);
+    for (auto &model : models) {
+        model->DeInit();
+    }
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const int modelMbArg = 2;
+    const int populateArg = 3;
+    size_t instances = BenchIterations(argc, argv, 32);
+    size_t modelMb = (argc > modelMbArg) ? std::strtoul(argv[modelMbArg], nullptr, 10) : 128;
+    ResourceInfo resourceInfo;
+    resourceInfo.deviceIds.insert(0);
+    resourceInfo.modelMapPopulate = (argc > populateArg) && std::atoi(argv[populateArg]) != 0;
+    if (ResourceManager::GetInstance()->InitResource(resourceInfo) != APP_ERR_OK) {
+        return EXIT_FAILURE;
+    }
+    WriteModelFile(modelMb);
+    std::shared_ptr<uint8_t> warmUp;
+    int length = 0;
+    ReadBinaryFile(MODEL_PATH, warmUp, length);
+    warmUp.reset();
+    std::printf("%zu instances, model of %zu MB, modelMapPopulate %d\n", instances, modelMb,
+        resourceInfo.modelMapPopulate ? 1 : 0);
+    ReadPerInstance(instances);
+    InitInstances(instances);
+    ResourceManager::GetInstance()->Release();
+    std::remove(MODEL_PATH);
+    return 0;
+}
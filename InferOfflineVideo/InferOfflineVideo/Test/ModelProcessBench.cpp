@@ -0,0 +1,67 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModelProcessHarness.h"
+#include "TestCommon.h"
+
+// Host time of one inference on the simulator, where the execution itself takes no time: ModelInference on
+// buffer vectors, which creates and destroys both datasets and looks the dynamic batch input up every run, and
+// ModelInference on a slot bound once, which only points the first input at the frame.
+// Usage: ModelProcessBench [inferences]
+namespace {
+const uint64_t BENCH_BATCH = 4;
+
+template<typename Infer> void Report(const char *name, Infer infer, size_t inferences)
+{
+    int failures = 0;
+    double start = NowSeconds();
+    for (size_t i = 0; i < inferences; i++) {
+        failures += (infer() == APP_ERR_OK) ? 0 : 1;
+    }
+    double nsPerInference = (NowSeconds() - start) * 1e9 / inferences;
+    std::printf("  %-12s %9.1f ns/inference%s\n", name, nsPerInference, (failures == 0) ? "" : "  (failed)");
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t inferences = BenchIterations(argc, argv, 200000);
+    aclrtContext context = nullptr;
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    aclrtCreateContext(&context, 0);
+    {
+        ModelProcess model(0, "ModelProcessBench");
+        if (model.Init(WriteDynamicBatchModel("ModelProcessBench")) != APP_ERR_OK) {
+            return EXIT_FAILURE;
+        }
+        SlotBuffers buffers = MallocSlotBuffers(model);
+        BindSlot(model, 0, buffers);
+        void *input = buffers.inputs[0];
+        std::printf("dynamic batch size %lu\n", static_cast<unsigned long>(BENCH_BATCH));
+        Report("vectors", [&]() {
+            return model.ModelInference(buffers.inputs, buffers.inputSizes, buffers.outputs, buffers.outputSizes,
+                BENCH_BATCH);
+        }, inferences);
+        Report("slot", [&]() { return model.ModelInference(0, input, BENCH_BATCH); }, inferences);
+        model.DeInit();
+        FreeSlotBuffers(buffers);
+    }
+    aclrtDestroyContext(context);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return 0;
+}
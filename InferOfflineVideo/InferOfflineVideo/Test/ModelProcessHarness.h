@@ -0,0 +1,84 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODEL_PROCESS_HARNESS_H
+#define MODEL_PROCESS_HARNESS_H
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "acl/acl.h"
+#include "ModelProcess/ModelProcess.h"
+
+// ModelProcess on the simulated model of ModelInfer with dynamic batches of up to 4 frames, and a set of device
+// buffers of its inputs and outputs per slot
+const uint64_t HARNESS_DYNAMIC_BATCHES[] = {1, 2, 4};
+
+// Sets the simulated model, the execution itself takes no time. Writes the model file, returns its name
+inline std::string WriteDynamicBatchModel(const std::string &name)
+{
+    setenv("ACL_SIM_MODEL_INPUTS", "1038336,64", 1);
+    setenv("ACL_SIM_MODEL_OUTPUTS", "98304,128", 1);
+    setenv("ACL_SIM_MODEL_DYNAMIC_BATCH", "1,2,4", 1);
+    setenv("ACL_SIM_MODEL_LATENCY_US", "0", 1);
+    setenv("ACL_SIM_MODEL_FRAME_LATENCY_US", "0", 1);
+    std::string modelPath = name + ".om";
+    std::ofstream(modelPath.c_str()) << "simulated";
+    return modelPath;
+}
+
+struct SlotBuffers {
+    std::vector<void *> inputs;
+    std::vector<size_t> inputSizes;
+    std::vector<void *> outputs;
+    std::vector<size_t> outputSizes;
+};
+
+inline SlotBuffers MallocSlotBuffers(ModelProcess &model)
+{
+    SlotBuffers buffers;
+    for (size_t i = 0; i < model.GetModelNumInputs(); i++) {
+        void *buffer = nullptr;
+        aclrtMalloc(&buffer, model.GetModelInputSizeByIndex(i), ACL_MEM_MALLOC_HUGE_FIRST);
+        buffers.inputs.push_back(buffer);
+        buffers.inputSizes.push_back(model.GetModelInputSizeByIndex(i));
+    }
+    for (size_t i = 0; i < model.GetModelNumOutputs(); i++) {
+        void *buffer = nullptr;
+        aclrtMalloc(&buffer, model.GetModelOutputSizeByIndex(i), ACL_MEM_MALLOC_HUGE_FIRST);
+        buffers.outputs.push_back(buffer);
+        buffers.outputSizes.push_back(model.GetModelOutputSizeByIndex(i));
+    }
+    return buffers;
+}
+
+inline void FreeSlotBuffers(SlotBuffers &buffers)
+{
+    for (void *buffer : buffers.inputs) {
+        aclrtFree(buffer);
+    }
+    for (void *buffer : buffers.outputs) {
+        aclrtFree(buffer);
+    }
+}
+
+inline APP_ERROR BindSlot(ModelProcess &model, size_t slotId, const SlotBuffers &buffers)
+{
+    return model.BindSlot(slotId, buffers.inputs, buffers.inputSizes, buffers.outputs, buffers.outputSizes);
+}
+
+#endif
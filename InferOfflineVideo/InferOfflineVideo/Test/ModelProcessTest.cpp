@@ -0,0 +1,79 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "acl/acl_simulator.h"
+#include "ModelProcessHarness.h"
+#include "TestCommon.h"
+
+// The slots of ModelProcess on the simulator: a slot is bound once, a slot which is not bound does not run, and the
+// dynamic batch input is looked up by the first run of a dynamic batch and not again
+namespace {
+const size_t SLOT_NUM = 3;
+const uint64_t UNKNOWN_BATCH = 3;
+
+void TestSlots()
+{
+    ModelProcess model(0, "ModelProcessTest");
+    TEST_CHECK(model.Init(WriteDynamicBatchModel("ModelProcessTest")) == APP_ERR_OK);
+    std::vector<SlotBuffers> buffers;
+    for (size_t i = 0; i < SLOT_NUM; i++) {
+        buffers.push_back(MallocSlotBuffers(model));
+    }
+    void *input = buffers[0].inputs[0];
+
+    // nothing bound, then slot 1 below the bound slot 2
+    TEST_CHECK(model.ModelInference(0, input, 1) != APP_ERR_OK);
+    TEST_CHECK(BindSlot(model, 2, buffers[2]) == APP_ERR_OK);
+    TEST_CHECK(model.ModelInference(1, input, 1) != APP_ERR_OK);
+    TEST_CHECK(model.ModelInference(SLOT_NUM, input, 1) != APP_ERR_OK);
+
+    // a bound slot keeps its buffers, a second binding is refused
+    TEST_CHECK(BindSlot(model, 0, buffers[0]) == APP_ERR_OK);
+    TEST_CHECK(BindSlot(model, 0, buffers[1]) == APP_ERR_COMM_EXIST);
+    TEST_CHECK(BindSlot(model, 1, buffers[1]) == APP_ERR_OK);
+
+    // the dynamic batch index is looked up once for all slots and batch sizes
+    uint64_t queriesBefore = AclSimulator::GetInputIndexQueries();
+    const int rounds = 3;
+    for (int round = 0; round < rounds; round++) {
+        for (size_t slotId = 0; slotId < SLOT_NUM; slotId++) {
+            for (uint64_t batch : HARNESS_DYNAMIC_BATCHES) {
+                TEST_CHECK(model.ModelInference(slotId, input, batch) == APP_ERR_OK);
+            }
+        }
+    }
+    TEST_CHECK(AclSimulator::GetInputIndexQueries() - queriesBefore == 1);
+    TEST_CHECK(model.ModelInference(0, input, UNKNOWN_BATCH) != APP_ERR_OK);
+
+    model.DeInit();
+    for (SlotBuffers &slotBuffers : buffers) {
+        FreeSlotBuffers(slotBuffers);
+    }
+}
+}
+
+int main()
+{
+    aclrtContext context = nullptr;
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    aclrtCreateContext(&context, 0);
+    TEST_RUN(TestSlots);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return TestResult();
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include "PostProcess/Nms.h"
+#include "BaselineNms.h"
+#include "NmsTestData.h"
+#include "TestCommon.h"
+
+// Time of the NMS of one frame with NmsEngine and with the NmsSort it replaced, in us per frame, for independent
+// boxes and for clusters of boxes around each object like the detections of yolo.
+// Usage: NmsBench [rounds]
+namespace {
+const int CLASS_NUM_COCO = 80;
+const size_t CLUSTER_SIZE = 8;
+
+void Report(size_t boxNum, int classNum, size_t clusterSize, size_t rounds)
+{
+    std::mt19937 random(1);
+    std::vector<DetectBox> boxes = MakeNmsBoxes(random, boxNum, classNum, clusterSize);
+    NmsEngine nms;
+    std::vector<DetectBox> frame;
+    size_t kept = 0;
+    double start = NowSeconds();
+    for (size_t round = 0; round < rounds; round++) {
+        frame = boxes;
+        baseline::NmsSort(frame, classNum);
+    }
+    double baselineUs = (NowSeconds() - start) * 1e6 / rounds;
+    kept = frame.size();
+    start = NowSeconds();
+    for (size_t round = 0; round < rounds; round++) {
+        frame = boxes;
+        nms.Run(frame);
+    }
+    double engineUs = (NowSeconds() - start) * 1e6 / rounds;
+    std::printf("%5zu boxes %2d classes cluster %zu: NmsSort %9.1f us  NmsEngine %8.1f us  (%zu / %zu kept)\n",
+                boxNum, classNum, clusterSize, baselineUs, engineUs, kept, frame.size());
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rounds = BenchIterations(argc, argv, 200);
+    const size_t boxNums[] = {100, 1000, 5000};
+    for (size_t boxNum : boxNums) {
+        // the rounds are for 100 boxes, the O(n^2) NmsSort of the larger frames gets fewer
+        size_t frameRounds = std::max<size_t>(rounds * 100 / boxNum, 1);
+        Report(boxNum, 1, 1, frameRounds);
+        Report(boxNum, 1, CLUSTER_SIZE, frameRounds);
+        Report(boxNum, CLASS_NUM_COCO, CLUSTER_SIZE, frameRounds);
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include "PostProcess/Nms.h"
+#include "BaselineNms.h"
+#include "NmsTestData.h"
+#include "TestCommon.h"
+
+namespace {
+const size_t BOX_NUMS[] = {0, 1, 2, 3, 5, 63, 64, 65, 300, 1000, 3000};
+const size_t CLUSTER_SIZES[] = {1, 4, 20};
+const int MULTI_CLASS_NUM = 80;
+const int ROUNDS = 3;
+
+bool SameBoxes(const std::vector<DetectBox> &a, const std::vector<DetectBox> &b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(DetectBox)) == 0);
+}
+
+// Hard NMS keeps the boxes of the removed NmsSort/FilterByIou, bit for bit and in the same order: grouped by class
+// in ascending order, by score within a class
+void CheckHardNms(int classNum)
+{
+    std::mt19937 random(static_cast<uint32_t>(classNum));
+    NmsEngine nms;
+    int mismatches = 0;
+    for (size_t boxNum : BOX_NUMS) {
+        for (size_t clusterSize : CLUSTER_SIZES) {
+            for (int round = 0; round < ROUNDS; round++) {
+                std::vector<DetectBox> boxes = MakeNmsBoxes(random, boxNum, classNum, clusterSize);
+                std::vector<DetectBox> expected = boxes;
+                baseline::NmsSort(expected, classNum);
+                nms.Run(boxes); // the same engine for every frame, like a PostProcess slot
+                if (!SameBoxes(boxes, expected)) {
+                    std::printf("boxes %zu, cluster %zu, classes %d: %zu kept, %zu expected\n", boxNum, clusterSize,
+                                classNum, boxes.size(), expected.size());
+                    mismatches++;
+                }
+            }
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+}
+
+void TestHardNmsOneClass()
+{
+    CheckHardNms(1);
+}
+
+void TestHardNmsClasses()
+{
+    CheckHardNms(MULTI_CLASS_NUM);
+}
+
+// With topK only the topK highest scores of the frame go into the NMS
+void TestTopK()
+{
+    const size_t topK = 100;
+    std::mt19937 random(2);
+    std::vector<DetectBox> boxes = MakeNmsBoxes(random, 1000, MULTI_CLASS_NUM, 4);
+    std::vector<DetectBox> expected = boxes;
+    std::sort(expected.begin(), expected.end(), [](const DetectBox &a, const DetectBox &b) {
+        return a.prob > b.prob;
+    });
+    expected.resize(topK);
+    baseline::NmsSort(expected, MULTI_CLASS_NUM);
+    NmsConfig config;
+    config.topK = topK;
+    NmsEngine nms;
+    nms.SetConfig(config);
+    nms.Run(boxes);
+    TEST_CHECK(SameBoxes(boxes, expected));
+}
+
+// Boxes of different classes at the same place only suppress each other when the NMS is class agnostic
+void TestClassAgnostic()
+{
+    DetectBox first = {0.9f, 1, 0.5f, 0.5f, 0.2f, 0.2f};
+    DetectBox second = {0.8f, 0, 0.5f, 0.5f, 0.2f, 0.2f};
+    NmsEngine nms;
+    std::vector<DetectBox> boxes = {first, second};
+    nms.Run(boxes);
+    TEST_CHECK(boxes.size() == 2 && boxes[0].classID == 0 && boxes[1].classID == 1);
+    NmsConfig config;
+    config.classAgnostic = true;
+    nms.SetConfig(config);
+    boxes = {first, second};
+    nms.Run(boxes);
+    TEST_CHECK(boxes.size() == 1 && boxes[0].classID == 1);
+}
+}
+
+int main()
+{
+    TEST_RUN(TestHardNmsOneClass);
+    TEST_RUN(TestHardNmsClasses);
+    TEST_RUN(TestTopK);
+    TEST_RUN(TestClassAgnostic);
+    return TestResult();
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NMS_TEST_DATA_H
+#define NMS_TEST_DATA_H
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "PostProcess/Yolov3Post.h"
+
+// Boxes of a frame for the NMS tests and benchmark, in normalized coordinates. Every box has its own score, so the
+// order of the kept boxes does not depend on how ties are broken. clusterSize boxes are spread around each object,
+// with a cluster size of 1 the boxes are independent
+inline std::vector<DetectBox> MakeNmsBoxes(std::mt19937 &random, size_t boxNum, int classNum, size_t clusterSize)
+{
+    const float scoreMin = 0.3f;
+    const float scoreRange = 0.7f;
+    std::uniform_real_distribution<float> position(0.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.02f, 0.2f);
+    std::normal_distribution<float> jitter(0.0f, 0.01f);
+    std::vector<uint32_t> ranks(boxNum);
+    for (size_t i = 0; i < boxNum; i++) {
+        ranks[i] = static_cast<uint32_t>(i);
+    }
+    std::shuffle(ranks.begin(), ranks.end(), random);
+    std::vector<DetectBox> boxes(boxNum);
+    DetectBox object = {};
+    for (size_t i = 0; i < boxNum; i++) {
+        if (i % clusterSize == 0) {
+            object = {0.0f, static_cast<int>(random() % classNum), position(random), position(random), size(random),
+                      size(random)};
+        }
+        DetectBox &box = boxes[i];
+        box = object;
+        if (clusterSize > 1) {
+            box.x += jitter(random);
+            box.y += jitter(random);
+            box.width = std::max(box.width + jitter(random), 0.01f);
+            box.height = std::max(box.height + jitter(random), 0.01f);
+        }
+        box.prob = scoreMin + scoreRange * (ranks[i] + 1) / boxNum;
+    }
+    return boxes;
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#include "BlockingQueue/RingQueue.h"
+#include "DataType/DataType.h"
+#include "TestCommon.h"
+
+// Heap allocations and time per frame of the messages passed between the decoder, ModelInfer and PostProcess
+// threads, made with make_shared, new and std::vector as before the object pool, and with MakePooled, NewPooled
+// and RawDataList as the modules do now.
+// Usage: ObjectPoolBench [frames]
+namespace {
+std::atomic<uint64_t> g_heapAllocations(0);
+}
+
+void *operator new(size_t size)
+{
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    void *block = std::malloc(size == 0 ? 1 : size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void *block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void *block, size_t) noexcept
+{
+    std::free(block);
+}
+
+namespace {
+const size_t QUEUE_SIZE = 32;
+const size_t OUTPUT_NUM = 3;        // outputs of yolov3
+const size_t WARM_UP_FRAMES = 10000;
+
+struct DecodeInfoStub {
+    uint32_t channelId = 0;
+    uint64_t frameId = 0;
+    DvppBuffer outputBuffer;
+};
+
+// The allocations of one frame, before the object pool
+struct HeapAllocation {
+    typedef std::vector<RawData> OutputList;
+
+    template<typename T> static std::shared_ptr<T> Make()
+    {
+        return std::make_shared<T>();
+    }
+
+    template<typename T> static T *New()
+    {
+        return new T();
+    }
+
+    template<typename T> static void Delete(T *object)
+    {
+        delete object;
+    }
+
+    // non-owning pointer to the output buffer of the model
+    static RawData Output(const std::shared_ptr<void> &, void *data, size_t size)
+    {
+        return RawData {size, std::shared_ptr<void>(data, [](void *) {})};
+    }
+};
+
+// The allocations of one frame with the object pool
+struct PooledAllocation {
+    typedef RawDataList OutputList;
+
+    template<typename T> static std::shared_ptr<T> Make()
+    {
+        return MakePooled<T>();
+    }
+
+    template<typename T> static T *New()
+    {
+        return NewPooled<T>();
+    }
+
+    template<typename T> static void Delete(T *object)
+    {
+        DeletePooled(object);
+    }
+
+    // aliases the lease of the output buffers, no control block
+    static RawData Output(const std::shared_ptr<void> &lease, void *data, size_t size)
+    {
+        return RawData {size, std::shared_ptr<void>(lease, data)};
+    }
+};
+
+template<typename Allocation> struct InferMessage {
+    std::shared_ptr<DvppDataInfoT> frame;
+    typename Allocation::OutputList outputs;
+};
+
+// decoder thread -> ModelInfer thread -> PostProcess thread, returns ns per frame, allocations are counted too
+template<typename Allocation> double RunFrames(size_t frameNum)
+{
+    SpscRingQueue<std::shared_ptr<DvppDataInfoT>> decoded(QUEUE_SIZE);
+    SpscRingQueue<std::shared_ptr<InferMessage<Allocation>>> inferred(QUEUE_SIZE);
+    std::shared_ptr<void> lease = std::make_shared<std::vector<uint8_t>>(OUTPUT_NUM * 64);
+    uint8_t *outputBuffer = static_cast<std::vector<uint8_t> *>(lease.get())->data();
+    double start = NowSeconds();
+    std::thread modelInfer([&]() {
+        std::shared_ptr<DvppDataInfoT> frame;
+        for (size_t i = 0; i < frameNum; ++i) {
+            decoded.Pop(frame);
+            auto message = Allocation::template Make<InferMessage<Allocation>>();
+            message->frame = std::move(frame);
+            message->outputs.reserve(OUTPUT_NUM);
+            for (size_t k = 0; k < OUTPUT_NUM; ++k) {
+                message->outputs.push_back(Allocation::Output(lease, outputBuffer + k * 64, 64));
+            }
+            inferred.Push(std::move(message), true);
+        }
+    });
+    std::thread postProcess([&]() {
+        std::shared_ptr<InferMessage<Allocation>> message;
+        for (size_t i = 0; i < frameNum; ++i) {
+            inferred.Pop(message);
+            message.reset();
+        }
+    });
+    for (size_t i = 0; i < frameNum; ++i) {
+        DecodeInfoStub *decodeInfo = Allocation::template New<DecodeInfoStub>(); // user data of the VDEC callback
+        decodeInfo->frameId = i;
+        std::shared_ptr<DvppDataInfo> picture = Allocation::template Make<DvppDataInfo>();
+        picture->frameId = i;
+        std::shared_ptr<DvppDataInfoT> frame = Allocation::template Make<DvppDataInfoT>();
+        frame->frameId = i;
+        frame->dvppData = std::move(picture);
+        Allocation::Delete(decodeInfo);
+        decoded.Push(std::move(frame), true);
+    }
+    modelInfer.join();
+    postProcess.join();
+    return (NowSeconds() - start) * 1e9 / frameNum;
+}
+
+template<typename Allocation> void Report(const char *name, size_t frameNum)
+{
+    RunFrames<Allocation>(WARM_UP_FRAMES);
+    uint64_t allocations = g_heapAllocations.load();
+    double nsPerFrame = RunFrames<Allocation>(frameNum);
+    // the threads and queues of the run allocate a few blocks of their own, they are not per frame
+    double allocationsPerFrame = static_cast<double>(g_heapAllocations.load() - allocations) / frameNum;
+    std::printf("%-20s %6.2f heap allocations/frame  %8.1f ns/frame\n", name, allocationsPerFrame, nsPerFrame);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t frameNum = BenchIterations(argc, argv, 1000000);
+    Report<HeapAllocation>("make_shared/new", frameNum);
+    Report<PooledAllocation>("ObjectPool", frameNum);
+    return 0;
+}
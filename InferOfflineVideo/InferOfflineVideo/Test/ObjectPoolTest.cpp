@@ -0,0 +1,146 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <malloc.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "BlockingQueue/RingQueue.h"
+#include "ObjectPool/ObjectPool.h"
+#include "TestCommon.h"
+
+namespace {
+const size_t MESSAGE_NUM = 100000;
+const size_t SMALL_SIZE = 17; // class of 32 bytes
+
+struct Message {
+    uint64_t frameId = 0;
+    char payload[100] = {};
+};
+
+// Messages made by one thread and released by another, like the module links. Once the blocks went round, the
+// pool does not take memory from the heap any more
+void TestCrossThreadRecycling()
+{
+    SpscRingQueue<std::shared_ptr<Message>> queue(64);
+    auto run = [&queue](size_t messageNum) {
+        std::thread consumer([&queue, messageNum]() {
+            std::shared_ptr<Message> message;
+            for (size_t i = 0; i < messageNum; ++i) {
+                queue.Pop(message);
+                message.reset();
+            }
+        });
+        for (size_t i = 0; i < messageNum; ++i) {
+            std::shared_ptr<Message> message = MakePooled<Message>();
+            message->frameId = i;
+            queue.Push(std::move(message), true);
+        }
+        consumer.join();
+    };
+    run(MESSAGE_NUM);
+    uint64_t mallocs = ObjectPool::GetStats().mallocs;
+    run(MESSAGE_NUM);
+    uint64_t transfers = ObjectPool::GetStats().transfers;
+    TEST_CHECK(ObjectPool::GetStats().mallocs == mallocs);
+    TEST_CHECK(transfers > 0);
+}
+
+void TestSizes()
+{
+    // blocks of one class are interchangeable, whatever size they were asked for
+    void *small = ObjectPool::Allocate(1);
+    ObjectPool::Deallocate(small, 1);
+    void *again = ObjectPool::Allocate(OBJECT_POOL_ALIGN);
+    TEST_CHECK(again == small);
+    std::memset(again, 0xab, OBJECT_POOL_ALIGN);
+    ObjectPool::Deallocate(again, OBJECT_POOL_ALIGN);
+
+    void *large = ObjectPool::Allocate(OBJECT_POOL_MAX_SIZE + 1);
+    std::memset(large, 0xab, OBJECT_POOL_MAX_SIZE + 1);
+    ObjectPool::Deallocate(large, OBJECT_POOL_MAX_SIZE + 1);
+    ObjectPool::Deallocate(nullptr, SMALL_SIZE);
+}
+
+void *g_exitBlock = nullptr;
+
+// Destroyed after the thread cache of the pool, so its allocation takes the path of an exiting thread
+struct LateAllocator {
+    bool armed = false;
+    ~LateAllocator()
+    {
+        if (armed) {
+            g_exitBlock = ObjectPool::Allocate(SMALL_SIZE);
+        }
+    }
+};
+
+thread_local LateAllocator t_lateAllocator;
+
+// A block allocated while its thread exits and released by a live thread goes into a free list, the next
+// allocation of the class gets it and may use the whole class size
+void TestBlockAllocatedAtThreadExit()
+{
+    std::thread exiting([]() {
+        t_lateAllocator.armed = true; // constructed before the thread cache, destroyed after it
+        ObjectPool::Deallocate(ObjectPool::Allocate(SMALL_SIZE), SMALL_SIZE);
+    });
+    exiting.join();
+    TEST_CHECK(g_exitBlock != nullptr);
+    if (g_exitBlock == nullptr) {
+        return;
+    }
+    std::thread live([]() {
+        ObjectPool::Deallocate(g_exitBlock, SMALL_SIZE);
+        void *block = ObjectPool::Allocate(2 * OBJECT_POOL_ALIGN);
+        TEST_CHECK(block == g_exitBlock);
+        TEST_CHECK(malloc_usable_size(block) >= 2 * OBJECT_POOL_ALIGN);
+        std::memset(block, 0xab, 2 * OBJECT_POOL_ALIGN);
+        ObjectPool::Deallocate(block, 2 * OBJECT_POOL_ALIGN);
+    });
+    live.join();
+}
+
+void TestNewPooled()
+{
+    struct Counted {
+        explicit Counted(int &count) : count_(count)
+        {
+            count_++;
+        }
+        ~Counted()
+        {
+            count_--;
+        }
+        int &count_;
+    };
+    int count = 0;
+    Counted *object = NewPooled<Counted>(count);
+    TEST_CHECK(count == 1);
+    DeletePooled(object);
+    TEST_CHECK(count == 0);
+    DeletePooled<Counted>(nullptr);
+}
+}
+
+int main()
+{
+    TEST_RUN(TestCrossThreadRecycling);
+    TEST_RUN(TestSizes);
+    TEST_RUN(TestBlockAllocatedAtThreadExit);
+    TEST_RUN(TestNewPooled);
+    return TestResult();
+}
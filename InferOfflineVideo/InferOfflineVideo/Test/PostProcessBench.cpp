@@ -0,0 +1,100 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+#include "PostProcessHarness.h"
+
+// Time per frame of PostProcess on the outputs of yolov3 with 80 classes, for 0 (no task pool), 1, 2, 4 and 8
+// decode workers: single frames whose layers are split into bands (ProcessData), and batches of 8 frames decoded
+// one per worker (ProcessBatch). The speedup is bounded by the cores of the host, which are printed too.
+// Usage: PostProcessBench [frames]
+namespace {
+const uint32_t WORKER_NUMS[] = {0, 1, 2, 4, 8};
+const uint32_t BATCH_SIZE = 8;
+const size_t OUTPUT_SET_NUM = 4;
+
+aclrtContext g_context = nullptr;
+
+double RunSingleFrames(std::vector<YoloOutputs> &outputs, uint32_t workerNum, size_t frameNum)
+{
+    std::string config = WritePostProcessConfig("PostProcessBench_single",
+        {"PostProcess.decodeThreadNum = " + std::to_string(workerNum)});
+    ResultRecorder recorder;
+    if (recorder.InitConfig(config, g_context, 1) != APP_ERR_OK) {
+        return 0.0;
+    }
+    double start = NowSeconds();
+    for (size_t i = 0; i < frameNum; i++) {
+        recorder.RunFrame(MakeYoloFrame(0, i, outputs[i % outputs.size()]));
+        if (i % BATCH_SIZE == 0) {
+            recorder.ClearResults();
+        }
+    }
+    double msPerFrame = (NowSeconds() - start) * 1e3 / frameNum;
+    recorder.DeInit();
+    return msPerFrame;
+}
+
+double RunBatches(std::vector<YoloOutputs> &outputs, uint32_t workerNum, size_t frameNum)
+{
+    std::string config = WritePostProcessConfig("PostProcessBench_batch",
+        {"PostProcess.decodeThreadNum = " + std::to_string(workerNum)});
+    ResultRecorder recorder;
+    if (recorder.InitConfig(config, g_context, BATCH_SIZE) != APP_ERR_OK) {
+        return 0.0;
+    }
+    size_t batchNum = (frameNum + BATCH_SIZE - 1) / BATCH_SIZE;
+    std::vector<std::shared_ptr<void>> batch;
+    double start = NowSeconds();
+    for (size_t i = 0; i < batchNum; i++) {
+        batch.clear();
+        for (uint32_t j = 0; j < BATCH_SIZE; j++) {
+            // one frame of every channel per batch
+            batch.push_back(MakeYoloFrame(j, i, outputs[(i + j) % outputs.size()]));
+        }
+        recorder.RunBatch(batch);
+        recorder.ClearResults();
+    }
+    double msPerFrame = (NowSeconds() - start) * 1e3 / (batchNum * BATCH_SIZE);
+    recorder.DeInit();
+    return msPerFrame;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t frameNum = BenchIterations(argc, argv, 200);
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    aclrtCreateContext(&g_context, 0);
+    std::mt19937 random(1);
+    std::vector<YoloOutputs> outputs;
+    for (size_t i = 0; i < OUTPUT_SET_NUM; i++) {
+        outputs.push_back(MakeYoloOutputs(random));
+    }
+    SetYoloModelOutputs(outputs[0]);
+    std::printf("%u cores\n", std::thread::hardware_concurrency());
+    std::printf("workers  single frame ms/frame  batch of %u ms/frame\n", BATCH_SIZE);
+    for (uint32_t workerNum : WORKER_NUMS) {
+        double single = RunSingleFrames(outputs, workerNum, frameNum);
+        double batch = RunBatches(outputs, workerNum, frameNum);
+        std::printf("%7u  %21.3f  %17.3f\n", workerNum, single, batch);
+    }
+    aclrtDestroyContext(g_context);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return 0;
+}
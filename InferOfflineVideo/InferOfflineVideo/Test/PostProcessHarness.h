@@ -0,0 +1,168 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POST_PROCESS_HARNESS_H
+#define POST_PROCESS_HARNESS_H
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "acl/acl.h"
+#include "PostProcess/PostProcess.h"
+#include "TestCommon.h"
+
+// PostProcess driven without the rest of the pipeline. The frames carry the outputs of a yolov3 model on host, as
+// an asynchronous ModelInfer sends them, and a ResultRecorder keeps the objects of every frame in the order they
+// are published instead of writing and streaming them
+const int HARNESS_NET_SIZE = 416;
+const int HARNESS_IMAGE_WIDTH = 1920;
+const int HARNESS_IMAGE_HEIGHT = 1080;
+const uint32_t HARNESS_YOLO_STRIDES[] = {32, 16, 8};
+const int HARNESS_CLASS_NUM = 80;
+const int YOLOV3_TF_MODEL = 1;
+
+// The float outputs of one frame, random logits of which a few percent of the anchors pass the objectness
+typedef std::vector<std::vector<float>> YoloOutputs;
+
+inline YoloOutputs MakeYoloOutputs(std::mt19937 &random)
+{
+    const float logitLimit = 9.0f;
+    std::normal_distribution<float> logits(-4.0f, 2.5f);
+    YoloOutputs outputs;
+    for (uint32_t stride : HARNESS_YOLO_STRIDES) {
+        size_t grid = HARNESS_NET_SIZE / stride;
+        std::vector<float> layer(grid * grid * ANCHOR_DIM * (BOX_DIM + 1 + HARNESS_CLASS_NUM));
+        for (float &value : layer) {
+            value = std::max(-logitLimit, std::min(logitLimit, logits(random)));
+        }
+        outputs.push_back(std::move(layer));
+    }
+    return outputs;
+}
+
+// Sets the output sizes and types of the model, which PostProcess::Init takes from ModelInfer
+inline void SetYoloModelOutputs(const YoloOutputs &outputs)
+{
+    ModelBufferSize::outputSize_ = static_cast<int>(outputs.size());
+    ModelBufferSize::bufferSize_.clear();
+    ModelBufferSize::dataType_.clear();
+    for (const std::vector<float> &output : outputs) {
+        ModelBufferSize::bufferSize_.push_back(output.size() * sizeof(float));
+        ModelBufferSize::dataType_.push_back(ACL_FLOAT);
+    }
+}
+
+// A frame of the outputs, which must outlive it
+inline std::shared_ptr<CommonData> MakeYoloFrame(uint32_t channelId, uint32_t frameId, YoloOutputs &outputs)
+{
+    std::shared_ptr<CommonData> frame = std::make_shared<CommonData>();
+    frame->eof = false;
+    frame->channelId = channelId;
+    frame->frameId = frameId;
+    frame->hostOutput = true;
+    frame->modelType = YOLOV3_TF_MODEL;
+    frame->yoloImgInfo = {HARNESS_NET_SIZE, HARNESS_NET_SIZE, HARNESS_IMAGE_WIDTH, HARNESS_IMAGE_HEIGHT};
+    for (std::vector<float> &output : outputs) {
+        frame->inferOutput.push_back(RawData {output.size() * sizeof(float),
+                                              std::shared_ptr<void>(std::shared_ptr<void>(), output.data())});
+    }
+    return frame;
+}
+
+// Writes the config of one PostProcess for HARNESS_CLASS_NUM classes, lines are "key = value" added to it.
+// Returns the config file name
+inline std::string WritePostProcessConfig(const std::string &name, const std::vector<std::string> &lines)
+{
+    std::string configPath = name + ".cfg";
+    std::ofstream config(configPath.c_str());
+    config << "SystemConfig.deviceId = 0\n";
+    config << "PostProcess.classNum = " << HARNESS_CLASS_NUM << "\n";
+    for (const std::string &line : lines) {
+        config << line << "\n";
+    }
+    return configPath;
+}
+
+// PostProcess whose results are recorded, and whose ProcessData and ProcessBatch can be called by the test
+class ResultRecorder : public PostProcess {
+public:
+    struct Result {
+        uint32_t channelId;
+        uint32_t frameId;
+        std::vector<ObjDetectInfo> objInfos;
+    };
+
+    APP_ERROR InitConfig(const std::string &configPath, aclrtContext context, uint32_t popBatchSize)
+    {
+        ConfigParser configParser;
+        APP_ERROR ret = configParser.ParseConfig(configPath);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        ascendBaseModule::ModuleInitArgs initArgs;
+        initArgs.context = context;
+        initArgs.pipelineName = "test";
+        initArgs.moduleName = "PostProcess";
+        initArgs.instanceId = 0;
+        initArgs.popBatchSize = popBatchSize;
+        return PostProcess::Init(configParser, initArgs);
+    }
+
+    APP_ERROR RunFrame(std::shared_ptr<CommonData> frame)
+    {
+        return ProcessData(frame);
+    }
+
+    APP_ERROR RunBatch(std::vector<std::shared_ptr<void>> &frames)
+    {
+        return ProcessBatch(frames);
+    }
+
+    std::vector<Result> GetResults()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return results_;
+    }
+
+    size_t GetResultNum()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return results_.size();
+    }
+
+    void ClearResults()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.clear();
+    }
+
+protected:
+    APP_ERROR SendResult(const CommonData &data, const std::vector<ObjDetectInfo> &objInfos)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.push_back({data.channelId, data.frameId, objInfos});
+        return APP_ERR_OK;
+    }
+
+private:
+    std::mutex mutex_ = {};
+    std::vector<Result> results_ = {};
+};
+
+#endif
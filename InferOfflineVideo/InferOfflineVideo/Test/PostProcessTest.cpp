@@ -0,0 +1,159 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+#include <cstring>
+#include <map>
+#include "BlockingQueue/RingQueue.h"
+#include "PostProcessHarness.h"
+
+// The frames of a batch decoded on the task pool are published in the order they were queued, so the frames of
+// every channel stay in order, and each one with the objects a single frame decode finds for it
+namespace {
+const size_t OUTPUT_SET_NUM = 4;  // different outputs, the frames take them in turn
+const uint32_t CHANNEL_NUM = 3;
+const uint32_t FRAME_NUM = 29;    // 3 full batches of 8 and a partial one
+const uint32_t POP_BATCH_SIZE = 8;
+const size_t QUEUE_SIZE = 64;
+const double RESULT_TIMEOUT_S = 30.0;
+
+aclrtContext g_context = nullptr;
+std::vector<YoloOutputs> g_outputs;
+// objects of each output set decoded one frame at a time without task pool
+std::vector<std::vector<ObjDetectInfo>> g_expected;
+
+struct QueuedFrame {
+    uint32_t channelId;
+    uint32_t frameId;
+    size_t outputSet;
+};
+
+// the channels interleaved at random, the frame ids of each channel counting up
+std::vector<QueuedFrame> MakeFrameOrder(uint32_t frameNum)
+{
+    std::mt19937 random(7);
+    std::vector<uint32_t> nextFrameIds(CHANNEL_NUM, 0);
+    std::vector<QueuedFrame> frames;
+    for (uint32_t i = 0; i < frameNum; i++) {
+        uint32_t channelId = random() % CHANNEL_NUM;
+        frames.push_back({channelId, nextFrameIds[channelId]++, i % OUTPUT_SET_NUM});
+    }
+    return frames;
+}
+
+bool SameObjects(const std::vector<ObjDetectInfo> &objInfos, const std::vector<ObjDetectInfo> &expected)
+{
+    return objInfos.size() == expected.size() &&
+        std::memcmp(objInfos.data(), expected.data(), expected.size() * sizeof(ObjDetectInfo)) == 0;
+}
+
+void CheckResults(ResultRecorder &recorder, const std::vector<QueuedFrame> &frames)
+{
+    std::vector<ResultRecorder::Result> results = recorder.GetResults();
+    TEST_CHECK(results.size() == frames.size());
+    std::map<uint32_t, uint32_t> nextFrameIds;
+    for (size_t i = 0; i < results.size() && i < frames.size(); i++) {
+        TEST_CHECK(results[i].channelId == frames[i].channelId && results[i].frameId == frames[i].frameId);
+        TEST_CHECK(results[i].frameId == nextFrameIds[results[i].channelId]++);
+        TEST_CHECK(SameObjects(results[i].objInfos, g_expected[frames[i].outputSet]));
+    }
+}
+
+void DecodeExpected()
+{
+    std::mt19937 random(1);
+    for (size_t i = 0; i < OUTPUT_SET_NUM; i++) {
+        g_outputs.push_back(MakeYoloOutputs(random));
+    }
+    SetYoloModelOutputs(g_outputs[0]);
+    ResultRecorder recorder;
+    std::string config = WritePostProcessConfig("PostProcessTest_single", {});
+    TEST_CHECK(recorder.InitConfig(config, g_context, 1) == APP_ERR_OK);
+    for (size_t i = 0; i < OUTPUT_SET_NUM; i++) {
+        TEST_CHECK(recorder.RunFrame(MakeYoloFrame(0, i, g_outputs[i])) == APP_ERR_OK);
+    }
+    for (const ResultRecorder::Result &result : recorder.GetResults()) {
+        g_expected.push_back(result.objInfos);
+    }
+    recorder.DeInit();
+    TEST_CHECK(g_expected.size() == OUTPUT_SET_NUM && !g_expected[0].empty());
+}
+
+// Batches of every size up to popBatchSize, with and without an eof among the frames
+void TestBatchSizes()
+{
+    std::string config = WritePostProcessConfig("PostProcessTest_batch", {"PostProcess.decodeThreadNum = 4"});
+    ResultRecorder recorder;
+    TEST_CHECK(recorder.InitConfig(config, g_context, POP_BATCH_SIZE) == APP_ERR_OK);
+    for (uint32_t batchSize = 1; batchSize <= POP_BATCH_SIZE; batchSize++) {
+        for (bool withEof : {false, true}) {
+            std::vector<QueuedFrame> frames = MakeFrameOrder(batchSize);
+            std::vector<std::shared_ptr<void>> batch;
+            for (const QueuedFrame &frame : frames) {
+                batch.push_back(MakeYoloFrame(frame.channelId, frame.frameId, g_outputs[frame.outputSet]));
+            }
+            if (withEof) {
+                std::shared_ptr<CommonData> eof = std::make_shared<CommonData>();
+                eof->eof = true;
+                batch.insert(batch.begin() + batchSize / 2, eof);
+                batch.resize(std::min<size_t>(batch.size(), POP_BATCH_SIZE));
+                frames.resize(batch.size() - 1);
+            }
+            recorder.ClearResults();
+            TEST_CHECK(recorder.RunBatch(batch) == APP_ERR_OK);
+            CheckResults(recorder, frames);
+        }
+    }
+    recorder.DeInit();
+}
+
+// The module thread pops the queued frames in batches of popBatchSize
+void TestQueuedChannels()
+{
+    std::string config = WritePostProcessConfig("PostProcessTest_queue", {"PostProcess.decodeThreadNum = 4"});
+    ResultRecorder recorder;
+    TEST_CHECK(recorder.InitConfig(config, g_context, POP_BATCH_SIZE) == APP_ERR_OK);
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> input =
+        std::make_shared<MpmcRingQueue<std::shared_ptr<void>>>(QUEUE_SIZE);
+    recorder.SetInputVec(input);
+    std::vector<QueuedFrame> frames = MakeFrameOrder(FRAME_NUM);
+    for (const QueuedFrame &frame : frames) {
+        input->Push(MakeYoloFrame(frame.channelId, frame.frameId, g_outputs[frame.outputSet]), true);
+    }
+    recorder.Run();
+    double deadline = NowSeconds() + RESULT_TIMEOUT_S;
+    while (recorder.GetResultNum() < frames.size() && NowSeconds() < deadline) {
+        usleep(1000);
+    }
+    recorder.Stop();
+    CheckResults(recorder, frames);
+    recorder.DeInit();
+}
+}
+
+int main()
+{
+    aclInit(nullptr);
+    aclrtSetDevice(0);
+    aclrtCreateContext(&g_context, 0);
+    DecodeExpected();
+    TEST_RUN(TestBatchSizes);
+    TEST_RUN(TestQueuedChannels);
+    aclrtDestroyContext(g_context);
+    aclrtResetDevice(0);
+    aclFinalize();
+    return TestResult();
+}
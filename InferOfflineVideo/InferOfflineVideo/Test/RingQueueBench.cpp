@@ -0,0 +1,86 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BlockingQueue/RingQueue.h"
+#include "TestCommon.h"
+
+// Throughput of the module link queues, in ns per item moved from the producers to the consumers.
+// Usage: RingQueueBench [items per producer]
+namespace {
+const uint32_t QUEUE_SIZE = 32;     // same order as the default link queue size
+const uint32_t POP_BATCH_SIZE = 8;
+
+template<typename Queue> double Run(int producerNum, int consumerNum, size_t itemsPerProducer, bool popBatch)
+{
+    Queue queue(QUEUE_SIZE);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> popped {0};
+    const size_t total = itemsPerProducer * producerNum;
+    double start = NowSeconds();
+    for (int p = 0; p < producerNum; ++p) {
+        threads.emplace_back([&queue, itemsPerProducer]() {
+            std::shared_ptr<void> item = std::make_shared<int>(0);
+            for (size_t i = 0; i < itemsPerProducer; ++i) {
+                queue.Push(item, true);
+            }
+        });
+    }
+    for (int c = 0; c < consumerNum; ++c) {
+        threads.emplace_back([&queue, &popped, total, popBatch]() {
+            std::shared_ptr<void> item;
+            std::vector<std::shared_ptr<void>> items;
+            while (popped.load(std::memory_order_relaxed) < total) {
+                if (popBatch) {
+                    if (queue.PopBatch(items, POP_BATCH_SIZE, 1) == APP_ERR_OK) {
+                        popped += items.size();
+                    }
+                } else if (queue.Pop(item, 1) == APP_ERR_OK) {
+                    popped++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return (NowSeconds() - start) * 1e9 / total;
+}
+
+template<typename Queue> void Report(const char *name, int producerNum, int consumerNum, size_t itemsPerProducer)
+{
+    double pop = Run<Queue>(producerNum, consumerNum, itemsPerProducer, false);
+    double popBatch = Run<Queue>(producerNum, consumerNum, itemsPerProducer, true);
+    std::printf("%-9s %dP/%dC  Pop %7.1f ns/item  PopBatch(%u) %7.1f ns/item\n", name, producerNum, consumerNum, pop,
+        POP_BATCH_SIZE, popBatch);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    size_t itemsPerProducer = BenchIterations(argc, argv, 1000000);
+    typedef std::shared_ptr<void> Item;
+    Report<SpscRingQueue<Item>>("spsc", 1, 1, itemsPerProducer);
+    Report<MpmcRingQueue<Item>>("mpmc", 1, 1, itemsPerProducer);
+    Report<BlockingQueue<Item>>("blocking", 1, 1, itemsPerProducer);
+    Report<MpmcRingQueue<Item>>("mpmc", 4, 1, itemsPerProducer / 4);
+    Report<BlockingQueue<Item>>("blocking", 4, 1, itemsPerProducer / 4);
+    Report<MpmcRingQueue<Item>>("mpmc", 4, 4, itemsPerProducer / 4);
+    Report<BlockingQueue<Item>>("blocking", 4, 4, itemsPerProducer / 4);
+    return 0;
+}
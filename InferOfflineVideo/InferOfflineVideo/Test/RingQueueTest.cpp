@@ -0,0 +1,308 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BlockingQueue/RingQueue.h"
+#include "TestCommon.h"
+
+namespace {
+const uint32_t SMALL_QUEUE_SIZE = 4; // small enough for the producers to fill the queue and wait
+const uint64_t ITEMS_PER_PRODUCER = 100000;
+const int PRODUCER_NUM = 4;
+const int CONSUMER_NUM = 4;
+const int BLOCK_TIME_MS = 50;        // time given to a thread to block in Pop or Push before the queue is stopped
+
+// Items are producer << 32 | sequence, starting from sequence 1 so an empty item is never valid
+uint64_t MakeItem(uint64_t producer, uint64_t sequence)
+{
+    return (producer << 32) | sequence;
+}
+
+template<typename Queue> void TestSingleProducerOrder()
+{
+    Queue queue(SMALL_QUEUE_SIZE);
+    std::thread producer([&queue]() {
+        for (uint64_t i = 1; i <= ITEMS_PER_PRODUCER; ++i) {
+            queue.Push(i, true);
+        }
+    });
+    uint64_t expected = 1;
+    bool inOrder = true;
+    for (uint64_t i = 1; i <= ITEMS_PER_PRODUCER; ++i) {
+        uint64_t item = 0;
+        if (queue.Pop(item) != APP_ERR_OK || item != expected) {
+            inOrder = false;
+            break;
+        }
+        expected++;
+    }
+    producer.join();
+    TEST_CHECK(inOrder);
+    TEST_CHECK(queue.GetSize() == 0);
+}
+
+// Every item arrives exactly once, and a consumer sees the items of one producer in the order they were pushed
+template<typename Queue> void TestMultiProducerOrder()
+{
+    Queue queue(SMALL_QUEUE_SIZE);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCER_NUM; ++p) {
+        threads.emplace_back([&queue, p]() {
+            for (uint64_t i = 1; i <= ITEMS_PER_PRODUCER; ++i) {
+                queue.Push(MakeItem(p, i), true);
+            }
+        });
+    }
+    std::atomic<uint64_t> popped {0};
+    std::atomic<int> orderErrors {0};
+    std::vector<std::vector<uint64_t>> counts(CONSUMER_NUM, std::vector<uint64_t>(PRODUCER_NUM, 0));
+    const uint64_t total = ITEMS_PER_PRODUCER * PRODUCER_NUM;
+    for (int c = 0; c < CONSUMER_NUM; ++c) {
+        threads.emplace_back([&, c]() {
+            std::vector<uint64_t> last(PRODUCER_NUM, 0);
+            while (popped.load() < total) {
+                uint64_t item = 0;
+                if (queue.Pop(item, 1) != APP_ERR_OK) {
+                    continue;
+                }
+                popped++;
+                uint64_t p = item >> 32;
+                uint64_t sequence = item & 0xffffffffULL;
+                if (p >= PRODUCER_NUM || sequence <= last[p]) {
+                    orderErrors++;
+                    continue;
+                }
+                last[p] = sequence;
+                counts[c][p]++;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    TEST_CHECK(orderErrors.load() == 0);
+    for (int p = 0; p < PRODUCER_NUM; ++p) {
+        uint64_t received = 0;
+        for (int c = 0; c < CONSUMER_NUM; ++c) {
+            received += counts[c][p];
+        }
+        TEST_CHECK(received == ITEMS_PER_PRODUCER);
+    }
+}
+
+template<typename Queue> void TestPopBatch()
+{
+    const uint32_t itemNum = 10;
+    const uint32_t maxItems = 4;
+    Queue queue(16);
+    for (uint64_t i = 1; i <= itemNum; ++i) {
+        TEST_CHECK(queue.Push(i) == APP_ERR_OK);
+    }
+    std::vector<uint64_t> items;
+    uint64_t expected = 1;
+    while (expected <= itemNum) {
+        TEST_CHECK(queue.PopBatch(items, maxItems, 0) == APP_ERR_OK);
+        TEST_CHECK(!items.empty() && items.size() <= maxItems);
+        for (uint64_t item : items) {
+            TEST_CHECK(item == expected);
+            expected++;
+        }
+        if (items.empty()) {
+            break;
+        }
+    }
+    TEST_CHECK(queue.PopBatch(items, maxItems, 1) == APP_ERR_QUEUE_EMPTY);
+    TEST_CHECK(items.empty());
+
+    // the batch takes what is queued, it does not wait to fill up
+    TEST_CHECK(queue.Push(uint64_t(1)) == APP_ERR_OK);
+    TEST_CHECK(queue.PopBatch(items, maxItems, 0) == APP_ERR_OK);
+    TEST_CHECK(items.size() == 1);
+
+    // a blocked batch pop is woken by the first push
+    std::thread producer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(BLOCK_TIME_MS));
+        queue.Push(uint64_t(7), true);
+    });
+    TEST_CHECK(queue.PopBatch(items, maxItems, 10000) == APP_ERR_OK);
+    TEST_CHECK(items.size() == 1 && items[0] == 7);
+    producer.join();
+}
+
+template<typename Queue> void TestStopWhileBlocked()
+{
+    Queue queue(SMALL_QUEUE_SIZE);
+    APP_ERROR popRet = APP_ERR_OK;
+    APP_ERROR batchRet = APP_ERR_OK;
+    std::thread consumer([&queue, &popRet]() {
+        uint64_t item = 0;
+        popRet = queue.Pop(item);
+    });
+    std::thread batchConsumer([&queue, &batchRet]() {
+        std::vector<uint64_t> items;
+        batchRet = queue.PopBatch(items, SMALL_QUEUE_SIZE, 100000);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(BLOCK_TIME_MS));
+    queue.Stop();
+    consumer.join();
+    batchConsumer.join();
+    TEST_CHECK(popRet == APP_ERR_QUEUE_STOPED);
+    TEST_CHECK(batchRet == APP_ERR_QUEUE_STOPED);
+
+    queue.Restart();
+    uint64_t item = 1;
+    while (queue.Push(item) == APP_ERR_OK) {
+        item++;
+    }
+    TEST_CHECK(queue.IsFull());
+    APP_ERROR pushRet = APP_ERR_OK;
+    std::thread producer([&queue, &pushRet]() {
+        pushRet = queue.Push(uint64_t(0), true);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(BLOCK_TIME_MS));
+    queue.Stop();
+    producer.join();
+    TEST_CHECK(pushRet == APP_ERR_QUEUE_STOPED);
+    TEST_CHECK(queue.Push(uint64_t(0)) == APP_ERR_QUEUE_STOPED);
+    TEST_CHECK(queue.Pop(item, 0) == APP_ERR_QUEUE_STOPED);
+}
+
+// A timed pop of an empty queue waits for its whole timeout, also when it is shorter than the rounding of the clock
+template<typename Queue> void TestTimedPop()
+{
+    const unsigned int timeOutMs[] = {1, 20};
+    Queue queue(SMALL_QUEUE_SIZE);
+    for (unsigned int timeOut : timeOutMs) {
+        uint64_t item = 0;
+        double start = NowSeconds();
+        TEST_CHECK(queue.Pop(item, timeOut) == APP_ERR_QUEUE_EMPTY);
+        TEST_CHECK((NowSeconds() - start) * 1000 >= timeOut);
+    }
+}
+
+template<typename Queue> void TestRingCapacity()
+{
+    Queue queue(3); // rounded up to 4
+    for (uint64_t i = 1; i <= 4; ++i) {
+        TEST_CHECK(queue.Push(i) == APP_ERR_OK);
+    }
+    TEST_CHECK(queue.Push(uint64_t(5)) == APP_ERROR_QUEUE_FULL);
+    TEST_CHECK(queue.GetSize() == 4);
+    uint64_t item = 0;
+    TEST_CHECK(queue.Pop(item, 0) == APP_ERR_OK && item == 1);
+    TEST_CHECK(queue.Push(uint64_t(5)) == APP_ERR_OK);
+
+    Queue tiny(1); // at least RING_MIN_CAPACITY
+    TEST_CHECK(tiny.Push(uint64_t(1)) == APP_ERR_OK);
+    TEST_CHECK(tiny.Push(uint64_t(2)) == APP_ERR_OK);
+    TEST_CHECK(tiny.Push(uint64_t(3)) == APP_ERROR_QUEUE_FULL);
+}
+
+// A push of an rvalue which fails leaves the item untouched, so the caller can keep it or retry
+template<typename Queue> void TestFailedPushKeepsItem()
+{
+    Queue queue(RING_MIN_CAPACITY);
+    while (queue.Push(std::make_shared<int>(0)) == APP_ERR_OK) {
+    }
+    std::shared_ptr<int> item = std::make_shared<int>(1);
+    TEST_CHECK(queue.Push(std::move(item)) == APP_ERROR_QUEUE_FULL);
+    TEST_CHECK(item != nullptr && *item == 1);
+}
+
+// The push listener runs after the item is visible to the consumer
+template<typename Queue> void TestPushListener()
+{
+    Queue queue(SMALL_QUEUE_SIZE);
+    int notified = 0;
+    bool visible = true;
+    queue.SetPushListener([&queue, &notified, &visible]() {
+        notified++;
+        visible = visible && queue.GetSize() > 0;
+    });
+    TEST_CHECK(queue.Push(uint64_t(1)) == APP_ERR_OK);
+    TEST_CHECK(queue.Push(uint64_t(2)) == APP_ERR_OK);
+    TEST_CHECK(notified == 2);
+    TEST_CHECK(visible);
+}
+
+void TestSpscOrder()
+{
+    TestSingleProducerOrder<SpscRingQueue<uint64_t>>();
+}
+
+void TestMpmcOrder()
+{
+    TestSingleProducerOrder<MpmcRingQueue<uint64_t>>();
+    TestMultiProducerOrder<MpmcRingQueue<uint64_t>>();
+}
+
+void TestBlockingQueueOrder()
+{
+    TestSingleProducerOrder<BlockingQueue<uint64_t>>();
+    TestMultiProducerOrder<BlockingQueue<uint64_t>>();
+}
+
+void TestPopBatchAll()
+{
+    TestPopBatch<SpscRingQueue<uint64_t>>();
+    TestPopBatch<MpmcRingQueue<uint64_t>>();
+    TestPopBatch<BlockingQueue<uint64_t>>();
+}
+
+void TestStopAll()
+{
+    TestStopWhileBlocked<SpscRingQueue<uint64_t>>();
+    TestStopWhileBlocked<MpmcRingQueue<uint64_t>>();
+    TestStopWhileBlocked<BlockingQueue<uint64_t>>();
+}
+
+void TestTimedPopAll()
+{
+    TestTimedPop<SpscRingQueue<uint64_t>>();
+    TestTimedPop<MpmcRingQueue<uint64_t>>();
+    TestTimedPop<BlockingQueue<uint64_t>>();
+}
+
+void TestCapacity()
+{
+    TestRingCapacity<SpscRingQueue<uint64_t>>();
+    TestRingCapacity<MpmcRingQueue<uint64_t>>();
+    TestFailedPushKeepsItem<SpscRingQueue<std::shared_ptr<int>>>();
+    TestFailedPushKeepsItem<MpmcRingQueue<std::shared_ptr<int>>>();
+}
+
+void TestListener()
+{
+    TestPushListener<SpscRingQueue<uint64_t>>();
+    TestPushListener<MpmcRingQueue<uint64_t>>();
+}
+}
+
+int main()
+{
+    TEST_RUN(TestSpscOrder);
+    TEST_RUN(TestMpmcOrder);
+    TEST_RUN(TestBlockingQueueOrder);
+    TEST_RUN(TestPopBatchAll);
+    TEST_RUN(TestStopAll);
+    TEST_RUN(TestTimedPopAll);
+    TEST_RUN(TestCapacity);
+    TEST_RUN(TestListener);
+    return TestResult();
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks shared by the tests, a failed check is reported and the test goes on, main returns TestResult()
+inline int &TestFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define TEST_CHECK(cond)                                                                            \
+    do {                                                                                            \
+        if (!(cond)) {                                                                              \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                    \
+            TestFailures()++;                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define TEST_CHECK_NEAR(a, b, tolerance)                                                            \
+    do {                                                                                            \
+        double testA_ = (a);                                                                        \
+        double testB_ = (b);                                                                        \
+        if (!(testA_ - testB_ <= (tolerance) && testB_ - testA_ <= (tolerance))) {                  \
+            std::printf("%s:%d: check failed: %s = %g, %s = %g, tolerance %g\n", __FILE__,          \
+                __LINE__, #a, testA_, #b, testB_, static_cast<double>(tolerance));                  \
+            TestFailures()++;                                                                       \
+        }                                                                                           \
+    } while (0)
+
+// Run one test function and print its name, so a failed check can be told apart from the others
+#define TEST_RUN(test)                                                                              \
+    do {                                                                                            \
+        int failuresBefore_ = TestFailures();                                                       \
+        test();                                                                                     \
+        std::printf("[%s] %s\n", TestFailures() == failuresBefore_ ? "PASS" : "FAIL", #test);       \
+    } while (0)
+
+inline int TestResult()
+{
+    return TestFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+inline double NowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Benchmarks take the iteration count from the first argument, so a short run can be done by hand or under a sanitizer
+inline size_t BenchIterations(int argc, char *argv[], size_t defaultIterations)
+{
+    if (argc > 1) {
+        long iterations = std::atol(argv[1]);
+        if (iterations > 0) {
+            return static_cast<size_t>(iterations);
+        }
+    }
+    return defaultIterations;
+}
+
+#endif
@@ -0,0 +1,334 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+#include "PostProcess/FastMath.h"
+#include "PostProcess/YoloDecoder.h"
+#include "TestCommon.h"
+
+// YoloDecoder::Decode of FLOAT16, INT8 and UINT8 outputs. Decoded in their type, they give exactly the boxes of
+// the FLOAT32 outputs of the same values, and the boxes of the original FLOAT32 outputs within the error of the
+// conversion. The objectness limit of the quantized outputs keeps every anchor the objectness check would keep
+namespace {
+const int NET_SIZE = 416;
+const uint32_t YOLOV3_STRIDES[] = {32, 16, 8};
+const int YOLOV3_CLASS_NUM = 80;
+const float LOGIT_LIMIT = 9.0f;  // the values of the outputs are within it, so the quantized ones do not saturate
+const float INT8_SCALE = 0.08f;
+const float INT8_ZERO_POINT = 3.0f;
+const float UINT8_ZERO_POINT = 131.0f;
+const float HALF_LOGIT_ERROR = 0.004f;  // rounding to half of values below 16
+const float QUANT_LOGIT_ERROR = INT8_SCALE / 2;
+const float FAST_MATH_ERROR = 1e-4f;    // of fastmath::sigmoid and exp, used by every type
+const float SCORE_THRESH_DEFAULT = 0.3f;
+const size_t MIN_BOX_NUM = 100;         // boxes of the random outputs, so the comparisons are not empty
+
+typedef std::vector<std::vector<float>> Outputs;
+
+Outputs MakeOutputs(std::mt19937 &random, const std::vector<uint32_t> &strides, int classNum)
+{
+    std::normal_distribution<float> logits(-4.0f, 2.5f);
+    Outputs outputs;
+    for (uint32_t stride : strides) {
+        size_t grid = NET_SIZE / stride;
+        std::vector<float> output(grid * grid * ANCHOR_DIM * (BOX_DIM + 1 + classNum));
+        for (float &value : output) {
+            value = std::max(-LOGIT_LIMIT, std::min(LOGIT_LIMIT, logits(random)));
+        }
+        outputs.push_back(std::move(output));
+    }
+    return outputs;
+}
+
+// float to half rounded to nearest, the values below the normal halves become zero
+uint16_t FloatToHalf(float value)
+{
+    const int32_t exponentRebias = 127 - 15; // exponent bias of float and half
+    const int32_t halfExponentMax = 31;
+    const uint32_t halfMaxFinite = 0x7bff;
+    const int mantissaShift = 13;            // mantissa bits of float - half
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - exponentRebias;
+    if (exponent <= 0) {
+        return static_cast<uint16_t>(sign);
+    }
+    // the exponent bits follow the mantissa, so a carry of the rounding goes into the exponent
+    uint32_t magnitude = (static_cast<uint32_t>(exponent) << 10) | ((bits >> mantissaShift) & 0x3ff);
+    uint32_t rest = bits & ((1U << mantissaShift) - 1);
+    const uint32_t halfWay = 1U << (mantissaShift - 1);
+    if (rest > halfWay || (rest == halfWay && (magnitude & 1) != 0)) {
+        magnitude++;
+    }
+    if ((magnitude >> 10) >= static_cast<uint32_t>(halfExponentMax)) {
+        magnitude = halfMaxFinite;
+    }
+    return static_cast<uint16_t>(sign | magnitude);
+}
+
+template<typename T> T Quantize(float value, const YoloOutputFormat &format)
+{
+    float q = std::round(value / format.scale + format.zeroPoint);
+    q = std::min<float>(std::numeric_limits<T>::max(), q);
+    return static_cast<T>(std::max<float>(std::numeric_limits<T>::min(), q));
+}
+
+template<typename T> float Dequantize(T q, const YoloOutputFormat &format)
+{
+    return (q - format.zeroPoint) * format.scale;
+}
+
+// An output converted to one type, with its values converted back to float
+struct Converted {
+    std::vector<std::shared_ptr<void>> data;
+    std::vector<size_t> sizes;
+    std::vector<std::shared_ptr<void>> floatData;
+    std::vector<size_t> floatSizes;
+};
+
+template<typename T> void AddOutput(Converted &converted, const std::vector<T> &values,
+                                    const std::vector<float> &floats)
+{
+    std::shared_ptr<std::vector<T>> copy = std::make_shared<std::vector<T>>(values);
+    converted.data.push_back(std::shared_ptr<void>(copy, copy->data()));
+    converted.sizes.push_back(values.size() * sizeof(T));
+    std::shared_ptr<std::vector<float>> floatCopy = std::make_shared<std::vector<float>>(floats);
+    converted.floatData.push_back(std::shared_ptr<void>(floatCopy, floatCopy->data()));
+    converted.floatSizes.push_back(floats.size() * sizeof(float));
+}
+
+Converted Convert(const Outputs &outputs, const YoloOutputFormat &format)
+{
+    Converted converted;
+    for (const std::vector<float> &output : outputs) {
+        std::vector<float> floats(output.size());
+        if (format.type == YOLO_TENSOR_FLOAT32) {
+            AddOutput(converted, output, output);
+        } else if (format.type == YOLO_TENSOR_FLOAT16) {
+            std::vector<uint16_t> halves(output.size());
+            for (size_t i = 0; i < output.size(); i++) {
+                halves[i] = FloatToHalf(output[i]);
+                floats[i] = fastmath::HalfToFloat(halves[i]);
+            }
+            AddOutput(converted, halves, floats);
+        } else if (format.type == YOLO_TENSOR_INT8) {
+            std::vector<int8_t> bytes(output.size());
+            for (size_t i = 0; i < output.size(); i++) {
+                bytes[i] = Quantize<int8_t>(output[i], format);
+                floats[i] = Dequantize(bytes[i], format);
+            }
+            AddOutput(converted, bytes, floats);
+        } else {
+            std::vector<uint8_t> bytes(output.size());
+            for (size_t i = 0; i < output.size(); i++) {
+                bytes[i] = Quantize<uint8_t>(output[i], format);
+                floats[i] = Dequantize(bytes[i], format);
+            }
+            AddOutput(converted, bytes, floats);
+        }
+    }
+    return converted;
+}
+
+std::vector<DetectBox> Decode(YoloDecoderConfig config, const YoloOutputFormat &format,
+                              const std::vector<std::shared_ptr<void>> &data, const std::vector<size_t> &sizes)
+{
+    config.outputFormats.assign(config.strides.empty() ? sizeof(YOLOV3_STRIDES) / sizeof(YOLOV3_STRIDES[0]) :
+        config.strides.size(), format);
+    YoloDecoder decoder;
+    std::vector<DetectBox> boxes;
+    TEST_CHECK(decoder.Init(config) == APP_ERR_OK);
+    TEST_CHECK(decoder.Decode(data, sizes, NET_SIZE, NET_SIZE, boxes) == APP_ERR_OK);
+    return boxes;
+}
+
+bool SameBoxes(const std::vector<DetectBox> &boxes, const std::vector<DetectBox> &expected)
+{
+    return boxes.size() == expected.size() &&
+        std::memcmp(boxes.data(), expected.data(), expected.size() * sizeof(DetectBox)) == 0;
+}
+
+YoloOutputFormat MakeFormat(YoloTensorType type)
+{
+    YoloOutputFormat format;
+    format.type = type;
+    if (type == YOLO_TENSOR_INT8 || type == YOLO_TENSOR_UINT8) {
+        format.scale = INT8_SCALE;
+        format.zeroPoint = (type == YOLO_TENSOR_INT8) ? INT8_ZERO_POINT : UINT8_ZERO_POINT;
+    }
+    return format;
+}
+
+// The outputs decoded in their type and the float outputs of their values give the same boxes in the same order
+void TestSameAsFloatValues()
+{
+    std::mt19937 random(1);
+    std::vector<uint32_t> strides(std::begin(YOLOV3_STRIDES), std::end(YOLOV3_STRIDES));
+    Outputs outputs = MakeOutputs(random, strides, YOLOV3_CLASS_NUM);
+    YoloDecoderConfig config;
+    config.classNum = YOLOV3_CLASS_NUM;
+    for (YoloTensorType type : {YOLO_TENSOR_FLOAT16, YOLO_TENSOR_INT8, YOLO_TENSOR_UINT8}) {
+        YoloOutputFormat format = MakeFormat(type);
+        Converted converted = Convert(outputs, format);
+        std::vector<DetectBox> boxes = Decode(config, format, converted.data, converted.sizes);
+        std::vector<DetectBox> expected = Decode(config, YoloOutputFormat(), converted.floatData,
+                                                 converted.floatSizes);
+        TEST_CHECK(expected.size() >= MIN_BOX_NUM);
+        TEST_CHECK(SameBoxes(boxes, expected));
+    }
+}
+
+/*
+ * Every byte as the objectness of an anchor of a quantized layer, for scales, zero points and thresholds which put
+ * the objectness limit of BuildLayers (the floor of the threshold logit in bytes) below, inside and above the
+ * bytes. The class logit is the largest byte and the score threshold 0, so nearly every anchor passing the
+ * objectness check is a box, as many as fastmath::sigmoid of their values finds
+ */
+void TestObjectnessLimit()
+{
+    const int byteNum = 256;
+    const float scales[] = {0.001f, 0.01f, 0.0625f, 0.08f, 0.3f, 1.0f, 4.0f};
+    const float zeroPoints[] = {-128.0f, -3.0f, 0.0f, 3.5f, 127.0f, 200.0f};
+    const float objectnessThreshs[] = {0.0f, 0.001f, 0.3f, 0.5f, 0.73f, 0.999f};
+    YoloDecoderConfig config;
+    config.classNum = 1;
+    config.strides = {YOLOV3_STRIDES[0]};
+    config.anchors = {116, 90, 156, 198, 373, 326};
+    config.scoreThresh = {0.0f};
+    const size_t grid = NET_SIZE / config.strides[0];
+    const size_t anchorNum = grid * grid * ANCHOR_DIM;
+    const size_t anchorSize = BOX_DIM + 1 + config.classNum;
+    int mismatches = 0;
+    for (YoloTensorType type : {YOLO_TENSOR_INT8, YOLO_TENSOR_UINT8}) {
+        for (float scale : scales) {
+            for (float zeroPoint : zeroPoints) {
+                YoloOutputFormat format;
+                format.type = type;
+                format.scale = scale;
+                format.zeroPoint = zeroPoint;
+                std::vector<uint8_t> bytes(anchorNum * anchorSize, 0);
+                for (size_t anchor = 0; anchor < anchorNum; anchor++) {
+                    bytes[anchor * anchorSize + BOX_DIM] = static_cast<uint8_t>(anchor % byteNum);
+                    bytes[anchor * anchorSize + BOX_DIM + 1] = (type == YOLO_TENSOR_INT8) ? 0x7f : 0xff;
+                }
+                std::vector<float> floats(bytes.size());
+                for (size_t i = 0; i < bytes.size(); i++) {
+                    floats[i] = (type == YOLO_TENSOR_INT8) ? Dequantize(static_cast<int8_t>(bytes[i]), format) :
+                        Dequantize(bytes[i], format);
+                }
+                Converted converted;
+                AddOutput(converted, bytes, floats);
+                for (float objectnessThresh : objectnessThreshs) {
+                    config.objectnessThresh = objectnessThresh;
+                    std::vector<DetectBox> boxes = Decode(config, format, converted.data, converted.sizes);
+                    std::vector<DetectBox> expected = Decode(config, YoloOutputFormat(), converted.floatData,
+                                                             converted.floatSizes);
+                    size_t passing = 0;
+                    for (size_t anchor = 0; anchor < anchorNum; anchor++) {
+                        float objectness = fastmath::sigmoid(floats[anchor * anchorSize + BOX_DIM]);
+                        float classProb = fastmath::sigmoid(floats[anchor * anchorSize + BOX_DIM + 1]) * objectness;
+                        passing += (objectness > objectnessThresh && classProb > 0.0f) ? 1 : 0;
+                    }
+                    mismatches += (SameBoxes(boxes, expected) && boxes.size() == passing) ? 0 : 1;
+                }
+            }
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+}
+
+struct MatchResult {
+    size_t unmatched;
+    size_t classChanged;
+};
+
+/*
+ * A box of expected is matched by one of boxes when the probability and the coordinates differ by at most what a
+ * logit error moves them. The class may differ, where the scores of two classes of the anchor are that close.
+ * Without match, the probability must be near the threshold, where the error can move a box in or out
+ */
+MatchResult MatchBoxes(const std::vector<DetectBox> &expected, const std::vector<DetectBox> &boxes, float logitError)
+{
+    const float sigmoidSlope = 0.25f;
+    const float probTol = 2 * sigmoidSlope * logitError + FAST_MATH_ERROR;
+    const float positionTol = sigmoidSlope * logitError / (NET_SIZE / YOLOV3_STRIDES[0]) + FAST_MATH_ERROR;
+    const float sizeTol = std::exp(logitError) - 1.0f + FAST_MATH_ERROR;
+    std::vector<bool> used(boxes.size(), false);
+    MatchResult result = {0, 0};
+    for (const DetectBox &box : expected) {
+        size_t match = boxes.size();
+        for (size_t i = 0; i < boxes.size(); i++) {
+            const DetectBox &other = boxes[i];
+            bool near = !used[i] && std::fabs(other.prob - box.prob) <= probTol &&
+                std::fabs(other.x - box.x) <= positionTol && std::fabs(other.y - box.y) <= positionTol &&
+                std::fabs(other.width - box.width) <= sizeTol * box.width &&
+                std::fabs(other.height - box.height) <= sizeTol * box.height;
+            if (near && (match == boxes.size() || other.classID == box.classID)) {
+                match = i;
+            }
+        }
+        if (match == boxes.size()) {
+            result.unmatched++;
+            TEST_CHECK(box.prob <= SCORE_THRESH_DEFAULT + probTol);
+            continue;
+        }
+        used[match] = true;
+        result.classChanged += (boxes[match].classID != box.classID) ? 1 : 0;
+    }
+    for (size_t i = 0; i < boxes.size(); i++) {
+        TEST_CHECK(used[i] || boxes[i].prob <= SCORE_THRESH_DEFAULT + probTol);
+    }
+    return result;
+}
+
+// The boxes of the converted outputs and of the original float outputs, before NMS
+void TestWithinTolerance()
+{
+    std::mt19937 random(2);
+    std::vector<uint32_t> strides(std::begin(YOLOV3_STRIDES), std::end(YOLOV3_STRIDES));
+    Outputs outputs = MakeOutputs(random, strides, YOLOV3_CLASS_NUM);
+    YoloDecoderConfig config;
+    config.classNum = YOLOV3_CLASS_NUM;
+    Converted original = Convert(outputs, YoloOutputFormat());
+    std::vector<DetectBox> expected = Decode(config, YoloOutputFormat(), original.data, original.sizes);
+    TEST_CHECK(expected.size() >= MIN_BOX_NUM);
+    const char *names[] = {"FLOAT32", "FLOAT16", "INT8", "UINT8"};
+    for (YoloTensorType type : {YOLO_TENSOR_FLOAT16, YOLO_TENSOR_INT8, YOLO_TENSOR_UINT8}) {
+        YoloOutputFormat format = MakeFormat(type);
+        Converted converted = Convert(outputs, format);
+        std::vector<DetectBox> boxes = Decode(config, format, converted.data, converted.sizes);
+        float logitError = (type == YOLO_TENSOR_FLOAT16) ? HALF_LOGIT_ERROR : QUANT_LOGIT_ERROR;
+        MatchResult result = MatchBoxes(expected, boxes, logitError);
+        std::printf("  %s: %zu boxes, of the %zu FLOAT32 boxes %zu unmatched near the threshold, %zu of another "
+                    "class\n", names[type], boxes.size(), expected.size(), result.unmatched, result.classChanged);
+        TEST_CHECK(result.classChanged * 10 < expected.size());
+    }
+}
+}
+
+int main()
+{
+    TEST_RUN(TestSameAsFloatValues);
+    TEST_RUN(TestObjectnessLimit);
+    TEST_RUN(TestWithinTolerance);
+    return TestResult();
+}
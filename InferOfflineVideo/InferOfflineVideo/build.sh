@@ -47,6 +47,38 @@ function buildA500() {
     return ${ret}
 }
 
+# build program which runs on a host without Ascend device, against the ACL simulator
+function buildSim() {
+    path_build=$path_cur/build
+    preparePath $path_build
+    cmake -DCMAKE_BUILD_TYPE=$build_type -DUSE_ACL_SIMULATOR=ON ..
+    make -j
+    ret=$?
+    cd ..
+    return ${ret}
+}
+
+# build the unit tests and benchmarks against the ACL simulator and run the tests
+function buildTest() {
+    path_build=$path_cur/build_test
+    preparePath $path_build
+    cmake -DCMAKE_BUILD_TYPE=$build_type ../Test
+    make -j
+    ret=$?
+    if [ ${ret} -eq 0 ]; then
+        ctest --output-on-failure
+        ret=$?
+    fi
+    cd ..
+    return ${ret}
+}
+
+# the tests need neither ASCEND_HOME nor FFmpeg and are not copied into dist
+if [ "$1" == "test" ]; then
+    buildTest
+    exit $?
+fi
+
 # set ASCEND_VERSION to ascend-toolkit/latest when it was not specified by user
 if [ ! "${ASCEND_VERSION}" ]; then
     export ASCEND_VERSION=ascend-toolkit/latest
@@ -54,9 +86,11 @@ if [ ! "${ASCEND_VERSION}" ]; then
 else
     echo "ASCEND_VERSION is set to ${ASCEND_VERSION} by user"
 fi
-# build with different according to the parameter, default is A300
+# build with different according to the parameter, default is A300, "sim" builds with the ACL simulator
 if [ "$1" == "A500" ]; then
     buildA500
+elif [ "$1" == "sim" ]; then
+    buildSim
 else
     buildA300
 fi
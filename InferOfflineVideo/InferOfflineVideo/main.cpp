@@ -24,6 +24,7 @@
 #include "ConfigParser/ConfigParser.h"
 #include "Log/Log.h"
 #include "ModuleManager/ModuleManager.h"
+#include "Statistic/Tracer.h"
 
 #include "StreamPuller/StreamPuller.h"
 #include "VideoDecoder/VideoDecoder.h"
@@ -45,15 +46,17 @@ ModuleDesc g_moduleDesc[MODULE_TYPE_COUNT] = {
 };
 
 ModuleConnectDesc g_connectDesc[MODULE_CONNECT_COUNT] = {
-    {MT_StreamPuller, MT_VideoDecoder, MODULE_CONNECT_CHANNEL},
-    {MT_VideoDecoder, MT_ModelInfer, MODULE_CONNECT_CHANNEL},
-    {MT_ModelInfer, MT_PostProcess, MODULE_CONNECT_CHANNEL},
+    {MT_StreamPuller, MT_VideoDecoder, MODULE_CONNECT_CHANNEL, BACKPRESSURE_BLOCK, 0, 0},
+    {MT_VideoDecoder, MT_ModelInfer, MODULE_CONNECT_CHANNEL, BACKPRESSURE_BLOCK, 0, 0},
+    {MT_ModelInfer, MT_PostProcess, MODULE_CONNECT_CHANNEL, BACKPRESSURE_BLOCK, 0, 0},
 };
 
 void SigHandler(int signo)
 {
     if (signo == SIGINT) {
         Singleton::GetInstance().SetSignalRecieved(true);
+    } else if (signo == SIGUSR1) {
+        Tracer::RequestDump(); // written by the main loop, not in the handler
     }
 }
 
@@ -132,9 +135,13 @@ int main(int argc, const char *argv[])
     if (signal(SIGINT, SigHandler) == SIG_ERR) {
         LogInfo << "cannot catch SIGINT.";
     }
+    if (signal(SIGUSR1, SigHandler) == SIG_ERR) {
+        LogInfo << "cannot catch SIGUSR1.";
+    }
     const uint16_t signalCheckInterval = 1000;
     while (!Singleton::GetInstance().GetSignalRecieved()) {
         usleep(signalCheckInterval);
+        Tracer::DumpIfRequested();
     }
 
     MainAssert(DeInitModuleManager(moduleManager));
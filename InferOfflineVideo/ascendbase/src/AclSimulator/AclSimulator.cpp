@@ -0,0 +1,882 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host-memory implementation of the ACL runtime and model API: device memory is host memory, a stream is a
+// worker thread and a model is a set of output templates returned after a synthetic latency
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "AclSimulatorInternal.h"
+#include "acl/acl_simulator.h"
+
+struct aclDataBuffer {
+    void *data;
+    size_t size;
+};
+
+struct aclTensorDesc {
+    aclDataType dataType;
+    std::vector<int64_t> dims;
+    aclFormat format;
+};
+
+struct aclmdlDataset {
+    std::vector<aclDataBuffer *> buffers;
+    uint64_t batchSize = 0; // set by aclmdlSetDynamicBatchSize
+};
+
+struct aclmdlDesc {
+    std::vector<size_t> inputSizes;
+    std::vector<size_t> outputSizes;
+    std::vector<aclDataType> outputTypes;
+    std::vector<uint64_t> dynamicBatches; // the batch sizes of a dynamic batch model, its last input is the size
+};
+
+namespace AclSimulator {
+namespace {
+std::atomic<uint64_t> g_inputIndexQueries(0);
+const size_t MODEL_WORK_SIZE = 4096;
+const size_t MODEL_WEIGHT_SIZE = 4096;
+const uint64_t DEFAULT_MODEL_LATENCY_US = 10000;
+// yolov3 converted from caffe: the 416 x 416 YUV420SP image and the image info in, the boxes (6 x 1024 floats)
+// and the box count (8 uint32) out. All zeros is a frame without objects
+const char *DEFAULT_MODEL_INPUTS = "259584,16";
+const char *DEFAULT_MODEL_OUTPUTS = "24576,32";
+const char *DEFAULT_MODEL_OUTPUT_TYPES = "float,uint32";
+const double BYTES_PER_US_PER_GBPS = 1000.0;
+const uint64_t DEFAULT_MODEL_FRAME_LATENCY_US = 2000;
+const size_t DYNAMIC_TENSOR_SIZE = sizeof(uint64_t);
+
+struct ReportQueue {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Task> callbacks;
+};
+
+struct SimModel {
+    aclmdlDesc desc;
+    std::vector<std::vector<uint8_t>> outputs;
+    uint64_t latencyUs = 0;
+    uint64_t frameLatencyUs = 0; // every frame of a dynamic batch after the first
+};
+
+struct SimEvent {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool complete = true;
+};
+
+std::mutex g_reportMutex;
+std::map<uint64_t, std::shared_ptr<ReportQueue>> g_reportQueues;
+
+std::mutex g_modelMutex;
+std::map<uint32_t, std::shared_ptr<SimModel>> g_models;
+uint32_t g_nextModelId = 1;
+
+int32_t g_deviceId = 0;
+thread_local aclrtContext g_currentContext = nullptr;
+
+std::shared_ptr<ReportQueue> GetReportQueue(uint64_t threadId)
+{
+    std::lock_guard<std::mutex> lock(g_reportMutex);
+    std::shared_ptr<ReportQueue> &queue = g_reportQueues[threadId];
+    if (queue == nullptr) {
+        queue = std::make_shared<ReportQueue>();
+    }
+    return queue;
+}
+
+std::shared_ptr<SimModel> FindModel(uint32_t modelId)
+{
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    auto iter = g_models.find(modelId);
+    return (iter == g_models.end()) ? nullptr : iter->second;
+}
+
+std::vector<std::string> SplitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool ParseSizeList(const char *name, const char *defaultValue, std::vector<size_t> &sizes)
+{
+    std::string list = GetEnvString(name, defaultValue);
+    for (auto &item : SplitList(list)) {
+        char *end = nullptr;
+        unsigned long long size = strtoull(item.c_str(), &end, 10);
+        if (end == item.c_str() || *end != '\0' || size == 0) {
+            fprintf(stderr, "[AclSimulator] invalid %s: %s\n", name, list.c_str());
+            return false;
+        }
+        sizes.push_back(static_cast<size_t>(size));
+    }
+    return true;
+}
+
+aclDataType ParseDataType(const std::string &name)
+{
+    static const std::map<std::string, aclDataType> dataTypes = {
+        {"float", ACL_FLOAT}, {"float16", ACL_FLOAT16}, {"int8", ACL_INT8}, {"uint8", ACL_UINT8},
+        {"int32", ACL_INT32}, {"uint32", ACL_UINT32}, {"int64", ACL_INT64}, {"uint64", ACL_UINT64}
+    };
+    auto iter = dataTypes.find(name);
+    return (iter == dataTypes.end()) ? ACL_DT_UNDEFINED : iter->second;
+}
+
+// output i starts as the content of the i-th file of ACL_SIM_MODEL_OUTPUT_FILES, cut or zero padded to its size
+bool CreateModel(SimModel &model)
+{
+    if (!ParseSizeList("ACL_SIM_MODEL_INPUTS", DEFAULT_MODEL_INPUTS, model.desc.inputSizes) ||
+        !ParseSizeList("ACL_SIM_MODEL_OUTPUTS", DEFAULT_MODEL_OUTPUTS, model.desc.outputSizes)) {
+        return false;
+    }
+    std::vector<std::string> types = SplitList(GetEnvString("ACL_SIM_MODEL_OUTPUT_TYPES",
+        DEFAULT_MODEL_OUTPUT_TYPES));
+    std::vector<std::string> files = SplitList(GetEnvString("ACL_SIM_MODEL_OUTPUT_FILES", ""));
+    for (size_t i = 0; i < model.desc.outputSizes.size(); i++) {
+        aclDataType dataType = (i < types.size()) ? ParseDataType(types[i]) : ACL_FLOAT;
+        if (dataType == ACL_DT_UNDEFINED) {
+            fprintf(stderr, "[AclSimulator] invalid type of output %zu: %s\n", i, types[i].c_str());
+            return false;
+        }
+        model.desc.outputTypes.push_back(dataType);
+        std::vector<uint8_t> output(model.desc.outputSizes[i], 0);
+        if (i < files.size()) {
+            std::ifstream file(files[i], std::ios::binary);
+            if (!file.is_open()) {
+                fprintf(stderr, "[AclSimulator] fail to open output file %s\n", files[i].c_str());
+                return false;
+            }
+            file.read(reinterpret_cast<char *>(output.data()), static_cast<std::streamsize>(output.size()));
+        }
+        model.outputs.push_back(std::move(output));
+    }
+    model.latencyUs = GetEnvUint("ACL_SIM_MODEL_LATENCY_US", DEFAULT_MODEL_LATENCY_US);
+    model.frameLatencyUs = GetEnvUint("ACL_SIM_MODEL_FRAME_LATENCY_US", DEFAULT_MODEL_FRAME_LATENCY_US);
+    // the inputs and outputs are sized for the largest batch, the batch size is one more input
+    std::vector<std::string> batches = SplitList(GetEnvString("ACL_SIM_MODEL_DYNAMIC_BATCH", ""));
+    for (auto &batch : batches) {
+        uint64_t batchSize = strtoull(batch.c_str(), nullptr, 10);
+        if (batchSize == 0 || model.desc.dynamicBatches.size() == ACL_MAX_BATCH_NUM) {
+            fprintf(stderr, "[AclSimulator] invalid dynamic batch size: %s\n", batch.c_str());
+            return false;
+        }
+        model.desc.dynamicBatches.push_back(batchSize);
+    }
+    if (!model.desc.dynamicBatches.empty()) {
+        model.desc.inputSizes.push_back(DYNAMIC_TENSOR_SIZE);
+    }
+    return true;
+}
+
+aclError ExecuteModel(SimModel &model, const aclmdlDataset *input, aclmdlDataset *output)
+{
+    if (input->buffers.size() != model.desc.inputSizes.size() || output->buffers.size() > model.outputs.size()) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    if (!model.desc.dynamicBatches.empty() && input->batchSize == 0) {
+        fprintf(stderr, "[AclSimulator] the dynamic batch size is not set\n");
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    uint64_t extraFrames = (input->batchSize > 1) ? input->batchSize - 1 : 0;
+    SleepUs(model.latencyUs + extraFrames * model.frameLatencyUs);
+    for (size_t i = 0; i < output->buffers.size(); i++) {
+        aclDataBuffer *buffer = output->buffers[i];
+        memcpy(buffer->data, model.outputs[i].data(), std::min(buffer->size, model.outputs[i].size()));
+    }
+    return ACL_ERROR_NONE;
+}
+
+size_t DataTypeSize(aclDataType dataType)
+{
+    switch (dataType) {
+        case ACL_INT8:
+        case ACL_UINT8:
+        case ACL_BOOL:
+            return sizeof(uint8_t);
+        case ACL_FLOAT16:
+        case ACL_INT16:
+        case ACL_UINT16:
+            return sizeof(uint16_t);
+        case ACL_INT64:
+        case ACL_UINT64:
+        case ACL_DOUBLE:
+            return sizeof(uint64_t);
+        default:
+            return sizeof(uint32_t);
+    }
+}
+}
+
+TaskWorker::TaskWorker()
+{
+    thread_ = std::thread(&TaskWorker::Run, this);
+}
+
+TaskWorker::~TaskWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    taskCond_.notify_all();
+    thread_.join();
+}
+
+void TaskWorker::Push(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    taskCond_.notify_one();
+}
+
+void TaskWorker::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCond_.wait(lock, [this] { return tasks_.empty() && !busy_; });
+}
+
+// pending tasks are finished before the worker stops
+void TaskWorker::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        taskCond_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+            return;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        busy_ = true;
+        lock.unlock();
+        task();
+        lock.lock();
+        busy_ = false;
+        if (tasks_.empty()) {
+            idleCond_.notify_all();
+        }
+    }
+}
+
+void RunOnStream(aclrtStream stream, Task task)
+{
+    if (stream == nullptr) {
+        task();
+        return;
+    }
+    static_cast<SimStream *>(stream)->worker.Push(std::move(task));
+}
+
+void PostReport(uint64_t threadId, Task task)
+{
+    std::shared_ptr<ReportQueue> queue = GetReportQueue(threadId);
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->callbacks.push_back(std::move(task));
+    }
+    queue->cond.notify_one();
+}
+
+void SleepUs(uint64_t us)
+{
+    if (us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+uint64_t GetEnvUint(const char *name, uint64_t defaultValue)
+{
+    const char *value = getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return defaultValue;
+    }
+    char *end = nullptr;
+    unsigned long long result = strtoull(value, &end, 10);
+    if (*end != '\0') {
+        fprintf(stderr, "[AclSimulator] invalid %s: %s, use %llu\n", name, value,
+            static_cast<unsigned long long>(defaultValue));
+        return defaultValue;
+    }
+    return static_cast<uint64_t>(result);
+}
+
+std::string GetEnvString(const char *name, const std::string &defaultValue)
+{
+    const char *value = getenv(name);
+    return (value == nullptr || *value == '\0') ? defaultValue : std::string(value);
+}
+
+uint64_t GetInputIndexQueries()
+{
+    return g_inputIndexQueries.load();
+}
+}
+
+using namespace AclSimulator;
+
+aclError aclInit(const char *)
+{
+    return ACL_ERROR_NONE;
+}
+
+aclError aclFinalize()
+{
+    return ACL_ERROR_NONE;
+}
+
+aclDataBuffer *aclCreateDataBuffer(void *data, size_t size)
+{
+    return new aclDataBuffer {data, size};
+}
+
+aclError aclDestroyDataBuffer(const aclDataBuffer *dataBuffer)
+{
+    delete dataBuffer;
+    return ACL_ERROR_NONE;
+}
+
+void *aclGetDataBufferAddr(const aclDataBuffer *dataBuffer)
+{
+    return (dataBuffer == nullptr) ? nullptr : dataBuffer->data;
+}
+
+size_t aclGetDataBufferSize(const aclDataBuffer *dataBuffer)
+{
+    return (dataBuffer == nullptr) ? 0 : dataBuffer->size;
+}
+
+aclError aclUpdateDataBuffer(aclDataBuffer *dataBuffer, void *data, size_t size)
+{
+    if (dataBuffer == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    dataBuffer->data = data;
+    dataBuffer->size = size;
+    return ACL_ERROR_NONE;
+}
+
+aclTensorDesc *aclCreateTensorDesc(aclDataType dataType, int numDims, const int64_t *dims, aclFormat format)
+{
+    if (numDims < 0 || (numDims > 0 && dims == nullptr)) {
+        return nullptr;
+    }
+    return new aclTensorDesc {dataType, std::vector<int64_t>(dims, dims + numDims), format};
+}
+
+void aclDestroyTensorDesc(const aclTensorDesc *desc)
+{
+    delete desc;
+}
+
+size_t aclGetTensorDescSize(const aclTensorDesc *desc)
+{
+    if (desc == nullptr) {
+        return 0;
+    }
+    size_t size = DataTypeSize(desc->dataType);
+    for (auto dim : desc->dims) {
+        size *= static_cast<size_t>(std::max<int64_t>(dim, 0));
+    }
+    return size;
+}
+
+aclError aclopSetModelDir(const char *)
+{
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSetDevice(int32_t deviceId)
+{
+    g_deviceId = deviceId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtResetDevice(int32_t)
+{
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtGetDevice(int32_t *deviceId)
+{
+    if (deviceId == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *deviceId = g_deviceId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtGetRunMode(aclrtRunMode *runMode)
+{
+    if (runMode == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *runMode = ACL_HOST;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtCreateContext(aclrtContext *context, int32_t deviceId)
+{
+    if (context == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *context = new int32_t(deviceId);
+    g_currentContext = *context;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtDestroyContext(aclrtContext context)
+{
+    if (g_currentContext == context) {
+        g_currentContext = nullptr;
+    }
+    delete static_cast<int32_t *>(context);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSetCurrentContext(aclrtContext context)
+{
+    g_currentContext = context;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtGetCurrentContext(aclrtContext *context)
+{
+    if (context == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *context = g_currentContext;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtCreateStream(aclrtStream *stream)
+{
+    if (stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *stream = new SimStream();
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtDestroyStream(aclrtStream stream)
+{
+    delete static_cast<SimStream *>(stream);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSynchronizeStream(aclrtStream stream)
+{
+    if (stream != nullptr) {
+        static_cast<SimStream *>(stream)->worker.WaitIdle();
+    }
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMalloc(void **devPtr, size_t size, aclrtMemMallocPolicy)
+{
+    if (devPtr == nullptr || size == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *devPtr = malloc(size);
+    return (*devPtr == nullptr) ? ACL_ERROR_BAD_ALLOC : ACL_ERROR_NONE;
+}
+
+aclError aclrtFree(void *devPtr)
+{
+    free(devPtr);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMallocHost(void **hostPtr, size_t size)
+{
+    return aclrtMalloc(hostPtr, size, ACL_MEM_MALLOC_NORMAL_ONLY);
+}
+
+aclError aclrtFreeHost(void *hostPtr)
+{
+    free(hostPtr);
+    return ACL_ERROR_NONE;
+}
+
+// copies between host and device take count / ACL_SIM_MEMCPY_GBPS when it is set, like a PCIe transfer
+aclError aclrtMemcpy(void *dst, size_t destMax, const void *src, size_t count, aclrtMemcpyKind kind)
+{
+    if (dst == nullptr || src == nullptr || count > destMax) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    memmove(dst, src, count);
+    static const uint64_t memcpyGbps = GetEnvUint("ACL_SIM_MEMCPY_GBPS", 0);
+    if (memcpyGbps > 0 && (kind == ACL_MEMCPY_HOST_TO_DEVICE || kind == ACL_MEMCPY_DEVICE_TO_HOST)) {
+        SleepUs(static_cast<uint64_t>(count / (memcpyGbps * BYTES_PER_US_PER_GBPS)));
+    }
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMemcpyAsync(void *dst, size_t destMax, const void *src, size_t count, aclrtMemcpyKind kind,
+    aclrtStream stream)
+{
+    if (dst == nullptr || src == nullptr || count > destMax) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    RunOnStream(stream, [=] { (void)aclrtMemcpy(dst, destMax, src, count, kind); });
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMemset(void *devPtr, size_t maxCount, int32_t value, size_t count)
+{
+    if (devPtr == nullptr || count > maxCount) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    memset(devPtr, value, count);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSubscribeReport(uint64_t threadId, aclrtStream stream)
+{
+    if (stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    SimStream *simStream = static_cast<SimStream *>(stream);
+    std::lock_guard<std::mutex> lock(simStream->mutex);
+    simStream->subscribed = true;
+    simStream->subscriber = threadId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtUnSubscribeReport(uint64_t, aclrtStream stream)
+{
+    if (stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    SimStream *simStream = static_cast<SimStream *>(stream);
+    simStream->worker.WaitIdle();
+    std::lock_guard<std::mutex> lock(simStream->mutex);
+    simStream->subscribed = false;
+    return ACL_ERROR_NONE;
+}
+
+// a blocking callback also holds back the tasks queued after it on the stream until it has run
+aclError aclrtLaunchCallback(aclrtCallback fn, void *userData, aclrtCallbackBlockType blockType, aclrtStream stream)
+{
+    if (fn == nullptr || stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    SimStream *simStream = static_cast<SimStream *>(stream);
+    uint64_t subscriber = 0;
+    {
+        std::lock_guard<std::mutex> lock(simStream->mutex);
+        if (!simStream->subscribed) {
+            return ACL_ERROR_FAILURE;
+        }
+        subscriber = simStream->subscriber;
+    }
+    simStream->worker.Push([fn, userData, blockType, subscriber] {
+        if (blockType != ACL_CALLBACK_BLOCK) {
+            PostReport(subscriber, [fn, userData] { fn(userData); });
+            return;
+        }
+        std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+        std::future<void> finished = done->get_future();
+        PostReport(subscriber, [fn, userData, done] {
+            fn(userData);
+            done->set_value();
+        });
+        finished.wait();
+    });
+    return ACL_ERROR_NONE;
+}
+
+// runs one callback posted for the calling thread, a negative timeout waits forever
+aclError aclrtProcessReport(int32_t timeout)
+{
+    std::shared_ptr<ReportQueue> queue = GetReportQueue(static_cast<uint64_t>(pthread_self()));
+    Task callback;
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        auto ready = [&queue] { return !queue->callbacks.empty(); };
+        if (timeout < 0) {
+            queue->cond.wait(lock, ready);
+        } else if (!queue->cond.wait_for(lock, std::chrono::milliseconds(timeout), ready)) {
+            return ACL_ERROR_WAIT_CALLBACK_TIMEOUT;
+        }
+        callback = std::move(queue->callbacks.front());
+        queue->callbacks.pop_front();
+    }
+    callback();
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtCreateEvent(aclrtEvent *event)
+{
+    if (event == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *event = new SimEvent();
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtDestroyEvent(aclrtEvent event)
+{
+    delete static_cast<SimEvent *>(event);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtRecordEvent(aclrtEvent event, aclrtStream stream)
+{
+    if (event == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    SimEvent *simEvent = static_cast<SimEvent *>(event);
+    {
+        std::lock_guard<std::mutex> lock(simEvent->mutex);
+        simEvent->complete = false;
+    }
+    RunOnStream(stream, [simEvent] {
+        std::lock_guard<std::mutex> lock(simEvent->mutex);
+        simEvent->complete = true;
+        simEvent->cond.notify_all();
+    });
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtQueryEvent(aclrtEvent event, aclrtEventStatus *status)
+{
+    if (event == nullptr || status == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    SimEvent *simEvent = static_cast<SimEvent *>(event);
+    std::lock_guard<std::mutex> lock(simEvent->mutex);
+    *status = simEvent->complete ? ACL_EVENT_STATUS_COMPLETE : ACL_EVENT_STATUS_NOT_READY;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSynchronizeEvent(aclrtEvent event)
+{
+    if (event == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    SimEvent *simEvent = static_cast<SimEvent *>(event);
+    std::unique_lock<std::mutex> lock(simEvent->mutex);
+    simEvent->cond.wait(lock, [simEvent] { return simEvent->complete; });
+    return ACL_ERROR_NONE;
+}
+
+aclmdlDesc *aclmdlCreateDesc()
+{
+    return new aclmdlDesc();
+}
+
+aclError aclmdlDestroyDesc(aclmdlDesc *modelDesc)
+{
+    delete modelDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlGetDesc(aclmdlDesc *modelDesc, uint32_t modelId)
+{
+    std::shared_ptr<SimModel> model = FindModel(modelId);
+    if (modelDesc == nullptr || model == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *modelDesc = model->desc;
+    return ACL_ERROR_NONE;
+}
+
+size_t aclmdlGetNumInputs(aclmdlDesc *modelDesc)
+{
+    return (modelDesc == nullptr) ? 0 : modelDesc->inputSizes.size();
+}
+
+size_t aclmdlGetNumOutputs(aclmdlDesc *modelDesc)
+{
+    return (modelDesc == nullptr) ? 0 : modelDesc->outputSizes.size();
+}
+
+size_t aclmdlGetInputSizeByIndex(aclmdlDesc *modelDesc, size_t index)
+{
+    return (modelDesc == nullptr || index >= modelDesc->inputSizes.size()) ? 0 : modelDesc->inputSizes[index];
+}
+
+size_t aclmdlGetOutputSizeByIndex(aclmdlDesc *modelDesc, size_t index)
+{
+    return (modelDesc == nullptr || index >= modelDesc->outputSizes.size()) ? 0 : modelDesc->outputSizes[index];
+}
+
+aclDataType aclmdlGetOutputDataType(const aclmdlDesc *modelDesc, size_t index)
+{
+    return (modelDesc == nullptr || index >= modelDesc->outputTypes.size()) ? ACL_DT_UNDEFINED :
+        modelDesc->outputTypes[index];
+}
+
+// a simulated model has a dynamic batch input when ACL_SIM_MODEL_DYNAMIC_BATCH is set, never a dynamic image size
+aclError aclmdlGetInputIndexByName(const aclmdlDesc *modelDesc, const char *name, size_t *index)
+{
+    g_inputIndexQueries++;
+    if (modelDesc == nullptr || name == nullptr || index == nullptr || modelDesc->dynamicBatches.empty() ||
+        strcmp(name, ACL_DYNAMIC_TENSOR_NAME) != 0) {
+        return ACL_ERROR_FAILURE;
+    }
+    *index = modelDesc->inputSizes.size() - 1;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlGetDynamicBatch(const aclmdlDesc *modelDesc, aclmdlBatch *batch)
+{
+    if (modelDesc == nullptr || batch == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    batch->batchCount = modelDesc->dynamicBatches.size();
+    std::copy(modelDesc->dynamicBatches.begin(), modelDesc->dynamicBatches.end(), batch->batch);
+    return ACL_ERROR_NONE;
+}
+
+aclmdlDataset *aclmdlCreateDataset()
+{
+    return new aclmdlDataset();
+}
+
+aclError aclmdlDestroyDataset(const aclmdlDataset *dataset)
+{
+    delete dataset;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlAddDatasetBuffer(aclmdlDataset *dataset, aclDataBuffer *dataBuffer)
+{
+    if (dataset == nullptr || dataBuffer == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    dataset->buffers.push_back(dataBuffer);
+    return ACL_ERROR_NONE;
+}
+
+size_t aclmdlGetDatasetNumBuffers(const aclmdlDataset *dataset)
+{
+    return (dataset == nullptr) ? 0 : dataset->buffers.size();
+}
+
+aclDataBuffer *aclmdlGetDatasetBuffer(const aclmdlDataset *dataset, size_t index)
+{
+    return (dataset == nullptr || index >= dataset->buffers.size()) ? nullptr : dataset->buffers[index];
+}
+
+aclError aclmdlQuerySize(const char *fileName, size_t *workSize, size_t *weightSize)
+{
+    if (fileName == nullptr || access(fileName, R_OK) != 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return aclmdlQuerySizeFromMem(fileName, 1, workSize, weightSize);
+}
+
+aclError aclmdlQuerySizeFromMem(const void *model, size_t modelSize, size_t *workSize, size_t *weightSize)
+{
+    if (model == nullptr || modelSize == 0 || workSize == nullptr || weightSize == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *workSize = MODEL_WORK_SIZE;
+    *weightSize = MODEL_WEIGHT_SIZE;
+    return ACL_ERROR_NONE;
+}
+
+// the model file is not parsed, every loaded model is described by the ACL_SIM_MODEL_* settings
+aclError aclmdlLoadFromMemWithMem(const void *model, size_t modelSize, uint32_t *modelId, void *,
+    size_t, void *, size_t)
+{
+    if (model == nullptr || modelSize == 0 || modelId == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::shared_ptr<SimModel> simModel = std::make_shared<SimModel>();
+    if (!CreateModel(*simModel)) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    *modelId = g_nextModelId++;
+    g_models[*modelId] = simModel;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlUnload(uint32_t modelId)
+{
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    return (g_models.erase(modelId) == 0) ? ACL_ERROR_INVALID_PARAM : ACL_ERROR_NONE;
+}
+
+aclError aclmdlExecute(uint32_t modelId, const aclmdlDataset *input, aclmdlDataset *output)
+{
+    std::shared_ptr<SimModel> model = FindModel(modelId);
+    if (model == nullptr || input == nullptr || output == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return ExecuteModel(*model, input, output);
+}
+
+aclError aclmdlExecuteAsync(uint32_t modelId, const aclmdlDataset *input, aclmdlDataset *output, aclrtStream stream)
+{
+    std::shared_ptr<SimModel> model = FindModel(modelId);
+    if (model == nullptr || input == nullptr || output == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    if (input->buffers.size() != model->desc.inputSizes.size() || output->buffers.size() > model->outputs.size()) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    RunOnStream(stream, [model, input, output] { (void)ExecuteModel(*model, input, output); });
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlSetDynamicBatchSize(uint32_t modelId, aclmdlDataset *dataset, size_t index, uint64_t batchSize)
+{
+    std::shared_ptr<SimModel> model = FindModel(modelId);
+    if (model == nullptr || dataset == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    const std::vector<uint64_t> &batches = model->desc.dynamicBatches;
+    if (batches.empty()) {
+        return ACL_ERROR_API_NOT_SUPPORT;
+    }
+    if (index != model->desc.inputSizes.size() - 1 ||
+        std::find(batches.begin(), batches.end(), batchSize) == batches.end()) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    dataset->batchSize = batchSize;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlSetDynamicHWSize(uint32_t, aclmdlDataset *, size_t, uint64_t, uint64_t)
+{
+    return ACL_ERROR_API_NOT_SUPPORT;
+}
@@ -0,0 +1,579 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host-memory implementation of DVPP: VPC resize and crop scale YUV420SP images with nearest neighbour sampling,
+// VDEC does not parse the stream and returns a synthetic frame per packet through the callback thread
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include "AclSimulatorInternal.h"
+#include "acl/ops/acl_dvpp.h"
+
+struct acldvppPicDesc {
+    void *data = nullptr;
+    uint32_t size = 0;
+    acldvppPixelFormat format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t widthStride = 0;
+    uint32_t heightStride = 0;
+};
+
+struct acldvppStreamDesc {
+    void *data = nullptr;
+    uint32_t size = 0;
+    bool eos = false;
+};
+
+struct acldvppChannelDesc {
+    bool created = false;
+};
+
+struct acldvppResizeConfig {
+    uint32_t interpolation = 0;
+};
+
+struct acldvppRoiConfig {
+    uint32_t left;
+    uint32_t right;
+    uint32_t top;
+    uint32_t bottom;
+};
+
+struct acldvppJpegeConfig {
+    uint32_t level = 100;
+};
+
+struct aclvdecChannelDesc {
+    uint32_t channelId = 0;
+    uint64_t threadId = 0;
+    aclvdecCallback callback = nullptr;
+    acldvppStreamFormat enType = H264_MAIN_LEVEL;
+    acldvppPixelFormat outPicFormat = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    std::unique_ptr<AclSimulator::TaskWorker> worker = nullptr;
+    // frames sent whose callback has not returned yet
+    std::mutex mutex;
+    std::condition_variable idleCond;
+    uint64_t pending = 0;
+    uint64_t frameCount = 0;
+};
+
+namespace {
+using namespace AclSimulator;
+
+const size_t DVPP_MEMORY_ALIGN = 128;
+const uint8_t YUV_NEUTRAL_CHROMA = 128;
+const uint64_t DEFAULT_VDEC_LATENCY_US = 2000;
+const uint64_t DEFAULT_VPC_LATENCY_US = 500;
+const uint32_t VDEC_STRIDE_WIDTH = 16;
+const uint32_t VDEC_STRIDE_HEIGHT = 2;
+
+uint32_t AlignUp(uint32_t value, uint32_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+uint32_t WidthStride(const acldvppPicDesc &desc)
+{
+    return (desc.widthStride == 0) ? desc.width : desc.widthStride;
+}
+
+uint32_t HeightStride(const acldvppPicDesc &desc)
+{
+    return (desc.heightStride == 0) ? desc.height : desc.heightStride;
+}
+
+bool IsYuv420sp(const acldvppPicDesc &desc)
+{
+    return desc.format == PIXEL_FORMAT_YUV_SEMIPLANAR_420 || desc.format == PIXEL_FORMAT_YVU_SEMIPLANAR_420;
+}
+
+bool IsValidPicture(const acldvppPicDesc &desc)
+{
+    uint64_t planeSize = static_cast<uint64_t>(WidthStride(desc)) * HeightStride(desc);
+    return desc.data != nullptr && desc.width > 0 && desc.height > 0 && IsYuv420sp(desc) &&
+        WidthStride(desc) >= desc.width && HeightStride(desc) >= desc.height && planeSize * 3 / 2 <= desc.size;
+}
+
+// Nearest neighbour scaling of the crop area of input into the paste area of output, both inclusive.
+// The interleaved chroma plane is scaled per pair of samples at half resolution
+void ScaleYuv420sp(const acldvppPicDesc &input, const acldvppRoiConfig &crop, const acldvppPicDesc &output,
+    const acldvppRoiConfig &paste)
+{
+    const uint8_t *inY = static_cast<const uint8_t *>(input.data);
+    const uint8_t *inUv = inY + static_cast<size_t>(WidthStride(input)) * HeightStride(input);
+    uint8_t *outY = static_cast<uint8_t *>(output.data);
+    uint8_t *outUv = outY + static_cast<size_t>(WidthStride(output)) * HeightStride(output);
+    uint32_t cropWidth = crop.right - crop.left + 1;
+    uint32_t cropHeight = crop.bottom - crop.top + 1;
+    uint32_t pasteWidth = paste.right - paste.left + 1;
+    uint32_t pasteHeight = paste.bottom - paste.top + 1;
+    for (uint32_t y = 0; y < pasteHeight; y++) {
+        uint32_t srcY = crop.top + static_cast<uint32_t>(static_cast<uint64_t>(y) * cropHeight / pasteHeight);
+        const uint8_t *srcRow = inY + static_cast<size_t>(srcY) * WidthStride(input);
+        uint8_t *dstRow = outY + static_cast<size_t>(paste.top + y) * WidthStride(output);
+        for (uint32_t x = 0; x < pasteWidth; x++) {
+            dstRow[paste.left + x] = srcRow[crop.left + static_cast<uint64_t>(x) * cropWidth / pasteWidth];
+        }
+    }
+    for (uint32_t y = 0; y < pasteHeight / 2; y++) {
+        uint32_t srcY = crop.top / 2 + static_cast<uint32_t>(static_cast<uint64_t>(y) * cropHeight / pasteHeight);
+        const uint8_t *srcRow = inUv + static_cast<size_t>(srcY) * WidthStride(input);
+        uint8_t *dstRow = outUv + static_cast<size_t>(paste.top / 2 + y) * WidthStride(output);
+        for (uint32_t x = 0; x < pasteWidth / 2; x++) {
+            uint32_t srcX = crop.left / 2 + static_cast<uint32_t>(static_cast<uint64_t>(x) * cropWidth / pasteWidth);
+            dstRow[(paste.left / 2 + x) * 2] = srcRow[srcX * 2];
+            dstRow[(paste.left / 2 + x) * 2 + 1] = srcRow[srcX * 2 + 1];
+        }
+    }
+}
+
+bool IsValidRoi(const acldvppRoiConfig &roi, const acldvppPicDesc &desc)
+{
+    return roi.left <= roi.right && roi.top <= roi.bottom && roi.right < desc.width && roi.bottom < desc.height;
+}
+
+aclError LaunchVpc(const acldvppPicDesc *inputDesc, const acldvppPicDesc *outputDesc, const acldvppRoiConfig &crop,
+    const acldvppRoiConfig &paste, aclrtStream stream)
+{
+    if (inputDesc == nullptr || outputDesc == nullptr || !IsValidPicture(*inputDesc) ||
+        !IsValidPicture(*outputDesc) || !IsValidRoi(crop, *inputDesc) || !IsValidRoi(paste, *outputDesc)) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    // the descriptions may be changed or destroyed once the task is queued, the task keeps its own copies
+    acldvppPicDesc input = *inputDesc;
+    acldvppPicDesc output = *outputDesc;
+    static const uint64_t vpcLatencyUs = GetEnvUint("ACL_SIM_VPC_LATENCY_US", DEFAULT_VPC_LATENCY_US);
+    RunOnStream(stream, [input, output, crop, paste] {
+        ScaleYuv420sp(input, crop, output, paste);
+        SleepUs(vpcLatencyUs);
+    });
+    return ACL_ERROR_NONE;
+}
+
+// a moving gradient, so consecutive frames differ
+void FillSyntheticFrame(const acldvppPicDesc &output, uint64_t frameIndex)
+{
+    uint8_t *data = static_cast<uint8_t *>(output.data);
+    size_t planeSize = static_cast<size_t>(WidthStride(output)) * HeightStride(output);
+    for (uint32_t y = 0; y < output.height; y++) {
+        uint8_t *row = data + static_cast<size_t>(y) * WidthStride(output);
+        for (uint32_t x = 0; x < output.width; x++) {
+            row[x] = static_cast<uint8_t>(x + y + frameIndex);
+        }
+    }
+    memset(data + planeSize, YUV_NEUTRAL_CHROMA, output.size - planeSize);
+}
+
+void WaitVdecIdle(aclvdecChannelDesc &channelDesc)
+{
+    std::unique_lock<std::mutex> lock(channelDesc.mutex);
+    channelDesc.idleCond.wait(lock, [&channelDesc] { return channelDesc.pending == 0; });
+}
+}
+
+aclError acldvppMalloc(void **devPtr, size_t size)
+{
+    if (devPtr == nullptr || size == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return (posix_memalign(devPtr, DVPP_MEMORY_ALIGN, size) == 0) ? ACL_ERROR_NONE : ACL_ERROR_BAD_ALLOC;
+}
+
+aclError acldvppFree(void *devPtr)
+{
+    free(devPtr);
+    return ACL_ERROR_NONE;
+}
+
+acldvppChannelDesc *acldvppCreateChannelDesc()
+{
+    return new acldvppChannelDesc();
+}
+
+aclError acldvppDestroyChannelDesc(acldvppChannelDesc *channelDesc)
+{
+    delete channelDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppCreateChannel(acldvppChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->created = true;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppDestroyChannel(acldvppChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->created = false;
+    return ACL_ERROR_NONE;
+}
+
+acldvppPicDesc *acldvppCreatePicDesc()
+{
+    return new acldvppPicDesc();
+}
+
+aclError acldvppDestroyPicDesc(acldvppPicDesc *picDesc)
+{
+    delete picDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescData(acldvppPicDesc *picDesc, void *dataDev)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->data = dataDev;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescSize(acldvppPicDesc *picDesc, uint32_t size)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->size = size;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescFormat(acldvppPicDesc *picDesc, acldvppPixelFormat format)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->format = format;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescWidth(acldvppPicDesc *picDesc, uint32_t width)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->width = width;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescHeight(acldvppPicDesc *picDesc, uint32_t height)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->height = height;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescWidthStride(acldvppPicDesc *picDesc, uint32_t widthStride)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->widthStride = widthStride;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetPicDescHeightStride(acldvppPicDesc *picDesc, uint32_t heightStride)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    picDesc->heightStride = heightStride;
+    return ACL_ERROR_NONE;
+}
+
+void *acldvppGetPicDescData(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? nullptr : picDesc->data;
+}
+
+uint32_t acldvppGetPicDescSize(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->size;
+}
+
+acldvppStreamDesc *acldvppCreateStreamDesc()
+{
+    return new acldvppStreamDesc();
+}
+
+aclError acldvppDestroyStreamDesc(acldvppStreamDesc *streamDesc)
+{
+    delete streamDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetStreamDescData(acldvppStreamDesc *streamDesc, void *dataDev)
+{
+    if (streamDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    streamDesc->data = dataDev;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetStreamDescSize(acldvppStreamDesc *streamDesc, uint32_t size)
+{
+    if (streamDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    streamDesc->size = size;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetStreamDescEos(acldvppStreamDesc *streamDesc, uint8_t eos)
+{
+    if (streamDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    streamDesc->eos = (eos != 0);
+    return ACL_ERROR_NONE;
+}
+
+void *acldvppGetStreamDescData(const acldvppStreamDesc *streamDesc)
+{
+    return (streamDesc == nullptr) ? nullptr : streamDesc->data;
+}
+
+acldvppResizeConfig *acldvppCreateResizeConfig()
+{
+    return new acldvppResizeConfig();
+}
+
+aclError acldvppDestroyResizeConfig(acldvppResizeConfig *resizeConfig)
+{
+    delete resizeConfig;
+    return ACL_ERROR_NONE;
+}
+
+acldvppRoiConfig *acldvppCreateRoiConfig(uint32_t left, uint32_t right, uint32_t top, uint32_t bottom)
+{
+    return new acldvppRoiConfig {left, right, top, bottom};
+}
+
+aclError acldvppDestroyRoiConfig(acldvppRoiConfig *roiConfig)
+{
+    delete roiConfig;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppVpcResizeAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppResizeConfig *, aclrtStream stream)
+{
+    if (channelDesc == nullptr || inputDesc == nullptr || outputDesc == nullptr || inputDesc->width == 0 ||
+        inputDesc->height == 0 || outputDesc->width == 0 || outputDesc->height == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    acldvppRoiConfig crop = {0, inputDesc->width - 1, 0, inputDesc->height - 1};
+    acldvppRoiConfig paste = {0, outputDesc->width - 1, 0, outputDesc->height - 1};
+    return LaunchVpc(inputDesc, outputDesc, crop, paste, stream);
+}
+
+aclError acldvppVpcCropAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc, acldvppPicDesc *outputDesc,
+    acldvppRoiConfig *cropArea, aclrtStream stream)
+{
+    if (channelDesc == nullptr || cropArea == nullptr || outputDesc == nullptr || outputDesc->width == 0 ||
+        outputDesc->height == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    acldvppRoiConfig paste = {0, outputDesc->width - 1, 0, outputDesc->height - 1};
+    return LaunchVpc(inputDesc, outputDesc, *cropArea, paste, stream);
+}
+
+aclError acldvppVpcCropAndPasteAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppRoiConfig *cropArea, acldvppRoiConfig *pasteArea, aclrtStream stream)
+{
+    if (channelDesc == nullptr || cropArea == nullptr || pasteArea == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return LaunchVpc(inputDesc, outputDesc, *cropArea, *pasteArea, stream);
+}
+
+aclError acldvppJpegDecodeAsync(acldvppChannelDesc *, const void *, uint32_t, acldvppPicDesc *, aclrtStream)
+{
+    return ACL_ERROR_API_NOT_SUPPORT;
+}
+
+aclError acldvppJpegEncodeAsync(acldvppChannelDesc *, acldvppPicDesc *, const void *,
+    uint32_t *, acldvppJpegeConfig *, aclrtStream)
+{
+    return ACL_ERROR_API_NOT_SUPPORT;
+}
+
+aclError acldvppJpegGetImageInfo(const void *, uint32_t, uint32_t *, uint32_t *, int32_t *)
+{
+    return ACL_ERROR_API_NOT_SUPPORT;
+}
+
+aclError acldvppJpegPredictDecSize(const void *, uint32_t, acldvppPixelFormat, uint32_t *)
+{
+    return ACL_ERROR_API_NOT_SUPPORT;
+}
+
+aclError acldvppJpegPredictEncSize(const acldvppPicDesc *, const acldvppJpegeConfig *, uint32_t *)
+{
+    return ACL_ERROR_API_NOT_SUPPORT;
+}
+
+acldvppJpegeConfig *acldvppCreateJpegeConfig()
+{
+    return new acldvppJpegeConfig();
+}
+
+aclError acldvppDestroyJpegeConfig(acldvppJpegeConfig *jpegeConfig)
+{
+    delete jpegeConfig;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetJpegeConfigLevel(acldvppJpegeConfig *jpegeConfig, uint32_t level)
+{
+    if (jpegeConfig == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    jpegeConfig->level = level;
+    return ACL_ERROR_NONE;
+}
+
+aclvdecChannelDesc *aclvdecCreateChannelDesc()
+{
+    return new aclvdecChannelDesc();
+}
+
+aclError aclvdecDestroyChannelDesc(aclvdecChannelDesc *channelDesc)
+{
+    delete channelDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSetChannelDescChannelId(aclvdecChannelDesc *channelDesc, uint32_t channelId)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->channelId = channelId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSetChannelDescThreadId(aclvdecChannelDesc *channelDesc, uint64_t threadId)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->threadId = threadId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSetChannelDescCallback(aclvdecChannelDesc *channelDesc, aclvdecCallback callback)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->callback = callback;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSetChannelDescEnType(aclvdecChannelDesc *channelDesc, acldvppStreamFormat enType)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->enType = enType;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSetChannelDescOutPicFormat(aclvdecChannelDesc *channelDesc, acldvppPixelFormat outPicFormat)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->outPicFormat = outPicFormat;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecCreateChannel(aclvdecChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr || channelDesc->callback == nullptr || channelDesc->threadId == 0 ||
+        channelDesc->worker != nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->worker.reset(new TaskWorker());
+    return ACL_ERROR_NONE;
+}
+
+// frames still being decoded are finished and their callbacks run before the channel goes away
+aclError aclvdecDestroyChannel(aclvdecChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr || channelDesc->worker == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    WaitVdecIdle(*channelDesc);
+    channelDesc->worker.reset();
+    return ACL_ERROR_NONE;
+}
+
+// Decoding takes ACL_SIM_VDEC_LATENCY_US per frame on the channel, then the callback is run by the thread set
+// with aclvdecSetChannelDescThreadId. Like the device, the eos frame returns after all callbacks have returned
+aclError aclvdecSendFrame(aclvdecChannelDesc *channelDesc, acldvppStreamDesc *input, acldvppPicDesc *output,
+    aclvdecFrameConfig *, void *userData)
+{
+    if (channelDesc == nullptr || channelDesc->worker == nullptr || input == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    if (input->eos) {
+        WaitVdecIdle(*channelDesc);
+        return ACL_ERROR_NONE;
+    }
+    if (output == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    // decoded frames are laid out with the strides of the device when the caller sets none
+    acldvppPicDesc picture = *output;
+    picture.widthStride = (picture.widthStride == 0) ? AlignUp(picture.width, VDEC_STRIDE_WIDTH) : picture.widthStride;
+    picture.heightStride = (picture.heightStride == 0) ? AlignUp(picture.height, VDEC_STRIDE_HEIGHT) :
+        picture.heightStride;
+    if (!IsValidPicture(picture)) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    uint64_t frameIndex = 0;
+    {
+        std::lock_guard<std::mutex> lock(channelDesc->mutex);
+        channelDesc->pending++;
+        frameIndex = channelDesc->frameCount++;
+    }
+    static const uint64_t vdecLatencyUs = GetEnvUint("ACL_SIM_VDEC_LATENCY_US", DEFAULT_VDEC_LATENCY_US);
+    channelDesc->worker->Push([channelDesc, input, output, picture, userData, frameIndex] {
+        SleepUs(vdecLatencyUs);
+        FillSyntheticFrame(picture, frameIndex);
+        PostReport(channelDesc->threadId, [channelDesc, input, output, userData] {
+            channelDesc->callback(input, output, userData);
+            std::lock_guard<std::mutex> lock(channelDesc->mutex);
+            if (--channelDesc->pending == 0) {
+                channelDesc->idleCond.notify_all();
+            }
+        });
+    });
+    return ACL_ERROR_NONE;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ACL_SIMULATOR_INTERNAL_H
+#define ACL_SIMULATOR_INTERNAL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "acl/acl.h"
+
+namespace AclSimulator {
+using Task = std::function<void()>;
+
+// Runs tasks one after another on its own thread, the stand-in for a device stream or a VDEC channel
+class TaskWorker {
+public:
+    TaskWorker();
+    ~TaskWorker();
+    TaskWorker(const TaskWorker &) = delete;
+    TaskWorker &operator=(const TaskWorker &) = delete;
+
+    void Push(Task task);
+    // Blocks until every task pushed before the call has finished
+    void WaitIdle();
+
+private:
+    void Run();
+
+    std::mutex mutex_ = {};
+    std::condition_variable taskCond_ = {};
+    std::condition_variable idleCond_ = {};
+    std::deque<Task> tasks_ = {};
+    bool busy_ = false;
+    bool stop_ = false;
+    std::thread thread_ = {};
+};
+
+struct SimStream {
+    TaskWorker worker;
+    std::mutex mutex;
+    bool subscribed = false;
+    uint64_t subscriber = 0;
+};
+
+// Runs the task on the stream, or at once when the stream is null like the default stream of the device
+void RunOnStream(aclrtStream stream, Task task);
+
+// Queues a callback to be run by the thread threadId in aclrtProcessReport
+void PostReport(uint64_t threadId, Task task);
+
+void SleepUs(uint64_t us);
+
+// Settings of the simulator come from ACL_SIM_* environment variables, see README.md
+uint64_t GetEnvUint(const char *name, uint64_t defaultValue);
+std::string GetEnvString(const char *name, const std::string &defaultValue);
+}
+
+#endif
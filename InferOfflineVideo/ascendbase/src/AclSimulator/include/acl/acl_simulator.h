@@ -0,0 +1,28 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Functions of the ACL simulator which ACL does not have, for the tests to see what the code under test called
+#ifndef ACL_SIMULATOR_ACL_SIMULATOR_H
+#define ACL_SIMULATOR_ACL_SIMULATOR_H
+
+#include <cstdint>
+
+namespace AclSimulator {
+// calls of aclmdlGetInputIndexByName since the process started
+uint64_t GetInputIndexQueries();
+}
+
+#endif
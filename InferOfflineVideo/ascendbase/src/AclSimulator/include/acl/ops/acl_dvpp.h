@@ -0,0 +1,126 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Subset of the DVPP (VPC, JPEG, VDEC) API used by this repository, implemented by the ACL simulator
+// (see AclSimulatorDvpp.cpp). JPEG encode and decode are declared but not simulated.
+#ifndef ACL_SIMULATOR_ACL_DVPP_H
+#define ACL_SIMULATOR_ACL_DVPP_H
+
+#include "acl/acl.h"
+
+typedef enum acldvppStreamFormat {
+    H265_MAIN_LEVEL = 0,
+    H264_BASELINE_LEVEL,
+    H264_MAIN_LEVEL,
+    H264_HIGH_LEVEL
+} acldvppStreamFormat;
+
+typedef enum acldvppPixelFormat {
+    PIXEL_FORMAT_YUV_400 = 0,
+    PIXEL_FORMAT_YUV_SEMIPLANAR_420 = 1,
+    PIXEL_FORMAT_YVU_SEMIPLANAR_420 = 2,
+    PIXEL_FORMAT_YUV_SEMIPLANAR_422 = 3,
+    PIXEL_FORMAT_YVU_SEMIPLANAR_422 = 4,
+    PIXEL_FORMAT_YUV_SEMIPLANAR_444 = 5,
+    PIXEL_FORMAT_YVU_SEMIPLANAR_444 = 6,
+    PIXEL_FORMAT_YUYV_PACKED_422 = 7,
+    PIXEL_FORMAT_UYVY_PACKED_422 = 8,
+    PIXEL_FORMAT_YVYU_PACKED_422 = 9,
+    PIXEL_FORMAT_VYUY_PACKED_422 = 10,
+    PIXEL_FORMAT_YUV_PACKED_444 = 11,
+    PIXEL_FORMAT_RGB_888 = 12,
+    PIXEL_FORMAT_BGR_888 = 13,
+    PIXEL_FORMAT_ARGB_8888 = 14,
+    PIXEL_FORMAT_ABGR_8888 = 15,
+    PIXEL_FORMAT_RGBA_8888 = 16,
+    PIXEL_FORMAT_BGRA_8888 = 17
+} acldvppPixelFormat;
+
+typedef struct acldvppPicDesc acldvppPicDesc;
+typedef struct acldvppStreamDesc acldvppStreamDesc;
+typedef struct acldvppChannelDesc acldvppChannelDesc;
+typedef struct acldvppResizeConfig acldvppResizeConfig;
+typedef struct acldvppRoiConfig acldvppRoiConfig;
+typedef struct acldvppJpegeConfig acldvppJpegeConfig;
+typedef struct aclvdecChannelDesc aclvdecChannelDesc;
+typedef struct aclvdecFrameConfig aclvdecFrameConfig;
+typedef void (*aclvdecCallback)(acldvppStreamDesc *input, acldvppPicDesc *output, void *userData);
+
+aclError acldvppMalloc(void **devPtr, size_t size);
+aclError acldvppFree(void *devPtr);
+
+acldvppChannelDesc *acldvppCreateChannelDesc();
+aclError acldvppDestroyChannelDesc(acldvppChannelDesc *channelDesc);
+aclError acldvppCreateChannel(acldvppChannelDesc *channelDesc);
+aclError acldvppDestroyChannel(acldvppChannelDesc *channelDesc);
+
+acldvppPicDesc *acldvppCreatePicDesc();
+aclError acldvppDestroyPicDesc(acldvppPicDesc *picDesc);
+aclError acldvppSetPicDescData(acldvppPicDesc *picDesc, void *dataDev);
+aclError acldvppSetPicDescSize(acldvppPicDesc *picDesc, uint32_t size);
+aclError acldvppSetPicDescFormat(acldvppPicDesc *picDesc, acldvppPixelFormat format);
+aclError acldvppSetPicDescWidth(acldvppPicDesc *picDesc, uint32_t width);
+aclError acldvppSetPicDescHeight(acldvppPicDesc *picDesc, uint32_t height);
+aclError acldvppSetPicDescWidthStride(acldvppPicDesc *picDesc, uint32_t widthStride);
+aclError acldvppSetPicDescHeightStride(acldvppPicDesc *picDesc, uint32_t heightStride);
+void *acldvppGetPicDescData(const acldvppPicDesc *picDesc);
+uint32_t acldvppGetPicDescSize(const acldvppPicDesc *picDesc);
+
+acldvppStreamDesc *acldvppCreateStreamDesc();
+aclError acldvppDestroyStreamDesc(acldvppStreamDesc *streamDesc);
+aclError acldvppSetStreamDescData(acldvppStreamDesc *streamDesc, void *dataDev);
+aclError acldvppSetStreamDescSize(acldvppStreamDesc *streamDesc, uint32_t size);
+aclError acldvppSetStreamDescEos(acldvppStreamDesc *streamDesc, uint8_t eos);
+void *acldvppGetStreamDescData(const acldvppStreamDesc *streamDesc);
+
+acldvppResizeConfig *acldvppCreateResizeConfig();
+aclError acldvppDestroyResizeConfig(acldvppResizeConfig *resizeConfig);
+acldvppRoiConfig *acldvppCreateRoiConfig(uint32_t left, uint32_t right, uint32_t top, uint32_t bottom);
+aclError acldvppDestroyRoiConfig(acldvppRoiConfig *roiConfig);
+aclError acldvppVpcResizeAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppResizeConfig *resizeConfig, aclrtStream stream);
+aclError acldvppVpcCropAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc, acldvppPicDesc *outputDesc,
+    acldvppRoiConfig *cropArea, aclrtStream stream);
+aclError acldvppVpcCropAndPasteAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppRoiConfig *cropArea, acldvppRoiConfig *pasteArea, aclrtStream stream);
+
+aclError acldvppJpegDecodeAsync(acldvppChannelDesc *channelDesc, const void *data, uint32_t size,
+    acldvppPicDesc *outputDesc, aclrtStream stream);
+aclError acldvppJpegEncodeAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc, const void *data,
+    uint32_t *size, acldvppJpegeConfig *config, aclrtStream stream);
+aclError acldvppJpegGetImageInfo(const void *data, uint32_t size, uint32_t *width, uint32_t *height,
+    int32_t *components);
+aclError acldvppJpegPredictDecSize(const void *data, uint32_t dataSize, acldvppPixelFormat outputPixelFormat,
+    uint32_t *decSize);
+aclError acldvppJpegPredictEncSize(const acldvppPicDesc *inputDesc, const acldvppJpegeConfig *config,
+    uint32_t *size);
+acldvppJpegeConfig *acldvppCreateJpegeConfig();
+aclError acldvppDestroyJpegeConfig(acldvppJpegeConfig *jpegeConfig);
+aclError acldvppSetJpegeConfigLevel(acldvppJpegeConfig *jpegeConfig, uint32_t level);
+
+aclvdecChannelDesc *aclvdecCreateChannelDesc();
+aclError aclvdecDestroyChannelDesc(aclvdecChannelDesc *channelDesc);
+aclError aclvdecSetChannelDescChannelId(aclvdecChannelDesc *channelDesc, uint32_t channelId);
+aclError aclvdecSetChannelDescThreadId(aclvdecChannelDesc *channelDesc, uint64_t threadId);
+aclError aclvdecSetChannelDescCallback(aclvdecChannelDesc *channelDesc, aclvdecCallback callback);
+aclError aclvdecSetChannelDescEnType(aclvdecChannelDesc *channelDesc, acldvppStreamFormat enType);
+aclError aclvdecSetChannelDescOutPicFormat(aclvdecChannelDesc *channelDesc, acldvppPixelFormat outPicFormat);
+aclError aclvdecCreateChannel(aclvdecChannelDesc *channelDesc);
+aclError aclvdecDestroyChannel(aclvdecChannelDesc *channelDesc);
+aclError aclvdecSendFrame(aclvdecChannelDesc *channelDesc, acldvppStreamDesc *input, acldvppPicDesc *output,
+    aclvdecFrameConfig *config, void *userData);
+
+#endif
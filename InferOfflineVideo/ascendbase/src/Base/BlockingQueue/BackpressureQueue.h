@@ -0,0 +1,239 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BACKPRESSURE_QUEUE_H
+#define BACKPRESSURE_QUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "ErrorCode/ErrorCode.h"
+#include "BlockingQueue/QueueBase.h"
+
+// What a producer does when the queue it pushes to is full
+enum BackpressurePolicy {
+    BACKPRESSURE_BLOCK = 0,   // wait for room, the default
+    BACKPRESSURE_DROP_OLDEST, // drop the oldest queued item to make room
+    BACKPRESSURE_DROP_NEWEST, // drop the item being pushed
+    BACKPRESSURE_KEEP_LATEST, // drop-oldest on a queue of N items, N is the queue size
+    BACKPRESSURE_BYTE_BUDGET  // drop the oldest items while the queued bytes exceed the budget
+};
+
+// Wraps a queue and applies a non-blocking policy on push. Dropped items are handed to the release function,
+// so resources their deleter does not own (e.g. device frames) are freed, and never dropped items
+// (e.g. end-of-stream markers) are still queued in order. Producers take the oldest item out for drop-oldest,
+// so the inner queue must implement PopFrontIf, as BlockingQueue does.
+template<typename T> class BackpressureQueue : public QueueBase<T> {
+public:
+    using SizeFunc = std::function<size_t(const T &)>;
+    using ReleaseFunc = std::function<void(T &)>;
+    using DroppableFunc = std::function<bool(const T &)>;
+
+    BackpressureQueue(std::shared_ptr<QueueBase<T>> queue, BackpressurePolicy policy, uint64_t byteBudget = 0)
+        : queue_(queue), policy_(policy), byteBudget_(byteBudget) {}
+
+    ~BackpressureQueue() {}
+
+    // All optional, must be set before the queue is used
+    void SetMessageFuncs(SizeFunc sizeFunc, ReleaseFunc releaseFunc, DroppableFunc droppableFunc)
+    {
+        sizeFunc_ = sizeFunc;
+        releaseFunc_ = releaseFunc;
+        droppableFunc_ = droppableFunc;
+    }
+
+    APP_ERROR Pop(T &item)
+    {
+        APP_ERROR ret = queue_->Pop(item);
+        OnPopped(ret, item);
+        return ret;
+    }
+
+    APP_ERROR Pop(T &item, unsigned int timeOutMs)
+    {
+        APP_ERROR ret = queue_->Pop(item, timeOutMs);
+        OnPopped(ret, item);
+        return ret;
+    }
+
+    APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxItems, unsigned int timeOutMs)
+    {
+        APP_ERROR ret = queue_->PopBatch(items, maxItems, timeOutMs);
+        if (ret == APP_ERR_OK && sizeFunc_) {
+            for (auto &item : items) {
+                queuedBytes_ -= static_cast<int64_t>(sizeFunc_(item));
+            }
+        }
+        return ret;
+    }
+
+    APP_ERROR Push(const T &item, bool isWait = false)
+    {
+        T copy = item;
+        return Push(std::move(copy), isWait);
+    }
+
+    APP_ERROR Push(T &&item, bool isWait = false)
+    {
+        int64_t bytes = sizeFunc_ ? static_cast<int64_t>(sizeFunc_(item)) : 0;
+        APP_ERROR ret = PushWithPolicy(std::move(item), isWait, bytes);
+        if (ret == APP_ERR_OK) {
+            this->NotifyPushed();
+        }
+        return ret;
+    }
+
+    void Stop()
+    {
+        queue_->Stop();
+    }
+
+    void Restart()
+    {
+        queue_->Restart();
+    }
+
+    int GetSize()
+    {
+        return queue_->GetSize();
+    }
+
+    APP_ERROR IsEmpty()
+    {
+        return queue_->IsEmpty();
+    }
+
+    APP_ERROR IsFull()
+    {
+        return queue_->IsFull();
+    }
+
+    void Clear()
+    {
+        std::vector<T> items;
+        while (queue_->PopBatch(items, UINT32_MAX, 0) == APP_ERR_OK) {
+            for (auto &item : items) {
+                Release(item);
+            }
+        }
+        queuedBytes_ = 0;
+    }
+
+    BackpressurePolicy GetPolicy() const
+    {
+        return policy_;
+    }
+
+    uint64_t GetDropCount() const
+    {
+        return dropCount_;
+    }
+
+    uint64_t GetDropBytes() const
+    {
+        return dropBytes_;
+    }
+
+private:
+    APP_ERROR PushWithPolicy(T &&item, bool isWait, int64_t bytes)
+    {
+        bool droppable = !droppableFunc_ || droppableFunc_(item);
+        if (policy_ == BACKPRESSURE_BLOCK || !droppable) {
+            return PushAccounted(std::move(item), isWait, bytes);
+        }
+        if (policy_ == BACKPRESSURE_BYTE_BUDGET) {
+            while (queuedBytes_ + bytes > static_cast<int64_t>(byteBudget_) && DropOldest()) {
+            }
+        }
+        while (true) {
+            APP_ERROR ret = PushAccounted(std::move(item), false, bytes);
+            if (ret != APP_ERROR_QUEUE_FULL) {
+                return ret;
+            }
+            if (policy_ == BACKPRESSURE_DROP_NEWEST || !DropOldest()) {
+                Drop(item);
+                return APP_ERR_OK;
+            }
+        }
+    }
+
+    APP_ERROR PushAccounted(T &&item, bool isWait, int64_t bytes)
+    {
+        // counted first, a consumer may take the item before Push returns
+        queuedBytes_ += bytes;
+        APP_ERROR ret = queue_->Push(std::move(item), isWait);
+        if (ret != APP_ERR_OK) {
+            queuedBytes_ -= bytes;
+        }
+        return ret;
+    }
+
+    // Return false if nothing could be dropped, the queue is empty or its oldest item must be kept. A kept item,
+    // e.g. an end-of-stream marker of another channel, stays at the front, the caller drops the new item instead
+    bool DropOldest()
+    {
+        T oldest;
+        bool isTaken = queue_->PopFrontIf(oldest, [this](const T &item) {
+            return !droppableFunc_ || droppableFunc_(item);
+        });
+        if (!isTaken) {
+            return false;
+        }
+        if (sizeFunc_) {
+            queuedBytes_ -= static_cast<int64_t>(sizeFunc_(oldest));
+        }
+        Drop(oldest);
+        return true;
+    }
+
+    void Drop(T &item)
+    {
+        dropCount_++;
+        if (sizeFunc_) {
+            dropBytes_ += sizeFunc_(item);
+        }
+        Release(item);
+    }
+
+    void Release(T &item)
+    {
+        if (releaseFunc_) {
+            releaseFunc_(item);
+        }
+        item = T();
+    }
+
+    void OnPopped(APP_ERROR ret, const T &item)
+    {
+        if (ret == APP_ERR_OK && sizeFunc_) {
+            queuedBytes_ -= static_cast<int64_t>(sizeFunc_(item));
+        }
+    }
+
+private:
+    std::shared_ptr<QueueBase<T>> queue_;
+    BackpressurePolicy policy_;
+    uint64_t byteBudget_;
+    SizeFunc sizeFunc_ = nullptr;
+    ReleaseFunc releaseFunc_ = nullptr;
+    DroppableFunc droppableFunc_ = nullptr;
+    std::atomic<int64_t> queuedBytes_ = {0};
+    std::atomic<uint64_t> dropCount_ = {0};
+    std::atomic<uint64_t> dropBytes_ = {0};
+};
+
+#endif
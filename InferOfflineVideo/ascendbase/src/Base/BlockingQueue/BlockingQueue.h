@@ -17,14 +17,16 @@
 #define BLOCKING_QUEUE_H
 
 #include "ErrorCode/ErrorCode.h"
+#include "BlockingQueue/QueueBase.h"
 #include <condition_variable>
 #include <list>
 #include <mutex>
+#include <vector>
 #include <stdint.h>
 
 static const int DEFAULT_MAX_QUEUE_SIZE = 256;
 
-template<typename T> class BlockingQueue {
+template<typename T> class BlockingQueue : public QueueBase<T> {
 public:
     BlockingQueue(uint32_t maxSize = DEFAULT_MAX_QUEUE_SIZE) : max_size_(maxSize), is_stoped_(false) {}
 
@@ -45,7 +47,7 @@ public:
         if (queue_.empty()) {
             return APP_ERR_QUEUE_EMPTY;
         } else {
-            item = queue_.front();
+            item = std::move(queue_.front());
             queue_.pop_front();
         }
 
@@ -57,12 +59,9 @@ public:
     APP_ERROR Pop(T& item, unsigned int timeOutMs)
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        auto realTime = std::chrono::milliseconds(timeOutMs);
+        empty_cond_.wait_for(lock, std::chrono::milliseconds(timeOutMs),
+            [this]() { return !queue_.empty() || is_stoped_; });
 
-        while (queue_.empty() && !is_stoped_) {
-            empty_cond_.wait_for(lock, realTime);
-        }
-        
         if (is_stoped_) {
             return APP_ERR_QUEUE_STOPED;
         }
@@ -70,7 +69,7 @@ public:
         if (queue_.empty()) {
             return APP_ERR_QUEUE_EMPTY;
         } else {
-            item = queue_.front();
+            item = std::move(queue_.front());
             queue_.pop_front();
         }
 
@@ -79,28 +78,41 @@ public:
         return APP_ERR_OK;
     }
 
-    APP_ERROR Push(const T& item, bool isWait = false)
+    APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxItems, unsigned int timeOutMs)
     {
+        items.clear();
         std::unique_lock<std::mutex> lock(mutex_);
-
-        while (queue_.size() >= max_size_ && isWait && !is_stoped_) {
-            full_cond_.wait(lock);
-        }
+        bool isReady = empty_cond_.wait_for(lock, std::chrono::milliseconds(timeOutMs),
+            [this]() { return !queue_.empty() || is_stoped_; });
 
         if (is_stoped_) {
             return APP_ERR_QUEUE_STOPED;
         }
 
-        if (queue_.size() >= max_size_) {
-            return APP_ERROR_QUEUE_FULL;
+        if (!isReady) {
+            return APP_ERR_QUEUE_EMPTY;
         }
-        queue_.push_back(item);
 
-        empty_cond_.notify_one();
+        while (!queue_.empty() && items.size() < maxItems) {
+            items.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+
+        full_cond_.notify_all();
 
         return APP_ERR_OK;
     }
 
+    APP_ERROR Push(const T& item, bool isWait = false)
+    {
+        return PushBack(item, isWait);
+    }
+
+    APP_ERROR Push(T &&item, bool isWait = false)
+    {
+        return PushBack(std::move(item), isWait);
+    }
+
     APP_ERROR Push_Front(const T &item, bool isWait = false)
     {
         std::unique_lock<std::mutex> lock(mutex_);
@@ -120,10 +132,24 @@ public:
         queue_.push_front(item);
 
         empty_cond_.notify_one();
+        lock.unlock();
+        this->NotifyPushed();
 
         return APP_ERR_OK;
     }
 
+    bool PopFrontIf(T &item, const std::function<bool(const T &)> &accept)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (is_stoped_ || queue_.empty() || !accept(queue_.front())) {
+            return false;
+        }
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        full_cond_.notify_one();
+        return true;
+    }
+
     void Stop()
     {
         {
@@ -197,6 +223,31 @@ public:
     }
 
 private:
+    // item is only consumed when it is queued
+    template<typename U> APP_ERROR PushBack(U &&item, bool isWait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (queue_.size() >= max_size_ && isWait && !is_stoped_) {
+            full_cond_.wait(lock);
+        }
+
+        if (is_stoped_) {
+            return APP_ERR_QUEUE_STOPED;
+        }
+
+        if (queue_.size() >= max_size_) {
+            return APP_ERROR_QUEUE_FULL;
+        }
+        queue_.push_back(std::forward<U>(item));
+
+        empty_cond_.notify_one();
+        lock.unlock();
+        this->NotifyPushed();
+
+        return APP_ERR_OK;
+    }
+
     std::list<T> queue_;
     std::mutex mutex_;
     std::condition_variable empty_cond_;
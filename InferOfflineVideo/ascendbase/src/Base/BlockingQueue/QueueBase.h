@@ -0,0 +1,73 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef QUEUE_BASE_H
+#define QUEUE_BASE_H
+
+#include <functional>
+#include <vector>
+#include <stdint.h>
+#include "ErrorCode/ErrorCode.h"
+
+// Common interface of the queues used to connect modules, BlockingQueue and the ring queues implement it
+template<typename T> class QueueBase {
+public:
+    virtual ~QueueBase() {}
+
+    // Block until an item is available or the queue is stopped
+    virtual APP_ERROR Pop(T &item) = 0;
+    // Block at most timeOutMs, return APP_ERR_QUEUE_EMPTY if no item arrived
+    virtual APP_ERROR Pop(T &item, unsigned int timeOutMs) = 0;
+    // Block at most timeOutMs for the first item, then take whatever else is queued, up to maxItems in total.
+    // items is cleared first, APP_ERR_QUEUE_EMPTY is returned if nothing arrived in time
+    virtual APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxItems, unsigned int timeOutMs) = 0;
+    // Return APP_ERROR_QUEUE_FULL if the queue is full and isWait is false
+    virtual APP_ERROR Push(const T &item, bool isWait = false) = 0;
+    // Same as above but moves the item in, it is left untouched if the push fails
+    virtual APP_ERROR Push(T &&item, bool isWait = false) = 0;
+    virtual void Stop() = 0;
+    virtual void Restart() = 0;
+    virtual int GetSize() = 0;
+    virtual APP_ERROR IsEmpty() = 0;
+    virtual APP_ERROR IsFull() = 0;
+    virtual void Clear() = 0;
+    // Take the oldest item without blocking, and only if accept returns true for it, else leave it in place.
+    // Return false if nothing was taken. Called by producers, so the ring queues, whose oldest item may only be read
+    // by a consumer, never take an item
+    virtual bool PopFrontIf(T &, const std::function<bool(const T &)> &)
+    {
+        return false;
+    }
+
+    // Called after every successful push, e.g. to schedule the receiver on the module executor.
+    // Must be set before the queue is used and not changed afterwards
+    void SetPushListener(std::function<void()> listener)
+    {
+        pushListener_ = listener;
+    }
+
+protected:
+    void NotifyPushed()
+    {
+        if (pushListener_) {
+            pushListener_();
+        }
+    }
+
+private:
+    std::function<void()> pushListener_ = nullptr;
+};
+
+#endif
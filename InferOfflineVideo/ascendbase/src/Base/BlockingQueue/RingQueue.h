@@ -0,0 +1,399 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include "ErrorCode/ErrorCode.h"
+#include "BlockingQueue/QueueBase.h"
+#include "BlockingQueue/BlockingQueue.h"
+
+static const size_t RING_CACHE_LINE_SIZE = 64;
+static const int RING_SPIN_COUNT = 64; // yield rounds before a waiter falls back to sleep
+static const int RING_WAIT_FOREVER = -1;
+static const size_t RING_MIN_CAPACITY = 2; // a sequence number per cell can't tell full from empty with one cell
+static const long long RING_US_PER_MS = 1000;
+
+inline size_t RingRoundUpPowerOfTwo(size_t size)
+{
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Sleep/wake helper of the ring queues. A waiter spins for a while before it sleeps on the condition variable,
+// and the waker only takes the mutex when there is a sleeper, so the push/pop path stays lock-free when busy.
+class RingWaiter {
+public:
+    // Return false if timeOutMs elapsed before ready() became true
+    template<typename Pred> bool Wait(Pred ready, int timeOutMs)
+    {
+        for (int i = 0; i < RING_SPIN_COUNT; ++i) {
+            if (ready()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleepers_.fetch_add(1);
+        // pairs with the fence in Notify, either the waker sees the sleeper or ready() sees the new state
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool isReady = true;
+        if (timeOutMs == RING_WAIT_FOREVER) {
+            cond_.wait(lock, ready);
+        } else {
+            isReady = cond_.wait_for(lock, std::chrono::milliseconds(timeOutMs), ready);
+        }
+        sleepers_.fetch_sub(1);
+        return isReady;
+    }
+
+    void Notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.notify_one();
+        }
+    }
+
+    void NotifyAll()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<int> sleepers_ {0};
+};
+
+// Push/Pop/Stop semantics shared by the ring queues, same as BlockingQueue.
+// Impl provides TryPush, TryPop, CanPush, CanPop and Size, which never block.
+template<typename T, typename Impl> class RingQueueCommon : public QueueBase<T> {
+public:
+    APP_ERROR Pop(T &item)
+    {
+        return PopWait(item, RING_WAIT_FOREVER);
+    }
+
+    APP_ERROR Pop(T &item, unsigned int timeOutMs)
+    {
+        return PopWait(item, static_cast<int>(timeOutMs));
+    }
+
+    APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxItems, unsigned int timeOutMs)
+    {
+        items.clear();
+        T item;
+        APP_ERROR ret = PopWait(item, static_cast<int>(timeOutMs));
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        items.push_back(std::move(item));
+        while (items.size() < maxItems && Derived()->TryPop(item)) {
+            items.push_back(std::move(item));
+        }
+        notFull_.NotifyAll();
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR Push(const T &item, bool isWait = false)
+    {
+        return PushImpl(item, isWait);
+    }
+
+    APP_ERROR Push(T &&item, bool isWait = false)
+    {
+        return PushImpl(std::move(item), isWait);
+    }
+
+    void Stop()
+    {
+        isStoped_.store(true, std::memory_order_release);
+        notFull_.NotifyAll();
+        notEmpty_.NotifyAll();
+    }
+
+    void Restart()
+    {
+        isStoped_.store(false, std::memory_order_release);
+    }
+
+    int GetSize()
+    {
+        return static_cast<int>(Derived()->Size());
+    }
+
+    APP_ERROR IsEmpty()
+    {
+        return Derived()->Size() == 0;
+    }
+
+    APP_ERROR IsFull()
+    {
+        return Derived()->Size() >= capacity_;
+    }
+
+    // Only safe when no producer is running
+    void Clear()
+    {
+        T item;
+        while (Derived()->TryPop(item)) {
+        }
+        notFull_.NotifyAll();
+    }
+
+protected:
+    explicit RingQueueCommon(uint32_t maxSize)
+        : capacity_(RingRoundUpPowerOfTwo(maxSize > RING_MIN_CAPACITY ? maxSize : RING_MIN_CAPACITY)),
+          mask_(capacity_ - 1) {}
+
+    size_t capacity_;
+    size_t mask_;
+
+private:
+    Impl *Derived()
+    {
+        return static_cast<Impl *>(this);
+    }
+
+    // TryPush only consumes item when it succeeds, so an rvalue can be retried
+    template<typename U> APP_ERROR PushImpl(U &&item, bool isWait)
+    {
+        while (true) {
+            if (isStoped_.load(std::memory_order_acquire)) {
+                return APP_ERR_QUEUE_STOPED;
+            }
+            if (Derived()->TryPush(std::forward<U>(item))) {
+                notEmpty_.Notify();
+                this->NotifyPushed();
+                return APP_ERR_OK;
+            }
+            if (!isWait) {
+                return APP_ERROR_QUEUE_FULL;
+            }
+            notFull_.Wait([this]() { return isStoped_.load(std::memory_order_acquire) || Derived()->CanPush(); },
+                RING_WAIT_FOREVER);
+        }
+    }
+
+    APP_ERROR PopWait(T &item, int timeOutMs)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeOutMs);
+        while (true) {
+            if (isStoped_.load(std::memory_order_acquire)) {
+                return APP_ERR_QUEUE_STOPED;
+            }
+            if (Derived()->TryPop(item)) {
+                notFull_.Notify();
+                return APP_ERR_OK;
+            }
+            int waitMs = RING_WAIT_FOREVER;
+            if (timeOutMs != RING_WAIT_FOREVER) {
+                // rounded up, else a wait of less than 1 ms left would return at once and the caller would spin
+                auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline -
+                    std::chrono::steady_clock::now()).count();
+                if (left <= 0) {
+                    return APP_ERR_QUEUE_EMPTY;
+                }
+                waitMs = static_cast<int>((left + RING_US_PER_MS - 1) / RING_US_PER_MS);
+            }
+            notEmpty_.Wait([this]() { return isStoped_.load(std::memory_order_acquire) || Derived()->CanPop(); },
+                waitMs);
+        }
+    }
+
+    std::atomic_bool isStoped_ {false};
+    RingWaiter notEmpty_;
+    RingWaiter notFull_;
+};
+
+// Single producer single consumer ring, used when every queue of a link is fed by exactly one sender instance.
+// Capacity is maxSize rounded up to a power of two, at least RING_MIN_CAPACITY.
+template<typename T> class SpscRingQueue : public RingQueueCommon<T, SpscRingQueue<T>> {
+public:
+    explicit SpscRingQueue(uint32_t maxSize = DEFAULT_MAX_QUEUE_SIZE)
+        : RingQueueCommon<T, SpscRingQueue<T>>(maxSize), slots_(this->capacity_) {}
+
+    ~SpscRingQueue() {}
+
+    template<typename U> bool TryPush(U &&item)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ >= this->capacity_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ >= this->capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & this->mask_] = std::forward<U>(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T &item)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) {
+                return false;
+            }
+        }
+        T &slot = slots_[head & this->mask_];
+        item = std::move(slot);
+        slot = T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size()
+    {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return (tail > head) ? (tail - head) : 0;
+    }
+
+    bool CanPush()
+    {
+        return Size() < this->capacity_;
+    }
+
+    bool CanPop()
+    {
+        return Size() > 0;
+    }
+
+private:
+    std::vector<T> slots_;
+    char padHead_[RING_CACHE_LINE_SIZE] = {};
+    std::atomic<size_t> head_ {0}; // written by the consumer only
+    size_t tailCache_ = 0;
+    char padTail_[RING_CACHE_LINE_SIZE] = {};
+    std::atomic<size_t> tail_ {0}; // written by the producer only
+    size_t headCache_ = 0;
+    char padEnd_[RING_CACHE_LINE_SIZE] = {};
+};
+
+// Multi producer multi consumer ring with a sequence number per cell (Vyukov bounded queue),
+// used for ONE and RANDOM links where several sender instances share one queue.
+template<typename T> class MpmcRingQueue : public RingQueueCommon<T, MpmcRingQueue<T>> {
+public:
+    explicit MpmcRingQueue(uint32_t maxSize = DEFAULT_MAX_QUEUE_SIZE)
+        : RingQueueCommon<T, MpmcRingQueue<T>>(maxSize), cells_(new Cell[this->capacity_])
+    {
+        for (size_t i = 0; i < this->capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcRingQueue() {}
+
+    template<typename U> bool TryPush(U &&item)
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &cells_[pos & this->mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T &item)
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &cells_[pos & this->mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + this->capacity_, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size()
+    {
+        size_t enqueuePos = enqueuePos_.load(std::memory_order_acquire);
+        size_t dequeuePos = dequeuePos_.load(std::memory_order_acquire);
+        return (enqueuePos > dequeuePos) ? (enqueuePos - dequeuePos) : 0;
+    }
+
+    // Size also counts the cells claimed by a push or pop which is still moving the item. The waiters look at the
+    // sequence of the next cell instead, else they would spin on TryPush/TryPop until the other thread gets a cpu
+    bool CanPush()
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        return cells_[pos & this->mask_].sequence.load(std::memory_order_acquire) == pos;
+    }
+
+    bool CanPop()
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        return cells_[pos & this->mask_].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    char padEnqueue_[RING_CACHE_LINE_SIZE] = {};
+    std::atomic<size_t> enqueuePos_ {0};
+    char padDequeue_[RING_CACHE_LINE_SIZE] = {};
+    std::atomic<size_t> dequeuePos_ {0};
+    char padEnd_[RING_CACHE_LINE_SIZE] = {};
+};
+
+#endif
@@ -131,6 +131,9 @@ enum VpcProcessType {
     VPC_PT_FILL,        // Resize with locked ratio and paste on whole locatin, the input image may be cropped
 };
 
+// Device memory from DvppMemoryPool, given back to the pool when the last copy is destroyed
+using DvppBuffer = std::shared_ptr<uint8_t>;
+
 struct DvppDataInfo {
     uint32_t width = 0;                                           // Width of image
     uint32_t height = 0;                                          // Height of image
@@ -140,6 +143,7 @@ struct DvppDataInfo {
     uint32_t frameId = 0;                                         // Needed by video
     uint32_t dataSize = 0;                                        // Size of data in byte
     uint8_t *data = nullptr;                                      // Image data
+    DvppBuffer buffer = nullptr;                                  // Owner of data when it is from the pool
 };
 
 struct CropRoiConfig {
@@ -195,6 +195,27 @@ APP_ERROR ConfigParser::GetVectorUint32Value(const std::string &name, std::vecto
     return APP_ERR_OK;
 }
 
+APP_ERROR ConfigParser::GetVectorFloatValue(const std::string &name, std::vector<float> &vector)
+{
+    if (configData_.count(name) == 0) {
+        return APP_ERR_COMM_NO_EXIST;
+    }
+    std::string str = configData_.find(name)->second;
+    std::vector<std::string> splits;
+    Split(str, splits, ',');
+    for (auto &it : splits) {
+        if (it.empty()) {
+            continue;
+        }
+        float value = 0;
+        if (!(std::stringstream(it) >> value)) {
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        vector.push_back(value);
+    }
+    return APP_ERR_OK;
+}
+
 // new config
 void ConfigParser::NewConfig(const std::string &fileName)
 {
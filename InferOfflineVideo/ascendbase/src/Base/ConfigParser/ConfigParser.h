@@ -45,6 +45,8 @@ public:
     APP_ERROR GetDoubleValue(const std::string &name, double &value);
     // Get the vector by key name, split by ","
     APP_ERROR GetVectorUint32Value(const std::string &name, std::vector<uint32_t> &vector);
+    // Get the float vector by key name, split by ","
+    APP_ERROR GetVectorFloatValue(const std::string &name, std::vector<float> &vector);
 
     void NewConfig(const std::string &fileName);
     // Write the values into new config file
@@ -33,6 +33,7 @@ DvppCommon::DvppCommon(aclrtStream dvppStream)
 DvppCommon::DvppCommon(const VdecConfig &vdecConfig)
 {
     vdecConfig_ = vdecConfig;
+    poolChannelId_ = vdecConfig.channelId;
 }
 
 /*
@@ -174,7 +175,8 @@ void DvppCommon::ReleaseDvppBuffer()
         RELEASE_DVPP_DATA(cropImage_->data);
     }
     if (resizedImage_ != nullptr) {
-        RELEASE_DVPP_DATA(resizedImage_->data);
+        resizedImage_->buffer = nullptr;
+        resizedImage_->data = nullptr;
     }
     if (decodedImage_ != nullptr) {
         RELEASE_DVPP_DATA(decodedImage_->data);
@@ -614,7 +616,7 @@ APP_ERROR DvppCommon::CombineResizeProcess(DvppDataInfo &input, DvppDataInfo &ou
         return ret;
     }
 
-    resizedImage_ = std::make_shared<DvppDataInfo>();
+    resizedImage_ = MakePooled<DvppDataInfo>();
     resizedImage_->width = output.width;
     resizedImage_->height = output.height;
     resizedImage_->format = output.format;
@@ -628,24 +630,60 @@ APP_ERROR DvppCommon::CombineResizeProcess(DvppDataInfo &input, DvppDataInfo &ou
     if (ret != APP_ERR_OK) {
         return ret;
     }
-    // Malloc buffer for output of resize module
-    // Need to pay attention to release of the buffer
-    ret = acldvppMalloc((void **)(&(resizedImage_->data)), resizedImage_->dataSize);
+    // The buffer of the output goes back to the pool when the last copy of resizedImage_->buffer is destroyed
+    ret = DvppMemoryPool::GetInstance().Alloc(resizedImage_->dataSize, poolChannelId_, resizedImage_->buffer);
     if (ret != APP_ERR_OK) {
         LogError << "Failed to malloc " << resizedImage_->dataSize << " bytes on dvpp for resize, ret = " << ret << ".";
         return ret;
     }
+    resizedImage_->data = resizedImage_->buffer.get();
 
-    aclrtMemset(resizedImage_->data, resizedImage_->dataSize, YUV_GREYER_VALUE, resizedImage_->dataSize);
+    FillResizePadding(input, processType);
     resizedImage_->frameId = input.frameId;
     ret = VpcResize(input, *resizedImage_, withSynchronize, processType);
     if (ret != APP_ERR_OK) {
         // Release the output buffer when resize failed, otherwise release it after use
-        RELEASE_DVPP_DATA(resizedImage_->data);
+        resizedImage_->buffer = nullptr;
+        resizedImage_->data = nullptr;
     }
     return ret;
 }
 
+/*
+ * @description: Fill the area of resizedImage_ which VPC does not write with grey
+ * @param: input specifies the input image information
+ * @param: processType specifies whether to perform proportional scaling
+ * @attention: Buffers from the pool hold the previous picture, so the padding is filled every time. When the paste
+ *             area spans whole rows only the bands above and below it are filled
+ */
+void DvppCommon::FillResizePadding(const DvppDataInfo &input, VpcProcessType processType)
+{
+    DvppDataInfo &output = *resizedImage_;
+    // The whole picture is written by VPC
+    if (processType == VPC_PT_DEFAULT || processType == VPC_PT_FILL) {
+        return;
+    }
+    CropRoiConfig pasteRoi = {0};
+    GetPasteRoi(input, output, processType, pasteRoi);
+    if (pasteRoi.left != 0 || pasteRoi.right + ODD_NUM_1 < output.width) {
+        aclrtMemset(output.data, output.dataSize, YUV_GREYER_VALUE, output.dataSize);
+        return;
+    }
+    auto fillRows = [&output](size_t planeOffset, uint32_t beginRow, uint32_t endRow) {
+        if (endRow > beginRow) {
+            size_t offset = planeOffset + static_cast<size_t>(beginRow) * output.widthStride;
+            size_t count = static_cast<size_t>(endRow - beginRow) * output.widthStride;
+            aclrtMemset(output.data + offset, output.dataSize - offset, YUV_GREYER_VALUE, count);
+        }
+    };
+    // YUV420SP, the chroma plane has half of the rows
+    size_t lumaSize = static_cast<size_t>(output.widthStride) * output.heightStride;
+    fillRows(0, 0, pasteRoi.up);
+    fillRows(0, pasteRoi.down + ODD_NUM_1, output.heightStride);
+    fillRows(lumaSize, 0, pasteRoi.up / MODULUS_NUM_2);
+    fillRows(lumaSize, (pasteRoi.down + ODD_NUM_1) / MODULUS_NUM_2, output.heightStride / MODULUS_NUM_2);
+}
+
 /*
  * @description: Set picture description information and execute crop function
  * @param: cropInput specifies the input image information and cropping area
@@ -1058,14 +1096,28 @@ APP_ERROR DvppCommon::CreateStreamDesc(std::shared_ptr<DvppDataInfo> data)
         LogError << "Failed to malloc dvpp data with " << data->dataSize << " bytes, ret = " << ret << ".";
         return APP_ERR_ACL_BAD_ALLOC;
     }
+    ret = CreateStreamDesc(data, modelInBuff);
+    if (ret != APP_ERR_OK) {
+        acldvppFree(modelInBuff);
+        modelInBuff = nullptr;
+    }
+    return ret;
+}
+
+/*
+ * @description: Copy the video stream to the device buffer and create the description of it
+ * @param: data specifies the information about the video stream
+ * @param: inDevBuff specifies the device buffer, its size is at least data->dataSize
+ * @return: APP_ERR_OK if success, other values if failure
+ */
+APP_ERROR DvppCommon::CreateStreamDesc(std::shared_ptr<DvppDataInfo> data, void *inDevBuff)
+{
     // copy input to device memory
-    ret = aclrtMemcpy(modelInBuff, data->dataSize, static_cast<uint8_t *>(data->data), data->dataSize,
-                      ACL_MEMCPY_HOST_TO_DEVICE);
+    APP_ERROR ret = aclrtMemcpy(inDevBuff, data->dataSize, static_cast<uint8_t *>(data->data), data->dataSize,
+                                ACL_MEMCPY_HOST_TO_DEVICE);
     if (ret != APP_ERR_OK) {
         LogError << "Failed to copy memory with " << data->dataSize  << " bytes from host to device, ret = " \
                  << ret << ".";
-        acldvppFree(modelInBuff);
-        modelInBuff = nullptr;
         return APP_ERR_ACL_FAILURE;
     }
     // Create input stream desc which need to be destoryed in vdec callback function
@@ -1074,7 +1126,7 @@ APP_ERROR DvppCommon::CreateStreamDesc(std::shared_ptr<DvppDataInfo> data)
         LogError << "Failed to create input stream description.";
         return APP_ERR_ACL_FAILURE;
     }
-    ret = acldvppSetStreamDescData(streamInputDesc_, modelInBuff);
+    ret = acldvppSetStreamDescData(streamInputDesc_, inDevBuff);
     if (ret != APP_ERR_OK) {
         LogError << "Failed to set data for stream desdescription, ret = " << ret << ".";
         return ret;
@@ -1124,6 +1176,73 @@ APP_ERROR DvppCommon::CombineVdecProcess(std::shared_ptr<DvppDataInfo> data, voi
         return APP_ERR_ACL_BAD_ALLOC;
     }
 
+    return SendVdecFrame(picOutBufferDev, dataSize, userData);
+}
+
+/*
+ * @description: Decode the video stream like above, the input and output buffers are taken from DvppMemoryPool
+ * @param: data specifies the information about the video stream
+ * @param: userdata is specified for user-defined data
+ * @param: inputBuffer is used to save the device buffer of the video stream
+ * @param: outputBuffer is used to save the device buffer of the decoded picture
+ * @return: APP_ERR_OK if success, other values if failure
+ * @attention: The buffers are set before the frame is sent, so they can be members of userData, and must be kept
+ *             until the callback of the frame returns. The input stream desc and the output pic desc are still
+ *             destroyed by the callback
+ */
+APP_ERROR DvppCommon::CombineVdecProcess(std::shared_ptr<DvppDataInfo> data, void *userData, DvppBuffer &inputBuffer,
+                                         DvppBuffer &outputBuffer)
+{
+    // Return special error code when the DvppCommon object is not initialized with InitVdec
+    if (!isVdec_) {
+        LogError << "CombineVdecProcess cannot be called by the DvppCommon object which is not initialized with InitVdec.";
+        return APP_ERR_DVPP_OBJ_FUNC_MISMATCH;
+    }
+    // The descs of the frames sent before are owned by their callbacks
+    streamInputDesc_ = nullptr;
+    picOutputDesc_ = nullptr;
+    DvppMemoryPool &pool = DvppMemoryPool::GetInstance();
+    APP_ERROR ret = pool.Alloc(data->dataSize, poolChannelId_, inputBuffer);
+    if (ret != APP_ERR_OK) {
+        return APP_ERR_ACL_BAD_ALLOC;
+    }
+    ret = CreateStreamDesc(data, inputBuffer.get());
+
+    uint32_t dataSize = 0;
+    if (ret == APP_ERR_OK) {
+        ret = GetVideoDecodeDataSize(vdecConfig_.inputWidth, vdecConfig_.inputHeight, vdecConfig_.outFormat,
+                                     dataSize);
+    }
+    if (ret == APP_ERR_OK) {
+        ret = pool.Alloc(dataSize, poolChannelId_, outputBuffer);
+    }
+    if (ret == APP_ERR_OK) {
+        ret = SendVdecFrame(outputBuffer.get(), dataSize, userData);
+    }
+    if (ret != APP_ERR_OK) {
+        if (streamInputDesc_ != nullptr) {
+            acldvppDestroyStreamDesc(streamInputDesc_);
+            streamInputDesc_ = nullptr;
+        }
+        if (picOutputDesc_ != nullptr) {
+            acldvppDestroyPicDesc(picOutputDesc_);
+            picOutputDesc_ = nullptr;
+        }
+        inputBuffer = nullptr;
+        outputBuffer = nullptr;
+    }
+    return ret;
+}
+
+/*
+ * @description: Create the description of the output picture and send the frame to VDEC
+ * @param: picOutBufferDev specifies the device buffer of the decoded picture
+ * @param: dataSize specifies the size of picOutBufferDev
+ * @param: userdata is specified for user-defined data
+ * @return: APP_ERR_OK if success, other values if failure
+ */
+APP_ERROR DvppCommon::SendVdecFrame(void *picOutBufferDev, uint32_t dataSize, void *userData)
+{
     // picOutputDesc_ will be destoryed in vdec callback function
     picOutputDesc_ = acldvppCreatePicDesc();
     if (picOutputDesc_ == NULL) {
@@ -1136,7 +1255,7 @@ APP_ERROR DvppCommon::CombineVdecProcess(std::shared_ptr<DvppDataInfo> data, voi
     dataInfo.format = vdecConfig_.outFormat;
     dataInfo.dataSize = dataSize;
     dataInfo.data = static_cast<uint8_t *>(picOutBufferDev);
-    ret = SetDvppPicDescData(dataInfo, *picOutputDesc_);
+    APP_ERROR ret = SetDvppPicDescData(dataInfo, *picOutputDesc_);
     if (ret != APP_ERR_OK) {
         return ret;
     }
@@ -1462,4 +1581,9 @@ std::shared_ptr<DvppDataInfo> DvppCommon::GetCropedImage()
     return cropImage_;
 }
 
+void DvppCommon::SetMemoryPoolChannel(uint32_t channelId)
+{
+    poolChannelId_ = channelId;
+}
+
 DvppCommon::~DvppCommon() {}
@@ -16,6 +16,8 @@
 #ifndef DVPP_COMMON_H
 #define DVPP_COMMON_H
 #include "CommonDataType/CommonDataType.h"
+#include "DvppCommon/DvppMemoryPool.h"
+#include "ObjectPool/ObjectPool.h"
 #include "ErrorCode/ErrorCode.h"
 
 #include "acl/ops/acl_dvpp.h"
@@ -148,6 +150,8 @@ public:
     // transfer pictures from host to device, and then execute the DVPP operation.
     // The caller needs to pay attention to the release of the memory alloced in these functions.
     // You can call the ReleaseDvppBuffer function to release memory after use completely.
+    // The output of CombineResizeProcess is taken from DvppMemoryPool and owned by the buffer of GetResizedImage(),
+    // it must not be freed with acldvppFree.
     APP_ERROR CombineResizeProcess(DvppDataInfo &input, DvppDataInfo &output, bool withSynchronize,
                                    VpcProcessType processType = VPC_PT_DEFAULT);
     APP_ERROR CombineCropProcess(DvppCropInputInfo &input, DvppDataInfo &output, bool withSynchronize);
@@ -156,6 +160,10 @@ public:
                                   bool withSynchronize);
     // The following interface can be called only when the DvppCommon object is initialized with InitVdec
     APP_ERROR CombineVdecProcess(std::shared_ptr<DvppDataInfo> data, void *userData);
+    // Same as above with the bitstream and picture buffers taken from DvppMemoryPool instead of freed by the callback.
+    // They are returned in inputBuffer and outputBuffer, which must be kept until the callback of the frame returns
+    APP_ERROR CombineVdecProcess(std::shared_ptr<DvppDataInfo> data, void *userData, DvppBuffer &inputBuffer,
+                                 DvppBuffer &outputBuffer);
 
     // Get the private member variables which are assigned in the interfaces which are started with "Combine"
     std::shared_ptr<DvppDataInfo> GetInputImage();
@@ -167,6 +175,8 @@ public:
     // Release the memory that is allocated in the interfaces which are started with "Combine"
     void ReleaseDvppBuffer();
     APP_ERROR VdecSendEosFrame() const;
+    // Buffers of this object are taken from the free lists of the channel, VDEC uses its channel by default
+    void SetMemoryPoolChannel(uint32_t channelId);
 
 private:
     APP_ERROR SetDvppPicDescData(const DvppDataInfo &dataInfo, acldvppPicDesc &picDesc);
@@ -183,6 +193,9 @@ private:
     APP_ERROR CheckCropParams(const DvppCropInputInfo &input);
     APP_ERROR TransferImageH2D(const RawData& imageInfo, const std::shared_ptr<DvppDataInfo>& jpegInput);
     APP_ERROR CreateStreamDesc(std::shared_ptr<DvppDataInfo> data);
+    APP_ERROR CreateStreamDesc(std::shared_ptr<DvppDataInfo> data, void *inDevBuff);
+    APP_ERROR SendVdecFrame(void *picOutBufferDev, uint32_t dataSize, void *userData);
+    void FillResizePadding(const DvppDataInfo &input, VpcProcessType processType);
     APP_ERROR DestroyResource();
 
     std::shared_ptr<acldvppRoiConfig> cropAreaConfig_ = nullptr;
@@ -213,5 +226,6 @@ private:
     acldvppStreamDesc *streamInputDesc_ = nullptr;
     acldvppPicDesc *picOutputDesc_ = nullptr;
     VdecConfig vdecConfig_;
+    uint32_t poolChannelId_ = 0;
 };
 #endif
@@ -0,0 +1,201 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DvppMemoryPool.h"
+#include "Log/Log.h"
+#include "ObjectPool/ObjectPool.h"
+
+namespace {
+const uint32_t MIN_CLASS_SIZE_LOG2 = 12;   // 4 KB
+const uint32_t MAX_CLASS_SIZE_LOG2 = 28;   // 256 MB
+const uint32_t SUB_CLASSES_LOG2 = 2;       // 4 classes per power of two, at most 25% is wasted
+const uint32_t SUB_CLASSES = 1U << SUB_CLASSES_LOG2;
+const uint32_t CLASS_NUM = 1 + (MAX_CLASS_SIZE_LOG2 - MIN_CLASS_SIZE_LOG2) * SUB_CLASSES;
+const uint32_t UNCACHED_CLASS = CLASS_NUM; // larger than the largest class, allocated and freed directly
+const uint32_t FREE_LIST_NUM = 64;         // channels share free lists when there are more of them
+const uint64_t DEFAULT_MAX_CACHED_BYTES = 1024ULL * 1024 * 1024;
+
+uint32_t Log2Floor(size_t value)
+{
+    uint32_t result = 0;
+    while (value >>= 1) {
+        result++;
+    }
+    return result;
+}
+
+// class 0 is 4 KB, class 1 + 4 * (e - 12) + (k - 1) is 2^e + k * 2^(e - 2) for k = 1 ~ 4
+uint32_t SizeClassOf(size_t size)
+{
+    if (size <= (1ULL << MIN_CLASS_SIZE_LOG2)) {
+        return 0;
+    }
+    uint32_t exponent = Log2Floor(size - 1);
+    if (exponent >= MAX_CLASS_SIZE_LOG2) {
+        return UNCACHED_CLASS;
+    }
+    size_t step = 1ULL << (exponent - SUB_CLASSES_LOG2);
+    size_t sub = (size - (1ULL << exponent) + step - 1) / step;
+    return 1 + (exponent - MIN_CLASS_SIZE_LOG2) * SUB_CLASSES + static_cast<uint32_t>(sub) - 1;
+}
+
+size_t ClassSize(uint32_t classIndex)
+{
+    if (classIndex == 0) {
+        return 1ULL << MIN_CLASS_SIZE_LOG2;
+    }
+    uint32_t exponent = MIN_CLASS_SIZE_LOG2 + (classIndex - 1) / SUB_CLASSES;
+    size_t sub = (classIndex - 1) % SUB_CLASSES + 1;
+    return (1ULL << exponent) + sub * (1ULL << (exponent - SUB_CLASSES_LOG2));
+}
+
+// pools are never destroyed, buffers may be released by threads still running at exit
+std::mutex g_poolMutex;
+std::map<int32_t, DvppMemoryPool *> g_pools;
+}
+
+DvppMemoryPool &DvppMemoryPool::GetInstance()
+{
+    int32_t deviceId = 0;
+    aclError ret = aclrtGetDevice(&deviceId);
+    if (ret != ACL_ERROR_NONE) {
+        deviceId = 0;
+    }
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    DvppMemoryPool *&pool = g_pools[deviceId];
+    if (pool == nullptr) {
+        pool = new DvppMemoryPool();
+    }
+    return *pool;
+}
+
+std::map<int32_t, DvppMemoryPoolStats> DvppMemoryPool::GetAllStats()
+{
+    std::map<int32_t, DvppMemoryPoolStats> stats;
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    for (auto &pool : g_pools) {
+        stats[pool.first] = pool.second->GetStats();
+    }
+    return stats;
+}
+
+void DvppMemoryPool::TrimAll()
+{
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    for (auto &pool : g_pools) {
+        pool.second->Drain();
+    }
+}
+
+DvppMemoryPool::DvppMemoryPool() : freeLists_(FREE_LIST_NUM), maxCachedBytes_(DEFAULT_MAX_CACHED_BYTES)
+{
+    for (auto &freeLists : freeLists_) {
+        freeLists.blocks.resize(CLASS_NUM);
+    }
+}
+
+APP_ERROR DvppMemoryPool::Alloc(size_t size, uint32_t channelId, DvppBuffer &buffer)
+{
+    uint32_t listIndex = channelId % FREE_LIST_NUM;
+    uint32_t classIndex = SizeClassOf(size);
+    size_t blockSize = (classIndex == UNCACHED_CLASS) ? size : ClassSize(classIndex);
+    void *block = nullptr;
+    if (classIndex != UNCACHED_CLASS) {
+        FreeLists &freeLists = freeLists_[listIndex];
+        std::lock_guard<std::mutex> lock(freeLists.mutex);
+        std::vector<void *> &blocks = freeLists.blocks[classIndex];
+        if (!blocks.empty()) {
+            block = blocks.back();
+            blocks.pop_back();
+            cachedBytes_ -= blockSize;
+        }
+    }
+    if (block != nullptr) {
+        hits_++;
+    } else {
+        APP_ERROR ret = acldvppMalloc(&block, blockSize);
+        if (ret != APP_ERR_OK) {
+            LogError << "Failed to malloc " << blockSize << " bytes on dvpp, ret = " << ret << ".";
+            return ret;
+        }
+        misses_++;
+    }
+    inUseBytes_ += blockSize;
+    buffer = DvppBuffer(static_cast<uint8_t *>(block), BlockReleaser(this, listIndex, classIndex, blockSize),
+                        RecyclingAllocator<uint8_t>());
+    return APP_ERR_OK;
+}
+
+void DvppMemoryPool::BlockReleaser::operator()(uint8_t *block) const
+{
+    pool_->Release(block, listIndex_, classIndex_, blockSize_);
+}
+
+void DvppMemoryPool::Release(uint8_t *block, uint32_t listIndex, uint32_t classIndex, size_t blockSize)
+{
+    inUseBytes_ -= blockSize;
+    if (classIndex != UNCACHED_CLASS) {
+        if (cachedBytes_.fetch_add(blockSize) + blockSize <= maxCachedBytes_) {
+            FreeLists &freeLists = freeLists_[listIndex];
+            std::lock_guard<std::mutex> lock(freeLists.mutex);
+            // checked under the lock, a block pushed before Drain sets the flag is freed by its Trim
+            if (!drained_) {
+                freeLists.blocks[classIndex].push_back(block);
+                return;
+            }
+        }
+        cachedBytes_ -= blockSize;
+    }
+    APP_ERROR ret = acldvppFree(block);
+    if (ret != APP_ERR_OK) {
+        LogError << "Failed to free memory on dvpp, ret = " << ret << ".";
+    }
+}
+
+void DvppMemoryPool::SetMaxCachedBytes(uint64_t maxCachedBytes)
+{
+    maxCachedBytes_ = maxCachedBytes;
+}
+
+DvppMemoryPoolStats DvppMemoryPool::GetStats() const
+{
+    DvppMemoryPoolStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.cachedBytes = cachedBytes_;
+    stats.inUseBytes = inUseBytes_;
+    return stats;
+}
+
+void DvppMemoryPool::Trim()
+{
+    for (auto &freeLists : freeLists_) {
+        std::lock_guard<std::mutex> lock(freeLists.mutex);
+        for (uint32_t classIndex = 0; classIndex < CLASS_NUM; classIndex++) {
+            for (void *block : freeLists.blocks[classIndex]) {
+                acldvppFree(block);
+                cachedBytes_ -= ClassSize(classIndex);
+            }
+            freeLists.blocks[classIndex].clear();
+        }
+    }
+}
+
+void DvppMemoryPool::Drain()
+{
+    drained_ = true;
+    Trim();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DVPP_MEMORY_POOL_H
+#define DVPP_MEMORY_POOL_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "CommonDataType/CommonDataType.h"
+#include "ErrorCode/ErrorCode.h"
+
+struct DvppMemoryPoolStats {
+    uint64_t hits = 0;        // allocations served from a free list
+    uint64_t misses = 0;      // allocations which called acldvppMalloc
+    uint64_t cachedBytes = 0; // memory in the free lists
+    uint64_t inUseBytes = 0;  // memory held by DvppBuffer handles
+};
+
+// Cache of DVPP memory of one device. Sizes are rounded up to a size class, 4 classes per power of two from 4 KB
+// to 256 MB, and released blocks are kept in per-channel free lists, so the buffers of a video channel are reused
+// without acldvppMalloc once the pipeline runs. Larger buffers and releases beyond the cache limit go to the device
+class DvppMemoryPool {
+public:
+    // Pool of the device of the current context
+    static DvppMemoryPool &GetInstance();
+    static std::map<int32_t, DvppMemoryPoolStats> GetAllStats();
+    // Frees the cached blocks of every device, called before the devices are reset. The pools are drained afterwards,
+    // blocks still held by a DvppBuffer are freed when it is released instead of going back to a free list
+    static void TrimAll();
+
+    // The memory goes back to the pool when the last copy of buffer is destroyed
+    APP_ERROR Alloc(size_t size, uint32_t channelId, DvppBuffer &buffer);
+    void SetMaxCachedBytes(uint64_t maxCachedBytes);
+    DvppMemoryPoolStats GetStats() const;
+    void Trim();
+    void Drain();
+
+private:
+    struct FreeLists {
+        std::mutex mutex;
+        std::vector<std::vector<void *>> blocks; // per size class
+    };
+
+    class BlockReleaser {
+    public:
+        BlockReleaser(DvppMemoryPool *pool, uint32_t listIndex, uint32_t classIndex, size_t blockSize)
+            : pool_(pool), listIndex_(listIndex), classIndex_(classIndex), blockSize_(blockSize) {}
+        void operator()(uint8_t *block) const;
+
+    private:
+        DvppMemoryPool *pool_;
+        uint32_t listIndex_;
+        uint32_t classIndex_;
+        size_t blockSize_;
+    };
+
+    DvppMemoryPool();
+    ~DvppMemoryPool() = default;
+    DvppMemoryPool(const DvppMemoryPool &) = delete;
+    DvppMemoryPool &operator=(const DvppMemoryPool &) = delete;
+
+    void Release(uint8_t *block, uint32_t listIndex, uint32_t classIndex, size_t blockSize);
+
+    std::vector<FreeLists> freeLists_;
+    std::atomic<uint64_t> maxCachedBytes_;
+    std::atomic<uint64_t> hits_ = {0};
+    std::atomic<uint64_t> misses_ = {0};
+    std::atomic<uint64_t> cachedBytes_ = {0};
+    std::atomic<uint64_t> inUseBytes_ = {0};
+    std::atomic<bool> drained_ = {false};
+};
+
+#endif
@@ -15,6 +15,7 @@
  */
 
 #include "ModelProcess.h"
+#include <chrono>
 #include "FileManager/FileManager.h"
 
 ModelProcess::ModelProcess(const int deviceId, const std::string& modelName)
@@ -98,6 +99,93 @@ int ModelProcess::ModelInference(std::vector<void *> &inputBufs, std::vector<siz
     return APP_ERR_OK;
 }
 
+/*
+ * @description: Create the datasets of a slot, bound to its buffers until the model is deinitialized. A slot is
+ *               bound once, an asynchronous run may still use the datasets of a bound slot
+ * @param slotId Index of the slot, e.g. of the output set in its ring
+ * @param inputBufs The inputs of the model, the first one is replaced by each inference
+ * @param outputBufs The outputs of the model, written by every inference of the slot
+ */
+APP_ERROR ModelProcess::BindSlot(size_t slotId, const std::vector<void *> &inputBufs,
+    const std::vector<size_t> &inputSizes, const std::vector<void *> &outputBufs,
+    const std::vector<size_t> &outputSizes)
+{
+    if (inputBufs.empty()) {
+        LogError << "The model needs an input to bind slot " << slotId << ".";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    if (slotId >= slots_.size()) {
+        slots_.resize(slotId + 1);
+    }
+    SlotDatasets &slot = slots_[slotId];
+    if (slot.input != nullptr) {
+        LogError << "Slot " << slotId << " of model[" << modelName_ << "] is already bound.";
+        return APP_ERR_COMM_EXIST;
+    }
+    slot.input = CreateAndFillDataset(inputBufs, inputSizes);
+    slot.output = CreateAndFillDataset(outputBufs, outputSizes);
+    if (slot.input == nullptr || slot.output == nullptr) {
+        DestroyDataset(slot.input);
+        DestroyDataset(slot.output);
+        slot = SlotDatasets();
+        return APP_ERR_COMM_FAILURE;
+    }
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Run the model on the datasets of a slot, with inputPtr as first input
+ * @param slotId Slot bound by BindSlot, its outputs are written
+ * @param inputPtr Device memory of the first input, of the size bound to the slot
+ * @param dynamicBatchSize Batch size to run a dynamic batch model with, 0 for a static model
+ * @param stream Stream the run is enqueued on, nullptr runs it synchronously
+ */
+APP_ERROR ModelProcess::ModelInference(size_t slotId, void *inputPtr, size_t dynamicBatchSize, aclrtStream stream)
+{
+    if (slotId >= slots_.size() || slots_[slotId].input == nullptr) {
+        LogError << "Slot " << slotId << " of model[" << modelName_ << "] is not bound.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    SlotDatasets &slot = slots_[slotId];
+    aclDataBuffer *inputBuffer = aclmdlGetDatasetBuffer(slot.input, 0);
+    APP_ERROR ret = aclUpdateDataBuffer(inputBuffer, inputPtr, aclGetDataBufferSize(inputBuffer));
+    if (ret != ACL_ERROR_NONE) {
+        LogError << "aclUpdateDataBuffer failed, ret[" << ret << "].";
+        return APP_ERR_ACL_FAILURE;
+    }
+    if (dynamicBatchSize != 0) {
+        if (dynamicIndex_ == SIZE_MAX &&
+            aclmdlGetInputIndexByName(modelDesc_.get(), ACL_DYNAMIC_TENSOR_NAME, &dynamicIndex_) != ACL_ERROR_NONE) {
+            dynamicIndex_ = SIZE_MAX;
+            LogError << "aclmdlGetInputIndexByName failed, maybe static model";
+            return APP_ERR_COMM_CONNECTION_FAILURE;
+        }
+        ret = aclmdlSetDynamicBatchSize(modelId_, slot.input, dynamicIndex_, dynamicBatchSize);
+        if (ret != ACL_ERROR_NONE) {
+            LogError << "dynamic batch set failed, modelId_=" << modelId_ << ", slot=" << slotId << ", index=" <<
+                dynamicIndex_ << ", dynamicBatchSize=" << dynamicBatchSize;
+            return APP_ERR_COMM_CONNECTION_FAILURE;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    ret = (stream == nullptr) ? aclmdlExecute(modelId_, slot.input, slot.output) :
+        aclmdlExecuteAsync(modelId_, slot.input, slot.output, stream);
+    if (ret != APP_ERR_OK) {
+        LogError << ((stream == nullptr) ? "aclmdlExecute" : "aclmdlExecuteAsync") << " failed, ret[" << ret << "].";
+        return ret;
+    }
+    return APP_ERR_OK;
+}
+
+void ModelProcess::UnbindSlots()
+{
+    for (auto &slot : slots_) {
+        DestroyDataset(slot.input);
+        DestroyDataset(slot.output);
+    }
+    slots_.clear();
+}
+
 int ModelProcess::ModelInferDynamicHW(const std::vector<void *> &inputBufs, const std::vector<size_t> &inputSizes,
                                       const std::vector<void *> &ouputBufs, const std::vector<size_t> &outputSizes)
 {
@@ -145,6 +233,7 @@ int ModelProcess::DeInit()
 {
     LogInfo << "Model[" << modelName_ << "][" << deviceId_ << "] deinit begin";
     isDeInit_ = true;
+    UnbindSlots();
     APP_ERROR ret = aclmdlUnload(modelId_);
     if (ret != APP_ERR_OK) {
         LogError << "aclmdlUnload  failed, ret["<< ret << "].";
@@ -159,14 +248,9 @@ int ModelProcess::DeInit()
         }
         modelDevPtr_ = nullptr;
     }
-    if (weightDevPtr_ != nullptr) {
-        ret = aclrtFree(weightDevPtr_);
-        if (ret != APP_ERR_OK) {
-            LogError << "aclrtFree  failed, ret[" << ret << "].";
-            return ret;
-        }
-        weightDevPtr_ = nullptr;
-    }
+    weight_ = nullptr;
+    weightDevPtr_ = nullptr;
+    model_ = nullptr;
     for (size_t i = 0; i < inputBuffers_.size(); i++) {
         if (inputBuffers_[i] != nullptr) {
             aclrtFree(inputBuffers_[i]);
@@ -186,21 +270,50 @@ int ModelProcess::DeInit()
     return APP_ERR_OK;
 }
 
-APP_ERROR ModelProcess::Init(std::string modelPath)
+/*
+ * @description: Allocate the weight memory of the model, or take the one of an instance loaded with the same model
+ * @param shareWeight Whether to share the weight memory
+ */
+APP_ERROR ModelProcess::AcquireWeight(bool shareWeight)
 {
-    LogInfo << "ModelProcess:Begin to init instance.";
-    int modelSize = 0;
-    std::shared_ptr<uint8_t> modelData = nullptr;
-    APP_ERROR ret = ReadBinaryFile(modelPath, modelData, modelSize);
+    std::lock_guard<std::mutex> lock(model_->weightMutex);
+    std::weak_ptr<void> &sharedWeight = model_->weight;
+    if (shareWeight) {
+        weight_ = sharedWeight.lock();
+        if (weight_ != nullptr) {
+            weightDevPtr_ = weight_.get();
+            return APP_ERR_OK;
+        }
+    }
+    APP_ERROR ret = aclrtMalloc(&weightDevPtr_, weightDevPtrSize_, ACL_MEM_MALLOC_HUGE_FIRST);
     if (ret != APP_ERR_OK) {
-        LogError << "read model file failed, ret[" << ret << "].";
+        LogError << "aclrtMalloc weight_ptr failed, ret[" << ret << "] (" << GetAppErrCodeInfo(ret) << ").";
+        weightDevPtr_ = nullptr;
         return ret;
     }
-    ret = aclmdlQuerySizeFromMem(modelData.get(), modelSize, &modelDevPtrSize_, &weightDevPtrSize_);
+    weight_.reset(weightDevPtr_, [](void *weight) {
+        APP_ERROR ret = aclrtFree(weight);
+        if (ret != APP_ERR_OK) {
+            LogError << "aclrtFree  failed, ret[" << ret << "].";
+        }
+    });
+    if (shareWeight) {
+        sharedWeight = weight_;
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR ModelProcess::Init(std::string modelPath, bool shareWeight)
+{
+    LogInfo << "ModelProcess:Begin to init instance.";
+    auto startTime = std::chrono::steady_clock::now();
+    APP_ERROR ret = ResourceManager::GetInstance()->AcquireModel(modelPath, deviceId_, model_);
     if (ret != APP_ERR_OK) {
-        LogError << "aclmdlQuerySizeFromMem failed, ret[" << ret << "].";
+        LogError << "acquire model file failed, ret[" << ret << "].";
         return ret;
     }
+    modelDevPtrSize_ = model_->workSize;
+    weightDevPtrSize_ = model_->weightSize;
     LogDebug << "modelDevPtrSize_[" << modelDevPtrSize_ << "], weightDevPtrSize_[" << weightDevPtrSize_ << "].";
 
     ret = aclrtMalloc(&modelDevPtr_, modelDevPtrSize_, ACL_MEM_MALLOC_HUGE_FIRST);
@@ -208,13 +321,13 @@ APP_ERROR ModelProcess::Init(std::string modelPath)
         LogError << "aclrtMalloc dev_ptr failed, ret[" << ret << "].";
         return ret;
     }
-    ret = aclrtMalloc(&weightDevPtr_, weightDevPtrSize_, ACL_MEM_MALLOC_HUGE_FIRST);
+    // a load writes the same weights again, the instances sharing them are loaded before any of them runs
+    ret = AcquireWeight(shareWeight);
     if (ret != APP_ERR_OK) {
-        LogError << "aclrtMalloc weight_ptr failed, ret[" << ret << "] (" << GetAppErrCodeInfo(ret) << ").";
         return ret;
     }
-    ret = aclmdlLoadFromMemWithMem(modelData.get(), modelSize, &modelId_, modelDevPtr_, modelDevPtrSize_,
-        weightDevPtr_, weightDevPtrSize_);
+    ret = aclmdlLoadFromMemWithMem(model_->info.modelFilePtr.get(), model_->info.modelFileSize, &modelId_,
+        modelDevPtr_, modelDevPtrSize_, weightDevPtr_, weightDevPtrSize_);
     if (ret != APP_ERR_OK) {
         LogError << "aclmdlLoadFromMemWithMem failed, ret[" << ret << "].";
         return ret;
@@ -236,6 +349,8 @@ APP_ERROR ModelProcess::Init(std::string modelPath)
         return ret;
     }
     modelDesc_.reset(modelDesc, aclmdlDestroyDesc);
+    LogInfo << "Model[" << modelName_ << "][" << deviceId_ << "] loaded in " << std::chrono::duration<double,
+        std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms.";
     return APP_ERR_OK;
 }
 
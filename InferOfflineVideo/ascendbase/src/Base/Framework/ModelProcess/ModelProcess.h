@@ -17,7 +17,9 @@
 #ifndef MODELPROCSS_H
 #define MODELPROCSS_H
 
+#include <cstdint>
 #include <cstdio>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
@@ -25,6 +27,7 @@
 #include "CommonDataType/CommonDataType.h"
 #include "Log/Log.h"
 #include "ErrorCode/ErrorCode.h"
+#include "ResourceManager/ResourceManager.h"
 
 // Class of model inference
 class ModelProcess {
@@ -35,13 +38,23 @@ public:
     ModelProcess();
     ~ModelProcess();
 
-    int Init(std::string modelPath);
+    // The model file is mapped once by ResourceManager. With shareWeight the instances loading the same model file on
+    // a device use one weight memory, freed with the last of them. Each instance still has its own model id and
+    // work memory
+    int Init(std::string modelPath, bool shareWeight = false);
     int DeInit();
 
     APP_ERROR InputBufferWithSizeMalloc(aclrtMemMallocPolicy policy = ACL_MEM_MALLOC_HUGE_FIRST);
     APP_ERROR OutputBufferWithSizeMalloc(aclrtMemMallocPolicy policy = ACL_MEM_MALLOC_HUGE_FIRST);
     int ModelInference(std::vector<void *> &inputBufs, std::vector<size_t> &inputSizes, std::vector<void *> &ouputBufs,
                        std::vector<size_t> &outputSizes, size_t dynamicBatchSize = 0);
+    // Fast path of a model run many times on the same buffers: the datasets of a slot are created once by BindSlot,
+    // an inference only points the first input of the slot at inputPtr. The other inputs and the outputs are the
+    // buffers bound to the slot, which cannot be bound again. With a stream the run is enqueued by
+    // aclmdlExecuteAsync, the slot must not run again before the stream has finished it
+    APP_ERROR BindSlot(size_t slotId, const std::vector<void *> &inputBufs, const std::vector<size_t> &inputSizes,
+                       const std::vector<void *> &outputBufs, const std::vector<size_t> &outputSizes);
+    APP_ERROR ModelInference(size_t slotId, void *inputPtr, size_t dynamicBatchSize = 0, aclrtStream stream = nullptr);
     int ModelInferDynamicHW(const std::vector<void *> &inputBufs, const std::vector<size_t> &inputSizes,
                             const std::vector<void *> &ouputBufs, const std::vector<size_t> &outputSizes);
     aclmdlDesc *GetModelDesc();
@@ -60,6 +73,13 @@ public:
 private:
     aclmdlDataset *CreateAndFillDataset(const std::vector<void *> &bufs, const std::vector<size_t> &sizes);
     void DestroyDataset(aclmdlDataset *dataset);
+    APP_ERROR AcquireWeight(bool shareWeight);
+    void UnbindSlots();
+
+    struct SlotDatasets {
+        aclmdlDataset *input = nullptr;
+        aclmdlDataset *output = nullptr;
+    };
 
     std::mutex mtx_ = {};
     int deviceId_ = 0; // Device used
@@ -71,9 +91,13 @@ private:
     size_t modelDevPtrSize_ = 0;
     void *weightDevPtr_ = nullptr;
     size_t weightDevPtrSize_ = 0;
+    std::shared_ptr<void> weight_ = nullptr; // owns weightDevPtr_, together with the instances sharing it
+    std::shared_ptr<ModelResource> model_ = nullptr;
     aclrtContext contextModel_ = nullptr;
     std::shared_ptr<aclmdlDesc> modelDesc_ = nullptr;
     bool isDeInit_ = false;
+    std::vector<SlotDatasets> slots_ = {};
+    size_t dynamicIndex_ = SIZE_MAX; // input of the dynamic batch size, looked up once for the slots
 };
 
 #endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModelProcess/OutputBufferRing.h"
+#include <chrono>
+#include "acl/acl.h"
+#include "Log/Log.h"
+#include "ObjectPool/ObjectPool.h"
+
+OutputBufferRing::~OutputBufferRing()
+{
+    DeInit();
+}
+
+APP_ERROR OutputBufferRing::Init(const std::vector<size_t> &bufferSizes, size_t depth, bool hostMemory)
+{
+    if (depth == 0) {
+        LogError << "The depth of the output buffer ring must be positive.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    std::shared_ptr<State> state = std::make_shared<State>();
+    state->sets.resize(depth);
+    state->hostMemory = hostMemory;
+    for (size_t i = 0; i < depth; i++) {
+        OutputBufferSet &set = state->sets[i];
+        set.sizes = bufferSizes;
+        set.index = i;
+        for (size_t size : bufferSizes) {
+            void *buffer = nullptr;
+            APP_ERROR ret = hostMemory ? aclrtMallocHost(&buffer, size) :
+                aclrtMalloc(&buffer, size, ACL_MEM_MALLOC_NORMAL_ONLY);
+            if (ret != APP_ERR_OK) {
+                LogError << "Failed to malloc output buffer, size is " << size << ", ret = " << ret << ".";
+                return ret; // the buffers allocated so far are freed with state
+            }
+            set.buffers.push_back(buffer);
+        }
+        state->freeSets.push_back(i);
+    }
+    state_ = state;
+    return APP_ERR_OK;
+}
+
+APP_ERROR OutputBufferRing::Acquire(OutputBufferLease &lease, int timeOutMs)
+{
+    if (state_ == nullptr) {
+        return APP_ERR_COMM_INNER;
+    }
+    State &state = *state_;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    auto ready = [&state]() { return state.stopped || !state.freeSets.empty(); };
+    if (!ready()) {
+        state.waits++;
+        if (timeOutMs < 0) {
+            state.released.wait(lock, ready);
+        } else if (!state.released.wait_for(lock, std::chrono::milliseconds(timeOutMs), ready)) {
+            return APP_ERR_COMM_TIMEOUT;
+        }
+    }
+    if (state.stopped) {
+        return APP_ERR_QUEUE_STOPED;
+    }
+    size_t index = state.freeSets.back();
+    state.freeSets.pop_back();
+    lease = OutputBufferLease(&state.sets[index], LeaseReleaser(state_, index), RecyclingAllocator<OutputBufferSet>());
+    return APP_ERR_OK;
+}
+
+void OutputBufferRing::DeInit()
+{
+    if (state_ == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stopped = true;
+    }
+    state_->released.notify_all();
+}
+
+OutputBufferRingStats OutputBufferRing::GetStats() const
+{
+    OutputBufferRingStats stats;
+    if (state_ != nullptr) {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        stats.depth = state_->sets.size();
+        stats.leased = state_->sets.size() - state_->freeSets.size();
+        stats.waits = state_->waits;
+    }
+    return stats;
+}
+
+size_t OutputBufferRing::GetDepth() const
+{
+    return (state_ == nullptr) ? 0 : state_->sets.size();
+}
+
+const OutputBufferSet &OutputBufferRing::GetSet(size_t index) const
+{
+    return state_->sets.at(index);
+}
+
+OutputBufferRing::State::~State()
+{
+    for (auto &set : sets) {
+        for (void *buffer : set.buffers) {
+            if (hostMemory) {
+                aclrtFreeHost(buffer);
+            } else {
+                aclrtFree(buffer);
+            }
+        }
+    }
+}
+
+void OutputBufferRing::LeaseReleaser::operator()(const OutputBufferSet *) const
+{
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->freeSets.push_back(index_);
+    }
+    state_->released.notify_one();
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OUTPUT_BUFFER_RING_H
+#define OUTPUT_BUFFER_RING_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ErrorCode/ErrorCode.h"
+
+// One buffer per output of the model, on the device, or on the host for the copies of the outputs
+struct OutputBufferSet {
+    std::vector<void *> buffers;
+    std::vector<size_t> sizes;
+    size_t index = 0; // position in the ring, the slot of the datasets bound to the set, see ModelProcess::BindSlot
+};
+
+// The set goes back to its ring when the last copy of the lease is destroyed
+using OutputBufferLease = std::shared_ptr<const OutputBufferSet>;
+
+struct OutputBufferRingStats {
+    size_t depth = 0;
+    size_t leased = 0;   // sets held by frames in flight
+    uint64_t waits = 0;  // calls of Acquire which found every set leased
+};
+
+// Fixed number of model output sets, leased to the frames in flight. A set is written by the inference and read
+// by the post-processing of one frame only, so the depth of the ring bounds the frames between the two modules:
+// Acquire blocks while every set is leased, which holds back the inference instead of overwriting the outputs
+// of a frame still queued. The sets are freed when the ring and every lease are destroyed
+class OutputBufferRing {
+public:
+    OutputBufferRing() = default;
+    ~OutputBufferRing();
+    OutputBufferRing(const OutputBufferRing &) = delete;
+    OutputBufferRing &operator=(const OutputBufferRing &) = delete;
+
+    // hostMemory allocates pinned host buffers with aclrtMallocHost, the targets of asynchronous copies
+    APP_ERROR Init(const std::vector<size_t> &bufferSizes, size_t depth, bool hostMemory = false);
+    // timeOutMs < 0 waits until a set is released, APP_ERR_COMM_TIMEOUT when none is released in time
+    APP_ERROR Acquire(OutputBufferLease &lease, int timeOutMs = -1);
+    // Wakes the waiters of Acquire, which return APP_ERR_QUEUE_STOPED
+    void DeInit();
+    OutputBufferRingStats GetStats() const;
+    size_t GetDepth() const;
+    // The set at index, to bind to the model before any of them is leased
+    const OutputBufferSet &GetSet(size_t index) const;
+
+private:
+    struct State {
+        ~State();
+
+        mutable std::mutex mutex;
+        std::condition_variable released;
+        std::vector<OutputBufferSet> sets;
+        std::vector<size_t> freeSets;
+        bool hostMemory = false;
+        bool stopped = false;
+        uint64_t waits = 0;
+    };
+
+    class LeaseReleaser {
+    public:
+        LeaseReleaser(const std::shared_ptr<State> &state, size_t index) : state_(state), index_(index) {}
+        void operator()(const OutputBufferSet *) const;
+
+    private:
+        std::shared_ptr<State> state_;
+        size_t index_;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+#endif
@@ -15,15 +15,24 @@
  */
 
 #include "ModuleBase.h"
+#include "ModuleExecutor.h"
 #include "Log/Log.h"
 #include "BlockingQueue/BlockingQueue.h"
 #include "ErrorCode/ErrorCode.h"
-#include <sys/time.h>
 #include "Statistic/Statistic.h"
 
 namespace ascendBaseModule {
 const int INPUTQUEUE_WARN_SIZE = 32;
 const double TIME_COUNTS = 1000.0;
+const unsigned int POP_BATCH_TIMEOUT_MS = 100;
+const uint32_t EXECUTOR_SLICE_ITEMS = 16; // items processed per executor task before yielding the worker
+const int PUSH_RETRY_SLEEP_US = 100;
+
+#ifdef ASCEND_MODULE_USE_ACL
+namespace {
+thread_local aclrtContext g_currentContext = nullptr; // context last set on an executor worker
+}
+#endif
 
 void ModuleBase::AssignInitArgs(ModuleInitArgs &initArgs)
 {
@@ -34,20 +43,110 @@ void ModuleBase::AssignInitArgs(ModuleInitArgs &initArgs)
     pipelineName_ = initArgs.pipelineName;
     moduleName_ = initArgs.moduleName;
     instanceId_ = initArgs.instanceId;
+    popBatchSize_ = (initArgs.popBatchSize > 0) ? initArgs.popBatchSize : 1;
+    dedicatedThread_ = initArgs.dedicatedThread;
+    threadPlacement_ = initArgs.threadPlacement;
     isStop_ = false;
+    isScheduled_ = false;
+    isWokenUp_ = false;
+}
+
+// Called for every instance before any of them runs, the push listener must be in place before producers start.
+// Modules without input queue always get their own thread, Process of them is a blocking loop
+void ModuleBase::SetExecutor(ModuleExecutor *executor)
+{
+    if (executor == nullptr || dedicatedThread_ || withoutInputQueue_ || inputQueue_ == nullptr) {
+        executor_ = nullptr;
+        return;
+    }
+    executor_ = executor;
+    inputQueue_->SetPushListener([this]() {
+        // pairs with the fence in RunSlice, the pushed item is visible before the flag is read
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        Schedule();
+    });
+}
+
+void ModuleBase::WakeUpAt(uint64_t deadlineUs)
+{
+    if (executor_ != nullptr && !isStop_) {
+        executor_->SubmitAt(this, deadlineUs);
+    }
 }
 
-// run module instance in a new thread created
+// run module instance in a new thread created, or let the executor run it whenever its input queue has data
 APP_ERROR ModuleBase::Run()
 {
     LogDebug << moduleName_ << "[" << instanceId_ << "] Run";
-    processThr_ = std::thread(&ModuleBase::ProcessThread, this);
+    if (executor_ == nullptr) {
+        processThr_ = std::thread(&ModuleBase::ProcessThread, this);
+        return APP_ERR_OK;
+    }
+    // items pushed before Run
+    if (inputQueue_->GetSize() > 0) {
+        Schedule();
+    }
     return APP_ERR_OK;
 }
 
+// submit the instance unless it is already queued or running, which keeps its items in order
+void ModuleBase::Schedule()
+{
+    if (!isStop_ && !isScheduled_.exchange(true)) {
+        executor_->Submit(this);
+    }
+}
+
+// one executor task, process what is queued now (at most one slice) and resubmit if more is left
+void ModuleBase::RunSlice()
+{
+    if (!isStop_) {
+#ifdef ASCEND_MODULE_USE_ACL
+        if (g_currentContext != aclContext_) {
+            APP_ERROR ret = aclrtSetCurrentContext(aclContext_);
+            if (ret != APP_ERR_OK) {
+                LogFatal << "Fail to set context for " << moduleName_ << "[" << instanceId_ << "]"
+                         << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+            } else {
+                g_currentContext = aclContext_;
+            }
+        }
+#endif
+        isWokenUp_ = false;
+        std::vector<std::shared_ptr<void>> inputDatas;
+        uint32_t maxItems = (popBatchSize_ > 1) ? popBatchSize_ : EXECUTOR_SLICE_ITEMS;
+        APP_ERROR ret = inputQueue_->PopBatch(inputDatas, maxItems, 0);
+        if (ret == APP_ERR_OK) {
+            if (popBatchSize_ > 1) {
+                CallProcessBatch(inputDatas);
+            } else {
+                for (auto &inputData : inputDatas) {
+                    CallProcess(inputData);
+                }
+            }
+        } else if (ret == APP_ERR_QUEUE_EMPTY) {
+            ret = ProcessIdle();
+            if (ret != APP_ERR_OK) {
+                metrics_.errors.fetch_add(1, std::memory_order_relaxed);
+                LogError << "Fail to process idle for " << moduleName_ << "[" << instanceId_ << "]"
+                         << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+            }
+        }
+    }
+    // a push racing with this slice either sees the flag cleared or is seen by the size check below. The store and
+    // the load are on different atomics, without the fences here and in the push listener both could miss each other.
+    // A wake-up due during the slice is seen the same way
+    isScheduled_.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!isStop_ && (inputQueue_->GetSize() > 0 || isWokenUp_)) {
+        Schedule();
+    }
+}
+
 // get the data from input queue then call Process function in the new thread
 void ModuleBase::ProcessThread()
 {
+    ApplyThreadPlacement(threadPlacement_, moduleName_ + "[" + std::to_string(instanceId_) + "]");
     APP_ERROR ret;
 #ifdef ASCEND_MODULE_USE_ACL
     ret = aclrtSetCurrentContext(aclContext_);
@@ -71,6 +170,11 @@ void ModuleBase::ProcessThread()
         return;
     }
     LogDebug << "Input queue for " << moduleName_ << "[" << instanceId_ << "], inputQueue=" << inputQueue_;
+    if (popBatchSize_ > 1) {
+        ProcessBatchLoop();
+        LogInfo << moduleName_ << "[" << instanceId_ << "] process thread End";
+        return;
+    }
     // repeatly pop data from input queue and call the Process funtion. Results will be pushed to output queues.
     while (!isStop_) {
         std::shared_ptr<void> frameInfo = nullptr;
@@ -88,15 +192,74 @@ void ModuleBase::ProcessThread()
     LogInfo << moduleName_ << "[" << instanceId_ << "] process thread End";
 }
 
+// pop up to popBatchSize_ items per queue round-trip and hand them to ProcessBatch together
+void ModuleBase::ProcessBatchLoop()
+{
+    std::vector<std::shared_ptr<void>> inputDatas;
+    inputDatas.reserve(popBatchSize_);
+    while (!isStop_) {
+        APP_ERROR ret = inputQueue_->PopBatch(inputDatas, popBatchSize_, POP_BATCH_TIMEOUT_MS);
+        if (ret == APP_ERR_QUEUE_STOPED) {
+            LogDebug << moduleName_ << "[" << instanceId_ << "] input queue Stopped";
+            break;
+        } else if (ret == APP_ERR_QUEUE_EMPTY) {
+            continue;
+        } else if (ret != APP_ERR_OK) {
+            LogError << "Fail to get data from input queue for " << moduleName_ << "[" << instanceId_ << "]"
+                     << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+            continue;
+        }
+        CallProcessBatch(inputDatas);
+    }
+}
+
+APP_ERROR ModuleBase::ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas)
+{
+    APP_ERROR result = APP_ERR_OK;
+    for (auto &inputData : inputDatas) {
+        if (inputData == nullptr) {
+            continue;
+        }
+        APP_ERROR ret = Process(std::move(inputData));
+        if (ret != APP_ERR_OK) {
+            LogError << "Fail to process data for " << moduleName_ << "[" << instanceId_ << "]"
+                     << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+            result = ret;
+        }
+    }
+    return result;
+}
+
+void ModuleBase::CallProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas)
+{
+    metrics_.itemsIn.fetch_add(inputDatas.size(), std::memory_order_relaxed);
+    uint64_t startUs = ModuleNowUs();
+    APP_ERROR ret = ProcessBatch(inputDatas);
+    uint64_t costUs = ModuleNowUs() - startUs;
+    metrics_.processTime.Record(costUs);
+    double costMs = costUs / TIME_COUNTS;
+    int queueSize = inputQueue_->GetSize();
+    if (queueSize > INPUTQUEUE_WARN_SIZE) {
+        LogWarn << "[Statistic] [Module] [" << moduleName_ << "] [" << instanceId_ << "] [QueueSize] [" << queueSize <<
+            "] [Batch] [" << inputDatas.size() << "] [Process] [" << costMs << " ms]";
+    }
+
+    if (ret != APP_ERR_OK) {
+        metrics_.errors.fetch_add(1, std::memory_order_relaxed);
+        LogError << "Fail to process batch for " << moduleName_ << "[" << instanceId_ << "]"
+                 << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+    }
+    inputDatas.clear();
+}
+
 void ModuleBase::CallProcess(std::shared_ptr<void> &frameAiInfo)
 {
-    struct timeval startTime = { 0, 0 };
-    struct timeval endTime = { 0, 0 };
-    gettimeofday(&startTime, nullptr);
-    APP_ERROR ret = Process(frameAiInfo);
-    gettimeofday(&endTime, nullptr);
-    double costMs =
-        (endTime.tv_sec - startTime.tv_sec) * TIME_COUNTS + (endTime.tv_usec - startTime.tv_usec) / TIME_COUNTS;
+    metrics_.itemsIn.fetch_add(1, std::memory_order_relaxed);
+    uint64_t startUs = ModuleNowUs();
+    APP_ERROR ret = Process(std::move(frameAiInfo));
+    uint64_t costUs = ModuleNowUs() - startUs;
+    metrics_.processTime.Record(costUs);
+    double costMs = costUs / TIME_COUNTS;
     int queueSize = inputQueue_->GetSize();
     if (queueSize > INPUTQUEUE_WARN_SIZE) {
         LogWarn << "[Statistic] [Module] [" << moduleName_ << "] [" << instanceId_ << "] [QueueSize] [" << queueSize <<
@@ -104,13 +267,14 @@ void ModuleBase::CallProcess(std::shared_ptr<void> &frameAiInfo)
     }
 
     if (ret != APP_ERR_OK) {
+        metrics_.errors.fetch_add(1, std::memory_order_relaxed);
         LogError << "Fail to process data for " << moduleName_ << "[" << instanceId_ << "]"
                  << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
     }
 }
 
 void ModuleBase::SetOutputInfo(std::string moduleName, ModuleConnectType connectType,
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec)
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec)
 {
     if (outputQueVec.size() == 0) {
         LogFatal << "outputQueVec is Empty! " << moduleName;
@@ -123,6 +287,10 @@ void ModuleBase::SetOutputInfo(std::string moduleName, ModuleConnectType connect
     outputInfo.outputQueVec = outputQueVec;
     outputInfo.outputQueVecSize = outputQueVec.size();
     outputQueMap_[moduleName] = outputInfo;
+    // the first connected module is the default output
+    if (defaultOutputPort_ == nullptr) {
+        defaultOutputPort_ = GetOutputPort(moduleName);
+    }
 }
 
 const std::string ModuleBase::GetModuleName()
@@ -135,45 +303,70 @@ const int ModuleBase::GetInstanceId()
     return instanceId_;
 }
 
-void ModuleBase::SetInputVec(std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue)
+void ModuleBase::SetInputVec(std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue)
 {
     inputQueue_ = inputQueue;
 }
 
-void ModuleBase::SendToNextModule(std::string moduleName, std::shared_ptr<void> outputData, int channelId)
+// The nodes of outputQueMap_ never move, so a port stays valid for the lifetime of the instance
+ModuleOutputPort ModuleBase::GetOutputPort(const std::string &moduleName)
 {
-    if (isStop_) {
-        LogDebug << moduleName_ << "[" << instanceId_ << "] is Stopped, can't send to next module";
-        return;
+    auto itr = outputQueMap_.find(moduleName);
+    if (itr == outputQueMap_.end()) {
+        return nullptr;
     }
+    return &itr->second;
+}
 
-    if (outputQueMap_.find(moduleName) == outputQueMap_.end()) {
+// Kept for callers that route by name, modules with one output should use the port version
+void ModuleBase::SendToNextModule(const std::string &moduleName, std::shared_ptr<void> outputData, int channelId)
+{
+    ModuleOutputPort outputPort = GetOutputPort(moduleName);
+    if (outputPort == nullptr) {
         LogFatal << "No Next Module " << moduleName;
         return;
     }
+    SendToNextModule(outputPort, std::move(outputData), channelId);
+}
 
-    auto itr = outputQueMap_.find(moduleName);
-    if (itr == outputQueMap_.end()) {
-        LogFatal << "No Next Module " << moduleName;
+void ModuleBase::SendToNextModule(ModuleOutputPort outputPort, std::shared_ptr<void> outputData, int channelId)
+{
+    if (isStop_) {
+        LogDebug << moduleName_ << "[" << instanceId_ << "] is Stopped, can't send to next module";
+        return;
+    }
+    if (outputPort == nullptr) {
+        LogFatal << "No Next Module of " << moduleName_ << "[" << instanceId_ << "]";
         return;
     }
-    ModuleOutputInfo outputInfo = itr->second;
 
-    if (outputInfo.connectType == MODULE_CONNECT_ONE) {
-        outputInfo.outputQueVec[0]->Push(outputData, true);
-    } else if (outputInfo.connectType == MODULE_CONNECT_CHANNEL) {
-        uint32_t ch = channelId % outputInfo.outputQueVecSize;
-        if (ch >= outputInfo.outputQueVecSize) {
-            LogFatal << "No Next Module!";
-            return;
-        }
-        outputInfo.outputQueVec[ch]->Push(outputData, true);
-    } else if (outputInfo.connectType == MODULE_CONNECT_PAIR) {
-        outputInfo.outputQueVec[instanceId_]->Push(outputData, true);
-    } else if (outputInfo.connectType == MODULE_CONNECT_RANDOM) {
-        outputInfo.outputQueVec[sendCount_ % outputInfo.outputQueVecSize]->Push(outputData, true);
+    uint32_t queueIndex = 0;
+    if (outputPort->connectType == MODULE_CONNECT_CHANNEL) {
+        queueIndex = static_cast<uint32_t>(channelId) % outputPort->outputQueVecSize;
+    } else if (outputPort->connectType == MODULE_CONNECT_PAIR) {
+        queueIndex = static_cast<uint32_t>(instanceId_);
+    } else if (outputPort->connectType == MODULE_CONNECT_RANDOM) {
+        queueIndex = static_cast<uint32_t>(sendCount_) % outputPort->outputQueVecSize;
     }
+    PushToQueue(outputPort->outputQueVec[queueIndex], outputData);
     sendCount_++;
+    metrics_.itemsOut.fetch_add(1, std::memory_order_relaxed);
+}
+
+// An executor worker must not sleep on a full queue, the receiver may be waiting for a free worker.
+// It runs other pending tasks instead until there is room. Other threads, e.g. decoder callbacks, just block.
+void ModuleBase::PushToQueue(std::shared_ptr<QueueBase<std::shared_ptr<void>>> &queue,
+    std::shared_ptr<void> &outputData)
+{
+    if (executor_ == nullptr || !executor_->IsWorkerThread()) {
+        queue->Push(std::move(outputData), true);
+        return;
+    }
+    while (queue->Push(std::move(outputData), false) == APP_ERROR_QUEUE_FULL && !isStop_) {
+        if (!executor_->HelpOnce()) {
+            usleep(PUSH_RETRY_SLEEP_US);
+        }
+    }
 }
 
 // clear input queue and stop the thread of the instance, called before destroy the instance
@@ -198,6 +391,20 @@ APP_ERROR ModuleBase::Stop()
         processThr_.join();
     }
 
+    // a wake-up due before isStop_ was seen may have submitted the instance, the wait below covers it
+    if (executor_ != nullptr) {
+        executor_->CancelWakeUp(this);
+    }
+
+    // wait for the executor task of the instance, it returns soon after isStop_ is set
+    while (isScheduled_) {
+        usleep(PUSH_RETRY_SLEEP_US);
+    }
+    // the last slice may have asked for a wake-up before it saw isStop_, none can be added any more
+    if (executor_ != nullptr) {
+        executor_->CancelWakeUp(this);
+    }
+
     return DeInit();
 }
 }
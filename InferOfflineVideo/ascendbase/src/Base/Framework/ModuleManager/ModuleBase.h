@@ -22,8 +22,12 @@
 #include <vector>
 #include <map>
 #include <atomic>
+#include <typeinfo>
 #include "ConfigParser/ConfigParser.h"
 #include "BlockingQueue/BlockingQueue.h"
+#include "ModuleManager/ModuleMessage.h"
+#include "ModuleManager/ModuleMetrics.h"
+#include "ModuleManager/ThreadPlacement.h"
 #ifdef ASCEND_MODULE_USE_ACL
 #include "acl/acl.h"
 #endif
@@ -44,18 +48,25 @@ struct ModuleInitArguments {
     std::string pipelineName = {};
     std::string moduleName = {};
     int instanceId = -1;
+    uint32_t popBatchSize = 1;
+    bool dedicatedThread = false;
+    ThreadPlacement threadPlacement = {}; // of the own thread, unused when the instance runs on the executor
     void *userData = nullptr;
 };
 
 struct ModuleOutputInformation {
     std::string moduleName = "";
     ModuleConnectType connectType = MODULE_CONNECT_RANDOM;
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec = {};
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec = {};
     uint32_t outputQueVecSize = 0;
 };
 
 using ModuleInitArgs = ModuleInitArguments;
 using ModuleOutputInfo = ModuleOutputInformation;
+// Output route resolved once when the modules are connected, sending through it needs no lookup
+using ModuleOutputPort = ModuleOutputInfo *;
+
+class ModuleExecutor;
 
 class ModuleBase {
 public:
@@ -63,14 +74,47 @@ public:
     virtual ~ModuleBase() {};
     virtual APP_ERROR Init(ConfigParser &configParser, ModuleInitArgs &initArgs) = 0;
     virtual APP_ERROR DeInit(void) = 0;
-    APP_ERROR Run(void); // create and run process thread
+    APP_ERROR Run(void); // create and run process thread, or schedule on the executor when one is set
     APP_ERROR Stop(void);
-    void SetInputVec(std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue);
+    void SetExecutor(ModuleExecutor *executor);
+    void SetInputVec(std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue);
     void SetOutputInfo(std::string moduleName, ModuleConnectType connectType,
-        std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec);
-    void SendToNextModule(std::string moduleNext, std::shared_ptr<void> outputData, int channelId = 0);
+        std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec);
+    void SendToNextModule(const std::string &moduleNext, std::shared_ptr<void> outputData, int channelId = 0);
+    void SendToNextModule(ModuleOutputPort outputPort, std::shared_ptr<void> outputData, int channelId = 0);
+    // nullptr if moduleName is not connected, valid once ModuleManager registered the connects
+    ModuleOutputPort GetOutputPort(const std::string &moduleName);
     const std::string GetModuleName();
     const int GetInstanceId();
+    const ModuleMetrics &GetMetrics() const
+    {
+        return metrics_;
+    }
+    int GetInputQueueSize() const
+    {
+        return (inputQueue_ == nullptr) ? 0 : inputQueue_->GetSize();
+    }
+    // Message types of the input and output ports, checked by ModuleManager when the modules are connected.
+    // nullptr means untyped, which is never checked. TypedModule overrides them
+    virtual const std::type_info *GetInputType() const
+    {
+        return nullptr;
+    }
+    virtual const std::type_info *GetOutputType() const
+    {
+        return nullptr;
+    }
+    // Accounting and release of output messages dropped by a link with a drop policy, see BackpressureQueue.
+    // TypedModule implements them for its output type
+    virtual size_t GetMessageBytes(const std::shared_ptr<void> &) const
+    {
+        return 0;
+    }
+    virtual void ReleaseMessage(std::shared_ptr<void> &) const {}
+    virtual bool IsMessageDroppable(const std::shared_ptr<void> &) const
+    {
+        return true;
+    }
 
 public:
 #ifdef ASCEND_MODULE_USE_ACL
@@ -79,10 +123,43 @@ public:
 #endif
 
 protected:
+    friend class ModuleExecutor;
     void ProcessThread();
+    void Schedule();
+    void RunSlice();
+    void PushToQueue(std::shared_ptr<QueueBase<std::shared_ptr<void>>> &queue, std::shared_ptr<void> &outputData);
+    void ProcessBatchLoop();
     virtual APP_ERROR Process(std::shared_ptr<void> inputData) = 0;
+    // Called with everything popped in one round-trip when popBatchSize_ > 1, the default calls Process for each
+    virtual APP_ERROR ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas);
+    // Called by an executor slice which found the input queue empty, e.g. after a wake-up of WakeUpAt
+    virtual APP_ERROR ProcessIdle()
+    {
+        return APP_ERR_OK;
+    }
+    // On the executor, run a slice of the instance at deadlineUs of ModuleNowUs() even if no input arrives by then.
+    // Does nothing when the instance has its own thread
+    void WakeUpAt(uint64_t deadlineUs);
     void CallProcess(std::shared_ptr<void> &frameAiInfo);
+    void CallProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas);
     void AssignInitArgs(ModuleInitArgs &initArgs);
+    // stamped on typed messages before they are queued, the receiver turns it into its queue wait time
+    void StampMessage(ModuleMessageContext *context)
+    {
+        if (context != nullptr) {
+            context->sendTimeUs = ModuleNowUs();
+        }
+    }
+    void RecordQueueWait(const ModuleMessageContext *context)
+    {
+        if (context != nullptr && context->sendTimeUs != 0) {
+            uint64_t nowUs = ModuleNowUs();
+            metrics_.queueWait.Record((nowUs > context->sendTimeUs) ? (nowUs - context->sendTimeUs) : 0);
+            if (context->trace.sampled) {
+                Tracer::Record(moduleName_.c_str(), TRACE_SPAN_QUEUE_WAIT, context->trace, context->sendTimeUs, nowUs);
+            }
+        }
+    }
 
 protected:
     int instanceId_ = -1;
@@ -92,11 +169,19 @@ protected:
     std::thread processThr_ = {};
     std::atomic_bool isStop_ = {};
     bool withoutInputQueue_ = false;
-    std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue_ = nullptr;
+    uint32_t popBatchSize_ = 1; // max items taken from the input queue at once
+    bool dedicatedThread_ = false; // keep an own thread even if the executor is used, e.g. for blocking sources
+    ThreadPlacement threadPlacement_ = {};
+    ModuleExecutor *executor_ = nullptr;
+    std::atomic_bool isScheduled_ = {}; // submitted to or running on the executor
+    std::atomic_bool isWokenUp_ = {}; // a wake-up of WakeUpAt is due
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue_ = nullptr;
     std::map<std::string, ModuleOutputInfo> outputQueMap_ = {};
+    ModuleOutputPort defaultOutputPort_ = nullptr; // first connected output
     int outputQueVecSize_ = 0;
     ModuleConnectType connectType_ = MODULE_CONNECT_RANDOM;
     int sendCount_ = 0;
+    ModuleMetrics metrics_ = {};
 };
 }
 
@@ -0,0 +1,281 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModuleManager/ModuleExecutor.h"
+#include <chrono>
+#include "Log/Log.h"
+#include "ModuleManager/ModuleBase.h"
+#include "ModuleManager/ModuleMessage.h"
+
+namespace ascendBaseModule {
+const int EXECUTOR_IDLE_WAIT_MS = 10;
+const int EXECUTOR_MAX_HELP_DEPTH = 4;
+
+namespace {
+thread_local ModuleExecutor *g_ownerExecutor = nullptr;
+thread_local int g_workerIndex = -1;
+thread_local int g_helpDepth = 0;
+}
+
+ModuleExecutor::ModuleExecutor(uint32_t threadNum)
+{
+    threadNum_ = (threadNum > 0) ? threadNum : std::thread::hardware_concurrency();
+    if (threadNum_ == 0) {
+        threadNum_ = 1;
+    }
+}
+
+ModuleExecutor::~ModuleExecutor()
+{
+    Stop();
+}
+
+APP_ERROR ModuleExecutor::Start()
+{
+    LogInfo << "ModuleExecutor: start " << threadNum_ << " worker threads.";
+    isStop_ = false;
+    for (uint32_t i = 0; i < threadNum_; i++) {
+        workers_.emplace_back(new Worker());
+    }
+    for (uint32_t i = 0; i < threadNum_; i++) {
+        workers_[i]->thread = std::thread(&ModuleExecutor::WorkerThread, this, i);
+    }
+    return APP_ERR_OK;
+}
+
+// called after every module instance is stopped, the tasks left are no-ops and are dropped
+void ModuleExecutor::Stop()
+{
+    isStop_ = true;
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCond_.notify_all();
+    }
+    for (auto &worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    workers_.clear();
+    {
+        std::unique_lock<std::mutex> lock(wakeUpMutex_);
+        wakeUps_.clear();
+        nextWakeUpUs_ = 0;
+    }
+    std::unique_lock<std::mutex> lock(injectMutex_);
+    injectTasks_.clear();
+    pendingCount_ = 0;
+}
+
+void ModuleExecutor::Submit(ModuleBase *module)
+{
+    if (g_ownerExecutor == this) {
+        Worker &worker = *workers_[g_workerIndex];
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(module);
+    } else {
+        std::unique_lock<std::mutex> lock(injectMutex_);
+        injectTasks_.push_back(module);
+    }
+    pendingCount_++;
+    WakeOne();
+}
+
+void ModuleExecutor::SubmitAt(ModuleBase *module, uint64_t deadlineUs)
+{
+    {
+        std::unique_lock<std::mutex> lock(wakeUpMutex_);
+        auto iter = wakeUps_.find(module);
+        if (iter != wakeUps_.end() && iter->second <= deadlineUs) {
+            return;
+        }
+        wakeUps_[module] = deadlineUs;
+        UpdateNextWakeUp();
+    }
+    // a sleeping worker recomputes its timeout, it may sleep past the new deadline otherwise
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    sleepCond_.notify_all();
+}
+
+void ModuleExecutor::CancelWakeUp(ModuleBase *module)
+{
+    std::unique_lock<std::mutex> lock(wakeUpMutex_);
+    if (wakeUps_.erase(module) > 0) {
+        UpdateNextWakeUp();
+    }
+}
+
+bool ModuleExecutor::HelpOnce()
+{
+    if (g_ownerExecutor != this || g_helpDepth >= EXECUTOR_MAX_HELP_DEPTH) {
+        return false;
+    }
+    ModuleBase *task = nullptr;
+    if (!TakeTask(static_cast<uint32_t>(g_workerIndex), task)) {
+        return false;
+    }
+    g_helpDepth++;
+    task->RunSlice();
+    g_helpDepth--;
+    return true;
+}
+
+uint32_t ModuleExecutor::GetThreadNum() const
+{
+    return threadNum_;
+}
+
+void ModuleExecutor::SetThreadPlacements(const std::vector<ThreadPlacement> &placements)
+{
+    placements_ = placements;
+}
+
+bool ModuleExecutor::IsWorkerThread() const
+{
+    return g_ownerExecutor == this;
+}
+
+void ModuleExecutor::WorkerThread(uint32_t index)
+{
+    ApplyThreadPlacement((index < placements_.size()) ? placements_[index] : ThreadPlacement(),
+        "Executor[" + std::to_string(index) + "]");
+    g_ownerExecutor = this;
+    g_workerIndex = static_cast<int>(index);
+    while (!isStop_) {
+        SubmitDueWakeUps();
+        ModuleBase *task = nullptr;
+        if (TakeTask(index, task)) {
+            task->RunSlice();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_++;
+        // the idle timeout only covers a missed wake-up, Submit notifies whenever a sleeper is registered.
+        // SubmitAt notifies as well, a changed nextWakeUpUs_ ends the sleep to shorten it
+        uint64_t nextWakeUpUs = nextWakeUpUs_;
+        sleepCond_.wait_for(lock, GetSleepTime(nextWakeUpUs),
+            [this, nextWakeUpUs]() { return isStop_ || pendingCount_ > 0 || nextWakeUpUs_ != nextWakeUpUs; });
+        sleepers_--;
+    }
+    g_ownerExecutor = nullptr;
+    g_workerIndex = -1;
+}
+
+bool ModuleExecutor::TakeTask(uint32_t index, ModuleBase *&task)
+{
+    if (PopLocal(index, task) || PopInject(task) || Steal(index, task)) {
+        pendingCount_--;
+        return true;
+    }
+    return false;
+}
+
+// the owner takes its newest task, which is most likely still in cache
+bool ModuleExecutor::PopLocal(uint32_t index, ModuleBase *&task)
+{
+    Worker &worker = *workers_[index];
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = worker.tasks.back();
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool ModuleExecutor::PopInject(ModuleBase *&task)
+{
+    std::unique_lock<std::mutex> lock(injectMutex_);
+    if (injectTasks_.empty()) {
+        return false;
+    }
+    task = injectTasks_.front();
+    injectTasks_.pop_front();
+    return true;
+}
+
+// thieves take the oldest task of the other workers, starting from the next one
+bool ModuleExecutor::Steal(uint32_t index, ModuleBase *&task)
+{
+    for (uint32_t i = 1; i < threadNum_; i++) {
+        Worker &victim = *workers_[(index + i) % threadNum_];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue;
+        }
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+// The modules are submitted under wakeUpMutex_, CancelWakeUp of a stopping module waits for it and no dangling
+// module is submitted
+void ModuleExecutor::SubmitDueWakeUps()
+{
+    uint64_t nextWakeUpUs = nextWakeUpUs_;
+    if (nextWakeUpUs == 0 || ModuleNowUs() < nextWakeUpUs) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(wakeUpMutex_);
+    uint64_t nowUs = ModuleNowUs();
+    for (auto iter = wakeUps_.begin(); iter != wakeUps_.end();) {
+        if (iter->second <= nowUs) {
+            // a running slice of the module sees the flag when it ends and runs once more
+            iter->first->isWokenUp_ = true;
+            iter->first->Schedule();
+            iter = wakeUps_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    UpdateNextWakeUp();
+}
+
+// called with wakeUpMutex_ held
+void ModuleExecutor::UpdateNextWakeUp()
+{
+    uint64_t nextWakeUpUs = 0;
+    for (const auto &wakeUp : wakeUps_) {
+        if (nextWakeUpUs == 0 || wakeUp.second < nextWakeUpUs) {
+            nextWakeUpUs = wakeUp.second;
+        }
+    }
+    nextWakeUpUs_ = nextWakeUpUs;
+}
+
+std::chrono::microseconds ModuleExecutor::GetSleepTime(uint64_t nextWakeUpUs) const
+{
+    std::chrono::microseconds sleepTime = std::chrono::milliseconds(EXECUTOR_IDLE_WAIT_MS);
+    if (nextWakeUpUs != 0) {
+        uint64_t nowUs = ModuleNowUs();
+        uint64_t untilUs = (nextWakeUpUs > nowUs) ? (nextWakeUpUs - nowUs) : 0;
+        if (untilUs < static_cast<uint64_t>(sleepTime.count())) {
+            sleepTime = std::chrono::microseconds(untilUs);
+        }
+    }
+    return sleepTime;
+}
+
+void ModuleExecutor::WakeOne()
+{
+    if (sleepers_ > 0) {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCond_.notify_one();
+    }
+}
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_MODULE_EXECUTOR_H
+#define INC_MODULE_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include "ErrorCode/ErrorCode.h"
+#include "ModuleManager/ThreadPlacement.h"
+
+namespace ascendBaseModule {
+class ModuleBase;
+
+// Work-stealing thread pool shared by the module instances. An instance is submitted as a task when its input
+// queue becomes non-empty and is never queued twice, so one instance only runs on one worker at a time and
+// its input is processed in order.
+class ModuleExecutor {
+public:
+    explicit ModuleExecutor(uint32_t threadNum);
+    ~ModuleExecutor();
+    APP_ERROR Start();
+    void Stop();
+    void Submit(ModuleBase *module);
+    // Submit the module once ModuleNowUs() reaches deadlineUs, even if its input queue stays empty. A module has at
+    // most one wake-up, an earlier deadline replaces a later one
+    void SubmitAt(ModuleBase *module, uint64_t deadlineUs);
+    // Drop the wake-up of a stopped module, no Submit of it follows the return
+    void CancelWakeUp(ModuleBase *module);
+    // Run one pending task on the calling worker, used by a task waiting for room in a full queue.
+    // Return false if the caller is not a worker or nothing could be run
+    bool HelpOnce();
+    uint32_t GetThreadNum() const;
+    // placement of each worker by index, set before Start. Workers without one only get a name
+    void SetThreadPlacements(const std::vector<ThreadPlacement> &placements);
+    bool IsWorkerThread() const; // whether the calling thread belongs to this pool
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<ModuleBase *> tasks;
+        std::thread thread;
+    };
+
+    void WorkerThread(uint32_t index);
+    bool TakeTask(uint32_t index, ModuleBase *&task);
+    bool PopLocal(uint32_t index, ModuleBase *&task);
+    bool PopInject(ModuleBase *&task);
+    bool Steal(uint32_t index, ModuleBase *&task);
+    void WakeOne();
+    void SubmitDueWakeUps();
+    void UpdateNextWakeUp();
+    std::chrono::microseconds GetSleepTime(uint64_t nextWakeUpUs) const;
+
+private:
+    uint32_t threadNum_ = 0;
+    std::vector<ThreadPlacement> placements_ = {};
+    std::vector<std::unique_ptr<Worker>> workers_ = {};
+    std::mutex injectMutex_ = {}; // tasks submitted from threads outside the pool
+    std::deque<ModuleBase *> injectTasks_ = {};
+    std::mutex sleepMutex_ = {};
+    std::condition_variable sleepCond_ = {};
+    std::atomic<int> sleepers_ = {0};
+    std::atomic<int> pendingCount_ = {0};
+    std::atomic_bool isStop_ = {false};
+    std::mutex wakeUpMutex_ = {}; // taken before the worker, inject and sleep mutexes
+    std::map<ModuleBase *, uint64_t> wakeUps_ = {}; // deadline of each module
+    std::atomic<uint64_t> nextWakeUpUs_ = {0}; // earliest deadline of wakeUps_, 0 if there is none
+};
+}
+
+#endif
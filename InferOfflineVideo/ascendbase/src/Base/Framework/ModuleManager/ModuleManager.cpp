@@ -15,13 +15,53 @@
  */
 
 #include "ModuleManager/ModuleManager.h"
+#include <cstdlib>
+#include <sstream>
 #include "Log/Log.h"
+#include "BlockingQueue/RingQueue.h"
+#include "Statistic/Tracer.h"
+#include "ObjectPool/ObjectPool.h"
 #ifdef ASCEND_MODULE_USE_ACL
 #include "ResourceManager/ResourceManager.h"
+#include "DvppCommon/DvppMemoryPool.h"
 #endif
 
 namespace ascendBaseModule {
 const int MODULE_QUEUE_SIZE = 200;
+const uint32_t KEEP_LATEST_DEFAULT_SIZE = 1;
+const std::map<std::string, BackpressurePolicy> BACKPRESSURE_POLICY_NAMES = {
+    {"block", BACKPRESSURE_BLOCK},
+    {"drop_oldest", BACKPRESSURE_DROP_OLDEST},
+    {"drop_newest", BACKPRESSURE_DROP_NEWEST},
+    {"keep_latest", BACKPRESSURE_KEEP_LATEST},
+    {"byte_budget", BACKPRESSURE_BYTE_BUDGET},
+};
+const double METRICS_QUANTILES[] = {0.5, 0.9, 0.99};
+const double METRICS_US_PER_SECOND = 1000000.0;
+
+namespace {
+void RenderSummary(std::ostringstream &out, const std::string &name, const std::string &labels,
+    const LatencyHistogram &histogram)
+{
+    for (double quantile : METRICS_QUANTILES) {
+        out << name << "{" << labels << ",quantile=\"" << quantile << "\"} " <<
+            histogram.GetPercentileUs(quantile) / METRICS_US_PER_SECOND << "\n";
+    }
+    out << name << "_sum{" << labels << "} " << histogram.GetSumUs() / METRICS_US_PER_SECOND << "\n";
+    out << name << "_count{" << labels << "} " << histogram.GetCount() << "\n";
+}
+
+void RenderBatchSize(std::ostringstream &out, const std::string &labels, const BatchSizeHistogram &histogram)
+{
+    for (uint32_t bound = 1; bound <= BatchSizeHistogram::MAX_SIZE; bound *= 2) {
+        out << "ascend_module_batch_size_bucket{" << labels << ",le=\"" << bound << "\"} " <<
+            histogram.GetCountUpTo(bound) << "\n";
+    }
+    out << "ascend_module_batch_size_bucket{" << labels << ",le=\"+Inf\"} " << histogram.GetCount() << "\n";
+    out << "ascend_module_batch_size_sum{" << labels << "} " << histogram.GetSum() << "\n";
+    out << "ascend_module_batch_size_count{" << labels << "} " << histogram.GetCount() << "\n";
+}
+}
 
 ModuleManager::ModuleManager() {}
 
@@ -38,6 +78,41 @@ APP_ERROR ModuleManager::Init(std::string &configPath, std::string &aclConfigPat
         return ret;
     }
 
+    // optional, the lock-free ring queues are used unless it is set to false
+    bool useRingQueue = true;
+    if (configParser_.GetBoolValue("SystemConfig.useRingQueue", useRingQueue) == APP_ERR_OK) {
+        useRingQueue_ = useRingQueue;
+    }
+
+    // optional, run the module instances as tasks of a shared work-stealing pool instead of a thread each
+    bool useExecutor = false;
+    if (configParser_.GetBoolValue("SystemConfig.useExecutor", useExecutor) == APP_ERR_OK && useExecutor) {
+        uint32_t executorThreadNum = 0; // 0: one worker per core
+        configParser_.GetUnsignedIntValue("SystemConfig.executorThreadNum", executorThreadNum);
+        executor_ = std::make_shared<ModuleExecutor>(executorThreadNum);
+        // optional, Executor.cpuset etc. with the worker index as instance id
+        std::vector<ThreadPlacement> placements(executor_->GetThreadNum());
+        for (uint32_t i = 0; i < placements.size(); i++) {
+            ret = LoadThreadPlacement(configParser_, "Executor", static_cast<int>(i), placements[i]);
+            if (ret != APP_ERR_OK) {
+                LogFatal << "ModuleManager: invalid thread placement of the executor.";
+                return ret;
+            }
+        }
+        executor_->SetThreadPlacements(placements);
+    }
+
+    // optional, serve GET /metrics on this port while the pipeline runs
+    configParser_.GetUnsignedIntValue("SystemConfig.metricsPort", metricsPort_);
+    configParser_.GetStringValue("SystemConfig.metricsAddress", metricsAddress_);
+
+    // optional, trace every N-th frame of each channel, the trace is written on SIGUSR1 and at exit
+    uint32_t traceSampleInterval = 0;
+    configParser_.GetUnsignedIntValue("SystemConfig.traceSampleInterval", traceSampleInterval);
+    std::string traceFile = DEFAULT_TRACE_FILE;
+    configParser_.GetStringValue("SystemConfig.traceFile", traceFile);
+    Tracer::Init(traceSampleInterval, traceFile);
+
     // Init Acl
 #ifdef ASCEND_MODULE_USE_ACL
     ret = InitAcl(aclConfigPath);
@@ -45,6 +120,12 @@ APP_ERROR ModuleManager::Init(std::string &configPath, std::string &aclConfigPat
         LogFatal << "ModuleManager: fail to init Acl.";
         return ret;
     }
+
+    // optional, the memory the DVPP memory pool of the device keeps for reuse
+    uint32_t dvppPoolMaxCachedMB = 0;
+    if (configParser_.GetUnsignedIntValue("SystemConfig.dvppPoolMaxCachedMB", dvppPoolMaxCachedMB) == APP_ERR_OK) {
+        DvppMemoryPool::GetInstance().SetMaxCachedBytes(static_cast<uint64_t>(dvppPoolMaxCachedMB) * 1024 * 1024);
+    }
 #endif
 
     // Init pipeline module
@@ -86,6 +167,8 @@ APP_ERROR ModuleManager::InitAcl(std::string &aclConfigPath)
     ResourceInfo resourceInfo;
     resourceInfo.aclConfigPath = aclConfigPath;
     resourceInfo.deviceIds.insert(deviceId_);
+    // optional, prefault the model files when they are mapped, so the loads do not page them in
+    configParser_.GetBoolValue("SystemConfig.modelMapPopulate", resourceInfo.modelMapPopulate);
     return ResourceManager::GetInstance()->InitResource(resourceInfo);
 }
 #endif
@@ -102,9 +185,25 @@ APP_ERROR ModuleManager::InitModuleInstance(std::shared_ptr<ModuleBase> moduleIn
     initArgs.pipelineName = pipelineName;
     initArgs.moduleName = moduleName;
     initArgs.instanceId = instanceId;
+    // optional, e.g. "ModelInfer.popBatchSize = 8" lets the module take up to 8 queued items per round-trip
+    uint32_t popBatchSize = 1;
+    if (configParser_.GetUnsignedIntValue(moduleName + ".popBatchSize", popBatchSize) == APP_ERR_OK) {
+        initArgs.popBatchSize = popBatchSize;
+    }
+    // optional, keep a thread per instance of the module when the executor is used
+    bool dedicatedThread = false;
+    if (configParser_.GetBoolValue(moduleName + ".dedicatedThread", dedicatedThread) == APP_ERR_OK) {
+        initArgs.dedicatedThread = dedicatedThread;
+    }
+    // optional, cpuset, numa node and scheduling of the instance thread, see ThreadPlacement.h
+    APP_ERROR ret = LoadThreadPlacement(configParser_, moduleName, instanceId, initArgs.threadPlacement);
+    if (ret != APP_ERR_OK) {
+        LogFatal << "ModuleManager: invalid thread placement of " << moduleName << "[" << instanceId << "].";
+        return ret;
+    }
 
     // Initialize the Init function of each module
-    APP_ERROR ret = moduleInstance->Init(configParser_, initArgs);
+    ret = moduleInstance->Init(configParser_, initArgs);
     if (ret != APP_ERR_OK) {
         LogFatal << "ModuleManager: fail to init module, name = " << moduleName.c_str() << ", instance id = " <<
             instanceId << ".";
@@ -130,6 +229,16 @@ APP_ERROR ModuleManager::RegisterModules(std::string pipelineName, ModuleDesc *m
     for (int i = 0; i < moduleTypeCount; i++) {
         ModuleDesc moduleDesc = modulesDesc[i];
         int moduleCount = (moduleDesc.moduleCount == -1) ? defaultCount : moduleDesc.moduleCount;
+        // optional, e.g. "ModelInfer.instanceNum = 4" runs 4 instances whatever the channel count is, a channel
+        // connect spreads the channels over them
+        int instanceNum = 0;
+        if (configParser_.GetIntValue(moduleDesc.moduleName + ".instanceNum", instanceNum) == APP_ERR_OK) {
+            if (instanceNum <= 0) {
+                LogFatal << "ModuleManager: " << moduleDesc.moduleName << ".instanceNum must be positive.";
+                return APP_ERR_COMM_INVALID_PARAM;
+            }
+            moduleCount = instanceNum;
+        }
         ModulesInfo modulesInfo;
         for (int j = 0; j < moduleCount; j++) {
             moduleInstance.reset(static_cast<ModuleBase *>(ModuleFactory::MakeModule(moduleDesc.moduleName)));
@@ -147,6 +256,92 @@ APP_ERROR ModuleManager::RegisterModules(std::string pipelineName, ModuleDesc *m
     return APP_ERR_OK;
 }
 
+// optional, e.g.
+//   Link.VideoDecoder.ModelInfer.policy = keep_latest
+//   Link.VideoDecoder.ModelInfer.queueSize = 2
+//   Link.ModelInfer.PostProcess.byteBudget = 33554432
+APP_ERROR ModuleManager::LoadLinkConfig(ModuleConnectDesc &connectDesc)
+{
+    std::string prefix = "Link." + connectDesc.moduleSend + "." + connectDesc.moduleRecv + ".";
+    std::string policyName;
+    if (configParser_.GetStringValue(prefix + "policy", policyName) == APP_ERR_OK) {
+        auto iter = BACKPRESSURE_POLICY_NAMES.find(policyName);
+        if (iter == BACKPRESSURE_POLICY_NAMES.end()) {
+            LogError << "Invalid " << prefix << "policy: " << policyName <<
+                ", expect block, drop_oldest, drop_newest, keep_latest or byte_budget.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        connectDesc.policy = iter->second;
+    }
+    uint32_t queueSize = 0;
+    if (configParser_.GetUnsignedIntValue(prefix + "queueSize", queueSize) == APP_ERR_OK) {
+        connectDesc.queueSize = queueSize;
+    }
+    std::string byteBudget;
+    if (configParser_.GetStringValue(prefix + "byteBudget", byteBudget) == APP_ERR_OK) {
+        connectDesc.byteBudget = std::strtoull(byteBudget.c_str(), nullptr, 0);
+    }
+    if (connectDesc.policy == BACKPRESSURE_BYTE_BUDGET && connectDesc.byteBudget == 0) {
+        LogError << prefix << "byteBudget must be set for the byte_budget policy.";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    return APP_ERR_OK;
+}
+
+// Each queue of a PAIR link, or of a CHANNEL link whose sender and receiver counts match, is fed by a single
+// sender instance and drained by a single receiver instance, so the SPSC ring can be used for it.
+// Links with a drop policy look at the oldest item on the sender side, which only BlockingQueue allows.
+std::shared_ptr<QueueBase<std::shared_ptr<void>>> ModuleManager::CreateModuleQueue(
+    const ModuleConnectDesc &connectDesc, size_t sendCount, size_t recvCount)
+{
+    uint32_t queueSize = connectDesc.queueSize;
+    if (queueSize == 0) {
+        queueSize = (connectDesc.policy == BACKPRESSURE_KEEP_LATEST) ? KEEP_LATEST_DEFAULT_SIZE : MODULE_QUEUE_SIZE;
+    }
+    if (!useRingQueue_ || connectDesc.policy != BACKPRESSURE_BLOCK) {
+        return std::make_shared<BlockingQueue<std::shared_ptr<void>>>(queueSize);
+    }
+    ModuleConnectType connectType = connectDesc.connectType;
+    bool isSingleProducer = (connectType == MODULE_CONNECT_PAIR) ||
+        (connectType == MODULE_CONNECT_CHANNEL && sendCount == recvCount);
+    if (isSingleProducer) {
+        return std::make_shared<SpscRingQueue<std::shared_ptr<void>>>(queueSize);
+    }
+    return std::make_shared<MpmcRingQueue<std::shared_ptr<void>>>(queueSize);
+}
+
+// The sender knows the type of the messages on the link, so it measures and releases the dropped ones.
+// The manager keeps every instance alive as long as the queues, a raw pointer avoids a reference cycle
+std::shared_ptr<BackpressureQueue<std::shared_ptr<void>>> ModuleManager::CreateLinkQueue(
+    const ModuleConnectDesc &connectDesc, std::shared_ptr<QueueBase<std::shared_ptr<void>>> queue,
+    ModuleBase *sender)
+{
+    auto linkQueue = std::make_shared<BackpressureQueue<std::shared_ptr<void>>>(queue, connectDesc.policy,
+        connectDesc.byteBudget);
+    linkQueue->SetMessageFuncs(
+        [sender](const std::shared_ptr<void> &message) { return sender->GetMessageBytes(message); },
+        [sender](std::shared_ptr<void> &message) { sender->ReleaseMessage(message); },
+        [sender](const std::shared_ptr<void> &message) { return sender->IsMessageDroppable(message); });
+    return linkQueue;
+}
+
+// Typed modules declare the message type of their ports, a connect is refused if the output type of the sender
+// differs from the input type of the receiver. Untyped ports are accepted as before
+bool ModuleManager::IsConnectTypeMatched(const ModulesInfo &moduleInfoSend, const ModulesInfo &moduleInfoRecv)
+{
+    if (moduleInfoSend.moduleVec.empty() || moduleInfoRecv.moduleVec.empty()) {
+        return true;
+    }
+    const std::type_info *sendType = moduleInfoSend.moduleVec[0]->GetOutputType();
+    const std::type_info *recvType = moduleInfoRecv.moduleVec[0]->GetInputType();
+    if (sendType == nullptr || recvType == nullptr || *sendType == *recvType) {
+        return true;
+    }
+    LogError << "Output type " << sendType->name() << " of " << moduleInfoSend.moduleVec[0]->GetModuleName() <<
+        " can not be received as " << recvType->name() << " by " << moduleInfoRecv.moduleVec[0]->GetModuleName();
+    return false;
+}
+
 APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, ModuleConnectDesc *connnectDesc,
     int moduleConnectCount)
 {
@@ -157,11 +352,15 @@ APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, Module
     }
     modulesInfoMap = iter->second;
 
-    std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> dataQueue = nullptr;
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> dataQueue = nullptr;
 
     // add connect
     for (int i = 0; i < moduleConnectCount; i++) {
         ModuleConnectDesc connectDesc = connnectDesc[i];
+        APP_ERROR ret = LoadLinkConfig(connectDesc);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
         LogDebug << "Add Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv << " type " <<
             connectDesc.connectType;
         auto iterSend = modulesInfoMap.find(connectDesc.moduleSend);
@@ -173,12 +372,28 @@ APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, Module
 
         ModulesInfo moduleInfoSend = iterSend->second;
         ModulesInfo moduleInfoRecv = iterRecv->second;
+        if (!IsConnectTypeMatched(moduleInfoSend, moduleInfoRecv)) {
+            LogFatal << "Message type mismatch between " << connectDesc.moduleSend << " and " <<
+                connectDesc.moduleRecv;
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
 
         // create input queue for recv module
+        LinkQueues linkQueues;
+        linkQueues.stat = {pipelineName, connectDesc.moduleSend, connectDesc.moduleRecv, connectDesc.policy, 0, 0};
         for (unsigned int j = 0; j < moduleInfoRecv.moduleVec.size(); j++) {
-            dataQueue = std::make_shared<BlockingQueue<std::shared_ptr<void>>>(MODULE_QUEUE_SIZE);
+            dataQueue = CreateModuleQueue(connectDesc, moduleInfoSend.moduleVec.size(),
+                moduleInfoRecv.moduleVec.size());
+            if (connectDesc.policy != BACKPRESSURE_BLOCK && !moduleInfoSend.moduleVec.empty()) {
+                auto linkQueue = CreateLinkQueue(connectDesc, dataQueue, moduleInfoSend.moduleVec[0].get());
+                linkQueues.queueVec.push_back(linkQueue);
+                dataQueue = linkQueue;
+            }
             moduleInfoRecv.inputQueueVec.push_back(dataQueue);
         }
+        if (!linkQueues.queueVec.empty()) {
+            linkQueuesVec_.push_back(linkQueues);
+        }
         RegisterInputVec(pipelineName, connectDesc.moduleRecv, moduleInfoRecv.inputQueueVec);
 
         //
@@ -189,7 +404,7 @@ APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, Module
 }
 
 APP_ERROR ModuleManager::RegisterInputVec(std::string pipelineName, std::string moduleName,
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> inputQueVec)
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> inputQueVec)
 {
     auto pipelineIter = pipelineMap_.find(pipelineName);
     std::map<std::string, ModulesInfo> modulesInfoMap;
@@ -205,7 +420,7 @@ APP_ERROR ModuleManager::RegisterInputVec(std::string pipelineName, std::string
         if (moduleInfo.moduleVec.size() != inputQueVec.size()) {
             return APP_ERR_COMM_FAILURE;
         }
-        std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue = nullptr;
+        std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue = nullptr;
         for (unsigned int j = 0; j < moduleInfo.moduleVec.size(); j++) {
             std::shared_ptr<ModuleBase> moduleInstance = moduleInfo.moduleVec[j];
             inputQueue = inputQueVec[j];
@@ -216,7 +431,7 @@ APP_ERROR ModuleManager::RegisterInputVec(std::string pipelineName, std::string
 }
 
 APP_ERROR ModuleManager::RegisterOutputModule(std::string pipelineName, std::string moduleSend, std::string moduleRecv,
-    ModuleConnectType connectType, std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec)
+    ModuleConnectType connectType, std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec)
 {
     auto pipelineIter = pipelineMap_.find(pipelineName);
     std::map<std::string, ModulesInfo> modulesInfoMap;
@@ -246,6 +461,23 @@ APP_ERROR ModuleManager::RunPipeline()
 {
     LogInfo << "ModuleManager: begin to run pipeline.";
 
+    if (executor_ != nullptr) {
+        APP_ERROR ret = executor_->Start();
+        if (ret != APP_ERR_OK) {
+            LogFatal << "ModuleManager: fail to start module executor.";
+            return ret;
+        }
+    }
+
+    // hand the executor to every instance before any of them runs, so no push misses a receiver
+    for (auto pipelineIter = pipelineMap_.begin(); pipelineIter != pipelineMap_.end(); pipelineIter++) {
+        for (auto iter = pipelineIter->second.begin(); iter != pipelineIter->second.end(); iter++) {
+            for (auto &instance : iter->second.moduleVec) {
+                instance->SetExecutor(executor_.get());
+            }
+        }
+    }
+
     // start the thread of the corresponding module
     std::map<std::string, ModulesInfo> modulesInfoMap;
     std::shared_ptr<ModuleBase> moduleInstance;
@@ -265,15 +497,136 @@ APP_ERROR ModuleManager::RunPipeline()
         }
     }
 
+    // a pipeline without metrics still runs, the failure is only logged
+    if (metricsPort_ > 0 && metricsPort_ <= UINT16_MAX) {
+        metricsServer_ = std::make_shared<MetricsServer>();
+        APP_ERROR ret = metricsServer_->Start(metricsAddress_, static_cast<uint16_t>(metricsPort_),
+            [this]() { return RenderMetrics(); });
+        if (ret != APP_ERR_OK) {
+            LogError << "ModuleManager: fail to start metrics server, ret=" << ret << ".";
+            metricsServer_ = nullptr;
+        }
+    } else if (metricsPort_ > UINT16_MAX) {
+        LogError << "ModuleManager: invalid metrics port " << metricsPort_ << ".";
+    }
+
     LogInfo << "ModuleManager: run pipeline success.";
     return APP_ERR_OK;
 }
 
+std::vector<ModuleLinkStat> ModuleManager::GetLinkStats()
+{
+    std::vector<ModuleLinkStat> linkStats;
+    for (auto &linkQueues : linkQueuesVec_) {
+        ModuleLinkStat stat = linkQueues.stat;
+        for (auto &queue : linkQueues.queueVec) {
+            stat.dropCount += queue->GetDropCount();
+            stat.dropBytes += queue->GetDropBytes();
+        }
+        linkStats.push_back(stat);
+    }
+    return linkStats;
+}
+
+// Modules and links are fixed once the pipeline runs, only the counters they hold change.
+// Every family is written as one block, as the text format requires
+std::string ModuleManager::RenderMetrics()
+{
+    std::ostringstream itemsIn;
+    std::ostringstream itemsOut;
+    std::ostringstream errors;
+    std::ostringstream queueDepth;
+    std::ostringstream processTime;
+    std::ostringstream queueWait;
+    std::ostringstream batchSize;
+    std::ostringstream batchTimeouts;
+    itemsIn << "# TYPE ascend_module_items_in_total counter\n";
+    itemsOut << "# TYPE ascend_module_items_out_total counter\n";
+    errors << "# TYPE ascend_module_errors_total counter\n";
+    queueDepth << "# TYPE ascend_module_queue_depth gauge\n";
+    processTime << "# TYPE ascend_module_process_seconds summary\n";
+    queueWait << "# TYPE ascend_module_queue_wait_seconds summary\n";
+    batchSize << "# TYPE ascend_module_batch_size histogram\n";
+    batchTimeouts << "# TYPE ascend_module_batch_timeouts_total counter\n";
+    for (auto &pipeline : pipelineMap_) {
+        for (auto &modulesInfo : pipeline.second) {
+            for (auto &instance : modulesInfo.second.moduleVec) {
+                const ModuleMetrics &metrics = instance->GetMetrics();
+                std::string labels = "pipeline=\"" + pipeline.first + "\",module=\"" + modulesInfo.first +
+                    "\",instance=\"" + std::to_string(instance->GetInstanceId()) + "\"";
+                itemsIn << "ascend_module_items_in_total{" << labels << "} " << metrics.itemsIn << "\n";
+                itemsOut << "ascend_module_items_out_total{" << labels << "} " << metrics.itemsOut << "\n";
+                errors << "ascend_module_errors_total{" << labels << "} " << metrics.errors << "\n";
+                queueDepth << "ascend_module_queue_depth{" << labels << "} " << instance->GetInputQueueSize() << "\n";
+                RenderSummary(processTime, "ascend_module_process_seconds", labels, metrics.processTime);
+                RenderSummary(queueWait, "ascend_module_queue_wait_seconds", labels, metrics.queueWait);
+                if (metrics.batchSize.GetCount() > 0) {
+                    RenderBatchSize(batchSize, labels, metrics.batchSize);
+                    batchTimeouts << "ascend_module_batch_timeouts_total{" << labels << "} " <<
+                        metrics.batchTimeouts << "\n";
+                }
+            }
+        }
+    }
+
+    std::ostringstream dropped;
+    std::ostringstream droppedBytes;
+    dropped << "# TYPE ascend_link_dropped_total counter\n";
+    droppedBytes << "# TYPE ascend_link_dropped_bytes_total counter\n";
+    for (auto &stat : GetLinkStats()) {
+        std::string policyName = std::to_string(stat.policy);
+        for (auto &policy : BACKPRESSURE_POLICY_NAMES) {
+            if (policy.second == stat.policy) {
+                policyName = policy.first;
+            }
+        }
+        std::string labels = "pipeline=\"" + stat.pipelineName + "\",send=\"" + stat.moduleSend + "\",recv=\"" +
+            stat.moduleRecv + "\",policy=\"" + policyName + "\"";
+        dropped << "ascend_link_dropped_total{" << labels << "} " << stat.dropCount << "\n";
+        droppedBytes << "ascend_link_dropped_bytes_total{" << labels << "} " << stat.dropBytes << "\n";
+    }
+    std::string metrics = itemsIn.str() + itemsOut.str() + errors.str() + queueDepth.str() + processTime.str() +
+        queueWait.str() + batchSize.str() + batchTimeouts.str() + dropped.str() + droppedBytes.str();
+
+    ObjectPoolStats objectPool = ObjectPool::GetStats();
+    std::ostringstream objectPoolMetrics;
+    objectPoolMetrics << "# TYPE ascend_object_pool_mallocs_total counter\n" <<
+        "ascend_object_pool_mallocs_total " << objectPool.mallocs << "\n" <<
+        "# TYPE ascend_object_pool_transfers_total counter\n" <<
+        "ascend_object_pool_transfers_total " << objectPool.transfers << "\n";
+    metrics += objectPoolMetrics.str();
+
+#ifdef ASCEND_MODULE_USE_ACL
+    std::ostringstream poolHits;
+    std::ostringstream poolMisses;
+    std::ostringstream poolCached;
+    std::ostringstream poolInUse;
+    poolHits << "# TYPE ascend_dvpp_pool_hits_total counter\n";
+    poolMisses << "# TYPE ascend_dvpp_pool_misses_total counter\n";
+    poolCached << "# TYPE ascend_dvpp_pool_cached_bytes gauge\n";
+    poolInUse << "# TYPE ascend_dvpp_pool_in_use_bytes gauge\n";
+    for (auto &pool : DvppMemoryPool::GetAllStats()) {
+        std::string labels = "device=\"" + std::to_string(pool.first) + "\"";
+        poolHits << "ascend_dvpp_pool_hits_total{" << labels << "} " << pool.second.hits << "\n";
+        poolMisses << "ascend_dvpp_pool_misses_total{" << labels << "} " << pool.second.misses << "\n";
+        poolCached << "ascend_dvpp_pool_cached_bytes{" << labels << "} " << pool.second.cachedBytes << "\n";
+        poolInUse << "ascend_dvpp_pool_in_use_bytes{" << labels << "} " << pool.second.inUseBytes << "\n";
+    }
+    metrics += poolHits.str() + poolMisses.str() + poolCached.str() + poolInUse.str();
+#endif
+    return metrics;
+}
+
 APP_ERROR ModuleManager::DeInit(void)
 {
     LogInfo << "begin to deinit module manager.";
     APP_ERROR ret = APP_ERR_OK;
 
+    if (metricsServer_ != nullptr) {
+        metricsServer_->Stop();
+        metricsServer_ = nullptr;
+    }
+
     // DeInit pipeline module
     ret = DeInitPipelineModule();
     if (ret != APP_ERR_OK) {
@@ -281,7 +634,27 @@ APP_ERROR ModuleManager::DeInit(void)
         return ret;
     }
 
+    for (auto &stat : GetLinkStats()) {
+        LogInfo << "[Statistic] [Link] [" << stat.moduleSend << " -> " << stat.moduleRecv << "] [Policy] [" <<
+            stat.policy << "] [Dropped] [" << stat.dropCount << "] [DroppedBytes] [" << stat.dropBytes << "]";
+    }
+
+    // every instance is stopped, no task is running any more
+    if (executor_ != nullptr) {
+        executor_->Stop();
+    }
+
+    if (Tracer::IsEnabled()) {
+        Tracer::Dump();
+    }
+
 #ifdef ASCEND_MODULE_USE_ACL
+    for (auto &pool : DvppMemoryPool::GetAllStats()) {
+        LogInfo << "[Statistic] [DvppMemoryPool] [Device] [" << pool.first << "] [Hits] [" << pool.second.hits <<
+            "] [Misses] [" << pool.second.misses << "] [InUseBytes] [" << pool.second.inUseBytes << "]";
+    }
+    // the cached blocks must be freed before the devices are reset
+    DvppMemoryPool::TrimAll();
     ResourceManager::GetInstance()->Release();
 #endif
 
@@ -22,6 +22,9 @@
 #include "Log/Log.h"
 #include "ModuleManager/ModuleBase.h"
 #include "ModuleManager/ModuleFactory.h"
+#include "ModuleManager/ModuleExecutor.h"
+#include "BlockingQueue/BackpressureQueue.h"
+#include "Statistic/MetricsServer.h"
 
 namespace ascendBaseModule {
 const std::string PIPELINE_DEFAULT = "DefaultPipeline";
@@ -31,16 +34,31 @@ struct ModuleDesc {
     int moduleCount; // -1 using the defaultCount
 };
 
+// policy, queueSize and byteBudget are the defaults of the link, BACKPRESSURE_BLOCK, 0, 0 for a plain queue. They
+// are overridden by Link.<moduleSend>.<moduleRecv>.* in the config file
 struct ModuleConnectDesc {
     std::string moduleSend;
     std::string moduleRecv;
     ModuleConnectType connectType;
+    BackpressurePolicy policy;
+    uint32_t queueSize;        // 0: the default size, the N of BACKPRESSURE_KEEP_LATEST
+    uint64_t byteBudget;       // max queued bytes of BACKPRESSURE_BYTE_BUDGET
+};
+
+// drop counters of one link, summed over its queues
+struct ModuleLinkStat {
+    std::string pipelineName;
+    std::string moduleSend;
+    std::string moduleRecv;
+    BackpressurePolicy policy;
+    uint64_t dropCount;
+    uint64_t dropBytes;
 };
 
 // information for one type of module
 struct ModulesInformation {
     std::vector<std::shared_ptr<ModuleBase>> moduleVec;
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> inputQueueVec;
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> inputQueueVec;
 };
 
 using ModulesInfo = ModulesInformation;
@@ -56,11 +74,14 @@ public:
     APP_ERROR RegisterModuleConnects(std::string pipelineName, ModuleConnectDesc *connnectDesc, int moduleConnectCount);
 
     APP_ERROR RegisterInputVec(std::string pipelineName, std::string moduleName,
-        std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> inputQueVec);
+        std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> inputQueVec);
     APP_ERROR RegisterOutputModule(std::string pipelineName, std::string moduleSend, std::string moduleRecv,
-        ModuleConnectType connectType, std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec);
+        ModuleConnectType connectType, std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec);
 
     APP_ERROR RunPipeline();
+    std::vector<ModuleLinkStat> GetLinkStats();
+    // counters, queue depths and latency summaries of every instance and link, in the Prometheus text format
+    std::string RenderMetrics();
 
 private:
 #ifdef ASCEND_MODULE_USE_ACL
@@ -69,6 +90,12 @@ private:
     APP_ERROR InitModuleInstance(std::shared_ptr<ModuleBase> moduleInstance, int instanceId, std::string pipelineName,
         std::string moduleName);
     APP_ERROR InitPipelineModule();
+    APP_ERROR LoadLinkConfig(ModuleConnectDesc &connectDesc);
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> CreateModuleQueue(const ModuleConnectDesc &connectDesc,
+        size_t sendCount, size_t recvCount);
+    std::shared_ptr<BackpressureQueue<std::shared_ptr<void>>> CreateLinkQueue(const ModuleConnectDesc &connectDesc,
+        std::shared_ptr<QueueBase<std::shared_ptr<void>>> queue, ModuleBase *sender);
+    static bool IsConnectTypeMatched(const ModulesInfo &moduleInfoSend, const ModulesInfo &moduleInfoRecv);
     APP_ERROR DeInitPipelineModule();
     static void StopModule(std::shared_ptr<ModuleBase> moduleInstance);
 
@@ -83,6 +110,16 @@ private:
     int moduleTypeCount_ = 0;
     int moduleConnectCount_ = 0;
     ModuleConnectDesc *connnectDesc_ = nullptr;
+    bool useRingQueue_ = true;
+    std::shared_ptr<ModuleExecutor> executor_ = nullptr; // null unless SystemConfig.useExecutor is true
+    struct LinkQueues {
+        ModuleLinkStat stat;
+        std::vector<std::shared_ptr<BackpressureQueue<std::shared_ptr<void>>>> queueVec;
+    };
+    std::vector<LinkQueues> linkQueuesVec_ = {}; // links with a drop policy
+    std::string metricsAddress_ = "127.0.0.1";
+    uint32_t metricsPort_ = 0; // 0: no metrics endpoint
+    std::shared_ptr<MetricsServer> metricsServer_ = nullptr;
 };
 }
 
@@ -0,0 +1,38 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_MODULE_MESSAGE_H
+#define INC_MODULE_MESSAGE_H
+
+#include <chrono>
+#include <cstdint>
+#include "Statistic/Tracer.h"
+
+namespace ascendBaseModule {
+// Carried by the messages between modules, filled by ModuleBase when a message is sent
+struct ModuleMessageContext {
+    uint64_t sendTimeUs = 0; // when the message was pushed to the queue of the next module
+    TraceContext trace = {};  // set by the source module, copied by each module to the messages it sends on
+};
+
+inline uint64_t ModuleNowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+}
+
+#endif
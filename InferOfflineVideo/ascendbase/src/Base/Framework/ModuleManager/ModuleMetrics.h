@@ -0,0 +1,38 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_MODULE_METRICS_H
+#define INC_MODULE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include "Statistic/BatchSizeHistogram.h"
+#include "Statistic/LatencyHistogram.h"
+
+namespace ascendBaseModule {
+// Counters of one module instance, written by the instance without locks and read by the metrics endpoint
+struct ModuleMetrics {
+    std::atomic<uint64_t> itemsIn = {0};  // messages handed to Process
+    std::atomic<uint64_t> itemsOut = {0}; // messages sent to the next modules
+    std::atomic<uint64_t> errors = {0};   // Process or ProcessBatch calls that failed
+    LatencyHistogram processTime;         // per Process call, or per ProcessBatch call when batched
+    LatencyHistogram queueWait;           // from SendToNextModule of the sender to Process, typed messages only
+    BatchSizeHistogram batchSize;         // items per batch, only for modules which pack items together
+    std::atomic<uint64_t> batchTimeouts = {0}; // batches sent by their deadline before they were full
+};
+}
+
+#endif
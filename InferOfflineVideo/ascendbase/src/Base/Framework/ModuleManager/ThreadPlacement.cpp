@@ -0,0 +1,266 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ThreadPlacement.h"
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include "Log/Log.h"
+
+namespace ascendBaseModule {
+namespace {
+const size_t THREAD_NAME_MAX_LEN = 15; // without the terminating null, limit of pthread_setname_np
+const int NUMA_NODE_MAX = 1024;
+const size_t BITS_PER_MASK_WORD = sizeof(unsigned long) * 8;
+const std::string NUMA_NODE_DIR = "/sys/devices/system/node/node";
+
+std::string TrimString(const std::string &str)
+{
+    size_t begin = str.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+// "3" or "0-3"
+bool ParseRange(const std::string &range, int &first, int &last)
+{
+    std::string item = TrimString(range);
+    size_t dash = item.find('-');
+    std::istringstream firstStream(item.substr(0, dash));
+    if (!(firstStream >> first) || first < 0) {
+        return false;
+    }
+    last = first;
+    if (dash != std::string::npos) {
+        std::istringstream lastStream(item.substr(dash + 1));
+        if (!(lastStream >> last) || last < first) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// picks the setting of instanceId out of "<setting>" or "<instances>:<setting>;<instances>:<setting>"
+APP_ERROR SelectInstanceValue(const std::string &value, int instanceId, std::string &selected, bool &found)
+{
+    found = false;
+    if (value.find(':') == std::string::npos) {
+        selected = TrimString(value);
+        found = true;
+        return APP_ERR_OK;
+    }
+    std::istringstream groups(value);
+    std::string group;
+    while (std::getline(groups, group, ';')) {
+        if (TrimString(group).empty()) {
+            continue;
+        }
+        size_t colon = group.find(':');
+        int first = 0;
+        int last = 0;
+        if (colon == std::string::npos || !ParseRange(group.substr(0, colon), first, last)) {
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        if (instanceId >= first && instanceId <= last) {
+            selected = TrimString(group.substr(colon + 1));
+            found = true;
+            return APP_ERR_OK;
+        }
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR GetInstanceValue(ConfigParser &configParser, const std::string &name, int instanceId,
+    std::string &selected, bool &found)
+{
+    found = false;
+    std::string value;
+    if (configParser.GetStringValue(name, value) != APP_ERR_OK) {
+        return APP_ERR_OK;
+    }
+    APP_ERROR ret = SelectInstanceValue(value, instanceId, selected, found);
+    if (ret != APP_ERR_OK) {
+        LogError << "Invalid value of " << name << ": " << value;
+    }
+    return ret;
+}
+
+APP_ERROR GetInstanceInt(ConfigParser &configParser, const std::string &name, int instanceId, int &value,
+    bool &found)
+{
+    std::string selected;
+    APP_ERROR ret = GetInstanceValue(configParser, name, instanceId, selected, found);
+    if (ret != APP_ERR_OK || !found) {
+        return ret;
+    }
+    std::istringstream stream(selected);
+    if (!(stream >> value)) {
+        LogError << "Invalid value of " << name << " for instance " << instanceId << ": " << selected;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    return APP_ERR_OK;
+}
+
+void SetThreadName(const std::string &threadName)
+{
+    std::string name = threadName.substr(0, THREAD_NAME_MAX_LEN);
+    int ret = pthread_setname_np(pthread_self(), name.c_str());
+    if (ret != 0) {
+        LogWarn << "Fail to set thread name " << name << ", err=" << ret;
+    }
+}
+
+void SetAffinity(const std::vector<int> &cpus, const std::string &threadName)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (ret != 0) {
+        LogWarn << "Fail to set cpu affinity of " << threadName << ", err=" << ret;
+    }
+}
+
+// thread-level MPOL_BIND through the syscall, so libnuma is not needed
+void BindMemory(int numaNode, const std::string &threadName)
+{
+    std::vector<unsigned long> nodeMask(NUMA_NODE_MAX / BITS_PER_MASK_WORD, 0);
+    nodeMask[numaNode / BITS_PER_MASK_WORD] |= 1UL << (numaNode % BITS_PER_MASK_WORD);
+    long ret = syscall(SYS_set_mempolicy, MPOL_BIND, nodeMask.data(), NUMA_NODE_MAX);
+    if (ret != 0) {
+        LogWarn << "Fail to bind memory of " << threadName << " to numa node " << numaNode << ", errno=" << errno;
+    }
+}
+
+void SetScheduling(const ThreadPlacement &placement, const std::string &threadName)
+{
+    if (!placement.schedPolicy.empty()) {
+        int policy = SCHED_OTHER;
+        if (placement.schedPolicy == "fifo") {
+            policy = SCHED_FIFO;
+        } else if (placement.schedPolicy == "rr") {
+            policy = SCHED_RR;
+        }
+        struct sched_param param;
+        param.sched_priority = (policy == SCHED_OTHER) ? 0 : placement.schedPriority;
+        int ret = pthread_setschedparam(pthread_self(), policy, &param);
+        if (ret != 0) {
+            LogWarn << "Fail to set " << placement.schedPolicy << " scheduling of " << threadName << ", err=" << ret;
+        }
+    }
+    // the nice value of a Linux thread is set through its thread id
+    if (placement.setNice && setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), placement.nice) != 0) {
+        LogWarn << "Fail to set nice " << placement.nice << " of " << threadName << ", errno=" << errno;
+    }
+}
+}
+
+APP_ERROR ParseCpuList(const std::string &cpuList, std::vector<int> &cpus)
+{
+    std::vector<int> parsed;
+    std::istringstream ranges(cpuList);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (TrimString(range).empty()) {
+            continue;
+        }
+        int first = 0;
+        int last = 0;
+        if (!ParseRange(range, first, last)) {
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            parsed.push_back(cpu);
+        }
+    }
+    cpus = parsed;
+    return APP_ERR_OK;
+}
+
+APP_ERROR LoadThreadPlacement(ConfigParser &configParser, const std::string &prefix, int instanceId,
+    ThreadPlacement &placement)
+{
+    std::string value;
+    bool found = false;
+    APP_ERROR ret = GetInstanceValue(configParser, prefix + ".cpuset", instanceId, value, found);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    if (found && ParseCpuList(value, placement.cpus) != APP_ERR_OK) {
+        LogError << "Invalid cpu list of " << prefix << ".cpuset for instance " << instanceId << ": " << value;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+
+    ret = GetInstanceInt(configParser, prefix + ".numaNode", instanceId, placement.numaNode, found);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    if (found && (placement.numaNode < 0 || placement.numaNode >= NUMA_NODE_MAX)) {
+        LogError << "Invalid " << prefix << ".numaNode for instance " << instanceId << ": " << placement.numaNode;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    // without a cpuset, run on the cpus of the node the memory is bound to
+    if (found && placement.cpus.empty()) {
+        std::ifstream cpuListFile(NUMA_NODE_DIR + std::to_string(placement.numaNode) + "/cpulist");
+        std::string cpuList;
+        if (std::getline(cpuListFile, cpuList)) {
+            ParseCpuList(cpuList, placement.cpus);
+        }
+    }
+
+    ret = GetInstanceValue(configParser, prefix + ".schedPolicy", instanceId, value, found);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    if (found) {
+        if (value != "fifo" && value != "rr" && value != "other") {
+            LogError << "Invalid " << prefix << ".schedPolicy for instance " << instanceId << ": " << value;
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        placement.schedPolicy = value;
+    }
+    ret = GetInstanceInt(configParser, prefix + ".schedPriority", instanceId, placement.schedPriority, found);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    return GetInstanceInt(configParser, prefix + ".nice", instanceId, placement.nice, placement.setNice);
+}
+
+void ApplyThreadPlacement(const ThreadPlacement &placement, const std::string &threadName)
+{
+    SetThreadName(threadName);
+    if (!placement.cpus.empty()) {
+        SetAffinity(placement.cpus, threadName);
+    }
+    if (placement.numaNode != THREAD_NUMA_NODE_NONE) {
+        BindMemory(placement.numaNode, threadName);
+    }
+    SetScheduling(placement, threadName);
+}
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_THREAD_PLACEMENT_H
+#define INC_THREAD_PLACEMENT_H
+
+#include <string>
+#include <vector>
+#include "ConfigParser/ConfigParser.h"
+#include "ErrorCode/ErrorCode.h"
+
+namespace ascendBaseModule {
+const int THREAD_NUMA_NODE_NONE = -1;
+
+// Where and how a thread runs, applied by the thread itself when it starts
+struct ThreadPlacement {
+    std::vector<int> cpus = {};                 // empty: any cpu, or the cpus of numaNode
+    int numaNode = THREAD_NUMA_NODE_NONE;       // memory allocated by the thread is bound to this node
+    std::string schedPolicy = {};               // "fifo", "rr" or "other", empty: unchanged
+    int schedPriority = 0;                      // 1 ~ 99 for fifo and rr
+    bool setNice = false;
+    int nice = 0;
+
+    bool IsSet() const
+    {
+        return !cpus.empty() || numaNode != THREAD_NUMA_NODE_NONE || !schedPolicy.empty() || setNice;
+    }
+};
+
+// Reads <prefix>.cpuset, .numaNode, .schedPolicy, .schedPriority and .nice for the given instance.
+// Every value is either one setting for all instances, e.g. "0-7,16-23", or a list of "<instances>:<setting>"
+// separated by ';', e.g. "0-3:0-7;4-7:8-15" for cpuset or "0-3:0;4-7:1" for numaNode.
+// A key that is missing or does not cover the instance leaves the setting unchanged
+APP_ERROR LoadThreadPlacement(ConfigParser &configParser, const std::string &prefix, int instanceId,
+    ThreadPlacement &placement);
+
+// Parses a cpu list like "0-3,8,10-11"
+APP_ERROR ParseCpuList(const std::string &cpuList, std::vector<int> &cpus);
+
+// Applies the placement to the calling thread and names it, names longer than 15 characters are cut.
+// Failures are logged and ignored, e.g. SCHED_FIFO without CAP_SYS_NICE
+void ApplyThreadPlacement(const ThreadPlacement &placement, const std::string &threadName);
+}
+
+#endif
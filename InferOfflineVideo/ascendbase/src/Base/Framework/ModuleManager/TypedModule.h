@@ -0,0 +1,169 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_TYPED_MODULE_H
+#define INC_TYPED_MODULE_H
+
+#include <memory>
+#include <typeinfo>
+#include "ModuleManager/ModuleBase.h"
+
+namespace ascendBaseModule {
+// type_info of a port, void stands for "no port" and is never checked
+template<typename T> inline const std::type_info *ModulePortType()
+{
+    return &typeid(T);
+}
+
+template<> inline const std::type_info *ModulePortType<void>()
+{
+    return nullptr;
+}
+
+// Defaults for the message hooks used by links that drop messages. Overload them next to a message type
+// (found by argument-dependent lookup) when it owns memory that is not released by its own destructor
+template<typename T> inline size_t ModuleMessageBytes(const T &)
+{
+    return sizeof(T);
+}
+
+template<typename T> inline void ModuleMessageRelease(T &) {}
+
+template<typename T> inline bool ModuleMessageDroppable(const T &)
+{
+    return true;
+}
+
+// Context carried by the message, nullptr if the type has none and its queue wait is not measured
+template<typename T> inline ModuleMessageContext *ModuleMessageContextOf(T &)
+{
+    return nullptr;
+}
+
+template<typename T> struct ModuleMessageHooks {
+    static size_t Bytes(const std::shared_ptr<void> &message)
+    {
+        return (message == nullptr) ? 0 : ModuleMessageBytes(*static_cast<const T *>(message.get()));
+    }
+    static void Release(std::shared_ptr<void> &message)
+    {
+        if (message != nullptr) {
+            ModuleMessageRelease(*static_cast<T *>(message.get()));
+        }
+    }
+    static bool Droppable(const std::shared_ptr<void> &message)
+    {
+        return (message == nullptr) || ModuleMessageDroppable(*static_cast<const T *>(message.get()));
+    }
+    static ModuleMessageContext *Context(const std::shared_ptr<void> &message)
+    {
+        return (message == nullptr) ? nullptr : ModuleMessageContextOf(*static_cast<T *>(message.get()));
+    }
+};
+
+template<> struct ModuleMessageHooks<void> {
+    static size_t Bytes(const std::shared_ptr<void> &)
+    {
+        return 0;
+    }
+    static void Release(std::shared_ptr<void> &) {}
+    static bool Droppable(const std::shared_ptr<void> &)
+    {
+        return true;
+    }
+    static ModuleMessageContext *Context(const std::shared_ptr<void> &)
+    {
+        return nullptr;
+    }
+};
+
+// Module whose input and output messages have fixed types. The cast from the type-erased queue item is done
+// once here, and ModuleManager refuses to connect a sender whose Out differs from the In of the receiver.
+// Use In = void for source modules and Out = void for sinks.
+template<typename In, typename Out> class TypedModule : public ModuleBase {
+public:
+    using InputType = In;
+    using OutputType = Out;
+
+    const std::type_info *GetInputType() const
+    {
+        return ModulePortType<In>();
+    }
+
+    const std::type_info *GetOutputType() const
+    {
+        return ModulePortType<Out>();
+    }
+
+    size_t GetMessageBytes(const std::shared_ptr<void> &message) const
+    {
+        return ModuleMessageHooks<Out>::Bytes(message);
+    }
+
+    void ReleaseMessage(std::shared_ptr<void> &message) const
+    {
+        ModuleMessageHooks<Out>::Release(message);
+    }
+
+    bool IsMessageDroppable(const std::shared_ptr<void> &message) const
+    {
+        return ModuleMessageHooks<Out>::Droppable(message);
+    }
+
+    using ModuleBase::SendToNextModule;
+
+    // outputData is moved into the queue of the next module, no reference count is taken on the way
+    void SendToNextModule(const std::string &moduleNext, std::shared_ptr<Out> &&outputData, int channelId = 0)
+    {
+        ModuleBase::SendToNextModule(moduleNext, Stamp(std::move(outputData)), channelId);
+    }
+
+    void SendToNextModule(ModuleOutputPort outputPort, std::shared_ptr<Out> &&outputData, int channelId = 0)
+    {
+        ModuleBase::SendToNextModule(outputPort, Stamp(std::move(outputData)), channelId);
+    }
+
+    // send to the first connected module, the usual case of a module with one output
+    void SendToNextModule(std::shared_ptr<Out> &&outputData, int channelId = 0)
+    {
+        ModuleBase::SendToNextModule(defaultOutputPort_, Stamp(std::move(outputData)), channelId);
+    }
+
+protected:
+    virtual APP_ERROR ProcessData(std::shared_ptr<In> inputData) = 0;
+
+private:
+    std::shared_ptr<void> Stamp(std::shared_ptr<Out> &&outputData)
+    {
+        std::shared_ptr<void> message(std::move(outputData));
+        StampMessage(ModuleMessageHooks<Out>::Context(message));
+        return message;
+    }
+
+    APP_ERROR Process(std::shared_ptr<void> inputData)
+    {
+        const ModuleMessageContext *context = ModuleMessageHooks<In>::Context(inputData);
+        RecordQueueWait(context);
+        if (context == nullptr || !context->trace.sampled) {
+            return ProcessData(std::static_pointer_cast<In>(inputData));
+        }
+        TraceSpan span(moduleName_.c_str(), context->trace, TRACE_SPAN_PROCESS);
+        return ProcessData(std::static_pointer_cast<In>(inputData));
+    }
+};
+}
+
+#endif
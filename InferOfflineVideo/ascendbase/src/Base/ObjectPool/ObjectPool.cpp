@@ -0,0 +1,156 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ObjectPool/ObjectPool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+const size_t CLASS_NUM = OBJECT_POOL_MAX_SIZE / OBJECT_POOL_ALIGN;
+const size_t BATCH_SIZE = 32;                    // blocks moved between a thread and the depot at once
+const size_t MAX_THREAD_BLOCKS = 2 * BATCH_SIZE; // per class and thread
+const size_t MAX_DEPOT_BLOCKS = 8192;            // per class, the surplus goes back to ::operator delete
+
+struct Depot {
+    std::mutex mutex;
+    std::vector<void *> blocks;
+};
+
+// never destroyed, threads give their blocks back when they exit
+Depot *GetDepots()
+{
+    static Depot *depots = new Depot[CLASS_NUM];
+    return depots;
+}
+
+std::atomic<uint64_t> g_mallocs(0);
+std::atomic<uint64_t> g_transfers(0);
+
+thread_local bool t_cacheDestroyed = false;
+
+struct ThreadCache {
+    std::vector<void *> blocks[CLASS_NUM];
+
+    ~ThreadCache()
+    {
+        t_cacheDestroyed = true;
+        for (size_t classIndex = 0; classIndex < CLASS_NUM; classIndex++) {
+            Depot &depot = GetDepots()[classIndex];
+            std::lock_guard<std::mutex> lock(depot.mutex);
+            for (void *block : blocks[classIndex]) {
+                if (depot.blocks.size() < MAX_DEPOT_BLOCKS) {
+                    depot.blocks.push_back(block);
+                } else {
+                    ::operator delete(block);
+                }
+            }
+        }
+    }
+};
+
+thread_local ThreadCache t_cache;
+
+size_t ClassOf(size_t size)
+{
+    return (size == 0) ? 0 : (size - 1) / OBJECT_POOL_ALIGN;
+}
+
+void Refill(size_t classIndex, std::vector<void *> &blocks)
+{
+    if (blocks.capacity() == 0) {
+        blocks.reserve(MAX_THREAD_BLOCKS);
+    }
+    Depot &depot = GetDepots()[classIndex];
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    size_t count = std::min(BATCH_SIZE, depot.blocks.size());
+    if (count > 0) {
+        blocks.insert(blocks.end(), depot.blocks.end() - count, depot.blocks.end());
+        depot.blocks.resize(depot.blocks.size() - count);
+        g_transfers.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// the oldest half of the list goes to the depot, the recently released blocks are more likely in cache
+void Flush(size_t classIndex, std::vector<void *> &blocks)
+{
+    Depot &depot = GetDepots()[classIndex];
+    {
+        std::lock_guard<std::mutex> lock(depot.mutex);
+        size_t count = std::min(BATCH_SIZE, MAX_DEPOT_BLOCKS - depot.blocks.size());
+        depot.blocks.insert(depot.blocks.end(), blocks.begin(), blocks.begin() + count);
+        for (size_t i = count; i < BATCH_SIZE; i++) {
+            ::operator delete(blocks[i]);
+        }
+    }
+    blocks.erase(blocks.begin(), blocks.begin() + BATCH_SIZE);
+    g_transfers.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+void *ObjectPool::Allocate(size_t size)
+{
+    if (size > OBJECT_POOL_MAX_SIZE) {
+        g_mallocs.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    size_t classIndex = ClassOf(size);
+    // also the size of a block allocated while the thread exits, another thread may put it in the free list
+    if (t_cacheDestroyed) {
+        g_mallocs.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new((classIndex + 1) * OBJECT_POOL_ALIGN);
+    }
+    std::vector<void *> &blocks = t_cache.blocks[classIndex];
+    if (blocks.empty()) {
+        Refill(classIndex, blocks);
+    }
+    if (!blocks.empty()) {
+        void *block = blocks.back();
+        blocks.pop_back();
+        return block;
+    }
+    g_mallocs.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new((classIndex + 1) * OBJECT_POOL_ALIGN);
+}
+
+void ObjectPool::Deallocate(void *block, size_t size)
+{
+    if (block == nullptr) {
+        return;
+    }
+    if (size > OBJECT_POOL_MAX_SIZE || t_cacheDestroyed) {
+        ::operator delete(block);
+        return;
+    }
+    size_t classIndex = ClassOf(size);
+    std::vector<void *> &blocks = t_cache.blocks[classIndex];
+    if (blocks.capacity() == 0) {
+        blocks.reserve(MAX_THREAD_BLOCKS);
+    }
+    blocks.push_back(block);
+    if (blocks.size() >= MAX_THREAD_BLOCKS) {
+        Flush(classIndex, blocks);
+    }
+}
+
+ObjectPoolStats ObjectPool::GetStats()
+{
+    ObjectPoolStats stats;
+    stats.mallocs = g_mallocs.load(std::memory_order_relaxed);
+    stats.transfers = g_transfers.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <stdint.h>
+
+const size_t OBJECT_POOL_ALIGN = 16;     // size classes are multiples of it
+const size_t OBJECT_POOL_MAX_SIZE = 1024; // larger blocks are not cached
+
+struct ObjectPoolStats {
+    uint64_t mallocs = 0;   // blocks taken from ::operator new
+    uint64_t transfers = 0; // batches moved between a thread and the shared depot
+};
+
+// Recycles the small blocks of the per-frame messages. Each thread keeps a free list per size class, without lock.
+// Messages are allocated by one module thread and released by the next one, so the releasing thread hands whole
+// batches to a shared depot and the allocating thread takes them from there, the lock is taken once per batch.
+// Once the pipeline runs, the blocks go round and ::operator new is not called any more
+class ObjectPool {
+public:
+    static void *Allocate(size_t size);
+    static void Deallocate(void *block, size_t size);
+    static ObjectPoolStats GetStats();
+};
+
+// Allocator of the standard containers and std::allocate_shared backed by ObjectPool
+template<typename T> class RecyclingAllocator {
+public:
+    using value_type = T;
+
+    RecyclingAllocator() = default;
+    template<typename U> RecyclingAllocator(const RecyclingAllocator<U> &) {}
+
+    T *allocate(size_t n)
+    {
+        static_assert(alignof(T) <= OBJECT_POOL_ALIGN, "alignment of the type is larger than the pool's");
+        return static_cast<T *>(ObjectPool::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *block, size_t n)
+    {
+        ObjectPool::Deallocate(block, n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const RecyclingAllocator<T> &, const RecyclingAllocator<U> &)
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const RecyclingAllocator<T> &, const RecyclingAllocator<U> &)
+{
+    return false;
+}
+
+// The object and its control block are one block of the pool
+template<typename T, typename... Args> std::shared_ptr<T> MakePooled(Args &&...args)
+{
+    return std::allocate_shared<T>(RecyclingAllocator<T>(), std::forward<Args>(args)...);
+}
+
+// For objects passed as raw pointers, e.g. the user data of callbacks. Release them with DeletePooled
+template<typename T, typename... Args> T *NewPooled(Args &&...args)
+{
+    static_assert(alignof(T) <= OBJECT_POOL_ALIGN, "alignment of the type is larger than the pool's");
+    void *block = ObjectPool::Allocate(sizeof(T));
+    try {
+        return new (block) T(std::forward<Args>(args)...);
+    } catch (...) {
+        ObjectPool::Deallocate(block, sizeof(T));
+        throw;
+    }
+}
+
+template<typename T> void DeletePooled(T *object)
+{
+    if (object != nullptr) {
+        object->~T();
+        ObjectPool::Deallocate(object, sizeof(T));
+    }
+}
+
+#endif
@@ -15,6 +15,10 @@
 
 #include "ResourceManager.h"
 #include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 std::shared_ptr<ResourceManager> ResourceManager::ptr_ = nullptr;
 
@@ -72,6 +76,7 @@ APP_ERROR ResourceManager::InitResource(ResourceInfo& resourceInfo)
         LogError << "Failed to init acl, ret = " << ret;
         return ret;
     }
+    modelMapPopulate_ = resourceInfo.modelMapPopulate;
     std::copy(resourceInfo.deviceIds.begin(), resourceInfo.deviceIds.end(), std::back_inserter(deviceIds_));
     LogInfo << "Initialized acl successfully.";
     // Open device and create context for each chip, note: it create one context for each chip
@@ -107,4 +112,79 @@ APP_ERROR ResourceManager::InitResource(ResourceInfo& resourceInfo)
 aclrtContext ResourceManager::GetContext(int deviceId)
 {
     return contexts_[deviceIdMap_[deviceId]];
-}
\ No newline at end of file
+}
+/*
+ * @description: Map a model file read-only, or share the mapping of it which is still in use
+ * @param modelPath Path of the om model file
+ * @param info Gets the mapping and the size of the file
+ */
+APP_ERROR ResourceManager::MapModelFile(const std::string &modelPath, ModelInfo &info)
+{
+    MappedFile &mappedFile = modelFiles_[modelPath];
+    info.modelFilePtr = mappedFile.data.lock();
+    if (info.modelFilePtr != nullptr) {
+        info.modelFileSize = mappedFile.size;
+        return APP_ERR_OK;
+    }
+    int fd = open(modelPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LogError << "Failed to open model file " << modelPath << ".";
+        return APP_ERR_COMM_OPEN_FAIL;
+    }
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        LogError << "Failed to get the size of model file " << modelPath << ".";
+        return APP_ERR_COMM_READ_FAIL;
+    }
+    size_t fileSize = static_cast<size_t>(fileStat.st_size);
+    int flags = MAP_PRIVATE | (modelMapPopulate_ ? MAP_POPULATE : 0);
+    void *data = mmap(nullptr, fileSize, PROT_READ, flags, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LogError << "Failed to map model file " << modelPath << ".";
+        return APP_ERR_COMM_READ_FAIL;
+    }
+    info.modelFilePtr.reset(data, [fileSize](void *ptr) { munmap(ptr, fileSize); });
+    info.modelFileSize = fileSize;
+    mappedFile.data = info.modelFilePtr;
+    mappedFile.size = fileSize;
+    return APP_ERR_OK;
+}
+
+/*
+ * @description: Get the shared resource of a model file on a device, the file is mapped on the first call
+ * @param modelPath Path of the om model file
+ * @param deviceId The device the model is loaded on
+ * @param model The resource, released with the last copy of it
+ */
+APP_ERROR ResourceManager::AcquireModel(const std::string &modelPath, int deviceId,
+    std::shared_ptr<ModelResource> &model)
+{
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    std::weak_ptr<ModelResource> &registered = models_[std::make_pair(deviceId, modelPath)];
+    model = registered.lock();
+    if (model != nullptr) {
+        return APP_ERR_OK;
+    }
+
+    std::shared_ptr<ModelResource> resource = std::make_shared<ModelResource>();
+    resource->info.modelPath = modelPath;
+    resource->info.method = LOAD_FROM_MEM_WITH_MEM;
+    resource->deviceId = deviceId;
+    APP_ERROR ret = MapModelFile(modelPath, resource->info);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = aclmdlQuerySizeFromMem(resource->info.modelFilePtr.get(), resource->info.modelFileSize,
+        &resource->workSize, &resource->weightSize);
+    if (ret != APP_ERR_OK) {
+        LogError << "aclmdlQuerySizeFromMem failed, ret[" << ret << "].";
+        return ret;
+    }
+    LogInfo << "Registered model " << modelPath << " of " << resource->info.modelFileSize << " bytes for device " <<
+        deviceId << ", work size " << resource->workSize << ", weight size " << resource->weightSize << ".";
+    registered = resource;
+    model = resource;
+    return APP_ERR_OK;
+}
@@ -16,6 +16,8 @@
 #ifndef RESOURCEMANAGER_H
 #define RESOURCEMANAGER_H
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <set>
 #include <unordered_map>
@@ -42,6 +44,17 @@ struct ModelInfo {
     ModelLoadMethod method; // Loading method of model
 };
 
+// A model file mapped once and the sizes queried from it, shared by the ModelProcess instances of the model on one
+// device. The file is unmapped with the last of them
+struct ModelResource {
+    ModelInfo info;         // modelPath, modelFileSize and modelFilePtr, the read-only mapping of the file
+    int deviceId = 0;
+    size_t workSize = 0;    // work memory of each loaded instance
+    size_t weightSize = 0;
+    std::mutex weightMutex;
+    std::weak_ptr<void> weight; // weight memory of the instances sharing it, owned by them
+};
+
 // Device resource info, such as model infos, etc
 struct DeviceResInfo {
     std::vector<ModelInfo> modelInfos;
@@ -51,6 +64,7 @@ struct ResourceInfo {
     std::set<int> deviceIds;
     std::string aclConfigPath;
     std::string singleOpFolderPath;
+    bool modelMapPopulate = false; // prefault the mapped model files (MAP_POPULATE)
     std::unordered_map<int, DeviceResInfo> deviceResInfos; // map <deviceId, deviceResourceInfo>
 };
 
@@ -67,6 +81,10 @@ public:
 
     aclrtContext GetContext(int deviceId);
 
+    // Model registry: the first call for a model file maps it, later calls for the same file share the mapping,
+    // and those for the same device also share the queried sizes
+    APP_ERROR AcquireModel(const std::string &modelPath, int deviceId, std::shared_ptr<ModelResource> &model);
+
     void Release();
 
 protected:
@@ -74,12 +92,22 @@ protected:
     ResourceManager() : initFlag(false) {};
 
 private:
+    struct MappedFile {
+        std::weak_ptr<void> data;
+        size_t size;
+    };
+
+    APP_ERROR MapModelFile(const std::string &modelPath, ModelInfo &info);
 
     static std::shared_ptr<ResourceManager> ptr_;
     bool initFlag;
     std::vector<int> deviceIds_;
     std::vector<aclrtContext> contexts_;
     std::unordered_map<int, int> deviceIdMap_; // Map of device to index
+    bool modelMapPopulate_ = false;
+    std::mutex modelMutex_;
+    std::map<std::string, MappedFile> modelFiles_; // by model path
+    std::map<std::pair<int, std::string>, std::weak_ptr<ModelResource>> models_; // by device and model path
 };
 
 #endif
\ No newline at end of file
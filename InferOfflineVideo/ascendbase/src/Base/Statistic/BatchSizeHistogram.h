@@ -0,0 +1,69 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BATCH_SIZE_HISTOGRAM_H
+#define BATCH_SIZE_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+// Count of batches per number of items, e.g. frames packed into one model execution. Sizes above MAX_SIZE share
+// the last bucket. Record is wait-free and may be called from any thread
+class BatchSizeHistogram {
+public:
+    static const uint32_t MAX_SIZE = 64;
+
+    BatchSizeHistogram()
+    {
+        for (uint32_t i = 0; i <= MAX_SIZE; i++) {
+            buckets_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Record(uint32_t size)
+    {
+        buckets_[(size < MAX_SIZE) ? size : MAX_SIZE].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    uint64_t GetCount() const
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t GetSum() const
+    {
+        return sum_.load(std::memory_order_relaxed);
+    }
+
+    // Number of batches with at most size items
+    uint64_t GetCountUpTo(uint32_t size) const
+    {
+        uint64_t count = 0;
+        for (uint32_t i = 0; i <= size && i <= MAX_SIZE; i++) {
+            count += buckets_[i].load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[MAX_SIZE + 1];
+    std::atomic<uint64_t> count_ = {0};
+    std::atomic<uint64_t> sum_ = {0};
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+// Log-linear histogram of durations in microseconds. Values below 16 us get a bucket each, every power of two
+// above is split into 8 linear sub-buckets, so a percentile is off by at most 12.5%.
+// Record is wait-free and may be called from any thread, readers get a slightly racy but consistent view.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 3;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const int LINEAR_LIMIT_BITS = SUB_BUCKET_BITS + 1;
+    static const uint64_t LINEAR_LIMIT = 1ULL << LINEAR_LIMIT_BITS;
+    static const int MAX_EXPONENT = 40; // buckets up to 2^41 us, about 25 days, longer values go to the last one
+    static const int BUCKET_COUNT = LINEAR_LIMIT + (MAX_EXPONENT - LINEAR_LIMIT_BITS + 1) * SUB_BUCKET_COUNT;
+
+    LatencyHistogram()
+    {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            buckets_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Record(uint64_t valueUs)
+    {
+        buckets_[BucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumUs_.fetch_add(valueUs, std::memory_order_relaxed);
+    }
+
+    uint64_t GetCount() const
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t GetSumUs() const
+    {
+        return sumUs_.load(std::memory_order_relaxed);
+    }
+
+    // Upper bound of the bucket holding the given quantile (0.0 ~ 1.0), 0 if nothing was recorded
+    uint64_t GetPercentileUs(double quantile) const
+    {
+        uint64_t total = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            total += buckets_[i].load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(quantile * total + 0.5);
+        rank = (rank == 0) ? 1 : rank;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return BucketUpperBound(i);
+            }
+        }
+        return BucketUpperBound(BUCKET_COUNT - 1);
+    }
+
+    static int BucketIndex(uint64_t valueUs)
+    {
+        if (valueUs < LINEAR_LIMIT) {
+            return static_cast<int>(valueUs);
+        }
+        int exponent = 63 - __builtin_clzll(valueUs);
+        if (exponent > MAX_EXPONENT) {
+            return BUCKET_COUNT - 1;
+        }
+        int subBucket = static_cast<int>((valueUs >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+        return static_cast<int>(LINEAR_LIMIT) + (exponent - LINEAR_LIMIT_BITS) * SUB_BUCKET_COUNT + subBucket;
+    }
+
+    // exclusive upper bound of the values counted in bucket index
+    static uint64_t BucketUpperBound(int index)
+    {
+        if (index < static_cast<int>(LINEAR_LIMIT)) {
+            return static_cast<uint64_t>(index) + 1;
+        }
+        int offset = index - static_cast<int>(LINEAR_LIMIT);
+        int exponent = LINEAR_LIMIT_BITS + offset / SUB_BUCKET_COUNT;
+        uint64_t subBucket = static_cast<uint64_t>(offset % SUB_BUCKET_COUNT);
+        return (SUB_BUCKET_COUNT + subBucket + 1) << (exponent - SUB_BUCKET_BITS);
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+    std::atomic<uint64_t> count_ = {0};
+    std::atomic<uint64_t> sumUs_ = {0};
+};
+
+#endif
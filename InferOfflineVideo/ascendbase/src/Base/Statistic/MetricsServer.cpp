@@ -0,0 +1,142 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetricsServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstring>
+#include "Log/Log.h"
+
+namespace {
+const int METRICS_LISTEN_BACKLOG = 8;
+const int METRICS_POLL_TIMEOUT_MS = 200; // how often the serve thread checks for Stop
+const int METRICS_RECV_TIMEOUT_S = 2;
+const size_t METRICS_REQUEST_MAX_SIZE = 4096;
+}
+
+MetricsServer::~MetricsServer()
+{
+    Stop();
+}
+
+APP_ERROR MetricsServer::Start(const std::string &address, uint16_t port, RenderFunc renderFunc)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        LogError << "MetricsServer: invalid address " << address;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        LogError << "MetricsServer: fail to create socket, errno=" << errno;
+        return APP_ERR_COMM_FAILURE;
+    }
+    int reuse = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listenFd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd_, METRICS_LISTEN_BACKLOG) != 0) {
+        LogError << "MetricsServer: fail to listen on " << address << ":" << port << ", errno=" << errno;
+        close(listenFd_);
+        listenFd_ = -1;
+        return APP_ERR_COMM_FAILURE;
+    }
+
+    renderFunc_ = renderFunc;
+    isStop_ = false;
+    serveThr_ = std::thread(&MetricsServer::ServeThread, this);
+    LogInfo << "MetricsServer: serving http://" << address << ":" << port << "/metrics";
+    return APP_ERR_OK;
+}
+
+void MetricsServer::Stop()
+{
+    isStop_ = true;
+    if (serveThr_.joinable()) {
+        serveThr_.join();
+    }
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+    }
+}
+
+void MetricsServer::ServeThread()
+{
+    struct pollfd pfd;
+    pfd.fd = listenFd_;
+    pfd.events = POLLIN;
+    while (!isStop_) {
+        pfd.revents = 0;
+        int ret = poll(&pfd, 1, METRICS_POLL_TIMEOUT_MS);
+        if (ret <= 0 || (pfd.revents & POLLIN) == 0) {
+            continue;
+        }
+        int connFd = accept(listenFd_, nullptr, nullptr);
+        if (connFd < 0) {
+            continue;
+        }
+        HandleConnection(connFd);
+        close(connFd);
+    }
+}
+
+void MetricsServer::HandleConnection(int connFd)
+{
+    struct timeval timeout = {METRICS_RECV_TIMEOUT_S, 0};
+    setsockopt(connFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(connFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // only the request line matters, the headers are read until the blank line and ignored
+    std::string request;
+    char buffer[512];
+    while (request.size() < METRICS_REQUEST_MAX_SIZE && request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t len = recv(connFd, buffer, sizeof(buffer), 0);
+        if (len <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(len));
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (request.compare(0, strlen("GET /metrics"), "GET /metrics") == 0) {
+        body = renderFunc_();
+    } else {
+        status = "404 Not Found";
+        body = "try GET /metrics\n";
+    }
+    std::string response = "HTTP/1.0 " + status + "\r\n" +
+        "Content-Type: text/plain; version=0.0.4\r\n" +
+        "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+        "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t len = send(connFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (len <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(len);
+    }
+}
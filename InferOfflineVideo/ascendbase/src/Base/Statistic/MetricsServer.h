@@ -0,0 +1,49 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include "ErrorCode/ErrorCode.h"
+
+// Minimal HTTP server answering GET /metrics with the text built by the render function, in the Prometheus
+// text exposition format. One request is served at a time on its own thread, so scraping never touches
+// the pipeline threads.
+class MetricsServer {
+public:
+    using RenderFunc = std::function<std::string()>;
+
+    MetricsServer() {}
+    ~MetricsServer();
+    APP_ERROR Start(const std::string &address, uint16_t port, RenderFunc renderFunc);
+    void Stop();
+
+private:
+    void ServeThread();
+    void HandleConnection(int connFd);
+
+private:
+    int listenFd_ = -1;
+    RenderFunc renderFunc_ = nullptr;
+    std::thread serveThr_ = {};
+    std::atomic_bool isStop_ = {false};
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Tracer.h"
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "Log/Log.h"
+
+namespace {
+const size_t TRACE_NAME_SIZE = 32;
+const size_t TRACE_BUFFER_EVENTS = 8192; // per thread, older spans are overwritten
+const size_t TRACE_THREAD_NAME_SIZE = 16;
+
+struct TraceEvent {
+    char name[TRACE_NAME_SIZE];
+    TraceSpanKind kind;
+    uint32_t channelId;
+    uint64_t frameId;
+    uint64_t startUs;
+    uint64_t endUs;
+};
+
+// Written only by its own thread. The reader takes the events below writeIndex and drops those the writer may
+// have overwritten while they were copied
+struct TraceBuffer {
+    long tid = 0;
+    std::string threadName = {};
+    std::atomic<uint64_t> writeIndex = {0};
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+};
+
+// buffers are kept after their thread exits, so the spans of finished threads are still dumped
+std::mutex g_bufferMutex;
+std::vector<std::shared_ptr<TraceBuffer>> g_buffers;
+thread_local TraceBuffer *g_threadBuffer = nullptr;
+
+TraceBuffer *GetThreadBuffer()
+{
+    if (g_threadBuffer == nullptr) {
+        std::shared_ptr<TraceBuffer> buffer = std::make_shared<TraceBuffer>();
+        buffer->tid = syscall(SYS_gettid);
+        char threadName[TRACE_THREAD_NAME_SIZE] = {0};
+        if (pthread_getname_np(pthread_self(), threadName, sizeof(threadName)) == 0) {
+            buffer->threadName = threadName;
+        }
+        std::lock_guard<std::mutex> lock(g_bufferMutex);
+        g_buffers.push_back(buffer);
+        g_threadBuffer = buffer.get();
+    }
+    return g_threadBuffer;
+}
+
+void CollectEvents(TraceBuffer &buffer, std::vector<TraceEvent> &events)
+{
+    uint64_t end = buffer.writeIndex.load(std::memory_order_acquire);
+    uint64_t begin = (end > TRACE_BUFFER_EVENTS) ? (end - TRACE_BUFFER_EVENTS) : 0;
+    std::vector<TraceEvent> copied;
+    copied.reserve(end - begin);
+    for (uint64_t i = begin; i < end; i++) {
+        copied.push_back(buffer.events[i % TRACE_BUFFER_EVENTS]);
+    }
+    uint64_t endAfter = buffer.writeIndex.load(std::memory_order_acquire);
+    uint64_t validBegin = (endAfter > TRACE_BUFFER_EVENTS) ? (endAfter - TRACE_BUFFER_EVENTS) : 0;
+    for (uint64_t i = begin; i < end; i++) {
+        if (i >= validBegin) {
+            events.push_back(copied[i - begin]);
+        }
+    }
+}
+
+// names come from module names and literals, only quotes and backslashes need escaping
+std::string JsonEscape(const char *str)
+{
+    std::string escaped;
+    for (; *str != '\0'; str++) {
+        if (*str == '"' || *str == '\\') {
+            escaped += '\\';
+        }
+        escaped += *str;
+    }
+    return escaped;
+}
+}
+
+std::atomic<uint32_t> Tracer::sampleInterval_ = {0};
+std::atomic_bool Tracer::dumpRequested_ = {false};
+std::string Tracer::traceFile_ = DEFAULT_TRACE_FILE;
+
+void Tracer::Init(uint32_t sampleInterval, const std::string &traceFile)
+{
+    traceFile_ = traceFile;
+    sampleInterval_ = sampleInterval;
+    if (sampleInterval > 0) {
+        LogInfo << "Tracer: trace every " << sampleInterval << " frames of each channel, dump to " << traceFile;
+    }
+}
+
+TraceContext Tracer::Begin(uint32_t channelId, uint64_t frameId)
+{
+    TraceContext context;
+    context.channelId = channelId;
+    context.frameId = frameId;
+    uint32_t sampleInterval = sampleInterval_.load(std::memory_order_relaxed);
+    context.sampled = (sampleInterval != 0) && (frameId % sampleInterval == 0);
+    return context;
+}
+
+uint64_t Tracer::NowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Tracer::Record(const char *name, TraceSpanKind kind, const TraceContext &context, uint64_t startUs,
+    uint64_t endUs)
+{
+    TraceBuffer *buffer = GetThreadBuffer();
+    uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer->events[index % TRACE_BUFFER_EVENTS];
+    strncpy(event.name, name, TRACE_NAME_SIZE - 1);
+    event.name[TRACE_NAME_SIZE - 1] = '\0';
+    event.kind = kind;
+    event.channelId = context.channelId;
+    event.frameId = context.frameId;
+    event.startUs = startUs;
+    event.endUs = (endUs > startUs) ? endUs : startUs;
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::RequestDump()
+{
+    dumpRequested_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::DumpIfRequested()
+{
+    if (dumpRequested_.exchange(false)) {
+        Dump();
+    }
+}
+
+APP_ERROR Tracer::Dump(const std::string &path)
+{
+    std::string tracePath = path.empty() ? traceFile_ : path;
+    std::ofstream out(tracePath, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        LogError << "Tracer: fail to open " << tracePath;
+        return APP_ERR_COMM_OPEN_FAIL;
+    }
+
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_bufferMutex);
+        buffers = g_buffers;
+    }
+
+    // one process per channel, one thread track per pipeline thread. Queue waits of consecutive frames overlap,
+    // they are async spans keyed by the frame id instead
+    size_t eventCount = 0;
+    std::set<std::pair<uint32_t, long>> tracks;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (auto &buffer : buffers) {
+        std::vector<TraceEvent> events;
+        CollectEvents(*buffer, events);
+        for (auto &event : events) {
+            std::string name = JsonEscape(event.name);
+            std::string common = ",\"pid\":" + std::to_string(event.channelId) + ",\"tid\":" +
+                std::to_string(buffer->tid) + ",\"args\":{\"frameId\":" + std::to_string(event.frameId) + "}}";
+            out << ((eventCount == 0) ? "" : ",\n");
+            if (event.kind == TRACE_SPAN_QUEUE_WAIT) {
+                std::string id = ",\"id\":" + std::to_string(event.frameId);
+                out << "{\"name\":\"" << name << " wait\",\"cat\":\"queue\",\"ph\":\"b\",\"ts\":" << event.startUs <<
+                    id << common << ",\n";
+                out << "{\"name\":\"" << name << " wait\",\"cat\":\"queue\",\"ph\":\"e\",\"ts\":" << event.endUs <<
+                    id << common;
+            } else {
+                out << "{\"name\":\"" << name << "\",\"cat\":\"" <<
+                    ((event.kind == TRACE_SPAN_PROCESS) ? "process" : "stage") << "\",\"ph\":\"X\",\"ts\":" <<
+                    event.startUs << ",\"dur\":" << (event.endUs - event.startUs) << common;
+            }
+            tracks.insert(std::make_pair(event.channelId, buffer->tid));
+            eventCount++;
+        }
+    }
+    std::set<uint32_t> channels;
+    for (auto &track : tracks) {
+        channels.insert(track.first);
+    }
+    for (auto channelId : channels) {
+        out << ((eventCount == 0) ? "" : ",\n");
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << channelId << ",\"args\":{\"name\":\"channel " <<
+            channelId << "\"}}";
+        eventCount++;
+    }
+    for (auto &buffer : buffers) {
+        for (auto &track : tracks) {
+            if (track.second == buffer->tid && !buffer->threadName.empty()) {
+                out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << track.first << ",\"tid\":" <<
+                    track.second << ",\"args\":{\"name\":\"" << JsonEscape(buffer->threadName.c_str()) << "\"}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    out.close();
+    LogInfo << "Tracer: wrote " << tracePath;
+    return APP_ERR_OK;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "ErrorCode/ErrorCode.h"
+
+const std::string DEFAULT_TRACE_FILE = "./logs/trace.json";
+
+// Identifies one source frame on its way through the pipeline. Copied from message to message,
+// nothing is recorded for it unless sampled is set
+struct TraceContext {
+    uint32_t channelId = 0;
+    uint64_t frameId = 0;
+    bool sampled = false;
+};
+
+enum TraceSpanKind {
+    TRACE_SPAN_PROCESS = 0, // Process of a module
+    TRACE_SPAN_QUEUE_WAIT,  // from the send of the previous module to Process, may overlap other frames
+    TRACE_SPAN_STAGE        // a step inside a module, e.g. the decode or the model execution
+};
+
+// Sampled per-frame tracing. Every thread writes its spans into an own ring buffer without locks, Dump merges
+// the buffers into a Chrome trace (chrome://tracing or ui.perfetto.dev) with one process track per channel.
+// When sampling is off the cost is the check of TraceContext::sampled.
+class Tracer {
+public:
+    // sampleInterval: trace every N-th frame of each channel, 0 turns tracing off
+    static void Init(uint32_t sampleInterval, const std::string &traceFile = DEFAULT_TRACE_FILE);
+    static bool IsEnabled()
+    {
+        return sampleInterval_.load(std::memory_order_relaxed) != 0;
+    }
+    // called by the source module once per frame, decides the sampling of the frame
+    static TraceContext Begin(uint32_t channelId, uint64_t frameId);
+    static void Record(const char *name, TraceSpanKind kind, const TraceContext &context, uint64_t startUs,
+        uint64_t endUs);
+    static uint64_t NowUs();
+    // async-signal-safe, the dump is written by the next DumpIfRequested
+    static void RequestDump();
+    static void DumpIfRequested();
+    // writes the spans still held by the buffers, traceFile_ if path is empty
+    static APP_ERROR Dump(const std::string &path = "");
+
+private:
+    static std::atomic<uint32_t> sampleInterval_;
+    static std::atomic_bool dumpRequested_;
+    static std::string traceFile_;
+};
+
+// Records the enclosing scope as a TRACE_SPAN_STAGE (or the given kind) span of a sampled frame
+class TraceSpan {
+public:
+    TraceSpan(const char *name, const TraceContext &context, TraceSpanKind kind = TRACE_SPAN_STAGE)
+        : name_(name), context_(context), kind_(kind), startUs_(context.sampled ? Tracer::NowUs() : 0) {}
+    ~TraceSpan()
+    {
+        if (context_.sampled) {
+            Tracer::Record(name_, kind_, context_, startUs_, Tracer::NowUs());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name_;
+    TraceContext context_; // a copy, the message holding the context may be sent on before the scope ends
+    TraceSpanKind kind_;
+    uint64_t startUs_;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TaskPool.h"
+#include <algorithm>
+#include <map>
+#include "Log/Log.h"
+
+namespace {
+std::mutex g_sharedMutex;
+std::map<uint32_t, std::weak_ptr<TaskPool>> g_sharedPools;
+}
+
+std::shared_ptr<TaskPool> TaskPool::GetShared(uint32_t threadNum)
+{
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    std::shared_ptr<TaskPool> pool = g_sharedPools[threadNum].lock();
+    if (pool == nullptr) {
+        pool = std::make_shared<TaskPool>(threadNum);
+        g_sharedPools[threadNum] = pool;
+    }
+    return pool;
+}
+
+TaskPool::TaskPool(uint32_t threadNum)
+{
+    for (uint32_t i = 0; i < threadNum; i++) {
+        threads_.emplace_back(&TaskPool::WorkerThread, this);
+    }
+    LogInfo << "Task pool started with " << threadNum << " workers.";
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStop_ = true;
+    }
+    workCond_.notify_all();
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+}
+
+uint32_t TaskPool::GetThreadNum() const
+{
+    return static_cast<uint32_t>(threads_.size());
+}
+
+void TaskPool::RunJob(Job &job)
+{
+    for (size_t i = job.next.fetch_add(1); i < job.count; i = job.next.fetch_add(1)) {
+        (*job.func)(i);
+    }
+}
+
+void TaskPool::ParallelFor(size_t count, const std::function<void(size_t)> &func)
+{
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || threads_.empty()) {
+        for (size_t i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+    Job job;
+    job.func = &func;
+    job.count = count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(&job);
+    }
+    // the caller takes one iteration itself, so no more workers than the rest are woken
+    if (count - 1 >= threads_.size()) {
+        workCond_.notify_all();
+    } else {
+        for (size_t i = 0; i < count - 1; i++) {
+            workCond_.notify_one();
+        }
+    }
+    RunJob(job);
+    // no iteration is left to take, the job leaves the queue and the caller waits for the workers still in it
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = std::find(jobs_.begin(), jobs_.end(), &job);
+    if (iter != jobs_.end()) {
+        jobs_.erase(iter);
+    }
+    doneCond_.wait(lock, [&job] { return job.users == 0; });
+}
+
+void TaskPool::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workCond_.wait(lock, [this] { return isStop_ || !jobs_.empty(); });
+        if (isStop_) {
+            return;
+        }
+        Job *job = jobs_.front();
+        if (job->next.load() >= job->count) {
+            // every iteration is taken, the caller removes it once it is done with its own
+            jobs_.pop_front();
+            continue;
+        }
+        job->users++;
+        lock.unlock();
+        RunJob(*job);
+        lock.lock();
+        if (--job->users == 0) {
+            doneCond_.notify_all();
+        }
+    }
+}
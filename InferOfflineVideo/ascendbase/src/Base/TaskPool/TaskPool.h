@@ -0,0 +1,69 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+// Workers for data parallel loops of the modules, e.g. the decode of the model outputs. Unlike ModuleExecutor,
+// which schedules module instances, a job here is one loop: the calling thread runs iterations too and returns
+// when all of them are done, so a job never waits for a worker which is busy elsewhere.
+// The workers have no ACL context, the loop bodies must only touch host memory
+class TaskPool {
+public:
+    // Pool shared by the callers asking for the same thread number, created by the first of them and stopped
+    // when the last reference is released
+    static std::shared_ptr<TaskPool> GetShared(uint32_t threadNum);
+
+    explicit TaskPool(uint32_t threadNum);
+    ~TaskPool();
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    // Calls func(i) for i in [0, count) on the workers and the calling thread, in any order
+    void ParallelFor(size_t count, const std::function<void(size_t)> &func);
+    uint32_t GetThreadNum() const;
+
+private:
+    struct Job {
+        const std::function<void(size_t)> *func = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next = {0};
+        uint32_t users = 0; // workers holding the job, guarded by mutex_
+    };
+
+    void WorkerThread();
+    static void RunJob(Job &job);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable workCond_;
+    std::condition_variable doneCond_;
+    std::deque<Job *> jobs_;
+    bool isStop_ = false;
+};
+
+#endif